@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+public class ClassLookupBenchmark {
+    private static final String[] BOOT_CLASS_NAMES = {
+        "java.lang.Object",
+        "java.lang.String",
+        "java.util.ArrayList",
+        "java.util.HashMap",
+        "java.util.concurrent.ConcurrentHashMap",
+        "java.io.File",
+    };
+
+    private static final String[] APP_CLASS_NAMES = {
+        "ClassLookupBenchmark",
+        "ClassLookupBenchmark$Lookup",
+    };
+
+    public void timeForNameBoot(int count) throws Exception {
+        total += new Lookup(BOOT_CLASS_NAMES, count).lookUp();
+    }
+
+    public void timeForNameApp(int count) throws Exception {
+        total += new Lookup(APP_CLASS_NAMES, count).lookUp();
+    }
+
+    public void timeForNameBoot4Threads(int count) throws Exception {
+        total += runThreads(BOOT_CLASS_NAMES, count, 4);
+    }
+
+    public void timeForNameApp4Threads(int count) throws Exception {
+        total += runThreads(APP_CLASS_NAMES, count, 4);
+    }
+
+    public void timeForNameBoot16Threads(int count) throws Exception {
+        total += runThreads(BOOT_CLASS_NAMES, count, 16);
+    }
+
+    private static int runThreads(String[] names, int count, int numThreads) throws Exception {
+        Lookup[] lookups = new Lookup[numThreads];
+        Thread[] threads = new Thread[numThreads];
+        for (int i = 0; i < numThreads; ++i) {
+            lookups[i] = new Lookup(names, count);
+            threads[i] = new Thread(lookups[i]);
+        }
+        for (Thread thread : threads) {
+            thread.start();
+        }
+        int found = 0;
+        for (int i = 0; i < numThreads; ++i) {
+            threads[i].join();
+            found += lookups[i].found;
+        }
+        return found;
+    }
+
+    private static class Lookup implements Runnable {
+        private final String[] names;
+        private final int count;
+        private final ClassLoader loader = ClassLookupBenchmark.class.getClassLoader();
+        public int found = 0;
+
+        Lookup(String[] names, int count) {
+            this.names = names;
+            this.count = count;
+        }
+
+        public int lookUp() throws ClassNotFoundException {
+            for (int i = 0; i < count; ++i) {
+                for (String name : names) {
+                    if (Class.forName(name, false, loader) != null) {
+                        ++found;
+                    }
+                }
+            }
+            return found;
+        }
+
+        public void run() {
+            try {
+                lookUp();
+            } catch (ClassNotFoundException e) {
+                throw new Error(e);
+            }
+        }
+    }
+
+    public int total = 0;
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+public class ExceptionThrowBenchmark {
+    public void timeThrowDepth0(int count) {
+        for (int i = 0; i < count; ++i) {
+            try {
+                $noinline$throw(0);
+            } catch (IllegalStateException expected) {
+                ++caught;
+            }
+        }
+    }
+
+    public void timeThrowDepth10(int count) {
+        for (int i = 0; i < count; ++i) {
+            try {
+                $noinline$throw(10);
+            } catch (IllegalStateException expected) {
+                ++caught;
+            }
+        }
+    }
+
+    public void timeThrowDepth50(int count) {
+        for (int i = 0; i < count; ++i) {
+            try {
+                $noinline$throw(50);
+            } catch (IllegalStateException expected) {
+                ++caught;
+            }
+        }
+    }
+
+    public void timeThrowInlined(int count) {
+        for (int i = 0; i < count; ++i) {
+            try {
+                $noinline$throwInlined();
+            } catch (IllegalStateException expected) {
+                ++caught;
+            }
+        }
+    }
+
+    public void timeThrowDepth10AndGetStackTrace(int count) {
+        for (int i = 0; i < count; ++i) {
+            try {
+                $noinline$throw(10);
+            } catch (IllegalStateException expected) {
+                caught += expected.getStackTrace().length;
+            }
+        }
+    }
+
+    public void timeNumberFormatException(int count) {
+        for (int i = 0; i < count; ++i) {
+            try {
+                Integer.parseInt("not a number");
+            } catch (NumberFormatException expected) {
+                ++caught;
+            }
+        }
+    }
+
+    private static void $noinline$throw(int depth) {
+        if (depth == 0) {
+            throw new IllegalStateException();
+        }
+        $noinline$throw(depth - 1);
+    }
+
+    private static void $noinline$throwInlined() {
+        level1();
+    }
+
+    private static void level1() {
+        level2();
+    }
+
+    private static void level2() {
+        level3();
+    }
+
+    private static void level3() {
+        throw new IllegalStateException();
+    }
+
+    public int caught = 0;
+}
@@ -34,6 +34,26 @@ extern "C" JNIEXPORT void JNICALL Java_JObjectBenchmark_timeAddRemoveLocal(
   }
 }
 
+extern "C" JNIEXPORT void JNICALL Java_JObjectBenchmark_timeAddRemoveLocalLargeTable(
+    JNIEnv* env, jobject jobj, jint reps) {
+  // Keep enough local references alive to grow the table past its initial small table.
+  constexpr jint kLiveLocals = 1000;
+  CHECK_EQ(env->PushLocalFrame(kLiveLocals + 1), JNI_OK);
+  {
+    ScopedObjectAccess soa(env);
+    ObjPtr<mirror::Object> obj = soa.Decode<mirror::Object>(jobj);
+    CHECK(obj != nullptr);
+    for (jint i = 0; i < kLiveLocals; ++i) {
+      soa.Env()->AddLocalReference<jobject>(obj);
+    }
+    for (jint i = 0; i < reps; ++i) {
+      jobject ref = soa.Env()->AddLocalReference<jobject>(obj);
+      soa.Env()->DeleteLocalRef(ref);
+    }
+  }
+  env->PopLocalFrame(nullptr);
+}
+
 extern "C" JNIEXPORT void JNICALL Java_JObjectBenchmark_timeDecodeLocal(
     JNIEnv* env, jobject jobj, jint reps) {
   ScopedObjectAccess soa(env);
@@ -96,6 +96,19 @@ static JNINativeMethod gMethods_Critical[] = {
         reinterpret_cast<void*>(NAME_CRITICAL_JNI_METHOD(emptyJniStaticMethod6_1Critical)) }
 };
 
+// @FastNative @ReferenceFreeNative methods use the same native code as @FastNative,
+// only the JNI stub differs.
+static void NativeMethods_emptyJniMethod0_ReferenceFree(JNIEnv*, jobject) { }
+static void NativeMethods_emptyJniStaticMethod0_ReferenceFree(JNIEnv*, jclass) { }
+static void NativeMethods_emptyJniStaticMethod6_ReferenceFree(JNIEnv*, jclass,
+                                                              int, int, int, int, int, int) { }
+
+static JNINativeMethod gMethods_ReferenceFree[] = {
+  NATIVE_METHOD(NativeMethods, emptyJniMethod0_ReferenceFree, "()V"),
+  NATIVE_METHOD(NativeMethods, emptyJniStaticMethod0_ReferenceFree, "()V"),
+  NATIVE_METHOD(NativeMethods, emptyJniStaticMethod6_ReferenceFree, "(IIIIII)V"),
+};
+
 void jniRegisterNativeMethods(JNIEnv* env,
                               const char* className,
                               const JNINativeMethod* methods,
@@ -143,4 +156,14 @@ void register_micro_native_methods(JNIEnv* env) {
     }
   }
   // else let them be registered implicitly.
+
+  if (env->FindClass("dalvik/annotation/optimization/ReferenceFreeNative") != nullptr) {
+    jniRegisterNativeMethods(env,
+                             CLASS_NAME,
+                             gMethods_ReferenceFree,
+                             NELEM(gMethods_ReferenceFree));
+  } else if (env->ExceptionCheck()) {
+    // It will throw NoClassDefFoundError
+    env->ExceptionClear();
+  }
 }
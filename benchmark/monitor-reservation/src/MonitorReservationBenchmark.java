@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import java.util.Hashtable;
+import java.util.Vector;
+
+public class MonitorReservationBenchmark {
+    private static final int SIZE = 16;
+
+    private final Counter counter = new Counter();
+    private final Object lock = new Object();
+
+    public void timeSynchronizedMethod(int count) {
+        for (int i = 0; i < count; ++i) {
+            counter.increment();
+        }
+        total += counter.get();
+    }
+
+    public void timeSynchronizedBlockNested(int count) {
+        for (int i = 0; i < count; ++i) {
+            synchronized (lock) {
+                synchronized (lock) {
+                    ++total;
+                }
+            }
+        }
+    }
+
+    public void timeStringBuffer(int count) {
+        for (int i = 0; i < count; ++i) {
+            StringBuffer buffer = new StringBuffer();
+            for (int j = 0; j < SIZE; ++j) {
+                buffer.append('x');
+            }
+            total += buffer.length();
+        }
+    }
+
+    public void timeVector(int count) {
+        Vector<Integer> vector = new Vector<>();
+        for (int i = 0; i < SIZE; ++i) {
+            vector.add(i);
+        }
+        for (int i = 0; i < count; ++i) {
+            for (int j = 0; j < SIZE; ++j) {
+                total += vector.get(j);
+            }
+        }
+    }
+
+    public void timeHashtable(int count) {
+        Hashtable<Integer, Integer> table = new Hashtable<>();
+        for (int i = 0; i < SIZE; ++i) {
+            table.put(i, i);
+        }
+        for (int i = 0; i < count; ++i) {
+            for (int j = 0; j < SIZE; ++j) {
+                total += table.get(j);
+            }
+        }
+    }
+
+    // The same counter used by two threads in turn, so that reservations get revoked.
+    public void timeSynchronizedMethodAlternatingThreads(int count) throws Exception {
+        Counter shared = new Counter();
+        for (int i = 0; i < 2; ++i) {
+            Thread thread = new Thread(() -> {
+                for (int j = 0; j < count; ++j) {
+                    shared.increment();
+                }
+            });
+            thread.start();
+            thread.join();
+        }
+        total += shared.get();
+    }
+
+    private static class Counter {
+        private int value = 0;
+
+        public synchronized void increment() {
+            ++value;
+        }
+
+        public synchronized int get() {
+            return value;
+        }
+    }
+
+    public int total = 0;
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+public class NterpFusionBenchmark {
+    private static final int DEPTH = 8;
+
+    private final Node chain = makeChain(DEPTH);
+
+    // Each level is an invoke, move-result and return.
+    public void timeDelegatingInt(int count) {
+        for (int i = 0; i < count; ++i) {
+            total += chain.getInt();
+        }
+    }
+
+    public void timeDelegatingLong(int count) {
+        for (int i = 0; i < count; ++i) {
+            total += chain.getLong();
+        }
+    }
+
+    public void timeDelegatingObject(int count) {
+        for (int i = 0; i < count; ++i) {
+            total += chain.getObject().hashCode();
+        }
+    }
+
+    public void timeRecursiveSum(int count) {
+        for (int i = 0; i < count; ++i) {
+            total += sum(DEPTH);
+        }
+    }
+
+    private static int sum(int n) {
+        if (n == 0) {
+            return 0;
+        }
+        return n + sum(n - 1);
+    }
+
+    private static Node makeChain(int depth) {
+        Node node = new Node(null);
+        for (int i = 0; i < depth; ++i) {
+            node = new Node(node);
+        }
+        return node;
+    }
+
+    private static class Node {
+        private final Node next;
+
+        Node(Node next) {
+            this.next = next;
+        }
+
+        int getInt() {
+            if (next == null) {
+                return 42;
+            }
+            return next.getInt();
+        }
+
+        long getLong() {
+            if (next == null) {
+                return 42L;
+            }
+            return next.getLong();
+        }
+
+        Object getObject() {
+            if (next == null) {
+                return this;
+            }
+            return next.getObject();
+        }
+    }
+
+    private long total = 0;
+}
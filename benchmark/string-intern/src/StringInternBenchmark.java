@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+public class StringInternBenchmark {
+    // Literals are strong interns, found in the boot image or app intern tables.
+    private static final String[] LITERALS = {
+        "java.lang.Object",
+        "StringInternBenchmark",
+        "intern",
+        "",
+    };
+
+    // Copies of the literals, so that String.intern() has to look them up.
+    private static final String[] COPIES = copies(LITERALS);
+
+    // Copies of weak interns, which String.intern() adds for strings that are not literals.
+    private static final String[] WEAK = copies(weakInterns(4));
+
+    public void timeInternStrong(int count) throws Exception {
+        total += new Intern(COPIES, count).intern();
+    }
+
+    public void timeInternWeak(int count) throws Exception {
+        total += new Intern(WEAK, count).intern();
+    }
+
+    public void timeInternStrong4Threads(int count) throws Exception {
+        total += runThreads(COPIES, count, 4);
+    }
+
+    public void timeInternWeak4Threads(int count) throws Exception {
+        total += runThreads(WEAK, count, 4);
+    }
+
+    public void timeInternStrong16Threads(int count) throws Exception {
+        total += runThreads(COPIES, count, 16);
+    }
+
+    private static String[] copies(String[] strings) {
+        String[] result = new String[strings.length];
+        for (int i = 0; i < strings.length; ++i) {
+            result[i] = new String(strings[i]);
+        }
+        return result;
+    }
+
+    private static String[] weakInterns(int num) {
+        String[] result = new String[num];
+        for (int i = 0; i < num; ++i) {
+            result[i] = ("weak intern " + i).intern();
+        }
+        return result;
+    }
+
+    private static int runThreads(String[] strings, int count, int numThreads) throws Exception {
+        Intern[] interns = new Intern[numThreads];
+        Thread[] threads = new Thread[numThreads];
+        for (int i = 0; i < numThreads; ++i) {
+            interns[i] = new Intern(strings, count);
+            threads[i] = new Thread(interns[i]);
+        }
+        for (Thread thread : threads) {
+            thread.start();
+        }
+        int found = 0;
+        for (int i = 0; i < numThreads; ++i) {
+            threads[i].join();
+            found += interns[i].found;
+        }
+        return found;
+    }
+
+    private static class Intern implements Runnable {
+        private final String[] strings;
+        private final int count;
+        public int found = 0;
+
+        Intern(String[] strings, int count) {
+            this.strings = strings;
+            this.count = count;
+        }
+
+        public int intern() {
+            for (int i = 0; i < count; ++i) {
+                for (String string : strings) {
+                    if (string.intern() != string) {
+                        ++found;
+                    }
+                }
+            }
+            return found;
+        }
+
+        public void run() {
+            intern();
+        }
+    }
+
+    public int total = 0;
+}
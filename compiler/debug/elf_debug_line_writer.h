@@ -50,14 +50,29 @@ class ElfDebugLineWriter {
   // Write line table for given set of methods.
   // Returns the number of bytes written.
   size_t WriteCompilationUnit(ElfCompilationUnit& compilation_unit) {
+    std::vector<uint8_t> buffer;
+    EncodeCompilationUnit(compilation_unit, &buffer);
+    return WriteCompilationUnit(compilation_unit, buffer);
+  }
+
+  // Write line table previously encoded by EncodeCompilationUnit().
+  size_t WriteCompilationUnit(ElfCompilationUnit& compilation_unit,
+                              const std::vector<uint8_t>& buffer) {
+    compilation_unit.debug_line_offset = builder_->GetDebugLine()->GetPosition();
+    builder_->GetDebugLine()->WriteFully(buffer.data(), buffer.size());
+    return buffer.size();
+  }
+
+  // Encode line table for given set of methods. The table does not depend on its
+  // position in the section, so this may be called concurrently for different units.
+  void EncodeCompilationUnit(const ElfCompilationUnit& compilation_unit,
+                             std::vector<uint8_t>* buffer) const {
     const InstructionSet isa = builder_->GetIsa();
     const bool is64bit = Is64BitInstructionSet(isa);
     const Elf_Addr base_address = compilation_unit.is_code_address_text_relative
         ? builder_->GetText()->GetAddress()
         : 0;
 
-    compilation_unit.debug_line_offset = builder_->GetDebugLine()->GetPosition();
-
     std::vector<dwarf::FileEntry> files;
     std::unordered_map<std::string, size_t> files_map;
     std::vector<std::string> directories;
@@ -261,11 +276,8 @@ class ElfDebugLineWriter {
       opcodes.AdvancePC(method_address + mi->code_size);
       opcodes.EndSequence();
     }
-    std::vector<uint8_t> buffer;
-    buffer.reserve(opcodes.data()->size() + KB);
-    WriteDebugLineTable(directories, files, opcodes, &buffer);
-    builder_->GetDebugLine()->WriteFully(buffer.data(), buffer.size());
-    return buffer.size();
+    buffer->reserve(opcodes.data()->size() + KB);
+    WriteDebugLineTable(directories, files, opcodes, buffer);
   }
 
   void End() {
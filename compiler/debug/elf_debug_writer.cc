@@ -16,6 +16,7 @@
 
 #include "elf_debug_writer.h"
 
+#include <functional>
 #include <type_traits>
 #include <unordered_map>
 #include <vector>
@@ -37,15 +38,29 @@
 #include "jit/debugger_interface.h"
 #include "oat/oat.h"
 #include "stream/vector_output_stream.h"
+#include "thread-current-inl.h"
+#include "thread_pool.h"
 
 namespace art HIDDEN {
 namespace debug {
 
 using ElfRuntimeTypes = std::conditional<sizeof(void*) == 4, ElfTypes32, ElfTypes64>::type;
 
+// Calls `fn(i)` for all `i` in [0, n), using the workers of `thread_pool` if there is one.
+static void ForAll(ThreadPool* thread_pool, size_t n, const std::function<void(size_t)>& fn) {
+  if (thread_pool != nullptr) {
+    thread_pool->ForAll(Thread::Current(), n, fn);
+  } else {
+    for (size_t i = 0; i != n; ++i) {
+      fn(i);
+    }
+  }
+}
+
 template <typename ElfTypes>
 void WriteDebugInfo(ElfBuilder<ElfTypes>* builder,
-                    const DebugInfo& debug_info) {
+                    const DebugInfo& debug_info,
+                    ThreadPool* thread_pool) {
   // Write .strtab and .symtab.
   WriteDebugSymbols(builder, /* mini-debug-info= */ false, debug_info);
 
@@ -88,12 +103,17 @@ void WriteDebugInfo(ElfBuilder<ElfTypes>* builder,
                 return a.methods.front() < b.methods.front();
             });
 
-  // Write .debug_line section.
+  // Write .debug_line section. The line tables are encoded in parallel
+  // and written in the order of the compilation units.
   if (!compilation_units.empty()) {
     ElfDebugLineWriter<ElfTypes> line_writer(builder);
+    std::vector<std::vector<uint8_t>> line_tables(compilation_units.size());
+    ForAll(thread_pool, compilation_units.size(), [&](size_t i) {
+      line_writer.EncodeCompilationUnit(compilation_units[i], &line_tables[i]);
+    });
     line_writer.Start();
-    for (auto& compilation_unit : compilation_units) {
-      line_writer.WriteCompilationUnit(compilation_unit);
+    for (size_t i = 0; i != compilation_units.size(); ++i) {
+      line_writer.WriteCompilationUnit(compilation_units[i], line_tables[i]);
     }
     line_writer.End();
   }
@@ -118,7 +138,8 @@ static std::vector<uint8_t> MakeMiniDebugInfoInternal(
     size_t text_section_size,
     typename ElfTypes::Addr dex_section_address,
     size_t dex_section_size,
-    const DebugInfo& debug_info) {
+    const DebugInfo& debug_info,
+    ThreadPool* thread_pool) {
   std::vector<uint8_t> buffer;
   buffer.reserve(KB);
   VectorOutputStream out("Mini-debug-info ELF file", &buffer);
@@ -141,7 +162,11 @@ static std::vector<uint8_t> MakeMiniDebugInfoInternal(
   CHECK(builder->Good());
   std::vector<uint8_t> compressed_buffer;
   compressed_buffer.reserve(buffer.size() / 4);
-  XzCompress(ArrayRef<const uint8_t>(buffer), &compressed_buffer);
+  XzCompressParallel(ArrayRef<const uint8_t>(buffer),
+                     &compressed_buffer,
+                     [thread_pool](size_t n, const std::function<void(size_t)>& fn) {
+                       ForAll(thread_pool, n, fn);
+                     });
   return compressed_buffer;
 }
 
@@ -152,7 +177,8 @@ std::vector<uint8_t> MakeMiniDebugInfo(
     size_t text_section_size,
     uint64_t dex_section_address,
     size_t dex_section_size,
-    const DebugInfo& debug_info) {
+    const DebugInfo& debug_info,
+    ThreadPool* thread_pool) {
   if (Is64BitInstructionSet(isa)) {
     return MakeMiniDebugInfoInternal<ElfTypes64>(isa,
                                                  features,
@@ -160,7 +186,8 @@ std::vector<uint8_t> MakeMiniDebugInfo(
                                                  text_section_size,
                                                  dex_section_address,
                                                  dex_section_size,
-                                                 debug_info);
+                                                 debug_info,
+                                                 thread_pool);
   } else {
     return MakeMiniDebugInfoInternal<ElfTypes32>(isa,
                                                  features,
@@ -168,7 +195,8 @@ std::vector<uint8_t> MakeMiniDebugInfo(
                                                  text_section_size,
                                                  dex_section_address,
                                                  dex_section_size,
-                                                 debug_info);
+                                                 debug_info,
+                                                 thread_pool);
   }
 }
 
@@ -372,10 +400,12 @@ std::vector<uint8_t> WriteDebugElfFileForClasses(
 // Explicit instantiations
 template void WriteDebugInfo<ElfTypes32>(
     ElfBuilder<ElfTypes32>* builder,
-    const DebugInfo& debug_info);
+    const DebugInfo& debug_info,
+    ThreadPool* thread_pool);
 template void WriteDebugInfo<ElfTypes64>(
     ElfBuilder<ElfTypes64>* builder,
-    const DebugInfo& debug_info);
+    const DebugInfo& debug_info,
+    ThreadPool* thread_pool);
 
 }  // namespace debug
 }  // namespace art
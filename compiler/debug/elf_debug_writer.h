@@ -29,6 +29,7 @@
 
 namespace art HIDDEN {
 class OatHeader;
+class ThreadPool;
 struct JITCodeEntry;
 namespace mirror {
 class Class;
@@ -36,11 +37,16 @@ class Class;
 namespace debug {
 struct MethodDebugInfo;
 
+// Uses the workers of `thread_pool`, if any, see ThreadPool::ForAll(). The output does not
+// depend on the thread pool.
 template <typename ElfTypes>
 EXPORT void WriteDebugInfo(
     ElfBuilder<ElfTypes>* builder,
-    const DebugInfo& debug_info);
+    const DebugInfo& debug_info,
+    ThreadPool* thread_pool = nullptr);
 
+// Uses the workers of `thread_pool`, if any, see ThreadPool::ForAll(). The output does not
+// depend on the thread pool.
 EXPORT std::vector<uint8_t> MakeMiniDebugInfo(
     InstructionSet isa,
     const InstructionSetFeatures* features,
@@ -48,7 +54,8 @@ EXPORT std::vector<uint8_t> MakeMiniDebugInfo(
     size_t text_section_size,
     uint64_t dex_section_address,
     size_t dex_section_size,
-    const DebugInfo& debug_info);
+    const DebugInfo& debug_info,
+    ThreadPool* thread_pool = nullptr);
 
 std::vector<uint8_t> MakeElfFileForJIT(
     InstructionSet isa,
@@ -74,6 +74,9 @@ CompilerOptions::CompilerOptions()
       check_linkage_conditions_(false),
       crash_on_linkage_violation_(false),
       deduplicate_code_(true),
+      stream_compiled_code_(false),
+      compile_shard_index_(0u),
+      compile_shard_count_(1u),
       count_hotness_in_compiled_code_(false),
       resolve_startup_const_strings_(false),
       initialize_app_image_classes_(false),
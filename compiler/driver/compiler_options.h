@@ -332,6 +332,23 @@ class CompilerOptions final {
     return deduplicate_code_;
   }
 
+  // Whether the code of each compiled method is freed as soon as it has been written to the
+  // oat file, instead of being kept until the CompilerDriver is destroyed. This only helps the
+  // phases after OatWriter::WriteCode(), all compiled code is in memory once compilation ends.
+  bool StreamCompiledCode() const {
+    return stream_compiled_code_;
+  }
+
+  // Whether the compilation of the dex files is split over several dex2oat invocations.
+  bool IsCompileShard() const {
+    return compile_shard_count_ > 1u;
+  }
+
+  // Whether the methods of the class at `class_def_index` are compiled by this shard.
+  bool IsInCompileShard(uint32_t class_def_index) const {
+    return class_def_index % compile_shard_count_ == compile_shard_index_;
+  }
+
   const std::vector<std::string>* GetPassesToRun() const {
     return passes_to_run_;
   }
@@ -460,6 +477,13 @@ class CompilerOptions final {
   // Whether code should be deduplicated.
   bool deduplicate_code_;
 
+  // Whether code should be freed once written to the oat file.
+  bool stream_compiled_code_;
+
+  // The shard of classes compiled by this invocation, and the total number of shards.
+  uint32_t compile_shard_index_;
+  uint32_t compile_shard_count_;
+
   // Whether compiled code should increment the hotness count of ArtMethod. Note that the increments
   // won't be atomic for performance reasons, so we accept races, just like in interpreter.
   bool count_hotness_in_compiled_code_;
@@ -83,6 +83,9 @@ inline bool ReadCompilerOptions(Base& map, CompilerOptions* options, std::string
   }
   map.AssignIfExists(Base::VerboseMethods, &options->verbose_methods_);
   options->deduplicate_code_ = map.GetOrDefault(Base::DeduplicateCode);
+  if (map.Exists(Base::StreamCompiledCode)) {
+    options->stream_compiled_code_ = true;
+  }
   if (map.Exists(Base::CountHotnessInCompiledCode)) {
     options->count_hotness_in_compiled_code_ = true;
   }
@@ -161,6 +164,13 @@ NO_INLINE void AddCompilerOptionsArgumentParserOptions(Builder& b) {
                     "symbol tagged with [DEDUPED].")
           .IntoKey(Map::DeduplicateCode)
 
+      .Define({"--stream-compiled-code"})
+          .WithHelp("Free the code of each compiled method once it is written to the oat file,\n"
+                    "lowering memory use of the phases after writing the code. All code is still\n"
+                    "held at the end of compilation, so this does not lower peak memory use.\n"
+                    "Not supported with --multi-image.")
+          .IntoKey(Map::StreamCompiledCode)
+
       .Define({"--count-hotness-in-compiled-code"})
           .IntoKey(Map::CountHotnessInCompiledCode)
 
@@ -221,6 +221,7 @@ class JniCompilerTest : public CommonCompilerTest {
   void SetUp() override {
     CommonCompilerTest::SetUp();
     check_generic_jni_ = false;
+    reference_free_native_ = false;
   }
 
   void TearDown() override {
@@ -232,6 +233,11 @@ class JniCompilerTest : public CommonCompilerTest {
     check_generic_jni_ = generic;
   }
 
+  // Compile the @FastNative method as if it was also annotated with @ReferenceFreeNative.
+  void SetReferenceFreeNative(bool reference_free) {
+    reference_free_native_ = reference_free;
+  }
+
  private:
   void CompileForTest(jobject class_loader,
                       bool direct,
@@ -248,6 +254,10 @@ class JniCompilerTest : public CommonCompilerTest {
     ArtMethod* method = c->FindClassMethod(method_name, method_sig, pointer_size);
     ASSERT_TRUE(method != nullptr) << method_name << " " << method_sig;
     ASSERT_EQ(direct, method->IsDirect()) << method_name << " " << method_sig;
+    if (reference_free_native_) {
+      ASSERT_TRUE(method->IsFastNative()) << method_name << " " << method_sig;
+      method->SetAccessFlags(method->GetAccessFlags() | kAccReferenceFreeNative);
+    }
     if (direct) {
       // Class initialization could replace the entrypoint, so force
       // the initialization before we set up the entrypoint below.
@@ -393,12 +403,14 @@ class JniCompilerTest : public CommonCompilerTest {
   void NormalNativeImpl();
   void FastNativeImpl();
   void CriticalNativeImpl();
+  void ReferenceFreeNativeImpl();
 
   JNIEnv* env_;
   jmethodID jmethod_;
 
  private:
   bool check_generic_jni_;
+  bool reference_free_native_;
 };
 
 jclass JniCompilerTest::jklass_;
@@ -492,6 +504,24 @@ LockWord JniCompilerTest::GetLockWord(jobject obj) {
     TestName ## Impl();                          \
   }
 
+// Test @FastNative @ReferenceFreeNative x (compiler, generic) only.
+#define JNI_TEST_REFERENCE_FREE_ONLY(TestName) \
+  TEST_F(JniCompilerTest, TestName ## ReferenceFreeCompiler) { \
+    ScopedCheckHandleScope top_handle_scope_check;  \
+    SCOPED_TRACE("@ReferenceFreeNative JNI with compiler");  \
+    gCurrentJni = static_cast<uint32_t>(JniKind::kFast); \
+    SetReferenceFreeNative(true);                \
+    TestName ## Impl();                          \
+  }                                              \
+  TEST_F(JniCompilerTest, TestName ## ReferenceFreeGeneric) { \
+    ScopedCheckHandleScope top_handle_scope_check;  \
+    SCOPED_TRACE("@ReferenceFreeNative JNI with generic");  \
+    gCurrentJni = static_cast<uint32_t>(JniKind::kFast); \
+    SetReferenceFreeNative(true);                \
+    SetCheckGenericJni(true);                    \
+    TestName ## Impl();                          \
+  }
+
 // Test everything: (normal, @FastNative, @CriticalNative) x (compiler, generic).
 #define JNI_TEST_CRITICAL(TestName)              \
   JNI_TEST(TestName)                             \
@@ -998,6 +1028,54 @@ void JniCompilerTest::CompileAndRunStaticIntIntMethodImpl() {
 
 JNI_TEST_CRITICAL(CompileAndRunStaticIntIntMethod)
 
+int gJava_MyClassNatives_fooSII_ReferenceFree_calls = 0;
+jint Java_MyClassNatives_fooSII_ReferenceFree(JNIEnv* env, jclass, jint x, jint y) {
+  // The JNIEnv* is still passed to reference-free natives.
+  EXPECT_EQ(Thread::Current()->GetJniEnv(), env);
+  gJava_MyClassNatives_fooSII_ReferenceFree_calls++;
+  return x + y;
+}
+
+jint Java_MyClassNatives_fooSII_ReferenceFreeWithLocalRef(JNIEnv* env,
+                                                          jclass klass,
+                                                          jint x,
+                                                          jint y) {
+  // Break the @ReferenceFreeNative contract.
+  jobject local_ref = env->NewLocalRef(klass);
+  env->DeleteLocalRef(local_ref);
+  return x + y;
+}
+
+void JniCompilerTest::ReferenceFreeNativeImpl() {
+  SetUpForTest(true, "fooSII", "(II)I",
+               CURRENT_JNI_WRAPPER(Java_MyClassNatives_fooSII_ReferenceFree));
+  {
+    ScopedObjectAccess soa(Thread::Current());
+    ASSERT_TRUE(jni::DecodeArtMethod(jmethod_)->IsReferenceFreeNative());
+  }
+
+  EXPECT_EQ(0, gJava_MyClassNatives_fooSII_ReferenceFree_calls);
+  for (jint i = 0; i != 10; ++i) {
+    jint result = env_->CallStaticIntMethod(jklass_, jmethod_, 20, i);
+    EXPECT_EQ(20 + i, result);
+  }
+  EXPECT_EQ(10, gJava_MyClassNatives_fooSII_ReferenceFree_calls);
+  gJava_MyClassNatives_fooSII_ReferenceFree_calls = 0;
+
+  // CheckJNI rejects local references created by a reference-free native method.
+  ASSERT_TRUE(Thread::Current()->GetJniEnv()->IsCheckJniEnabled());
+  JNINativeMethod methods[] = {
+      { "fooSII_Fast",
+        "(II)I",
+        CURRENT_JNI_WRAPPER(Java_MyClassNatives_fooSII_ReferenceFreeWithLocalRef) } };
+  ASSERT_EQ(JNI_OK, env_->RegisterNatives(jklass_, methods, 1));
+  CheckJniAbortCatcher check_jni_abort_catcher;
+  EXPECT_EQ(50, env_->CallStaticIntMethod(jklass_, jmethod_, 20, 30));
+  check_jni_abort_catcher.Check("Local reference created in a reference-free native method");
+}
+
+JNI_TEST_REFERENCE_FREE_ONLY(ReferenceFreeNative)
+
 int gJava_MyClassNatives_fooSDD_calls[kJniKindCount] = {};
 jdouble Java_MyClassNatives_fooSDD([[maybe_unused]] JNIEnv* env,
                                    [[maybe_unused]] jclass klass,
@@ -153,6 +153,10 @@ static JniCompiledMethod ArtJniCompileMethodInternal(const CompilerOptions& comp
                                    shorty,
                                    instruction_set);
   bool reference_return = main_jni_conv->IsReturnAReference();
+  // @FastNative methods declared reference-free do not need a local reference frame.
+  // The verifier rejects them if they return a reference, but do not rely on that here.
+  const bool is_reference_free_native =
+      ArtMethod::IsReferenceFreeNative(access_flags) && !reference_return;
 
   std::unique_ptr<ManagedRuntimeCallingConvention> mr_conv(
       ManagedRuntimeCallingConvention::Create(
@@ -278,6 +282,7 @@ static JniCompiledMethod ArtJniCompileMethodInternal(const CompilerOptions& comp
 
   // 3. Push local reference frame.
   // Skip this for @CriticalNative methods, they cannot use any references.
+  // Reference-free @FastNative methods still need the JNI environment pointer but no frame.
   ManagedRegister jni_env_reg = ManagedRegister::NoRegister();
   ManagedRegister previous_state_reg = ManagedRegister::NoRegister();
   ManagedRegister current_state_reg = ManagedRegister::NoRegister();
@@ -298,11 +303,13 @@ static JniCompiledMethod ArtJniCompileMethodInternal(const CompilerOptions& comp
     // Load the JNI environment pointer.
     __ LoadRawPtrFromThread(jni_env_reg, Thread::JniEnvOffset<kPointerSize>());
 
-    // Load the local reference frame states.
-    __ LoadLocalReferenceTableStates(jni_env_reg, previous_state_reg, current_state_reg);
+    if (LIKELY(!is_reference_free_native)) {
+      // Load the local reference frame states.
+      __ LoadLocalReferenceTableStates(jni_env_reg, previous_state_reg, current_state_reg);
 
-    // Store the current state as the previous state (push the LRT frame).
-    __ Store(jni_env_reg, previous_state_offset, current_state_reg, kLRTSegmentStateSize);
+      // Store the current state as the previous state (push the LRT frame).
+      __ Store(jni_env_reg, previous_state_offset, current_state_reg, kLRTSegmentStateSize);
+    }
   }
 
   // 4. Make the main native call.
@@ -517,7 +524,9 @@ static JniCompiledMethod ArtJniCompileMethodInternal(const CompilerOptions& comp
 
   // 6. Pop local reference frame.
   if (LIKELY(!is_critical_native)) {
-    __ StoreLocalReferenceTableStates(jni_env_reg, previous_state_reg, current_state_reg);
+    if (LIKELY(!is_reference_free_native)) {
+      __ StoreLocalReferenceTableStates(jni_env_reg, previous_state_reg, current_state_reg);
+    }
     // For x86, the `callee_save_temp` is not valid, so let's simply change it to one
     // of the callee save registers that we don't need anymore for all architectures.
     callee_save_temp = current_state_reg;
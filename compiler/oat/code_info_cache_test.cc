@@ -0,0 +1,252 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "oat/code_info_cache.h"
+
+#include <sys/mman.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "android-base/logging.h"
+#include "base/arena_bit_vector.h"
+#include "base/malloc_arena_pool.h"
+#include "base/scoped_arena_allocator.h"
+#include "base/time_utils.h"
+#include "oat/oat_quick_method_header.h"
+#include "oat/stack_map.h"
+#include "optimizing/stack_map_stream.h"
+
+#include "gtest/gtest.h"
+
+namespace art HIDDEN {
+
+class CodeInfoCacheTest : public testing::Test {
+ protected:
+  static constexpr uint32_t kPcAlign = GetInstructionSetInstructionAlignment(kRuntimeISA);
+  static constexpr size_t kNumStackMaps = 16u;
+  static constexpr size_t kStackMaskBits = 40u;
+  // Space for the CodeInfo before each method header.
+  static constexpr size_t kCodeInfoSpace = 1 * KB;
+  // The second method is placed so that its lookups use the same entries as the first one.
+  static constexpr size_t kMethodDistance = 4u * CodeInfoCache::kNumEntries;
+  static constexpr size_t kMemorySize = 2u * kCodeInfoSpace + kMethodDistance;
+
+  void SetUp() override {
+    // Use mmap to make sure we get untagged memory here, like the exception test does.
+    memory_ = static_cast<uint8_t*>(
+        mmap(nullptr, kMemorySize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    ASSERT_NE(memory_, MAP_FAILED);
+    CodeInfoCache::Clear();
+  }
+
+  void TearDown() override {
+    CodeInfoCache::Clear();
+    munmap(memory_, kMemorySize);
+  }
+
+  static uint32_t NativePcOffset(size_t stack_map_index) {
+    return (stack_map_index + 1u) * 8u * kPcAlign;
+  }
+
+  static uint32_t RegisterMask(uint32_t salt, size_t stack_map_index) {
+    return salt ^ static_cast<uint32_t>(stack_map_index);
+  }
+
+  static bool StackMaskBit(uint32_t salt, size_t stack_map_index, size_t bit) {
+    return ((salt + stack_map_index + bit) % 3u) == 0u;
+  }
+
+  // Encodes a CodeInfo with kNumStackMaps stack maps whose GC masks depend on `salt`.
+  static std::vector<uint8_t> EncodeCodeInfo(uint32_t salt) {
+    MallocArenaPool pool;
+    ArenaStack arena_stack(&pool);
+    ScopedArenaAllocator allocator(&arena_stack);
+    StackMapStream stream(&allocator, kRuntimeISA);
+    stream.BeginMethod(/* frame_size_in_bytes= */ 64,
+                       /* core_spill_mask= */ 0,
+                       /* fp_spill_mask= */ 0,
+                       /* num_dex_registers= */ 0,
+                       /* baseline= */ false,
+                       /* debuggable= */ false);
+    for (size_t i = 0; i != kNumStackMaps; ++i) {
+      ArenaBitVector sp_mask(&allocator, kStackMaskBits, /* expandable= */ false);
+      for (size_t bit = 0; bit != kStackMaskBits; ++bit) {
+        if (StackMaskBit(salt, i, bit)) {
+          sp_mask.SetBit(bit);
+        }
+      }
+      stream.BeginStackMapEntry(i, NativePcOffset(i), RegisterMask(salt, i), &sp_mask);
+      stream.EndStackMapEntry();
+    }
+    stream.EndMethod(NativePcOffset(kNumStackMaps));
+    ScopedArenaVector<uint8_t> code_info = stream.Encode();
+    return std::vector<uint8_t>(code_info.begin(), code_info.end());
+  }
+
+  // Writes the CodeInfo for `salt` and a method header at `code_offset` of `memory_`, as if
+  // the JIT had allocated the method there. Returns the method header.
+  const OatQuickMethodHeader* WriteMethod(size_t code_offset, uint32_t salt) {
+    std::vector<uint8_t> code_info = EncodeCodeInfo(salt);
+    CHECK_LE(code_info.size() + sizeof(OatQuickMethodHeader), kCodeInfoSpace);
+    uint8_t* code = memory_ + code_offset;
+    uint8_t* code_info_ptr = code - kCodeInfoSpace;
+    memcpy(code_info_ptr, code_info.data(), code_info.size());
+    OatQuickMethodHeader method_header(code - code_info_ptr);
+    memcpy(code - sizeof(method_header), &method_header, sizeof(method_header));
+    return reinterpret_cast<const OatQuickMethodHeader*>(code - sizeof(method_header));
+  }
+
+  static bool Matches(const CodeInfoCache::StackMapInfo& info, uint32_t salt, size_t index) {
+    if (info.stack_map_index != index || info.register_mask != RegisterMask(salt, index)) {
+      return false;
+    }
+    // The encoded stack mask ends with its last set bit.
+    for (size_t bit = 0; bit != kStackMaskBits; ++bit) {
+      bool is_set = bit < info.stack_mask.size_in_bits() && info.stack_mask.LoadBit(bit);
+      if (is_set != StackMaskBit(salt, index, bit)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  uint8_t* memory_;
+};
+
+TEST_F(CodeInfoCacheTest, LookupInsert) {
+  const OatQuickMethodHeader* method = WriteMethod(kCodeInfoSpace, /* salt= */ 0x5u);
+  CodeInfoCache::StackMapInfo info;
+  EXPECT_FALSE(CodeInfoCache::Lookup(method, NativePcOffset(3u), &info));
+
+  EXPECT_TRUE(Matches(CodeInfoCache::GetStackMapInfo(method, NativePcOffset(3u)), 0x5u, 3u));
+  ASSERT_TRUE(CodeInfoCache::Lookup(method, NativePcOffset(3u), &info));
+  EXPECT_TRUE(Matches(info, 0x5u, 3u));
+
+  // Other pcs are not cached yet, and pcs without stack map are never cached.
+  EXPECT_FALSE(CodeInfoCache::Lookup(method, NativePcOffset(4u), &info));
+  info = CodeInfoCache::GetStackMapInfo(method, NativePcOffset(3u) + kPcAlign);
+  EXPECT_EQ(info.stack_map_index, StackMap::kNoValue);
+  EXPECT_FALSE(CodeInfoCache::Lookup(method, NativePcOffset(3u) + kPcAlign, &info));
+}
+
+TEST_F(CodeInfoCacheTest, SameEntry) {
+  const OatQuickMethodHeader* method1 = WriteMethod(kCodeInfoSpace, /* salt= */ 0x5u);
+  const OatQuickMethodHeader* method2 =
+      WriteMethod(kCodeInfoSpace + kMethodDistance, /* salt= */ 0xa0u);
+  CodeInfoCache::StackMapInfo info;
+  EXPECT_TRUE(Matches(CodeInfoCache::GetStackMapInfo(method1, NativePcOffset(2u)), 0x5u, 2u));
+  // The lookup of the other method for the same pc offset replaces the entry.
+  EXPECT_FALSE(CodeInfoCache::Lookup(method2, NativePcOffset(2u), &info));
+  EXPECT_TRUE(Matches(CodeInfoCache::GetStackMapInfo(method2, NativePcOffset(2u)), 0xa0u, 2u));
+  EXPECT_FALSE(CodeInfoCache::Lookup(method1, NativePcOffset(2u), &info));
+  ASSERT_TRUE(CodeInfoCache::Lookup(method2, NativePcOffset(2u), &info));
+  EXPECT_TRUE(Matches(info, 0xa0u, 2u));
+}
+
+TEST_F(CodeInfoCacheTest, ClearAfterFree) {
+  const OatQuickMethodHeader* method = WriteMethod(kCodeInfoSpace, /* salt= */ 0x5u);
+  EXPECT_TRUE(Matches(CodeInfoCache::GetStackMapInfo(method, NativePcOffset(1u)), 0x5u, 1u));
+
+  // The JIT frees the method and reuses the memory for another method with the same header
+  // address. Freeing the code clears the cache, see JitCodeCache::FreeLocked().
+  CodeInfoCache::Clear();
+  const OatQuickMethodHeader* new_method = WriteMethod(kCodeInfoSpace, /* salt= */ 0x33u);
+  ASSERT_EQ(method, new_method);
+  CodeInfoCache::StackMapInfo info;
+  EXPECT_FALSE(CodeInfoCache::Lookup(new_method, NativePcOffset(1u), &info));
+  EXPECT_TRUE(Matches(CodeInfoCache::GetStackMapInfo(new_method, NativePcOffset(1u)), 0x33u, 1u));
+  ASSERT_TRUE(CodeInfoCache::Lookup(new_method, NativePcOffset(1u), &info));
+  EXPECT_TRUE(Matches(info, 0x33u, 1u));
+}
+
+TEST_F(CodeInfoCacheTest, ConcurrentReadersAndWriters) {
+  // Two methods whose lookups use the same entries, so that threads looking up either of them
+  // keep replacing each other's entries while others read them.
+  const uint32_t salts[] = {0x5u, 0xa0u};
+  const OatQuickMethodHeader* methods[] = {
+      WriteMethod(kCodeInfoSpace, salts[0]),
+      WriteMethod(kCodeInfoSpace + kMethodDistance, salts[1]),
+  };
+  static constexpr size_t kNumThreads = 4u;
+  static constexpr size_t kIterations = 100000u;
+  std::atomic<size_t> mismatches(0u);
+  std::atomic<bool> done(false);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t != kNumThreads; ++t) {
+    threads.emplace_back([&, t]() {
+      uint32_t random = static_cast<uint32_t>(t) + 1u;
+      for (size_t i = 0; i != kIterations; ++i) {
+        random ^= random << 13;
+        random ^= random >> 17;
+        random ^= random << 5;
+        size_t m = random & 1u;
+        size_t index = (random >> 1) % kNumStackMaps;
+        CodeInfoCache::StackMapInfo info;
+        bool ok = ((random >> 8) & 1u) != 0u
+            ? (!CodeInfoCache::Lookup(methods[m], NativePcOffset(index), &info) ||
+               Matches(info, salts[m], index))
+            : Matches(CodeInfoCache::GetStackMapInfo(methods[m], NativePcOffset(index)),
+                      salts[m],
+                      index);
+        if (!ok) {
+          mismatches.fetch_add(1u, std::memory_order_relaxed);
+        }
+      }
+    });
+  }
+  // Also invalidate the entries concurrently, like freeing unrelated JIT code does.
+  std::thread clearer([&]() {
+    while (!done.load(std::memory_order_relaxed)) {
+      CodeInfoCache::Clear();
+      std::this_thread::yield();
+    }
+  });
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  done.store(true, std::memory_order_relaxed);
+  clearer.join();
+  EXPECT_EQ(mismatches.load(), 0u);
+}
+
+TEST_F(CodeInfoCacheTest, LookupTime) {
+  // Compares the time of a cached lookup with decoding the GC masks, which is what the GC root
+  // visiting of a frame did before, for the record.
+  const OatQuickMethodHeader* method = WriteMethod(kCodeInfoSpace, /* salt= */ 0x5u);
+  static constexpr size_t kIterations = 1000000u;
+  uint32_t checksum = 0u;
+  uint64_t start = NanoTime();
+  for (size_t i = 0; i != kIterations; ++i) {
+    CodeInfo code_info = CodeInfo::DecodeGcMasksOnly(method);
+    StackMap stack_map =
+        code_info.GetStackMapForNativePcOffset(NativePcOffset(i % kNumStackMaps));
+    checksum += code_info.GetRegisterMaskOf(stack_map);
+  }
+  uint64_t decode_time = NanoTime() - start;
+  start = NanoTime();
+  for (size_t i = 0; i != kIterations; ++i) {
+    checksum -= CodeInfoCache::GetStackMapInfo(method, NativePcOffset(i % kNumStackMaps))
+                    .register_mask;
+  }
+  uint64_t cached_time = NanoTime() - start;
+  EXPECT_EQ(checksum, 0u);
+  LOG(INFO) << "GC masks of " << kIterations << " frames: decoded in "
+            << PrettyDuration(decode_time) << ", cached in " << PrettyDuration(cached_time);
+}
+
+}  // namespace art
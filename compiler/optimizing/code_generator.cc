@@ -1647,6 +1647,57 @@ bool CodeGenerator::StoreNeedsWriteBarrier(DataType::Type type,
             : write_barrier_kind != WriteBarrierKind::kDontEmit;
 }
 
+bool CodeGenerator::UseEntrypointThunk(QuickEntrypointEnum entrypoint,
+                                       SlowPathCode* slow_path) const {
+  // For JIT, thunk sharing is per-method, so the gains would be smaller or even negative.
+  if (GetCompilerOptions().IsJitCompiler()) {
+    return false;
+  }
+  if (slow_path != nullptr) {
+    return true;
+  }
+  switch (entrypoint) {
+    // Listed in the same order as in quick_entrypoints_list.h.
+    case kQuickInitializeStaticStorage:
+    case kQuickResolveTypeAndVerifyAccess:
+    case kQuickResolveType:
+    case kQuickResolveMethodHandle:
+    case kQuickResolveMethodType:
+    case kQuickResolveString:
+    case kQuickSet8Instance:
+    case kQuickSet8Static:
+    case kQuickSet16Instance:
+    case kQuickSet16Static:
+    case kQuickSet32Instance:
+    case kQuickSet32Static:
+    case kQuickSet64Instance:
+    case kQuickSet64Static:
+    case kQuickSetObjInstance:
+    case kQuickSetObjStatic:
+    case kQuickGetByteInstance:
+    case kQuickGetBooleanInstance:
+    case kQuickGetByteStatic:
+    case kQuickGetBooleanStatic:
+    case kQuickGetShortInstance:
+    case kQuickGetCharInstance:
+    case kQuickGetShortStatic:
+    case kQuickGetCharStatic:
+    case kQuickGet32Instance:
+    case kQuickGet32Static:
+    case kQuickGet64Instance:
+    case kQuickGet64Static:
+    case kQuickGetObjInstance:
+    case kQuickGetObjStatic:
+    case kQuickDeliverException:
+    case kQuickStringBuilderAppend:
+      return true;
+    default:
+      // Allocations, locking and invokes are frequent on hot paths. The invoke trampolines
+      // may also take hidden arguments in the thunk's scratch register.
+      return false;
+  }
+}
+
 void CodeGenerator::ValidateInvokeRuntime(QuickEntrypointEnum entrypoint,
                                           HInstruction* instruction,
                                           SlowPathCode* slow_path) {
@@ -527,6 +527,12 @@ class CodeGenerator : public DeletableArenaObject<kArenaAllocCodeGenerator> {
                               HInstruction* value,
                               WriteBarrierKind write_barrier_kind) const;
 
+  // Whether a runtime call should branch to an entrypoint thunk shared across the entire oat file
+  // (see linker::LinkerPatch::Type::kCallEntrypoint) instead of loading the entrypoint inline.
+  // This reduces code size at the cost of an extra branch, so apart from slow paths it is only
+  // used for main path calls that are rare or far more expensive than the branch.
+  bool UseEntrypointThunk(QuickEntrypointEnum entrypoint, SlowPathCode* slow_path) const;
+
   // Performs checks pertaining to an InvokeRuntime call.
   void ValidateInvokeRuntime(QuickEntrypointEnum entrypoint,
                              HInstruction* instruction,
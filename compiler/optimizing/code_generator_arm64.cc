@@ -2278,10 +2278,9 @@ void CodeGeneratorARM64::InvokeRuntime(QuickEntrypointEnum entrypoint,
   ValidateInvokeRuntime(entrypoint, instruction, slow_path);
 
   ThreadOffset64 entrypoint_offset = GetThreadOffset<kArm64PointerSize>(entrypoint);
-  // Reduce code size for AOT by using shared trampolines for slow path runtime calls across the
-  // entire oat file. This adds an extra branch and we do not want to slow down the main path.
-  // For JIT, thunk sharing is per-method, so the gains would be smaller or even negative.
-  if (slow_path == nullptr || GetCompilerOptions().IsJitCompiler()) {
+  // Reduce code size for AOT by using shared trampolines for cold runtime calls across the
+  // entire oat file.
+  if (!UseEntrypointThunk(entrypoint, slow_path)) {
     __ Ldr(lr, MemOperand(tr, entrypoint_offset.Int32Value()));
     // Ensure the pc position is recorded immediately after the `blr` instruction.
     ExactAssemblyScope eas(GetVIXLAssembler(), kInstructionSize, CodeBufferCheckScope::kExactSize);
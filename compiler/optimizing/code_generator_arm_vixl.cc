@@ -2778,10 +2778,9 @@ void CodeGeneratorARMVIXL::InvokeRuntime(QuickEntrypointEnum entrypoint,
   ValidateInvokeRuntime(entrypoint, instruction, slow_path);
 
   ThreadOffset32 entrypoint_offset = GetThreadOffset<kArmPointerSize>(entrypoint);
-  // Reduce code size for AOT by using shared trampolines for slow path runtime calls across the
-  // entire oat file. This adds an extra branch and we do not want to slow down the main path.
-  // For JIT, thunk sharing is per-method, so the gains would be smaller or even negative.
-  if (slow_path == nullptr || GetCompilerOptions().IsJitCompiler()) {
+  // Reduce code size for AOT by using shared trampolines for cold runtime calls across the
+  // entire oat file.
+  if (!UseEntrypointThunk(entrypoint, slow_path)) {
     __ Ldr(lr, MemOperand(tr, entrypoint_offset.Int32Value()));
     // Ensure the pc position is recorded immediately after the `blx` instruction.
     // blx in T32 has only 16bit encoding that's why a stricter check for the scope is used.
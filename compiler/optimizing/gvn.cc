@@ -368,6 +368,7 @@ class GlobalValueNumberer : public ValueObject {
             &allocator_, graph->GetBlocks().size(), kArenaAllocGvn)),
         visited_blocks_(ArenaBitVector::CreateFixedSize(
             &allocator_, graph->GetBlocks().size(), kArenaAllocGvn)),
+        work_(0u),
         did_optimization_(false) {
     for (HBasicBlock* block : graph->GetReversePostOrder()) {
       dominated_to_visit_[block->GetBlockId()] = block->GetDominatedBlocks().size();
@@ -378,6 +379,11 @@ class GlobalValueNumberer : public ValueObject {
   bool Run();
 
  private:
+  // Upper bound of the work done by GVN, counted as visited instructions plus ValueSet entries
+  // copied or intersected. The cost of the ValueSet copies grows superlinearly with the method
+  // size, so huge methods, such as generated parsers, are only optimized up to this point.
+  static constexpr size_t kMaximumWork = 1u << 20;
+
   // Per-block GVN. Will also update the ValueSet of the dominated and
   // successor blocks.
   void VisitBasicBlock(HBasicBlock* block);
@@ -425,6 +431,9 @@ class GlobalValueNumberer : public ValueObject {
   // visited/unvisited Boolean.
   BitVectorView<size_t> visited_blocks_;
 
+  // Work done so far, bounded by kMaximumWork.
+  size_t work_;
+
   // True if GVN did at least one removal.
   bool did_optimization_;
 
@@ -438,6 +447,10 @@ bool GlobalValueNumberer::Run() {
   // Use the reverse post order to ensure the non back-edge predecessors of a block are
   // visited before the block itself.
   for (HBasicBlock* block : graph_->GetReversePostOrder()) {
+    if (work_ > kMaximumWork) {
+      // Replacements done so far remain valid, the remaining blocks are left as they are.
+      break;
+    }
     VisitBasicBlock(block);
   }
   return did_optimization_;
@@ -466,6 +479,7 @@ void GlobalValueNumberer::VisitBasicBlock(HBasicBlock* block) {
       // Try to find a basic block which will never be referenced again and whose
       // ValueSet can therefore be recycled. We will need to copy `dominator_set`
       // into the recycled set, so we pass `dominator_set` as a reference for size.
+      work_ += dominator_set->GetNumberOfEntries();
       HBasicBlock* recyclable = FindVisitedBlockWithRecyclableSet(*dominator_set);
       if (recyclable == nullptr) {
         // No block with a suitable ValueSet found. Allocate a new one and
@@ -496,6 +510,7 @@ void GlobalValueNumberer::VisitBasicBlock(HBasicBlock* block) {
         }
       } else if (predecessors.size() > 1) {
         for (HBasicBlock* predecessor : predecessors) {
+          work_ += set->GetNumberOfEntries();
           set->IntersectWith(FindSetFor(predecessor));
           if (set->IsEmpty()) {
             break;
@@ -511,6 +526,7 @@ void GlobalValueNumberer::VisitBasicBlock(HBasicBlock* block) {
   while (current != nullptr) {
     // Save the next instruction in case `current` is removed from the graph.
     HInstruction* next = current->GetNext();
+    ++work_;
     // Do not kill the set with the side effects of the instruction just now: if
     // the instruction is GVN'ed, we don't need to kill.
     //
@@ -72,6 +72,9 @@ static constexpr size_t kMaximumNumberOfRecursiveCalls = 4;
 // recursive calls at all.
 static constexpr size_t kMaximumNumberOfPolymorphicRecursiveCalls = 0;
 
+// Maximum number of code units of a callee we scan to prove it does not write to the heap.
+static constexpr size_t kMaximumCodeUnitsForReadOnlyCheck = 64;
+
 // Controls the use of inline caches in AOT mode.
 static constexpr bool kUseAOTInlineCaches = true;
 
@@ -191,9 +194,12 @@ bool HInliner::Run() {
           if (callee_name.find("$noinline$") == std::string::npos) {
             if (TryInline(call)) {
               did_inline = true;
-            } else if (honor_inline_directives) {
-              bool should_have_inlined = (callee_name.find("$inline$") != std::string::npos);
-              CHECK(!should_have_inlined) << "Could not inline " << callee_name;
+            } else {
+              if (honor_inline_directives) {
+                bool should_have_inlined = (callee_name.find("$inline$") != std::string::npos);
+                CHECK(!should_have_inlined) << "Could not inline " << callee_name;
+              }
+              MaybeRefineSideEffectsOfCall(call);
             }
           }
         } else {
@@ -201,6 +207,8 @@ bool HInliner::Run() {
           // Normal case: try to inline.
           if (TryInline(call)) {
             did_inline = true;
+          } else {
+            MaybeRefineSideEffectsOfCall(call);
           }
         }
       }
@@ -460,6 +468,134 @@ static bool AlwaysThrows(ArtMethod* method)
   return throw_seen;
 }
 
+// Returns whether `method` is known to only read the heap. We conservatively scan the dex
+// code and reject anything that may write memory, call other code, allocate, synchronize,
+// or initialize or load classes. Volatile loads are rejected as they order other accesses.
+static bool IsReadOnlyMethod(ArtMethod* method, ClassLinker* class_linker)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  CodeItemDataAccessor accessor(method->DexInstructionData());
+  if (!accessor.HasCodeItem() ||
+      accessor.TriesSize() != 0 ||
+      accessor.InsnsSizeInCodeUnits() > kMaximumCodeUnitsForReadOnlyCheck) {
+    return false;
+  }
+  for (const DexInstructionPcPair& pair : accessor) {
+    const Instruction& instruction = pair.Inst();
+    Instruction::Code opcode = instruction.Opcode();
+    switch (opcode) {
+      case Instruction::NOP:  // Includes switch and array data payloads.
+      case Instruction::MOVE:
+      case Instruction::MOVE_FROM16:
+      case Instruction::MOVE_16:
+      case Instruction::MOVE_WIDE:
+      case Instruction::MOVE_WIDE_FROM16:
+      case Instruction::MOVE_WIDE_16:
+      case Instruction::MOVE_OBJECT:
+      case Instruction::MOVE_OBJECT_FROM16:
+      case Instruction::MOVE_OBJECT_16:
+      case Instruction::RETURN_VOID:
+      case Instruction::RETURN:
+      case Instruction::RETURN_WIDE:
+      case Instruction::RETURN_OBJECT:
+      case Instruction::CONST_4:
+      case Instruction::CONST_16:
+      case Instruction::CONST:
+      case Instruction::CONST_HIGH16:
+      case Instruction::CONST_WIDE_16:
+      case Instruction::CONST_WIDE_32:
+      case Instruction::CONST_WIDE:
+      case Instruction::CONST_WIDE_HIGH16:
+      case Instruction::ARRAY_LENGTH:
+      case Instruction::GOTO:
+      case Instruction::GOTO_16:
+      case Instruction::GOTO_32:
+      case Instruction::PACKED_SWITCH:
+      case Instruction::SPARSE_SWITCH:
+      case Instruction::CMPL_FLOAT:
+      case Instruction::CMPG_FLOAT:
+      case Instruction::CMPL_DOUBLE:
+      case Instruction::CMPG_DOUBLE:
+      case Instruction::CMP_LONG:
+      case Instruction::IF_EQ:
+      case Instruction::IF_NE:
+      case Instruction::IF_LT:
+      case Instruction::IF_GE:
+      case Instruction::IF_GT:
+      case Instruction::IF_LE:
+      case Instruction::IF_EQZ:
+      case Instruction::IF_NEZ:
+      case Instruction::IF_LTZ:
+      case Instruction::IF_GEZ:
+      case Instruction::IF_GTZ:
+      case Instruction::IF_LEZ:
+      case Instruction::AGET:
+      case Instruction::AGET_WIDE:
+      case Instruction::AGET_OBJECT:
+      case Instruction::AGET_BOOLEAN:
+      case Instruction::AGET_BYTE:
+      case Instruction::AGET_CHAR:
+      case Instruction::AGET_SHORT:
+        break;
+      case Instruction::IGET:
+      case Instruction::IGET_WIDE:
+      case Instruction::IGET_OBJECT:
+      case Instruction::IGET_BOOLEAN:
+      case Instruction::IGET_BYTE:
+      case Instruction::IGET_CHAR:
+      case Instruction::IGET_SHORT: {
+        ArtField* field = class_linker->LookupResolvedField(
+            instruction.VRegC_22c(), method, /* is_static= */ false);
+        if (field == nullptr || field->IsVolatile()) {
+          return false;
+        }
+        break;
+      }
+      default:
+        // Unary and binary arithmetic, including the literal forms.
+        if (opcode >= Instruction::NEG_INT && opcode <= Instruction::USHR_INT_LIT8) {
+          break;
+        }
+        return false;
+    }
+  }
+  return true;
+}
+
+void HInliner::MaybeRefineSideEffectsOfCall(HInvoke* invoke_instruction) {
+  HInvokeStaticOrDirect* invoke = invoke_instruction->AsInvokeStaticOrDirectOrNull();
+  if (invoke == nullptr ||
+      invoke->IsIntrinsic() ||
+      invoke->IsStringInit() ||
+      invoke->IsStaticWithImplicitClinitCheck()) {
+    return;
+  }
+  ScopedObjectAccess soa(Thread::Current());
+  ArtMethod* method = invoke->GetResolvedMethod();
+  if (method == nullptr ||
+      method->IsNative() ||
+      method->IsSynchronized() ||
+      method->IsConstructor() ||
+      !method->IsCompilable() ||
+      !IsMethodVerified(method)) {
+    return;
+  }
+  // For AOT, only trust the code of methods shipped in the same dex file, as other dex files
+  // may be updated independently of the oat file we are producing.
+  if (Runtime::Current()->IsAotCompiler() &&
+      !IsSameDexFile(*method->GetDexFile(), *outer_compilation_unit_.GetDexFile())) {
+    return;
+  }
+  if (!IsReadOnlyMethod(method, caller_compilation_unit_.GetClassLinker())) {
+    return;
+  }
+  // The call can still throw (e.g. StackOverflowError, NullPointerException) and therefore
+  // allocate, but it does not write to the heap. This lets GVN, LICM and LSE keep values
+  // across the call.
+  invoke->SetSideEffects(SideEffects::AllReads().Union(SideEffects::CanTriggerGC()));
+  MaybeRecordStat(stats_, MethodCompilationStat::kReadOnlyInvoke);
+  LOG_NOTE() << "Call to " << method->PrettyMethod() << " only reads the heap";
+}
+
 bool HInliner::TryInline(HInvoke* invoke_instruction) {
   MaybeRecordStat(stats_, MethodCompilationStat::kTryInline);
 
@@ -681,11 +817,17 @@ bool HInliner::TryInlineFromInlineCache(HInvoke* invoke_instruction)
     }
 
     case kInlineCacheMegamorphic: {
+      MaybeRecordStat(stats_, MethodCompilationStat::kMegamorphicCall);
+      // AOT profiles do not record the types of megamorphic calls.
+      if (classes.Size() != 0u &&
+          TryInlinePolymorphicCallToSameTarget(
+              invoke_instruction, classes, /* is_megamorphic= */ true)) {
+        return true;
+      }
       LOG_FAIL_NO_STAT()
           << "Interface or virtual call to "
           << invoke_instruction->GetMethodReference().PrettyMethod()
           << " is megamorphic and not inlined";
-      MaybeRecordStat(stats_, MethodCompilationStat::kMegamorphicCall);
       return false;
     }
 
@@ -1214,7 +1356,8 @@ void HInliner::CreateDiamondPatternForPolymorphicInline(HInstruction* compare,
 
 bool HInliner::TryInlinePolymorphicCallToSameTarget(
     HInvoke* invoke_instruction,
-    const StackHandleScope<InlineCache::kIndividualCacheSize>& classes) {
+    const StackHandleScope<InlineCache::kIndividualCacheSize>& classes,
+    bool is_megamorphic) {
   // This optimization only works under JIT for now.
   if (!codegen_->GetCompilerOptions().IsJitCompiler()) {
     return false;
@@ -1303,7 +1446,7 @@ bool HInliner::TryInlinePolymorphicCallToSameTarget(
   bb_cursor->InsertInstructionAfter(class_table_get, receiver_class);
   bb_cursor->InsertInstructionAfter(compare, class_table_get);
 
-  if (outermost_graph_->IsCompilingOsr()) {
+  if (outermost_graph_->IsCompilingOsr() || is_megamorphic) {
     CreateDiamondPatternForPolymorphicInline(compare, return_replacement, invoke_instruction);
   } else {
     HDeoptimize* deoptimize = new (graph_->GetAllocator()) HDeoptimize(
@@ -1321,9 +1464,12 @@ bool HInliner::TryInlinePolymorphicCallToSameTarget(
 
   // Lazily run type propagation to get the guard typed.
   run_extra_type_propagation_ = true;
-  MaybeRecordStat(stats_, MethodCompilationStat::kInlinedPolymorphicCall);
+  MaybeRecordStat(stats_,
+                  is_megamorphic ? MethodCompilationStat::kInlinedMegamorphicCall
+                                 : MethodCompilationStat::kInlinedPolymorphicCall);
 
-  LOG_SUCCESS() << "Inlined same polymorphic target " << actual_method->PrettyMethod();
+  LOG_SUCCESS() << "Inlined same " << (is_megamorphic ? "megamorphic" : "polymorphic")
+                << " target " << actual_method->PrettyMethod();
   return true;
 }
 
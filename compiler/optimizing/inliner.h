@@ -84,6 +84,10 @@ class HInliner : public HOptimization {
 
   bool TryInline(HInvoke* invoke_instruction);
 
+  // Called on calls we failed to inline. If the callee is a small method which provably does
+  // not write to the heap, narrow the side effects of `invoke_instruction` accordingly.
+  void MaybeRefineSideEffectsOfCall(HInvoke* invoke_instruction);
+
   // Try to inline `resolved_method` in place of `invoke_instruction`. `do_rtp` is whether
   // reference type propagation can run after the inlining. If the inlining is successful, this
   // method will replace and remove the `invoke_instruction`.
@@ -225,9 +229,13 @@ class HInliner : public HOptimization {
                                 const StackHandleScope<InlineCache::kIndividualCacheSize>& classes)
     REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Try to inline the target of a polymorphic or megamorphic call when all the types seen
+  // resolve to the same method. For megamorphic calls, the types in `classes` are only a sample
+  // so the guard falls back to the original invoke instead of deoptimizing.
   bool TryInlinePolymorphicCallToSameTarget(
       HInvoke* invoke_instruction,
-      const StackHandleScope<InlineCache::kIndividualCacheSize>& classes)
+      const StackHandleScope<InlineCache::kIndividualCacheSize>& classes,
+      bool is_megamorphic = false)
     REQUIRES_SHARED(Locks::mutator_lock_);
 
   // Returns whether or not we should use only polymorphic inlining with no deoptimizations.
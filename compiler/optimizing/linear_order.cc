@@ -36,9 +36,34 @@ static bool IsInnerLoop(HLoopInformation* outer, HLoopInformation* inner) {
       && inner->IsIn(*outer);
 }
 
+// Returns whether `block` is outside any loop and only leads to the exit block without
+// returning, i.e. it ends with a throw. Such blocks are considered cold.
+static bool IsColdThrowingBlock(HBasicBlock* block) {
+  return !IsLoop(block->GetLoopInformation())
+      && !block->IsCatchBlock()
+      && block->GetSuccessors().size() == 1u
+      && block->GetSingleSuccessor()->IsExitBlock()
+      && !block->EndsWithReturn();
+}
+
+// Returns whether the branch profile of `block` says that its true successor is taken
+// more often than its false successor.
+static bool IsTrueSuccessorHotter(HBasicBlock* block) {
+  if (!block->EndsWithIf()) {
+    return false;
+  }
+  HIf* if_instr = block->GetLastInstruction()->AsIf();
+  return if_instr->GetTrueCount() > if_instr->GetFalseCount();
+}
+
 // Helper method to update work list for linear order.
 static void AddToListForLinearization(ScopedArenaVector<HBasicBlock*>* worklist,
                                       HBasicBlock* block) {
+  if (IsColdThrowingBlock(block)) {
+    // Defer cold blocks to the end of the linear order, away from the hot code.
+    worklist->insert(worklist->begin(), block);
+    return;
+  }
   HLoopInformation* block_loop = block->GetLoopInformation();
   auto insert_pos = worklist->rbegin();  // insert_pos.base() will be the actual position.
   for (auto end = worklist->rend(); insert_pos != end; ++insert_pos) {
@@ -87,7 +112,9 @@ void LinearizeGraphInternal(const HGraph* graph, ArrayRef<HBasicBlock*> linear_o
   DCHECK_EQ(linear_order.size(), graph->GetReversePostOrder().size());
   // Create a reverse post ordering with the following properties:
   // - Blocks in a loop are consecutive,
-  // - Back-edge is the last block before loop exits.
+  // - Back-edge is the last block before loop exits,
+  // - The more frequently taken successor of a profiled `HIf` is preferred as the next block,
+  // - Blocks that end with a throw are moved after the rest of the code.
   //
   // (1): Record the number of forward predecessors for each block. This is to
   //      ensure the resulting order is reverse post order. We could use the
@@ -116,7 +143,13 @@ void LinearizeGraphInternal(const HGraph* graph, ArrayRef<HBasicBlock*> linear_o
     worklist.pop_back();
     linear_order[num_added] = current;
     ++num_added;
-    for (HBasicBlock* successor : current->GetSuccessors()) {
+    // The worklist is processed in LIFO order, so the last successor added is the one most
+    // likely to be placed right after `current`. By default that is the false successor of
+    // an `HIf`, unless the branch profile says the true successor is hotter.
+    ArrayRef<HBasicBlock* const> successors(current->GetSuccessors());
+    bool reverse = IsTrueSuccessorHotter(current);
+    for (size_t i = 0, size = successors.size(); i != size; ++i) {
+      HBasicBlock* successor = successors[reverse ? size - 1u - i : i];
       int block_id = successor->GetBlockId();
       size_t number_of_remaining_predecessors = forward_predecessors[block_id];
       if (number_of_remaining_predecessors == 1) {
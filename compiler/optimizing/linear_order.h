@@ -28,7 +28,10 @@ void LinearizeGraphInternal(const HGraph* graph, ArrayRef<HBasicBlock*> linear_o
 
 // Linearizes the 'graph' such that:
 // (1): a block is always after its dominator,
-// (2): blocks of loops are contiguous.
+// (2): blocks of loops are contiguous,
+// (3): blocks ending with a throw are placed after the rest of the code,
+// (4): if branch profiling data is available, the hotter successor of a branch is
+//      preferably placed right after it.
 //
 // Storage is obtained through 'allocator' and the linear order it computed
 // into 'linear_order'. Once computed, iteration can be expressed as:
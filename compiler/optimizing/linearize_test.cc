@@ -14,9 +14,11 @@
  * limitations under the License.
  */
 
+#include <algorithm>
 #include <fstream>
 
 #include "base/arena_allocator.h"
+#include "base/array_ref.h"
 #include "base/macros.h"
 #include "builder.h"
 #include "code_generator.h"
@@ -36,17 +38,40 @@ class LinearizeTest : public CommonCompilerTest, public OptimizingUnitTestHelper
   template <size_t number_of_blocks>
   void TestCode(const std::vector<uint16_t>& data,
                 const uint32_t (&expected_order)[number_of_blocks]);
+
+  void Linearize(HGraph* graph) {
+    std::unique_ptr<CompilerOptions> compiler_options =
+        CommonCompilerTest::CreateCompilerOptions(kRuntimeISA, "default");
+    std::unique_ptr<CodeGenerator> codegen = CodeGenerator::Create(graph, *compiler_options);
+    SsaLivenessAnalysis liveness(graph, codegen.get(), GetScopedAllocator());
+    liveness.Analyze();
+  }
+
+  static size_t LinearPositionOf(HGraph* graph, HBasicBlock* block) {
+    ArrayRef<HBasicBlock* const> linear_order(graph->GetLinearOrder());
+    auto it = std::find(linear_order.begin(), linear_order.end(), block);
+    CHECK(it != linear_order.end());
+    return std::distance(linear_order.begin(), it);
+  }
+
+  static HIf* FindSingleIf(HGraph* graph) {
+    HIf* result = nullptr;
+    for (HBasicBlock* block : graph->GetReversePostOrder()) {
+      if (block->EndsWithIf()) {
+        CHECK(result == nullptr);
+        result = block->GetLastInstruction()->AsIf();
+      }
+    }
+    CHECK(result != nullptr);
+    return result;
+  }
 };
 
 template <size_t number_of_blocks>
 void LinearizeTest::TestCode(const std::vector<uint16_t>& data,
                              const uint32_t (&expected_order)[number_of_blocks]) {
   HGraph* graph = CreateCFG(data);
-  std::unique_ptr<CompilerOptions> compiler_options =
-      CommonCompilerTest::CreateCompilerOptions(kRuntimeISA, "default");
-  std::unique_ptr<CodeGenerator> codegen = CodeGenerator::Create(graph, *compiler_options);
-  SsaLivenessAnalysis liveness(graph, codegen.get(), GetScopedAllocator());
-  liveness.Analyze();
+  Linearize(graph);
 
   ASSERT_EQ(graph->GetLinearOrder().size(), number_of_blocks);
   for (size_t i = 0; i < number_of_blocks; ++i) {
@@ -245,4 +270,95 @@ TEST_F(LinearizeTest, CFG7) {
   TestCode(data, blocks);
 }
 
+TEST_F(LinearizeTest, ColdThrowingBlockIsLast) {
+  //            Block0
+  //              |
+  //            Block1
+  //            /    \
+  //  (throw) Block2  Block3 (return)
+  //            \    /
+  //             Exit
+  //
+  // The throwing block is the false successor and would be placed right after Block1
+  // without the cold block heuristic.
+  const std::vector<uint16_t> data = ONE_REGISTER_CODE_ITEM(
+    Instruction::CONST_4 | 0 | 0,
+    Instruction::IF_EQ, 3,
+    Instruction::THROW | 0,
+    Instruction::RETURN_VOID);
+
+  HGraph* graph = CreateCFG(data);
+  ASSERT_TRUE(graph != nullptr);
+  HIf* if_instr = FindSingleIf(graph);
+  HBasicBlock* throwing_block = if_instr->IfFalseSuccessor();
+  HBasicBlock* returning_block = if_instr->IfTrueSuccessor();
+  ASSERT_TRUE(throwing_block->GetLastInstruction()->IsThrow());
+  ASSERT_TRUE(returning_block->EndsWithReturn());
+
+  Linearize(graph);
+  EXPECT_EQ(LinearPositionOf(graph, if_instr->GetBlock()) + 1u,
+            LinearPositionOf(graph, returning_block));
+  EXPECT_LT(LinearPositionOf(graph, returning_block), LinearPositionOf(graph, throwing_block));
+}
+
+TEST_F(LinearizeTest, UnprofiledBranchPrefersFalseSuccessor) {
+  //            Block0
+  //              |
+  //            Block1
+  //            /    \
+  //        Block2  Block3
+  //            \    /
+  //             Exit
+  const std::vector<uint16_t> data = ONE_REGISTER_CODE_ITEM(
+    Instruction::CONST_4 | 0 | 0,
+    Instruction::IF_EQ, 3,
+    Instruction::RETURN_VOID,
+    Instruction::RETURN_VOID);
+
+  HGraph* graph = CreateCFG(data);
+  ASSERT_TRUE(graph != nullptr);
+  HIf* if_instr = FindSingleIf(graph);
+
+  Linearize(graph);
+  EXPECT_EQ(LinearPositionOf(graph, if_instr->GetBlock()) + 1u,
+            LinearPositionOf(graph, if_instr->IfFalseSuccessor()));
+}
+
+TEST_F(LinearizeTest, ProfiledBranchPrefersHotterSuccessor) {
+  // Same graph as above, with a branch profile saying the true successor is hotter.
+  const std::vector<uint16_t> data = ONE_REGISTER_CODE_ITEM(
+    Instruction::CONST_4 | 0 | 0,
+    Instruction::IF_EQ, 3,
+    Instruction::RETURN_VOID,
+    Instruction::RETURN_VOID);
+
+  HGraph* graph = CreateCFG(data);
+  ASSERT_TRUE(graph != nullptr);
+  HIf* if_instr = FindSingleIf(graph);
+  if_instr->SetTrueCount(100u);
+  if_instr->SetFalseCount(1u);
+
+  Linearize(graph);
+  EXPECT_EQ(LinearPositionOf(graph, if_instr->GetBlock()) + 1u,
+            LinearPositionOf(graph, if_instr->IfTrueSuccessor()));
+}
+
+TEST_F(LinearizeTest, ProfiledBranchKeepsFalseSuccessorWhenHotter) {
+  const std::vector<uint16_t> data = ONE_REGISTER_CODE_ITEM(
+    Instruction::CONST_4 | 0 | 0,
+    Instruction::IF_EQ, 3,
+    Instruction::RETURN_VOID,
+    Instruction::RETURN_VOID);
+
+  HGraph* graph = CreateCFG(data);
+  ASSERT_TRUE(graph != nullptr);
+  HIf* if_instr = FindSingleIf(graph);
+  if_instr->SetTrueCount(1u);
+  if_instr->SetFalseCount(100u);
+
+  Linearize(graph);
+  EXPECT_EQ(LinearPositionOf(graph, if_instr->GetBlock()) + 1u,
+            LinearPositionOf(graph, if_instr->IfFalseSuccessor()));
+}
+
 }  // namespace art
@@ -2965,6 +2965,11 @@ bool LoadStoreElimination::Run() {
     // No HeapLocation information from LSA, skip this optimization.
     return false;
   }
+  if (graph_->GetBlocks().size() * heap_location_collector.GetNumberOfHeapLocations() >
+      kMaximumNumberOfHeapValues) {
+    // Too expensive, skip this optimization.
+    return false;
+  }
 
   // Currently load_store analysis can't handle predicated load/stores; specifically pairs of
   // memory operations with different predicates.
@@ -29,6 +29,11 @@ class LoadStoreElimination : public HOptimization {
   // Controls whether to enable VLOG(compiler) logs explaining the transforms taking place.
   static constexpr bool kVerboseLoggingMode = false;
 
+  // Maximum number of heap values, one per block and heap location, that LSE tracks. Time and
+  // memory are proportional to that, so huge methods are skipped rather than slowing down the
+  // whole compilation.
+  static constexpr size_t kMaximumNumberOfHeapValues = 1u << 18;
+
   LoadStoreElimination(HGraph* graph,
                        OptimizingCompilerStats* stats,
                        const char* name = kLoadStoreEliminationPassName)
@@ -49,6 +49,11 @@ void LoopAnalysis::CalculateLoopBasicProperties(HLoopInformation* loop_info,
       }
     }
 
+    HIf* hif = block->GetLastInstruction()->AsIfOrNull();
+    if (hif != nullptr && IsLoopInvariantBranch(loop_info, hif)) {
+      analysis_results->invariant_branches_num_++;
+    }
+
     for (HInstructionIterator it(block->GetInstructions()); !it.Done(); it.Advance()) {
       HInstruction* instruction = it.Current();
       if (it.Current()->GetType() == DataType::Type::kInt64) {
@@ -40,6 +40,7 @@ class LoopAnalysisInfo : public ValueObject {
         instr_num_(0),
         exits_num_(0),
         invariant_exits_num_(0),
+        invariant_branches_num_(0),
         has_instructions_preventing_scalar_peeling_(false),
         has_instructions_preventing_scalar_unrolling_(false),
         has_long_type_instructions_(false),
@@ -50,6 +51,7 @@ class LoopAnalysisInfo : public ValueObject {
   size_t GetNumberOfInstructions() const { return instr_num_; }
   size_t GetNumberOfExits() const { return exits_num_; }
   size_t GetNumberOfInvariantExits() const { return invariant_exits_num_; }
+  size_t GetNumberOfInvariantBranches() const { return invariant_branches_num_; }
 
   bool HasInstructionsPreventingScalarPeeling() const {
     return has_instructions_preventing_scalar_peeling_;
@@ -80,6 +82,9 @@ class LoopAnalysisInfo : public ValueObject {
   size_t exits_num_;
   // Number of "if" loop exits (with HIf instruction) whose condition is loop-invariant.
   size_t invariant_exits_num_;
+  // Number of "if" instructions inside the loop which are not loop exits and whose condition is
+  // loop-invariant.
+  size_t invariant_branches_num_;
   // Whether the loop has instructions which make scalar loop peeling non-beneficial.
   bool has_instructions_preventing_scalar_peeling_;
   // Whether the loop has instructions which make scalar loop unrolling non-beneficial.
@@ -108,6 +113,16 @@ class LoopAnalysis : public ValueObject {
   static int64_t GetLoopTripCount(HLoopInformation* loop_info,
                                   const InductionVarRange* induction_range);
 
+  // Returns whether 'hif' is a branch inside the loop (i.e. not a loop exit) with a non-constant
+  // loop-invariant condition; such a branch can be eliminated by loop versioning (unswitching).
+  static bool IsLoopInvariantBranch(HLoopInformation* loop_info, HIf* hif) {
+    HInstruction* condition = hif->InputAt(0);
+    return loop_info->Contains(*hif->IfTrueSuccessor()) &&
+           loop_info->Contains(*hif->IfFalseSuccessor()) &&
+           !loop_info->Contains(*condition->GetBlock()) &&
+           !condition->IsConstant();
+  }
+
  private:
   // Returns whether an instruction makes scalar loop peeling/unrolling non-beneficial.
   //
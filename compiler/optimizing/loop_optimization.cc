@@ -521,6 +521,7 @@ HLoopOptimization::HLoopOptimization(HGraph* graph,
       iset_(nullptr),
       reductions_(nullptr),
       simplified_(false),
+      unswitched_instructions_(0u),
       predicated_vectorization_mode_(codegen.SupportsPredicatedSIMD()),
       vector_length_(0),
       vector_refs_(nullptr),
@@ -1045,6 +1046,51 @@ bool HLoopOptimization::TryPeelingForLoopInvariantExitsElimination(LoopAnalysisI
   return true;
 }
 
+bool HLoopOptimization::TryUnswitchingForLoopInvariantBranchesElimination(
+    LoopAnalysisInfo* analysis_info, bool generate_code) {
+  // Versioning duplicates the loop body once, as peeling does; use the same target heuristics.
+  if (!arch_loop_helper_->IsLoopPeelingEnabled()) {
+    return false;
+  }
+
+  if (analysis_info->GetNumberOfInvariantBranches() == 0) {
+    return false;
+  }
+
+  // Bound the code size growth of the whole method, the loop itself is already bounded by
+  // IsLoopNonBeneficialForScalarOpts().
+  size_t instruction_count = analysis_info->GetNumberOfInstructions();
+  if (unswitched_instructions_ + instruction_count > kMaxUnswitchedInstructions) {
+    return false;
+  }
+
+  if (generate_code) {
+    unswitched_instructions_ += instruction_count;
+    HLoopInformation* loop_info = analysis_info->GetLoopInfo();
+    HIf* invariant_if = nullptr;
+    for (HBlocksInLoopIterator it(*loop_info); !it.Done(); it.Advance()) {
+      HIf* hif = it.Current()->GetLastInstruction()->AsIfOrNull();
+      if (hif != nullptr && LoopAnalysis::IsLoopInvariantBranch(loop_info, hif)) {
+        invariant_if = hif;
+        break;
+      }
+    }
+    DCHECK(invariant_if != nullptr);
+
+    // Perform versioning: the original loop is executed when the condition is true and the copy
+    // otherwise.
+    LoopClonerSimpleHelper helper(loop_info, &induction_range_);
+    helper.DoVersioning(invariant_if->InputAt(0));
+
+    // Statically evaluate the invariant condition in both versions of the loop.
+    HIf* copy_if = helper.GetInstructionMap()->Get(invariant_if)->AsIf();
+    invariant_if->ReplaceInput(graph_->GetIntConstant(1), 0u);
+    copy_if->ReplaceInput(graph_->GetIntConstant(0), 0u);
+  }
+
+  return true;
+}
+
 bool HLoopOptimization::TryFullUnrolling(LoopAnalysisInfo* analysis_info, bool generate_code) {
   // Fully unroll loops with a known and small trip count.
   int64_t trip_count = analysis_info->GetTripCount();
@@ -1104,6 +1150,7 @@ bool HLoopOptimization::TryLoopScalarOpts(LoopNode* node) {
 
   if (!TryFullUnrolling(&analysis_info, /*generate_code*/ false) &&
       !TryPeelingForLoopInvariantExitsElimination(&analysis_info, /*generate_code*/ false) &&
+      !TryUnswitchingForLoopInvariantBranchesElimination(&analysis_info, /*generate_code*/ false) &&
       !TryUnrollingForBranchPenaltyReduction(&analysis_info, /*generate_code*/ false) &&
       !TryToRemoveSuspendCheckFromLoopHeader(&analysis_info, /*generate_code*/ false)) {
     return false;
@@ -1121,6 +1168,7 @@ bool HLoopOptimization::TryLoopScalarOpts(LoopNode* node) {
 
   return TryFullUnrolling(&analysis_info) ||
          TryPeelingForLoopInvariantExitsElimination(&analysis_info) ||
+         TryUnswitchingForLoopInvariantBranchesElimination(&analysis_info) ||
          TryUnrollingForBranchPenaltyReduction(&analysis_info) || removed_suspend_check;
 }
 
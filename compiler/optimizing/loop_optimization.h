@@ -60,6 +60,11 @@ class HLoopOptimization : public HOptimization {
   // be performed.
   static constexpr int64_t kMaxTotalInstRemoveSuspendCheck = 128;
 
+  // The maximum number of instructions that loop unswitching may duplicate in one method.
+  // Each unswitched loop is copied in full, so without a limit a method with many loops with
+  // invariant branches would grow far more than the branches are worth.
+  static constexpr size_t kMaxUnswitchedInstructions = 64;
+
  private:
   /**
    * A single loop inside the loop hierarchy representation.
@@ -277,6 +282,12 @@ class HLoopOptimization : public HOptimization {
   bool TryPeelingForLoopInvariantExitsElimination(LoopAnalysisInfo* analysis_info,
                                                   bool generate_code = true);
 
+  // Tries to apply loop versioning (unswitching) for loop invariant branches elimination. Returns
+  // whether transformation happened. 'generate_code' determines whether the optimization should
+  // be actually applied.
+  bool TryUnswitchingForLoopInvariantBranchesElimination(LoopAnalysisInfo* analysis_info,
+                                                         bool generate_code = true);
+
   // Tries to perform whole loop unrolling for a small loop with a small trip count to eliminate
   // the loop check overhead and to have more opportunities for inter-iteration optimizations.
   // Returns whether transformation happened. 'generate_code' determines whether the optimization
@@ -524,6 +535,10 @@ class HLoopOptimization : public HOptimization {
   // Flag that tracks if any simplifications have occurred.
   bool simplified_;
 
+  // Number of instructions duplicated by loop unswitching so far, bounded by
+  // kMaxUnswitchedInstructions.
+  size_t unswitched_instructions_;
+
   // Whether to use predicated loop vectorization (e.g. for arm64 SVE target).
   bool predicated_vectorization_mode_;
 
@@ -83,12 +83,15 @@ class PassObserver : public ValueObject {
   PassObserver(HGraph* graph,
                CodeGenerator* codegen,
                std::ostream* visualizer_output,
-               const CompilerOptions& compiler_options)
+               const CompilerOptions& compiler_options,
+               CumulativeLogger* cumulative_pass_timings)
       : graph_(graph),
         last_seen_graph_size_(0),
         cached_method_name_(),
         timing_logger_enabled_(compiler_options.GetDumpPassTimings()),
         timing_logger_(timing_logger_enabled_ ? GetMethodName() : "", true, true),
+        cumulative_pass_timings_(cumulative_pass_timings),
+        dump_method_timings_(timing_logger_enabled_),
         disasm_info_(graph->GetAllocator()),
         visualizer_oss_(),
         visualizer_output_(visualizer_output),
@@ -98,7 +101,9 @@ class PassObserver : public ValueObject {
         graph_in_bad_state_(false) {
     if (timing_logger_enabled_ || visualizer_enabled_) {
       if (!IsVerboseMethod(compiler_options, GetMethodName())) {
-        timing_logger_enabled_ = visualizer_enabled_ = false;
+        dump_method_timings_ = visualizer_enabled_ = false;
+        // Keep timing the passes if they are accumulated over all compiled methods.
+        timing_logger_enabled_ = (cumulative_pass_timings_ != nullptr);
       }
       if (visualizer_enabled_) {
         visualizer_.PrintHeader(GetMethodName());
@@ -108,10 +113,13 @@ class PassObserver : public ValueObject {
   }
 
   ~PassObserver() {
-    if (timing_logger_enabled_) {
+    if (dump_method_timings_) {
       LOG(INFO) << "TIMINGS " << GetMethodName();
       LOG(INFO) << Dumpable<TimingLogger>(timing_logger_);
     }
+    if (timing_logger_enabled_ && cumulative_pass_timings_ != nullptr) {
+      cumulative_pass_timings_->AddLogger(timing_logger_);
+    }
     if (visualizer_enabled_) {
       FlushVisualizer();
     }
@@ -205,6 +213,10 @@ class PassObserver : public ValueObject {
 
   bool timing_logger_enabled_;
   TimingLogger timing_logger_;
+  // Pass timings of all the methods compiled by the same compiler, if requested.
+  CumulativeLogger* const cumulative_pass_timings_;
+  // Whether the timings of this particular method should be dumped.
+  bool dump_method_timings_;
 
   DisassemblyInformation disasm_info_;
 
@@ -380,6 +392,9 @@ class OptimizingCompiler final : public Compiler {
 
   std::unique_ptr<OptimizingCompilerStats> compilation_stats_;
 
+  // Per-pass timings accumulated over all compiled methods, for --dump-pass-timings.
+  std::unique_ptr<CumulativeLogger> cumulative_pass_timings_;
+
   std::unique_ptr<std::ostream> visualizer_output_;
 
   DISALLOW_COPY_AND_ASSIGN(OptimizingCompiler);
@@ -401,12 +416,18 @@ OptimizingCompiler::OptimizingCompiler(const CompilerOptions& compiler_options,
   if (compiler_options.GetDumpStats()) {
     compilation_stats_.reset(new OptimizingCompilerStats());
   }
+  if (compiler_options.GetDumpPassTimings()) {
+    cumulative_pass_timings_.reset(new CumulativeLogger("Optimizing passes"));
+  }
 }
 
 OptimizingCompiler::~OptimizingCompiler() {
   if (compilation_stats_.get() != nullptr) {
     compilation_stats_->Log();
   }
+  if (cumulative_pass_timings_ != nullptr && cumulative_pass_timings_->GetIterations() != 0u) {
+    LOG(INFO) << Dumpable<CumulativeLogger>(*cumulative_pass_timings_);
+  }
 }
 
 void OptimizingCompiler::DumpInstructionSetFeaturesToCfg() const {
@@ -902,7 +923,8 @@ CodeGenerator* OptimizingCompiler::TryCompile(ArenaAllocator* allocator,
   PassObserver pass_observer(graph,
                              codegen.get(),
                              visualizer_output_.get(),
-                             compiler_options);
+                             compiler_options,
+                             cumulative_pass_timings_.get());
 
   {
     VLOG(compiler) << "Building " << pass_observer.GetMethodName();
@@ -1075,7 +1097,8 @@ CodeGenerator* OptimizingCompiler::TryCompileIntrinsic(
   PassObserver pass_observer(graph,
                              codegen.get(),
                              visualizer_output_.get(),
-                             compiler_options);
+                             compiler_options,
+                             cumulative_pass_timings_.get());
 
   {
     VLOG(compiler) << "Building intrinsic graph " << pass_observer.GetMethodName();
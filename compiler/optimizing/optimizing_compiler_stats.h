@@ -70,9 +70,11 @@ enum class MethodCompilationStat {
   kNotCompiledFrameTooBig,
   kInlinedMonomorphicCall,
   kInlinedPolymorphicCall,
+  kInlinedMegamorphicCall,
   kMonomorphicCall,
   kPolymorphicCall,
   kMegamorphicCall,
+  kReadOnlyInvoke,
   kBooleanSimplified,
   kIntrinsicRecognized,
   kLoopInvariantMoved,
@@ -911,7 +911,15 @@ bool SuperblockCloner::IsFastCase() const {
                           EdgeHashSetsEqual(&remap_copy_internal, remap_copy_internal_) &&
                           EdgeHashSetsEqual(&remap_incoming, remap_incoming_);
 
-  return peeling_or_unrolling;
+  // Check whether remapping info corresponds to loop versioning: all the internal edges are kept
+  // and a single incoming edge to the loop header is redirected to the copy.
+  uint32_t header_id = common_loop_info->GetHeader()->GetBlockId();
+  bool versioning = remap_orig_internal_->empty() &&
+                    remap_copy_internal_->empty() &&
+                    remap_incoming_->size() == 1u &&
+                    remap_incoming_->begin()->GetTo() == header_id;
+
+  return peeling_or_unrolling || versioning;
 }
 
 void SuperblockCloner::Run() {
@@ -1107,7 +1115,42 @@ bool LoopClonerHelper::IsLoopClonable(HLoopInformation* loop_info) {
   return helper.IsLoopClonable();
 }
 
-HBasicBlock* LoopClonerHelper::DoLoopTransformationImpl(TransformationKind transformation) {
+HBasicBlock* LoopClonerHelper::InsertVersioningGuard(HInstruction* condition) {
+  DCHECK(!loop_info_->Contains(*condition->GetBlock()));
+  HBasicBlock* loop_header = loop_info_->GetHeader();
+  HBasicBlock* preheader = loop_info_->GetPreHeader();
+  HGraph* graph = loop_header->GetGraph();
+  ArenaAllocator* allocator = graph->GetAllocator();
+  uint32_t dex_pc = loop_header->GetDexPc();
+
+  HBasicBlock* guard_block = graph->SplitEdge(preheader, loop_header);
+  HBasicBlock* orig_entry = graph->SplitEdge(guard_block, loop_header);
+  HBasicBlock* copy_entry = new (allocator) HBasicBlock(graph, dex_pc);
+  graph->AddBlock(copy_entry);
+  guard_block->AddSuccessor(copy_entry);  // False successor.
+  copy_entry->AddSuccessor(loop_header);
+
+  guard_block->AddInstruction(new (allocator) HIf(condition, dex_pc));
+  orig_entry->AddInstruction(new (allocator) HGoto(dex_pc));
+  copy_entry->AddInstruction(new (allocator) HGoto(dex_pc));
+  for (HBasicBlock* block : {guard_block, orig_entry, copy_entry}) {
+    graph->UpdateLoopAndTryInformationOfNewBlock(
+        block, preheader, /* replace_if_back_edge= */ false);
+  }
+
+  // 'copy_entry' was added as the last predecessor of the header; its phi inputs are the same
+  // as for the original entry.
+  size_t orig_entry_index = loop_header->GetPredecessorIndexOf(orig_entry);
+  for (HInstructionIterator it(loop_header->GetPhis()); !it.Done(); it.Advance()) {
+    HPhi* phi = it.Current()->AsPhi();
+    phi->AddInput(phi->InputAt(orig_entry_index));
+  }
+
+  return copy_entry;
+}
+
+HBasicBlock* LoopClonerHelper::DoLoopTransformationImpl(TransformationKind transformation,
+                                                        HInstruction* condition) {
   // For now do transformations only for natural loops.
   DCHECK(!loop_info_->IsIrreducible());
 
@@ -1127,6 +1170,9 @@ HBasicBlock* LoopClonerHelper::DoLoopTransformationImpl(TransformationKind trans
       case TransformationKind::kUnrolling:
         oss<< "unrolling";
         break;
+      case TransformationKind::kVersioning:
+        oss << "versioning";
+        break;
     }
     oss << " was applied to the loop <" << loop_header->GetBlockId() << ">.";
     LOG(INFO) << oss.str();
@@ -1138,11 +1184,17 @@ HBasicBlock* LoopClonerHelper::DoLoopTransformationImpl(TransformationKind trans
   HEdgeSet remap_copy_internal(graph->GetAllocator()->Adapter(kArenaAllocSuperblockCloner));
   HEdgeSet remap_incoming(graph->GetAllocator()->Adapter(kArenaAllocSuperblockCloner));
 
-  CollectRemappingInfoForPeelUnroll(transformation == TransformationKind::kUnrolling,
-                                    loop_info_,
-                                    &remap_orig_internal,
-                                    &remap_copy_internal,
-                                    &remap_incoming);
+  if (transformation == TransformationKind::kVersioning) {
+    DCHECK(condition != nullptr);
+    HBasicBlock* copy_entry = InsertVersioningGuard(condition);
+    remap_incoming.insert(HEdge(copy_entry, loop_header));
+  } else {
+    CollectRemappingInfoForPeelUnroll(transformation == TransformationKind::kUnrolling,
+                                      loop_info_,
+                                      &remap_orig_internal,
+                                      &remap_copy_internal,
+                                      &remap_incoming);
+  }
 
   cloner_.SetSuccessorRemappingInfo(&remap_orig_internal, &remap_copy_internal, &remap_incoming);
   cloner_.Run();
@@ -162,7 +162,7 @@ class SuperblockCloner : public ValueObject {
   //
   // TODO: formally describe the criteria.
   //
-  // Loop peeling and unrolling satisfy the criteria.
+  // Loop peeling, unrolling and versioning satisfy the criteria.
   bool IsFastCase() const;
 
   // Runs the copy algorithm according to the description.
@@ -363,7 +363,7 @@ class SuperblockCloner : public ValueObject {
   DISALLOW_COPY_AND_ASSIGN(SuperblockCloner);
 };
 
-// Helper class to perform loop peeling/unrolling.
+// Helper class to perform loop peeling/unrolling/versioning.
 //
 // This helper should be used when correspondence map between original and copied
 // basic blocks/instructions are demanded.
@@ -443,25 +443,64 @@ class LoopClonerHelper : public ValueObject {
     return DoLoopTransformationImpl(TransformationKind::kUnrolling);
   }
 
+  // Perform loop versioning: the loop is duplicated and a guard on 'condition' is inserted
+  // before the two versions. The original loop is executed when 'condition' is true, the copy
+  // otherwise. 'condition' must be defined outside of the loop.
+  //
+  // Control flow of an example (ignoring critical edges splitting).
+  //
+  //       Before                    After
+  //
+  //         |B|                      |B|
+  //          |                        |
+  //          v                        v
+  //         |1|                      |1|
+  //          |                        |
+  //          v                        v
+  //         |2|<-\                   |G|
+  //         / \  /                  /   \
+  //        v   v/                  v     v
+  //       |4|  |3|              |2|<-\  |2A|<-\
+  //        |                    / \  /   / \   /
+  //        v                   /   v/   /   v /
+  //       |E|                 |   |3|  |   |3A|
+  //                            \       /
+  //                             v     v
+  //                               |4|
+  //                                |
+  //                                v
+  //                               |E|
+  HBasicBlock* DoVersioning(HInstruction* condition) {
+    return DoLoopTransformationImpl(TransformationKind::kVersioning, condition);
+  }
+
   HLoopInformation* GetRegionToBeAdjusted() const { return cloner_.GetRegionToBeAdjusted(); }
 
  protected:
   enum class TransformationKind {
     kPeeling,
     kUnrolling,
+    kVersioning,
   };
 
-  // Applies a specific loop transformation to the loop.
-  HBasicBlock* DoLoopTransformationImpl(TransformationKind transformation);
+  // Applies a specific loop transformation to the loop; 'condition' is only used for versioning.
+  HBasicBlock* DoLoopTransformationImpl(TransformationKind transformation,
+                                        HInstruction* condition = nullptr);
 
  private:
+  // Inserts a guard block ending with an HIf on 'condition' between the loop preheader and the
+  // loop header. Its true successor leads to the loop header; its false successor is a new block
+  // which also leads to the loop header and is returned. The edge from that block to the header
+  // is to be redirected to the loop copy by the cloner.
+  HBasicBlock* InsertVersioningGuard(HInstruction* condition);
+
   HLoopInformation* loop_info_;
   SuperblockCloner cloner_;
 
   DISALLOW_COPY_AND_ASSIGN(LoopClonerHelper);
 };
 
-// Helper class to perform loop peeling/unrolling.
+// Helper class to perform loop peeling/unrolling/versioning.
 //
 // This helper should be used when there is no need to get correspondence information between
 // original and copied basic blocks/instructions.
@@ -471,6 +510,7 @@ class LoopClonerSimpleHelper : public ValueObject {
   bool IsLoopClonable() const { return helper_.IsLoopClonable(); }
   HBasicBlock* DoPeeling() { return helper_.DoPeeling(); }
   HBasicBlock* DoUnrolling() { return helper_.DoUnrolling(); }
+  HBasicBlock* DoVersioning(HInstruction* condition) { return helper_.DoVersioning(condition); }
   HLoopInformation* GetRegionToBeAdjusted() const { return helper_.GetRegionToBeAdjusted(); }
 
   const SuperblockCloner::HBasicBlockMap* GetBasicBlockMap() const { return &bb_map_; }
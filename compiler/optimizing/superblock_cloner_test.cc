@@ -301,6 +301,58 @@ TEST_F(SuperblockClonerTest, LoopUnrolling) {
   EXPECT_EQ(loop_info->GetBackEdges()[0], bb_map.Get(loop_body));
 }
 
+// Tests SuperblockCloner for loop versioning case.
+//
+// See an ASCII graphics example near LoopClonerHelper::DoVersioning.
+TEST_F(SuperblockClonerTest, LoopVersioning) {
+  HBasicBlock* return_block = InitGraphAndParameters();
+  auto [preheader, header, loop_body] = CreateWhileLoop(return_block);
+  CreateBasicLoopDataFlow(header, loop_body);
+  HInstruction* condition = MakeCondition(preheader, kCondEQ, param_, graph_->GetIntConstant(0));
+  graph_->BuildDominatorTree();
+  EXPECT_TRUE(CheckGraph());
+
+  HBasicBlockMap bb_map(
+      std::less<HBasicBlock*>(), graph_->GetAllocator()->Adapter(kArenaAllocSuperblockCloner));
+  HInstructionMap hir_map(
+      std::less<HInstruction*>(), graph_->GetAllocator()->Adapter(kArenaAllocSuperblockCloner));
+
+  HLoopInformation* loop_info = header->GetLoopInformation();
+  LoopClonerHelper helper(loop_info, &bb_map, &hir_map, /* induction_range= */ nullptr);
+  EXPECT_TRUE(helper.IsLoopClonable());
+  HBasicBlock* new_header = helper.DoVersioning(condition);
+
+  EXPECT_TRUE(CheckGraph());
+
+  HBasicBlock* copy_header = bb_map.Get(header);
+  HBasicBlock* copy_body = bb_map.Get(loop_body);
+
+  // Check loop body successors.
+  EXPECT_EQ(loop_body->GetSingleSuccessor(), header);
+  EXPECT_EQ(copy_body->GetSingleSuccessor(), copy_header);
+
+  // Check that the guard selects between the two versions of the loop.
+  HBasicBlock* guard_block = loop_info->GetPreHeader()->GetSinglePredecessor();
+  ASSERT_TRUE(guard_block->EndsWithIf());
+  HIf* guard_if = guard_block->GetLastInstruction()->AsIf();
+  EXPECT_EQ(guard_if->InputAt(0), condition);
+  EXPECT_EQ(guard_if->IfTrueSuccessor()->GetSingleSuccessor(), header);
+  EXPECT_EQ(guard_if->IfFalseSuccessor()->GetSingleSuccessor(), copy_header);
+
+  // Check loop structure.
+  EXPECT_EQ(header, new_header);
+  EXPECT_EQ(loop_info, header->GetLoopInformation());
+  EXPECT_EQ(loop_info->GetBackEdges().size(), 1u);
+  EXPECT_EQ(loop_info->GetBackEdges()[0], loop_body);
+
+  HLoopInformation* copy_loop_info = copy_header->GetLoopInformation();
+  ASSERT_NE(copy_loop_info, nullptr);
+  EXPECT_NE(copy_loop_info, loop_info);
+  EXPECT_EQ(copy_loop_info->GetHeader(), copy_header);
+  EXPECT_EQ(copy_loop_info->GetBackEdges().size(), 1u);
+  EXPECT_EQ(copy_loop_info->GetBackEdges()[0], copy_body);
+}
+
 // Checks that loop unrolling works fine for a loop with multiple back edges. Tests that after
 // the transformation the loop has a single preheader.
 TEST_F(SuperblockClonerTest, LoopPeelingMultipleBackEdges) {
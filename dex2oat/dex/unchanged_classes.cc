@@ -0,0 +1,389 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "unchanged_classes.h"
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <string_view>
+
+#include <android-base/logging.h>
+
+#include "dex/class_accessor-inl.h"
+#include "dex/code_item_accessors-inl.h"
+#include "dex/dex_file-inl.h"
+#include "dex/dex_file_exception_helpers.h"
+#include "dex/dex_instruction-inl.h"
+#include "dex/signature-inl.h"
+
+namespace art {
+
+namespace {
+
+// Compares a class definition of a previous build with the one of the current build. Indices
+// into the dex files are compared by the entity they refer to, and the descriptors of all the
+// types referenced by the new definition are collected.
+class ClassComparator {
+ public:
+  ClassComparator(const DexFile& old_dex_file,
+                  const DexFile& new_dex_file,
+                  std::set<std::string_view>* referenced_types)
+      : old_dex_file_(old_dex_file),
+        new_dex_file_(new_dex_file),
+        referenced_types_(referenced_types) {}
+
+  bool SameClass(const dex::ClassDef& old_def, const dex::ClassDef& new_def) {
+    if (old_def.access_flags_ != new_def.access_flags_ ||
+        !SameOptionalType(old_def.superclass_idx_, new_def.superclass_idx_) ||
+        !SameTypeList(old_dex_file_.GetInterfacesList(old_def),
+                      new_dex_file_.GetInterfacesList(new_def))) {
+      return false;
+    }
+    ClassAccessor old_accessor(old_dex_file_, old_def);
+    ClassAccessor new_accessor(new_dex_file_, new_def);
+    if (old_accessor.NumStaticFields() != new_accessor.NumStaticFields() ||
+        old_accessor.NumInstanceFields() != new_accessor.NumInstanceFields() ||
+        old_accessor.NumDirectMethods() != new_accessor.NumDirectMethods() ||
+        old_accessor.NumVirtualMethods() != new_accessor.NumVirtualMethods()) {
+      return false;
+    }
+    auto old_field = old_accessor.GetFields().begin();
+    for (const ClassAccessor::Field& new_field : new_accessor.GetFields()) {
+      if (old_field->GetAccessFlags() != new_field.GetAccessFlags() ||
+          !SameField(old_field->GetIndex(), new_field.GetIndex())) {
+        return false;
+      }
+      ++old_field;
+    }
+    auto old_method = old_accessor.GetMethods().begin();
+    for (const ClassAccessor::Method& new_method : new_accessor.GetMethods()) {
+      if (old_method->GetAccessFlags() != new_method.GetAccessFlags() ||
+          !SameMethod(old_method->GetIndex(), new_method.GetIndex()) ||
+          !SameCode(old_method->GetInstructionsAndData(), new_method.GetInstructionsAndData())) {
+        return false;
+      }
+      ++old_method;
+    }
+    return true;
+  }
+
+ private:
+  void AddReferencedType(std::string_view descriptor) {
+    size_t dims = descriptor.find_first_not_of('[');
+    if (dims != std::string_view::npos && descriptor[dims] == 'L') {
+      referenced_types_->insert(descriptor.substr(dims));
+    }
+  }
+
+  bool SameString(dex::StringIndex old_idx, dex::StringIndex new_idx) {
+    return old_dex_file_.GetStringView(old_idx) == new_dex_file_.GetStringView(new_idx);
+  }
+
+  bool SameType(dex::TypeIndex old_idx, dex::TypeIndex new_idx) {
+    std::string_view descriptor = new_dex_file_.GetTypeDescriptorView(new_idx);
+    AddReferencedType(descriptor);
+    return old_dex_file_.GetTypeDescriptorView(old_idx) == descriptor;
+  }
+
+  bool SameOptionalType(dex::TypeIndex old_idx, dex::TypeIndex new_idx) {
+    if (old_idx.IsValid() != new_idx.IsValid()) {
+      return false;
+    }
+    return !new_idx.IsValid() || SameType(old_idx, new_idx);
+  }
+
+  bool SameTypeList(const dex::TypeList* old_list, const dex::TypeList* new_list) {
+    uint32_t old_size = (old_list != nullptr) ? old_list->Size() : 0u;
+    uint32_t new_size = (new_list != nullptr) ? new_list->Size() : 0u;
+    if (old_size != new_size) {
+      return false;
+    }
+    for (uint32_t i = 0; i != new_size; ++i) {
+      if (!SameType(old_list->GetTypeItem(i).type_idx_, new_list->GetTypeItem(i).type_idx_)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool SameProto(const dex::ProtoId& old_proto, const dex::ProtoId& new_proto) {
+    return SameType(old_proto.return_type_idx_, new_proto.return_type_idx_) &&
+           SameTypeList(old_dex_file_.GetProtoParameters(old_proto),
+                        new_dex_file_.GetProtoParameters(new_proto));
+  }
+
+  bool SameField(uint32_t old_idx, uint32_t new_idx) {
+    const dex::FieldId& old_field = old_dex_file_.GetFieldId(old_idx);
+    const dex::FieldId& new_field = new_dex_file_.GetFieldId(new_idx);
+    return SameType(old_field.class_idx_, new_field.class_idx_) &&
+           SameType(old_field.type_idx_, new_field.type_idx_) &&
+           SameString(old_field.name_idx_, new_field.name_idx_);
+  }
+
+  bool SameMethod(uint32_t old_idx, uint32_t new_idx) {
+    const dex::MethodId& old_method = old_dex_file_.GetMethodId(old_idx);
+    const dex::MethodId& new_method = new_dex_file_.GetMethodId(new_idx);
+    return SameType(old_method.class_idx_, new_method.class_idx_) &&
+           SameString(old_method.name_idx_, new_method.name_idx_) &&
+           SameProto(old_dex_file_.GetProtoId(old_method.proto_idx_),
+                     new_dex_file_.GetProtoId(new_method.proto_idx_));
+  }
+
+  bool SameIndex(Instruction::IndexType index_type, uint32_t old_idx, uint32_t new_idx) {
+    switch (index_type) {
+      case Instruction::kIndexTypeRef:
+        return SameType(dex::TypeIndex(old_idx), dex::TypeIndex(new_idx));
+      case Instruction::kIndexStringRef:
+        return SameString(dex::StringIndex(old_idx), dex::StringIndex(new_idx));
+      case Instruction::kIndexFieldRef:
+        return SameField(old_idx, new_idx);
+      case Instruction::kIndexMethodRef:
+      case Instruction::kIndexMethodAndProtoRef:
+        return SameMethod(old_idx, new_idx);
+      case Instruction::kIndexProtoRef:
+        return SameProto(old_dex_file_.GetProtoId(dex::ProtoIndex(old_idx)),
+                         new_dex_file_.GetProtoId(dex::ProtoIndex(new_idx)));
+      default:
+        // Call sites and method handles are not worth the trouble, treat them as changed.
+        return false;
+    }
+  }
+
+  bool SameInstruction(const Instruction& old_inst, const Instruction& new_inst) {
+    if (old_inst.Opcode() != new_inst.Opcode() ||
+        old_inst.SizeInCodeUnits() != new_inst.SizeInCodeUnits()) {
+      return false;
+    }
+    // Code units holding an index are compared through the entity they refer to, all the
+    // other code units (opcode, registers, literals, branch offsets, payloads) must match.
+    size_t first_index_unit = 0u;
+    size_t last_index_unit = 0u;
+    size_t proto_index_unit = 0u;
+    Instruction::IndexType index_type = Instruction::IndexTypeOf(new_inst.Opcode());
+    switch (Instruction::FormatOf(new_inst.Opcode())) {
+      case Instruction::k21c:
+      case Instruction::k35c:
+      case Instruction::k3rc:
+        if (!SameIndex(index_type, old_inst.VRegB(), new_inst.VRegB())) {
+          return false;
+        }
+        first_index_unit = last_index_unit = 1u;
+        break;
+      case Instruction::k22c:
+        if (!SameIndex(index_type, old_inst.VRegC(), new_inst.VRegC())) {
+          return false;
+        }
+        first_index_unit = last_index_unit = 1u;
+        break;
+      case Instruction::k31c:
+        if (!SameIndex(index_type, old_inst.VRegB(), new_inst.VRegB())) {
+          return false;
+        }
+        first_index_unit = 1u;
+        last_index_unit = 2u;
+        break;
+      case Instruction::k45cc:
+      case Instruction::k4rcc:
+        if (!SameIndex(index_type, old_inst.VRegB(), new_inst.VRegB()) ||
+            !SameIndex(Instruction::kIndexProtoRef, old_inst.VRegH(), new_inst.VRegH())) {
+          return false;
+        }
+        first_index_unit = last_index_unit = 1u;
+        proto_index_unit = 3u;
+        break;
+      default:
+        DCHECK(index_type == Instruction::kIndexNone);
+        break;
+    }
+    for (size_t i = 0, size = new_inst.SizeInCodeUnits(); i != size; ++i) {
+      bool is_index_unit =
+          (first_index_unit != 0u && i >= first_index_unit && i <= last_index_unit) ||
+          (proto_index_unit != 0u && i == proto_index_unit);
+      if (!is_index_unit && old_inst.Fetch16(i) != new_inst.Fetch16(i)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool SameCode(const CodeItemDataAccessor& old_code, const CodeItemDataAccessor& new_code) {
+    if (old_code.HasCodeItem() != new_code.HasCodeItem()) {
+      return false;
+    }
+    if (!new_code.HasCodeItem()) {
+      return true;
+    }
+    if (old_code.RegistersSize() != new_code.RegistersSize() ||
+        old_code.InsSize() != new_code.InsSize() ||
+        old_code.OutsSize() != new_code.OutsSize() ||
+        old_code.TriesSize() != new_code.TriesSize() ||
+        old_code.InsnsSizeInCodeUnits() != new_code.InsnsSizeInCodeUnits()) {
+      return false;
+    }
+    const dex::TryItem* old_try = old_code.TryItems().begin();
+    for (const dex::TryItem& new_try : new_code.TryItems()) {
+      if (old_try->start_addr_ != new_try.start_addr_ ||
+          old_try->insn_count_ != new_try.insn_count_) {
+        return false;
+      }
+      CatchHandlerIterator old_handlers(old_code, *old_try);
+      CatchHandlerIterator new_handlers(new_code, new_try);
+      for (; new_handlers.HasNext(); new_handlers.Next(), old_handlers.Next()) {
+        if (!old_handlers.HasNext() ||
+            old_handlers.GetHandlerAddress() != new_handlers.GetHandlerAddress() ||
+            !SameOptionalType(old_handlers.GetHandlerTypeIndex(),
+                              new_handlers.GetHandlerTypeIndex())) {
+          return false;
+        }
+      }
+      if (old_handlers.HasNext()) {
+        return false;
+      }
+      ++old_try;
+    }
+    auto old_inst = old_code.begin();
+    for (const DexInstructionPcPair& new_inst : new_code) {
+      if (old_inst.DexPc() != new_inst.DexPc() ||
+          !SameInstruction(old_inst.Inst(), new_inst.Inst())) {
+        return false;
+      }
+      ++old_inst;
+    }
+    return true;
+  }
+
+  const DexFile& old_dex_file_;
+  const DexFile& new_dex_file_;
+  std::set<std::string_view>* const referenced_types_;
+};
+
+// Maps each descriptor to its class definition. Descriptors defined more than once map to
+// an invalid reference.
+using ClassMap = std::map<std::string_view, ClassReference>;
+
+ClassMap BuildClassMap(const std::vector<const DexFile*>& dex_files) {
+  ClassMap classes;
+  for (const DexFile* dex_file : dex_files) {
+    for (uint32_t i = 0, num_class_defs = dex_file->NumClassDefs(); i != num_class_defs; ++i) {
+      std::string_view descriptor =
+          dex_file->GetTypeDescriptorView(dex_file->GetClassDef(i).class_idx_);
+      auto [it, inserted] = classes.emplace(descriptor, ClassReference(dex_file, i));
+      if (!inserted) {
+        it->second = ClassReference(nullptr, 0u);
+      }
+    }
+  }
+  return classes;
+}
+
+class UnchangedClassFinder {
+ public:
+  UnchangedClassFinder(const std::vector<const DexFile*>& old_dex_files,
+                       const std::vector<const DexFile*>& new_dex_files)
+      : old_classes_(BuildClassMap(old_dex_files)),
+        new_classes_(BuildClassMap(new_dex_files)) {}
+
+  std::vector<UnchangedClass> Find() {
+    std::vector<UnchangedClass> result;
+    for (const auto& [descriptor, new_ref] : new_classes_) {
+      if (!IsStable(descriptor)) {
+        continue;
+      }
+      const ClassInfo& info = infos_.find(descriptor)->second;
+      bool all_references_stable =
+          std::all_of(info.referenced_types.begin(),
+                      info.referenced_types.end(),
+                      [this](std::string_view type) { return IsStable(type); });
+      if (all_references_stable) {
+        result.emplace_back(old_classes_.find(descriptor)->second, new_ref);
+      }
+    }
+    return result;
+  }
+
+ private:
+  enum class State {
+    kInProgress,
+    kStable,
+    kUnstable,
+  };
+
+  struct ClassInfo {
+    State state = State::kInProgress;
+    std::set<std::string_view> referenced_types;
+  };
+
+  // Returns whether `descriptor` is either not defined in the dex files, or has an unchanged
+  // definition and stable superclasses and interfaces.
+  bool IsStable(std::string_view descriptor) {
+    auto info_it = infos_.find(descriptor);
+    if (info_it != infos_.end()) {
+      // A class in progress is part of a hierarchy cycle, which cannot be stable.
+      return info_it->second.state == State::kStable;
+    }
+    auto old_it = old_classes_.find(descriptor);
+    auto new_it = new_classes_.find(descriptor);
+    if (old_it == old_classes_.end() && new_it == new_classes_.end()) {
+      // Defined in the classpath, the verifier dependencies cover it.
+      return true;
+    }
+    ClassInfo& info = infos_[descriptor];
+    if (old_it == old_classes_.end() ||
+        new_it == new_classes_.end() ||
+        old_it->second.dex_file == nullptr ||
+        new_it->second.dex_file == nullptr) {
+      // Added, removed or duplicate class.
+      info.state = State::kUnstable;
+      return false;
+    }
+    const DexFile& old_dex_file = *old_it->second.dex_file;
+    const DexFile& new_dex_file = *new_it->second.dex_file;
+    const dex::ClassDef& old_def = old_dex_file.GetClassDef(old_it->second.ClassDefIdx());
+    const dex::ClassDef& new_def = new_dex_file.GetClassDef(new_it->second.ClassDefIdx());
+    ClassComparator comparator(old_dex_file, new_dex_file, &info.referenced_types);
+    if (!comparator.SameClass(old_def, new_def)) {
+      info.state = State::kUnstable;
+      return false;
+    }
+    // Method and field resolution in this class also depends on its supertypes. Note that
+    // `info` stays valid as std::map does not invalidate references on insertion.
+    bool stable = !new_def.superclass_idx_.IsValid() ||
+                  IsStable(new_dex_file.GetTypeDescriptorView(new_def.superclass_idx_));
+    const dex::TypeList* interfaces = new_dex_file.GetInterfacesList(new_def);
+    if (interfaces != nullptr) {
+      for (uint32_t i = 0; stable && i != interfaces->Size(); ++i) {
+        stable = IsStable(new_dex_file.GetTypeDescriptorView(interfaces->GetTypeItem(i).type_idx_));
+      }
+    }
+    info.state = stable ? State::kStable : State::kUnstable;
+    return stable;
+  }
+
+  const ClassMap old_classes_;
+  const ClassMap new_classes_;
+  std::map<std::string_view, ClassInfo> infos_;
+};
+
+}  // namespace
+
+std::vector<UnchangedClass> FindUnchangedClasses(
+    const std::vector<const DexFile*>& old_dex_files,
+    const std::vector<const DexFile*>& new_dex_files) {
+  return UnchangedClassFinder(old_dex_files, new_dex_files).Find();
+}
+
+}  // namespace art
@@ -0,0 +1,44 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_DEX2OAT_DEX_UNCHANGED_CLASSES_H_
+#define ART_DEX2OAT_DEX_UNCHANGED_CLASSES_H_
+
+#include <utility>
+#include <vector>
+
+#include "dex/class_reference.h"
+
+namespace art {
+
+class DexFile;
+
+// A class of a previous build paired with the class of the current build it maps to.
+using UnchangedClass = std::pair<ClassReference, ClassReference>;
+
+// Finds the classes of `new_dex_files` whose verification outcome cannot differ from the
+// one of the class with the same descriptor in `old_dex_files`. Dex indices are allowed to
+// differ between the two builds; the entities they refer to are compared instead.
+//
+// A class qualifies if its definition is unchanged and every class of the dex files that it
+// references, directly or through the superclasses and interfaces of those classes, is also
+// unchanged. Classes that are defined more than once are never reported.
+std::vector<UnchangedClass> FindUnchangedClasses(const std::vector<const DexFile*>& old_dex_files,
+                                                 const std::vector<const DexFile*>& new_dex_files);
+
+}  // namespace art
+
+#endif  // ART_DEX2OAT_DEX_UNCHANGED_CLASSES_H_
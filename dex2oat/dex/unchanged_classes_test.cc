@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "unchanged_classes.h"
+
+#include <gtest/gtest.h>
+
+#include "base/common_art_test.h"
+#include "base/stl_util.h"
+#include "dex/dex_file.h"
+
+namespace art {
+
+class UnchangedClassesTest : public CommonArtTest {
+ protected:
+  static const char* GetDescriptor(const ClassReference& ref) {
+    return ref.dex_file->GetClassDescriptor(ref.dex_file->GetClassDef(ref.ClassDefIdx()));
+  }
+};
+
+TEST_F(UnchangedClassesTest, SameDexFiles) {
+  std::vector<std::unique_ptr<const DexFile>> old_dex_files = OpenTestDexFiles("MultiDex");
+  std::vector<std::unique_ptr<const DexFile>> new_dex_files = OpenTestDexFiles("MultiDex");
+  ASSERT_EQ(new_dex_files.size(), 2u);
+
+  std::vector<UnchangedClass> unchanged = FindUnchangedClasses(
+      MakeNonOwningPointerVector(old_dex_files), MakeNonOwningPointerVector(new_dex_files));
+  ASSERT_EQ(unchanged.size(), 2u);
+  for (const auto& [old_ref, new_ref] : unchanged) {
+    EXPECT_STREQ(GetDescriptor(old_ref), GetDescriptor(new_ref));
+    EXPECT_NE(old_ref.dex_file, new_ref.dex_file);
+  }
+}
+
+TEST_F(UnchangedClassesTest, ModifiedSecondary) {
+  // `Second` returns a different string literal, and `Main` uses `Second`, so neither
+  // class can reuse its previous verification.
+  std::vector<std::unique_ptr<const DexFile>> old_dex_files = OpenTestDexFiles("MultiDex");
+  std::vector<std::unique_ptr<const DexFile>> new_dex_files =
+      OpenTestDexFiles("MultiDexModifiedSecondary");
+
+  std::vector<UnchangedClass> unchanged = FindUnchangedClasses(
+      MakeNonOwningPointerVector(old_dex_files), MakeNonOwningPointerVector(new_dex_files));
+  EXPECT_TRUE(unchanged.empty());
+}
+
+TEST_F(UnchangedClassesTest, DuplicateClasses) {
+  std::vector<std::unique_ptr<const DexFile>> old_dex_files = OpenTestDexFiles("MultiDex");
+  std::vector<std::unique_ptr<const DexFile>> new_dex_files = OpenTestDexFiles("MultiDex");
+  std::vector<std::unique_ptr<const DexFile>> extra_dex_files = OpenTestDexFiles("MultiDex");
+  std::vector<const DexFile*> new_dex_file_ptrs = MakeNonOwningPointerVector(new_dex_files);
+  // Define `Main` twice in the new build.
+  new_dex_file_ptrs.push_back(extra_dex_files[0].get());
+
+  std::vector<UnchangedClass> unchanged =
+      FindUnchangedClasses(MakeNonOwningPointerVector(old_dex_files), new_dex_file_ptrs);
+  ASSERT_EQ(unchanged.size(), 1u);
+  EXPECT_STREQ(GetDescriptor(unchanged[0].second), "LSecond;");
+}
+
+}  // namespace art
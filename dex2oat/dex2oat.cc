@@ -33,6 +33,7 @@
 
 #if defined(__linux__)
 #include <sched.h>
+#include <sys/resource.h>
 #endif
 
 #include <android-base/parseint.h>
@@ -74,8 +75,10 @@
 #include "dex/dex_file-inl.h"
 #include "dex/dex_file_loader.h"
 #include "dex/quick_compiler_callbacks.h"
+#include "dex/unchanged_classes.h"
 #include "dex/verification_results.h"
 #include "dex2oat_options.h"
+#include "driver/compiled_method_archive.h"
 #include "driver/compiler_driver.h"
 #include "driver/compiler_options.h"
 #include "driver/compiler_options_map-inl.h"
@@ -275,6 +278,18 @@ static void SetCpuAffinity(const std::vector<int32_t>& cpu_list) {
 #endif  // __linux__
 }
 
+// Returns the peak resident set size of this process, or 0 if not known.
+static size_t GetPeakResidentSetSize() {
+#ifdef __linux__
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0) {
+    // Reported in kilobytes.
+    return static_cast<size_t>(usage.ru_maxrss) * KB;
+  }
+#endif  // __linux__
+  return 0u;
+}
+
 
 
 // The primary goal of the watchdog is to prevent stuck build servers
@@ -844,6 +859,24 @@ class Dex2Oat final {
       Usage("--preloaded-classes and --preloaded-classes-fds should not be both specified");
     }
 
+    if (compiler_options_->compile_shard_count_ == 0u) {
+      Usage("--compile-shard-count must be positive");
+    }
+    if (compiler_options_->compile_shard_index_ >= compiler_options_->compile_shard_count_) {
+      Usage("--compile-shard-index must be less than --compile-shard-count");
+    }
+    if (compiler_options_->IsCompileShard() != !compiled_methods_archive_.empty()) {
+      Usage("--compiled-methods-archive must be used with a --compile-shard-count above 1");
+    }
+    if (compiler_options_->IsCompileShard() && !merge_compiled_methods_archives_.empty()) {
+      Usage("--merge-compiled-methods-archive should not be used with --compile-shard-count");
+    }
+    if (compiler_options_->StreamCompiledCode() && compiler_options_->IsMultiImage()) {
+      // Deduplicated code can be shared by several oat files, so it cannot be freed
+      // when the first of them is written.
+      Usage("--stream-compiled-code is not supported with --multi-image");
+    }
+
     if (!cpu_set_.empty()) {
       SetCpuAffinity(cpu_set_);
     }
@@ -1084,6 +1117,7 @@ class Dex2Oat final {
     AssignIfExists(args, M::OutputVdexFd, &output_vdex_fd_);
     AssignIfExists(args, M::InputVdex, &input_vdex_);
     AssignIfExists(args, M::OutputVdex, &output_vdex_);
+    AssignTrueIfExists(args, M::ReuseStaleInputVdex, &reuse_stale_input_vdex_);
     AssignIfExists(args, M::DmFd, &dm_fd_);
     AssignIfExists(args, M::DmFile, &dm_file_location_);
     AssignIfExists(args, M::OatFd, &oat_fd_);
@@ -1108,6 +1142,10 @@ class Dex2Oat final {
     AssignIfExists(args, M::AppImageFile, &app_image_file_name_);
     AssignIfExists(args, M::AppImageFileFd, &app_image_fd_);
     AssignIfExists(args, M::NoInlineFrom, &no_inline_from_string_);
+    AssignIfExists(args, M::CompileShardIndex, &compiler_options_->compile_shard_index_);
+    AssignIfExists(args, M::CompileShardCount, &compiler_options_->compile_shard_count_);
+    AssignIfExists(args, M::CompiledMethodsArchive, &compiled_methods_archive_);
+    AssignIfExists(args, M::MergeCompiledMethodsArchive, &merge_compiled_methods_archives_);
     AssignIfExists(args, M::ClasspathDir, &classpath_dir_);
     AssignIfExists(args, M::DirtyImageObjects, &dirty_image_objects_filenames_);
     AssignIfExists(args, M::DirtyImageObjectsFd, &dirty_image_objects_fds_);
@@ -1386,6 +1424,17 @@ class Dex2Oat final {
       }
     }
 
+    // A stale input vdex comes from a previous build of the dex files: neither its dex section
+    // nor its verification results can be used as is. Keep it aside so that we only reuse the
+    // verification of unchanged classes, see ImportStaleVerifierDeps().
+    if (reuse_stale_input_vdex_ && input_vdex_file_ != nullptr) {
+      if (use_existing_vdex_) {
+        LOG(ERROR) << "A stale input vdex cannot also be the output vdex";
+        return false;
+      }
+      stale_input_vdex_file_ = std::move(input_vdex_file_);
+    }
+
     // Swap file handling
     //
     // If the swap fd is not -1, we assume this is the file descriptor of an open but unlinked file
@@ -1754,11 +1803,44 @@ class Dex2Oat final {
       // Create the main VerifierDeps, here instead of in the compiler since we want to aggregate
       // the results for all the dex files, not just the results for the current dex file.
       callbacks_->SetVerifierDeps(new verifier::VerifierDeps(dex_files));
+      ImportStaleVerifierDeps(dex_files);
     }
 
     return dex2oat::ReturnCode::kNoFailure;
   }
 
+  // Record the classes that did not change since the build which produced the stale input vdex
+  // as verified, with the dependencies that build recorded for them. The compiler driver
+  // validates these dependencies and only verifies the other classes. If anything goes wrong
+  // here, all classes are verified.
+  void ImportStaleVerifierDeps(const std::vector<const DexFile*>& dex_files) {
+    if (stale_input_vdex_file_ == nullptr) {
+      return;
+    }
+    TimingLogger::ScopedTiming t("Import Stale Verifier Deps", timings_);
+    if (!stale_input_vdex_file_->HasDexSection()) {
+      LOG(WARNING) << "Stale input vdex has no dex files, cannot reuse its verifier deps";
+      return;
+    }
+    std::string error_msg;
+    std::vector<std::unique_ptr<const DexFile>> old_dex_files;
+    if (!stale_input_vdex_file_->OpenAllDexFiles(&old_dex_files, &error_msg)) {
+      LOG(WARNING) << "Failed to open dex files of stale input vdex: " << error_msg;
+      return;
+    }
+    std::vector<const DexFile*> old_dex_file_ptrs = MakeNonOwningPointerVector(old_dex_files);
+    std::vector<UnchangedClass> unchanged_classes =
+        FindUnchangedClasses(old_dex_file_ptrs, dex_files);
+    if (!callbacks_->GetVerifierDeps()->ImportClasses(old_dex_file_ptrs,
+                                                      stale_input_vdex_file_->GetVerifierDepsData(),
+                                                      unchanged_classes)) {
+      LOG(WARNING) << "Failed to parse verifier deps of stale input vdex";
+      return;
+    }
+    VLOG(compiler) << "Reusing verification of " << unchanged_classes.size()
+                   << " unchanged classes from stale input vdex";
+  }
+
   // Validates that the input vdex checksums match the source dex checksums.
   // Note that this is only effective and relevant if the input_vdex_file does not
   // contain a dex section (e.g. when they come from .dm files).
@@ -1994,11 +2076,81 @@ class Dex2Oat final {
                         dex_files,
                         timings_,
                         &compiler_options_->image_classes_);
+    MergeCompiledMethodsArchives(dex_files);
     driver_->CompileAll(class_loader, dex_files, timings_);
     driver_->FreeThreadPools();
     return class_loader;
   }
 
+  // Add the code compiled by the shards of a sharded compilation. Methods that no archive
+  // provides are compiled by CompileAll() as usual.
+  void MergeCompiledMethodsArchives(const std::vector<const DexFile*>& dex_files) {
+    if (merge_compiled_methods_archives_.empty()) {
+      return;
+    }
+    TimingLogger::ScopedTiming t("Merge compiled methods", timings_);
+    std::vector<const DexFile*> referenced_dex_files =
+        Runtime::Current()->GetClassLinker()->GetBootClassPath();
+    if (!IsBootImage() && !IsBootImageExtension()) {
+      std::vector<const DexFile*> class_path_files = class_loader_context_->FlattenOpenedDexFiles();
+      referenced_dex_files.insert(
+          referenced_dex_files.end(), class_path_files.begin(), class_path_files.end());
+    }
+    for (const std::string& archive : merge_compiled_methods_archives_) {
+      std::unique_ptr<File> file(OS::OpenFileForReading(archive.c_str()));
+      if (file == nullptr) {
+        PLOG(WARNING) << "Failed to open compiled methods archive " << archive;
+        continue;
+      }
+      std::string error_msg;
+      size_t num_methods = 0u;
+      if (!CompiledMethodArchive::Read(file.get(),
+                                       dex_files,
+                                       GetEncodedClassLoaderContext(),
+                                       referenced_dex_files,
+                                       driver_.get(),
+                                       &num_methods,
+                                       &error_msg)) {
+        LOG(WARNING) << error_msg;
+        continue;
+      }
+      VLOG(compiler) << "Merged " << num_methods << " methods from " << archive;
+    }
+  }
+
+  // The class loader context that the code of a sharded compilation depends on, including the
+  // checksums of its dex files. Empty for the boot image and boot image extensions.
+  std::string GetEncodedClassLoaderContext() const {
+    return (class_loader_context_ != nullptr)
+        ? class_loader_context_->EncodeContextForOatFile(classpath_dir_)
+        : std::string();
+  }
+
+  // Write the code compiled by this shard of a sharded compilation.
+  bool WriteCompiledMethodsArchive() {
+    TimingLogger::ScopedTiming t("Write compiled methods", timings_);
+    std::unique_ptr<File> file(OS::CreateEmptyFile(compiled_methods_archive_.c_str()));
+    if (file == nullptr) {
+      PLOG(ERROR) << "Failed to create compiled methods archive " << compiled_methods_archive_;
+      return false;
+    }
+    std::string error_msg;
+    if (!CompiledMethodArchive::Write(*driver_,
+                                      compiler_options_->GetDexFilesForOatFile(),
+                                      GetEncodedClassLoaderContext(),
+                                      file.get(),
+                                      &error_msg)) {
+      LOG(ERROR) << error_msg;
+      file->Erase();
+      return false;
+    }
+    if (file->FlushCloseOrErase() != 0) {
+      PLOG(ERROR) << "Failed to flush compiled methods archive " << compiled_methods_archive_;
+      return false;
+    }
+    return true;
+  }
+
   // Notes on the interleaving of creating the images and oat files to
   // ensure the references between the two are correct.
   //
@@ -2332,6 +2484,10 @@ class Dex2Oat final {
     if (compiler_options_->GetDumpTimings() ||
         (kIsDebugBuild && timings_->GetTotalNs() > MsToNs(1000))) {
       LOG(INFO) << Dumpable<TimingLogger>(*timings_);
+      const size_t peak_rss = GetPeakResidentSetSize();
+      if (peak_rss != 0u) {
+        LOG(INFO) << "Peak RSS: " << PrettySize(peak_rss);
+      }
     }
   }
 
@@ -2351,6 +2507,10 @@ class Dex2Oat final {
     return compiler_options_->IsBootImageExtension();
   }
 
+  bool IsCompileShard() const {
+    return compiler_options_->IsCompileShard();
+  }
+
   bool IsHost() const {
     return is_host_;
   }
@@ -2660,7 +2820,8 @@ class Dex2Oat final {
     elf_writers_.reserve(oat_files_.size());
     oat_writers_.reserve(oat_files_.size());
     for (const std::unique_ptr<File>& oat_file : oat_files_) {
-      elf_writers_.emplace_back(linker::CreateElfWriterQuick(*compiler_options_, oat_file.get()));
+      elf_writers_.emplace_back(
+          linker::CreateElfWriterQuick(*compiler_options_, oat_file.get(), thread_count_));
       elf_writers_.back()->Start();
       bool do_oat_writer_layout = DoOatLayoutOptimizations();
       oat_writers_.emplace_back(new linker::OatWriter(
@@ -3017,6 +3178,14 @@ class Dex2Oat final {
   // Whether the given input vdex is also the output.
   bool use_existing_vdex_ = false;
 
+  // Where a compilation shard writes its code, and the archives of the shards to merge.
+  std::string compiled_methods_archive_;
+  std::vector<std::string> merge_compiled_methods_archives_;
+
+  // Whether the given input vdex comes from a previous build of different dex files.
+  bool reuse_stale_input_vdex_ = false;
+  std::unique_ptr<VdexFile> stale_input_vdex_file_;
+
   // By default, copy the dex to the vdex file only if dex files are
   // compressed in APK.
   linker::CopyOption copy_dex_files_ = linker::CopyOption::kOnlyIfCompressed;
@@ -3065,6 +3234,17 @@ static dex2oat::ReturnCode DoCompilation(Dex2Oat& dex2oat) REQUIRES(!Locks::muta
   // process.
   ScopedGlobalRef global_ref(class_loader);
 
+  // A compilation shard only produces its part of the code, the oat file is linked by a
+  // separate invocation merging all shards.
+  if (dex2oat.IsCompileShard()) {
+    dex2oat.EraseOutputFiles();
+    if (!dex2oat.WriteCompiledMethodsArchive()) {
+      return dex2oat::ReturnCode::kOther;
+    }
+    dex2oat.DumpTiming();
+    return dex2oat::ReturnCode::kNoFailure;
+  }
+
   if (!dex2oat.WriteOutputFiles(class_loader)) {
     dex2oat.EraseOutputFiles();
     return dex2oat::ReturnCode::kOther;
@@ -702,4 +702,33 @@ TEST_F(Dex2oatImageTest, TestExtension) {
   }
 }
 
+TEST_F(Dex2oatImageTest, ParallelClassInitializationDeterminism) {
+  // Classes without class initializer are initialized on all threads before the single-threaded
+  // pass that runs the class initializers. Check that the image does not depend on that.
+  TEST_DISABLED_FOR_RISCV64();
+
+  ScratchDir scratch;
+  // Compile only core-oj and core-libart to keep the test short.
+  std::vector<std::string> libcore_dex_files = GetLibCoreDexFileNames();
+  ArrayRef<const std::string> dex_files =
+      ArrayRef<const std::string>(libcore_dex_files).SubArray(/*pos=*/ 0u, /*length=*/ 2u);
+  std::vector<std::string> prefixes;
+  for (const char* threads : {"-j1", "-j4"}) {
+    std::string filename_prefix = scratch.GetPath() + "boot" + (threads + 1);
+    std::vector<std::string> extra_args = {
+        threads,
+        "--force-determinism",
+        "--avoid-storing-invocation",
+        android::base::StringPrintf("--base=0x%08x", kBaseAddress),
+    };
+    std::string error_msg;
+    ASSERT_TRUE(CompileBootImage(extra_args, filename_prefix, dex_files, &error_msg))
+        << error_msg;
+    prefixes.push_back(filename_prefix);
+  }
+  for (const char* extension : {".art", ".oat", ".vdex"}) {
+    EXPECT_TRUE(CompareFiles(prefixes[0] + extension, prefixes[1] + extension)) << extension;
+  }
+}
+
 }  // namespace art
@@ -117,6 +117,11 @@ static void AddGeneratedArtifactMappings(Builder& builder) {
           .WithType<std::string>()
           .WithHelp("specifies the vdex input source via a filename.")
           .IntoKey(M::InputVdex)
+      .Define("--reuse-stale-input-vdex")
+          .WithHelp("the input vdex comes from a previous build of possibly different dex files.\n"
+                    "Its dex files are not used, but the verification results of the classes\n"
+                    "that did not change are reused.")
+          .IntoKey(M::ReuseStaleInputVdex)
       .Define("--output-vdex-fd=_")
           .WithHelp("specifies the vdex output destination via a file descriptor.")
           .WithType<int>()
@@ -272,7 +277,27 @@ static void AddCompilerMappings(Builder& builder) {
       .Define("--preloaded-classes-fds=_")
           .WithType<std::vector<int>>().AppendValues()
           .WithHelp("Specify files containing list of classes preloaded in the zygote.")
-          .IntoKey(M::PreloadedClassesFds);
+          .IntoKey(M::PreloadedClassesFds)
+      .Define("--compile-shard-index=_")
+          .WithType<unsigned int>()
+          .WithHelp("Compile only the classes whose class def index modulo the shard count is\n"
+                    "equal to this index. Requires --compiled-methods-archive.")
+          .IntoKey(M::CompileShardIndex)
+      .Define("--compile-shard-count=_")
+          .WithType<unsigned int>()
+          .WithHelp("Split the compilation of the dex files into this many shards.")
+          .IntoKey(M::CompileShardCount)
+      .Define("--compiled-methods-archive=_")
+          .WithType<std::string>()
+          .WithHelp("Write the code compiled by this shard to the given file instead of writing\n"
+                    "the oat and vdex files.")
+          .IntoKey(M::CompiledMethodsArchive)
+      .Define("--merge-compiled-methods-archive=_")
+          .WithType<std::vector<std::string>>().AppendValues()
+          .WithHelp("Use the code of an archive written by a compilation shard instead of\n"
+                    "compiling its methods again. Methods missing from all archives, or from\n"
+                    "archives that do not match the inputs, are compiled as usual.")
+          .IntoKey(M::MergeCompiledMethodsArchive);
   // clang-format on
 }
 
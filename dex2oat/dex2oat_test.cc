@@ -21,6 +21,7 @@
 #include <iterator>
 #include <optional>
 #include <regex>
+#include <set>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -1245,6 +1246,102 @@ TEST_F(Dex2oatDeterminism, UnloadCompile) {
       << unload_vdex_name << " " << no_unload_vdex_name;
 }
 
+TEST_F(Dex2oatDeterminism, ShardedCompile) {
+  std::string dex_location = GetTestDexFileName("MyClassNatives");
+  std::string out_dir = GetScratchDir();
+  const std::string oat_name = out_dir + "/base.oat";
+  const std::string vdex_name = out_dir + "/base.vdex";
+  const std::string monolithic_oat_name = out_dir + "/monolithic.oat";
+  const std::string monolithic_vdex_name = out_dir + "/monolithic.vdex";
+  const std::vector<std::string> common_args = {"--force-determinism",
+                                                "--avoid-storing-invocation"};
+  auto with_args = [&](std::initializer_list<std::string> args) {
+    std::vector<std::string> result = common_args;
+    result.insert(result.end(), args);
+    return result;
+  };
+  auto expect_same_as_monolithic = [&]() {
+    std::unique_ptr<File> monolithic_oat(OS::OpenFileForReading(monolithic_oat_name.c_str()));
+    std::unique_ptr<File> monolithic_vdex(OS::OpenFileForReading(monolithic_vdex_name.c_str()));
+    std::unique_ptr<File> oat(OS::OpenFileForReading(oat_name.c_str()));
+    std::unique_ptr<File> vdex(OS::OpenFileForReading(vdex_name.c_str()));
+    ASSERT_TRUE(monolithic_oat != nullptr);
+    ASSERT_TRUE(monolithic_vdex != nullptr);
+    ASSERT_TRUE(oat != nullptr);
+    ASSERT_TRUE(vdex != nullptr);
+    EXPECT_EQ(monolithic_oat->Compare(oat.get()), 0) << monolithic_oat_name << " " << oat_name;
+    EXPECT_EQ(monolithic_vdex->Compare(vdex.get()), 0) << monolithic_vdex_name << " " << vdex_name;
+  };
+
+  ASSERT_THAT(GenerateOdexForTestWithStatus(
+                  {dex_location}, oat_name, CompilerFilter::Filter::kSpeed, common_args),
+              HasValue(0));
+  Copy(oat_name, monolithic_oat_name);
+  Copy(vdex_name, monolithic_vdex_name);
+
+  // Compile each half of the classes separately, then link the two halves.
+  constexpr size_t kNumShards = 2u;
+  std::vector<std::string> merge_args = common_args;
+  for (size_t i = 0; i != kNumShards; ++i) {
+    std::string archive = out_dir + "/shard" + std::to_string(i) + ".cma";
+    ASSERT_THAT(GenerateOdexForTestWithStatus(
+                    {dex_location},
+                    oat_name,
+                    CompilerFilter::Filter::kSpeed,
+                    with_args({"--compile-shard-count=" + std::to_string(kNumShards),
+                               "--compile-shard-index=" + std::to_string(i),
+                               "--compiled-methods-archive=" + archive})),
+                HasValue(0));
+    merge_args.push_back("--merge-compiled-methods-archive=" + archive);
+  }
+  ASSERT_THAT(GenerateOdexForTestWithStatus(
+                  {dex_location}, oat_name, CompilerFilter::Filter::kSpeed, merge_args),
+              HasValue(0));
+  expect_same_as_monolithic();
+
+  // Archives compiled for a debuggable app are rejected, and their methods compiled again.
+  merge_args = common_args;
+  for (size_t i = 0; i != kNumShards; ++i) {
+    std::string archive = out_dir + "/debuggable_shard" + std::to_string(i) + ".cma";
+    ASSERT_THAT(GenerateOdexForTestWithStatus(
+                    {dex_location},
+                    oat_name,
+                    CompilerFilter::Filter::kSpeed,
+                    with_args({"--debuggable",
+                               "--compile-shard-count=" + std::to_string(kNumShards),
+                               "--compile-shard-index=" + std::to_string(i),
+                               "--compiled-methods-archive=" + archive})),
+                HasValue(0));
+    merge_args.push_back("--merge-compiled-methods-archive=" + archive);
+  }
+  ASSERT_THAT(GenerateOdexForTestWithStatus(
+                  {dex_location}, oat_name, CompilerFilter::Filter::kSpeed, merge_args),
+              HasValue(0));
+  EXPECT_NE(output_.find("has a different debuggable"), std::string::npos) << output_;
+  expect_same_as_monolithic();
+
+  // So are archives compiled with debug info.
+  merge_args = common_args;
+  for (size_t i = 0; i != kNumShards; ++i) {
+    std::string archive = out_dir + "/debug_info_shard" + std::to_string(i) + ".cma";
+    ASSERT_THAT(GenerateOdexForTestWithStatus(
+                    {dex_location},
+                    oat_name,
+                    CompilerFilter::Filter::kSpeed,
+                    with_args({"--generate-debug-info",
+                               "--compile-shard-count=" + std::to_string(kNumShards),
+                               "--compile-shard-index=" + std::to_string(i),
+                               "--compiled-methods-archive=" + archive})),
+                HasValue(0));
+    merge_args.push_back("--merge-compiled-methods-archive=" + archive);
+  }
+  ASSERT_THAT(GenerateOdexForTestWithStatus(
+                  {dex_location}, oat_name, CompilerFilter::Filter::kSpeed, merge_args),
+              HasValue(0));
+  EXPECT_NE(output_.find("has a different debug info"), std::string::npos) << output_;
+  expect_same_as_monolithic();
+}
+
 class Dex2oatVerifierAbort : public Dex2oatTest {};
 
 TEST_F(Dex2oatVerifierAbort, HardFail) {
@@ -1297,6 +1394,97 @@ TEST_F(Dex2oatDedupeCode, DedupeTest) {
   EXPECT_LT(dedupe_size, no_dedupe_size);
 }
 
+TEST_F(Dex2oatDedupeCode, StreamCompiledCode) {
+  // Freeing the code as it is written must not change the oat file, with or without
+  // deduplicated code.
+  std::unique_ptr<const DexFile> dex(OpenTestDexFile("MyClassNatives"));
+  std::string out_dir = GetScratchDir();
+  const std::string base_oat_name = out_dir + "/base.oat";
+  auto get_code = [](const OatFile& o) {
+    const uint8_t* text_begin = o.Begin() + o.GetOatHeader().GetExecutableOffset();
+    return std::vector<uint8_t>(text_begin, o.End());
+  };
+  for (const char* dedupe_arg : {"--deduplicate-code=true", "--deduplicate-code=false"}) {
+    std::vector<uint8_t> code;
+    ASSERT_TRUE(GenerateOdexForTest(dex->GetLocation(),
+                                    base_oat_name,
+                                    CompilerFilter::Filter::kSpeed,
+                                    {dedupe_arg},
+                                    /*expect_status=*/Status::kSuccess,
+                                    /*use_fd=*/false,
+                                    /*use_zip_fd=*/false,
+                                    [&](const OatFile& o) { code = get_code(o); }));
+    ASSERT_FALSE(code.empty());
+
+    std::vector<uint8_t> stream_code;
+    ASSERT_TRUE(GenerateOdexForTest(dex->GetLocation(),
+                                    base_oat_name,
+                                    CompilerFilter::Filter::kSpeed,
+                                    {dedupe_arg, "--stream-compiled-code"},
+                                    /*expect_status=*/Status::kSuccess,
+                                    /*use_fd=*/false,
+                                    /*use_zip_fd=*/false,
+                                    [&](const OatFile& o) { stream_code = get_code(o); }));
+
+    EXPECT_TRUE(code == stream_code) << dedupe_arg;
+  }
+}
+
+TEST_F(Dex2oatDedupeCode, StreamSharedCode) {
+  // The methods of SharedCode compile to the same code with patches for different strings.
+  // Their code is shared in the CompiledMethodStorage but written once for each method, so it
+  // must not be freed before the last of them has been written.
+  std::unique_ptr<const DexFile> dex(OpenTestDexFile("SharedCode"));
+  ASSERT_EQ(dex->NumClassDefs(), 1u);
+  std::string out_dir = GetScratchDir();
+  const std::string base_oat_name = out_dir + "/base.oat";
+  auto get_code = [](const OatFile& o) {
+    const uint8_t* text_begin = o.Begin() + o.GetOatHeader().GetExecutableOffset();
+    return std::vector<uint8_t>(text_begin, o.End());
+  };
+  auto get_code_offsets = [&](const OatFile& o) {
+    std::set<uint32_t> code_offsets;
+    const OatFile::OatClass oat_class = o.GetOatDexFiles()[0]->GetOatClass(/*class_def_index=*/ 0);
+    ClassAccessor accessor(*dex, /*class_def_index=*/ 0);
+    uint32_t method_index = 0u;
+    for (const ClassAccessor::Method& method : accessor.GetMethods()) {
+      if (dex->GetMethodName(method.GetIndex()) != std::string_view("<init>")) {
+        code_offsets.insert(oat_class.GetOatMethod(method_index).GetCodeOffset());
+      }
+      ++method_index;
+    }
+    return code_offsets;
+  };
+
+  std::vector<uint8_t> code;
+  std::set<uint32_t> code_offsets;
+  ASSERT_TRUE(GenerateOdexForTest(dex->GetLocation(),
+                                  base_oat_name,
+                                  CompilerFilter::Filter::kSpeed,
+                                  {"--deduplicate-code=true"},
+                                  /*expect_status=*/Status::kSuccess,
+                                  /*use_fd=*/false,
+                                  /*use_zip_fd=*/false,
+                                  [&](const OatFile& o) {
+                                    code = get_code(o);
+                                    code_offsets = get_code_offsets(o);
+                                  }));
+  // Each of the three methods has its own code.
+  EXPECT_EQ(code_offsets.size(), 3u);
+  EXPECT_EQ(code_offsets.count(0u), 0u);
+
+  std::vector<uint8_t> stream_code;
+  ASSERT_TRUE(GenerateOdexForTest(dex->GetLocation(),
+                                  base_oat_name,
+                                  CompilerFilter::Filter::kSpeed,
+                                  {"--deduplicate-code=true", "--stream-compiled-code"},
+                                  /*expect_status=*/Status::kSuccess,
+                                  /*use_fd=*/false,
+                                  /*use_zip_fd=*/false,
+                                  [&](const OatFile& o) { stream_code = get_code(o); }));
+  EXPECT_TRUE(code == stream_code);
+}
+
 TEST_F(Dex2oatTest, UncompressedTest) {
   std::unique_ptr<const DexFile> dex(OpenTestDexFile("MainUncompressedAligned"));
   std::string out_dir = GetScratchDir();
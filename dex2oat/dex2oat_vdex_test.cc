@@ -277,4 +277,40 @@ TEST_F(Dex2oatVdexTest, VerifyInputDmWithMismatchedChecksums) {
       << output_;
 }
 
+// Check that the verification of unchanged classes is reused from the vdex of a previous
+// build, and that the changed classes are verified again.
+TEST_F(Dex2oatVdexTest, ReuseStaleInputVdex) {
+  std::unique_ptr<const DexFile> old_dex_file(OpenTestDexFile("StaleVdex"));
+  std::unique_ptr<const DexFile> new_dex_file(OpenTestDexFile("StaleVdexModified"));
+
+  // The stale vdex needs the dex files of the previous build to compare the classes.
+  ASSERT_THAT(RunDex2oat(old_dex_file->GetLocation(),
+                         GetOdex(old_dex_file),
+                         /*public_sdk=*/nullptr,
+                         /*copy_dex_files=*/true,
+                         {"--copy-dex-files=always"}),
+              HasValue(true))
+      << output_;
+
+  std::vector<std::string> extra_args;
+  extra_args.push_back("--input-vdex=" + GetVdex(old_dex_file));
+  extra_args.push_back("--reuse-stale-input-vdex");
+  ASSERT_THAT(RunDex2oat(new_dex_file->GetLocation(),
+                         GetOdex(new_dex_file),
+                         /*public_sdk=*/nullptr,
+                         /*copy_dex_files=*/false,
+                         extra_args),
+              HasValue(true))
+      << output_;
+  // Only `Unchanged` is reused, `Changed` returns a different string.
+  EXPECT_NE(output_.find("Reusing verification of 1 unchanged classes from stale input vdex"),
+            std::string::npos)
+      << output_;
+
+  std::unique_ptr<VerifierDeps> deps =
+      OR_ASSERT_FAIL(GetVerifierDeps(GetVdex(new_dex_file), new_dex_file.get()));
+  ASSERT_TRUE(HasVerifiedClass(deps, "LUnchanged;", *new_dex_file));
+  ASSERT_TRUE(HasVerifiedClass(deps, "LChanged;", *new_dex_file));
+}
+
 }  // namespace art
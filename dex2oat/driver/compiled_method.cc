@@ -33,6 +33,14 @@ CompiledCode::~CompiledCode() {
   GetStorage()->ReleaseCode(quick_code_);
 }
 
+void CompiledCode::ReleaseWrittenQuickCode(bool is_last_user) {
+  DCHECK(quick_code_ != nullptr);
+  if (is_last_user) {
+    GetStorage()->ReleaseWrittenCode(quick_code_);
+  }
+  quick_code_ = nullptr;
+}
+
 bool CompiledCode::operator==(const CompiledCode& rhs) const {
   if (quick_code_ != nullptr) {
     if (rhs.quick_code_ == nullptr) {
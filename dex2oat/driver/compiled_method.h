@@ -50,6 +50,12 @@ class CompiledCode {
 
   ArrayRef<const uint8_t> GetQuickCode() const;
 
+  // Drops the reference to the code once it has been written to the oat file, see
+  // CompilerOptions::StreamCompiledCode(). The code itself is freed only if `is_last_user`,
+  // even if it was deduplicated, so the caller must know that no other compiled method
+  // referencing the same code remains.
+  void ReleaseWrittenQuickCode(bool is_last_user);
+
   bool operator==(const CompiledCode& rhs) const;
 
   // To align an offset from a page-aligned value to make it suitable
@@ -92,7 +98,7 @@ class CompiledCode {
   CompiledMethodStorage* const storage_;
 
   // Used to store the compiled code.
-  const LengthPrefixedArray<uint8_t>* const quick_code_;
+  const LengthPrefixedArray<uint8_t>* quick_code_;
 
   uint32_t packed_fields_;
 };
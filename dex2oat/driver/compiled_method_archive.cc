@@ -0,0 +1,561 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "compiled_method_archive.h"
+
+#include <errno.h>
+#include <string.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <map>
+#include <utility>
+
+#include <android-base/logging.h>
+#include <android-base/stringprintf.h>
+
+#include "arch/instruction_set.h"
+#include "arch/instruction_set_features.h"
+#include "base/array_ref.h"
+#include "base/casts.h"
+#include "base/compiler_filter.h"
+#include "base/leb128.h"
+#include "class_linker.h"
+#include "compiled_method.h"
+#include "compiler_driver.h"
+#include "dex/dex_file.h"
+#include "dex/method_reference.h"
+#include "driver/compiler_options.h"
+#include "gc/heap.h"
+#include "gc/space/image_space.h"
+#include "linker/linker_patch.h"
+#include "oat/oat.h"
+#include "profile/profile_compilation_info.h"
+#include "runtime.h"
+
+namespace art {
+
+using android::base::StringPrintf;
+using linker::LinkerPatch;
+
+namespace {
+
+// Archive layout, all integers being unsigned LEB128:
+//   magic, version, instruction set, configuration count, { value length, value }*,
+//   dex file count, { location length, location, location checksum }*,
+//   method count, { dex file, method index, intrinsic flag, code, vmap table, CFI, patches }*.
+// Byte arrays are prefixed with their size, and patches with their count.
+constexpr uint8_t kArchiveMagic[] = { 'c', 'm', 'a', '\n' };
+constexpr uint8_t kArchiveVersion[] = { '0', '0', '3', '\0' };
+
+// Returns a short digest of `data` for configuration values that are too big to be stored.
+std::string Digest(std::string_view data) {
+  uLong checksum = adler32(0L, Z_NULL, 0);
+  checksum = adler32(checksum, reinterpret_cast<const Bytef*>(data.data()), data.size());
+  return StringPrintf("%zu:%08lx", data.size(), checksum);
+}
+
+// Returns the image kind and the image classes, which decide what code is compiled for
+// classes that end up in the image.
+std::string GetImageConfiguration(const CompilerOptions& compiler_options) {
+  if (!compiler_options.IsGeneratingImage()) {
+    return "none";
+  }
+  std::string kind = compiler_options.IsBootImage() ? "boot-image" :
+                     compiler_options.IsBootImageExtension() ? "boot-image-extension" :
+                     "app-image";
+  std::vector<std::string_view> image_classes(compiler_options.GetImageClasses().begin(),
+                                              compiler_options.GetImageClasses().end());
+  std::sort(image_classes.begin(), image_classes.end());
+  std::string descriptors;
+  for (std::string_view descriptor : image_classes) {
+    descriptors.append(descriptor);
+    descriptors.push_back('\n');
+  }
+  return kind + " " + Digest(descriptors);
+}
+
+// Returns a digest of the profile, which guides inlining and what is compiled.
+std::string GetProfileConfiguration(const CompilerOptions& compiler_options) {
+  const ProfileCompilationInfo* profile = compiler_options.GetProfileCompilationInfo();
+  if (profile == nullptr) {
+    return "none";
+  }
+  return Digest(profile->DumpInfo(/*dex_files=*/ {}, /*print_full_dex_location=*/ true));
+}
+
+// Returns the configuration that the compiled code depends on besides the instruction set and
+// the dex files, as pairs of a name used in error messages and a value that must be equal in
+// the shards and in the merging invocation.
+std::vector<std::pair<const char*, std::string>> GetConfiguration(
+    const CompilerOptions& compiler_options, const std::string& class_loader_context) {
+  Runtime* runtime = Runtime::Current();
+  ArrayRef<gc::space::ImageSpace* const> image_spaces(runtime->GetHeap()->GetBootImageSpaces());
+  ArrayRef<const DexFile* const> boot_class_path(runtime->GetClassLinker()->GetBootClassPath());
+  return {
+      {"instruction set features",
+       compiler_options.GetInstructionSetFeatures()->GetFeatureString()},
+      {OatHeader::kBootClassPathChecksumsKey,
+       gc::space::ImageSpace::GetBootClassPathChecksums(image_spaces, boot_class_path)},
+      {OatHeader::kClassPathKey, class_loader_context},
+      {OatHeader::kCompilerFilter,
+       CompilerFilter::NameOfFilter(compiler_options.GetCompilerFilter())},
+      {OatHeader::kDebuggableKey,
+       compiler_options.GetDebuggable() ? OatHeader::kTrueValue : OatHeader::kFalseValue},
+      {"debug info",
+       StringPrintf("%s %s",
+                    compiler_options.GetGenerateDebugInfo() ? "full" : "none",
+                    compiler_options.GetGenerateMiniDebugInfo() ? "mini" : "none")},
+      {"image configuration", GetImageConfiguration(compiler_options)},
+      {"profile", GetProfileConfiguration(compiler_options)},
+  };
+}
+
+// Assigns indexes to the dex files referenced by the written methods, in the order they are
+// first seen so that the archive does not depend on pointer values.
+class DexFileTable {
+ public:
+  uint32_t GetIndex(const DexFile* dex_file) {
+    auto it = indexes_.find(dex_file);
+    if (it != indexes_.end()) {
+      return it->second;
+    }
+    uint32_t index = dchecked_integral_cast<uint32_t>(dex_files_.size());
+    indexes_.emplace(dex_file, index);
+    dex_files_.push_back(dex_file);
+    return index;
+  }
+
+  const std::vector<const DexFile*>& GetDexFiles() const {
+    return dex_files_;
+  }
+
+ private:
+  std::map<const DexFile*, uint32_t> indexes_;
+  std::vector<const DexFile*> dex_files_;
+};
+
+void EncodeBytes(std::vector<uint8_t>* out, ArrayRef<const uint8_t> data) {
+  EncodeUnsignedLeb128(out, data.size());
+  out->insert(out->end(), data.begin(), data.end());
+}
+
+void EncodeString(std::vector<uint8_t>* out, std::string_view str) {
+  EncodeBytes(out, ArrayRef<const uint8_t>(reinterpret_cast<const uint8_t*>(str.data()),
+                                           str.size()));
+}
+
+void EncodePatch(std::vector<uint8_t>* out, DexFileTable* table, const LinkerPatch& patch) {
+  EncodeUnsignedLeb128(out, static_cast<uint8_t>(patch.GetType()));
+  EncodeUnsignedLeb128(out, patch.LiteralOffset());
+  switch (patch.GetType()) {
+    case LinkerPatch::Type::kIntrinsicReference:
+      EncodeUnsignedLeb128(out, patch.PcInsnOffset());
+      EncodeUnsignedLeb128(out, patch.IntrinsicData());
+      break;
+    case LinkerPatch::Type::kBootImageRelRo:
+      EncodeUnsignedLeb128(out, patch.PcInsnOffset());
+      EncodeUnsignedLeb128(out, patch.BootImageOffset());
+      break;
+    case LinkerPatch::Type::kMethodRelative:
+    case LinkerPatch::Type::kMethodAppImageRelRo:
+    case LinkerPatch::Type::kMethodBssEntry:
+    case LinkerPatch::Type::kJniEntrypointRelative:
+      EncodeUnsignedLeb128(out, table->GetIndex(patch.TargetMethod().dex_file));
+      EncodeUnsignedLeb128(out, patch.PcInsnOffset());
+      EncodeUnsignedLeb128(out, patch.TargetMethod().index);
+      break;
+    case LinkerPatch::Type::kCallRelative:
+      EncodeUnsignedLeb128(out, table->GetIndex(patch.TargetMethod().dex_file));
+      EncodeUnsignedLeb128(out, patch.TargetMethod().index);
+      break;
+    case LinkerPatch::Type::kTypeRelative:
+    case LinkerPatch::Type::kTypeAppImageRelRo:
+    case LinkerPatch::Type::kTypeBssEntry:
+    case LinkerPatch::Type::kPublicTypeBssEntry:
+    case LinkerPatch::Type::kPackageTypeBssEntry:
+      EncodeUnsignedLeb128(out, table->GetIndex(patch.TargetType().dex_file));
+      EncodeUnsignedLeb128(out, patch.PcInsnOffset());
+      EncodeUnsignedLeb128(out, patch.TargetType().index);
+      break;
+    case LinkerPatch::Type::kStringRelative:
+    case LinkerPatch::Type::kStringBssEntry:
+      EncodeUnsignedLeb128(out, table->GetIndex(patch.TargetString().dex_file));
+      EncodeUnsignedLeb128(out, patch.PcInsnOffset());
+      EncodeUnsignedLeb128(out, patch.TargetString().index);
+      break;
+    case LinkerPatch::Type::kMethodTypeBssEntry:
+      EncodeUnsignedLeb128(out, table->GetIndex(patch.TargetProto().dex_file));
+      EncodeUnsignedLeb128(out, patch.PcInsnOffset());
+      EncodeUnsignedLeb128(out, patch.TargetProto().index);
+      break;
+    case LinkerPatch::Type::kCallEntrypoint:
+      EncodeUnsignedLeb128(out, patch.EntrypointOffset());
+      break;
+    case LinkerPatch::Type::kBakerReadBarrierBranch:
+      EncodeUnsignedLeb128(out, patch.GetBakerCustomValue1());
+      EncodeUnsignedLeb128(out, patch.GetBakerCustomValue2());
+      break;
+  }
+}
+
+// Bounds-checked decoding of the archive. Once a read fails, all subsequent reads return
+// zero or empty data and `IsValid()` returns false.
+class ArchiveReader {
+ public:
+  explicit ArchiveReader(ArrayRef<const uint8_t> data)
+      : ptr_(data.data()), end_(data.data() + data.size()), valid_(true) {}
+
+  bool IsValid() const {
+    return valid_;
+  }
+
+  bool AtEnd() const {
+    return ptr_ == end_;
+  }
+
+  uint32_t ReadUnsigned() {
+    uint32_t value = 0u;
+    if (valid_ && !DecodeUnsignedLeb128Checked(&ptr_, end_, &value)) {
+      valid_ = false;
+    }
+    return valid_ ? value : 0u;
+  }
+
+  ArrayRef<const uint8_t> ReadBytes(size_t size) {
+    if (!valid_ || static_cast<size_t>(end_ - ptr_) < size) {
+      valid_ = false;
+      return ArrayRef<const uint8_t>();
+    }
+    ArrayRef<const uint8_t> result(ptr_, size);
+    ptr_ += size;
+    return result;
+  }
+
+  ArrayRef<const uint8_t> ReadBytes() {
+    return ReadBytes(ReadUnsigned());
+  }
+
+  std::string_view ReadString() {
+    ArrayRef<const uint8_t> data = ReadBytes();
+    return std::string_view(reinterpret_cast<const char*>(data.data()), data.size());
+  }
+
+ private:
+  const uint8_t* ptr_;
+  const uint8_t* const end_;
+  bool valid_;
+};
+
+// A method decoded from the archive, with the code still pointing into the archive data.
+struct ArchivedMethod {
+  MethodReference method_ref;
+  bool is_intrinsic;
+  ArrayRef<const uint8_t> code;
+  ArrayRef<const uint8_t> vmap_table;
+  ArrayRef<const uint8_t> cfi_info;
+  std::vector<LinkerPatch> patches;
+};
+
+}  // namespace
+
+bool CompiledMethodArchive::Write(const CompilerDriver& driver,
+                                  const std::vector<const DexFile*>& dex_files,
+                                  const std::string& class_loader_context,
+                                  File* file,
+                                  std::string* error_msg) {
+  const InstructionSet isa = driver.GetCompilerOptions().GetInstructionSet();
+  DexFileTable table;
+  std::vector<uint8_t> methods;
+  uint32_t num_methods = 0u;
+  for (const DexFile* dex_file : dex_files) {
+    for (uint32_t method_idx = 0; method_idx != dex_file->NumMethodIds(); ++method_idx) {
+      const CompiledMethod* compiled_method =
+          driver.GetCompiledMethod(MethodReference(dex_file, method_idx));
+      if (compiled_method == nullptr) {
+        continue;
+      }
+      DCHECK_EQ(compiled_method->GetInstructionSet(), isa);
+      EncodeUnsignedLeb128(&methods, table.GetIndex(dex_file));
+      EncodeUnsignedLeb128(&methods, method_idx);
+      EncodeUnsignedLeb128(&methods, compiled_method->IsIntrinsic() ? 1u : 0u);
+      EncodeBytes(&methods, compiled_method->GetQuickCode());
+      EncodeBytes(&methods, compiled_method->GetVmapTable());
+      EncodeBytes(&methods, compiled_method->GetCFIInfo());
+      ArrayRef<const LinkerPatch> patches = compiled_method->GetPatches();
+      EncodeUnsignedLeb128(&methods, patches.size());
+      for (const LinkerPatch& patch : patches) {
+        EncodePatch(&methods, &table, patch);
+      }
+      ++num_methods;
+    }
+  }
+
+  std::vector<uint8_t> header(std::begin(kArchiveMagic), std::end(kArchiveMagic));
+  header.insert(header.end(), std::begin(kArchiveVersion), std::end(kArchiveVersion));
+  EncodeUnsignedLeb128(&header, static_cast<uint32_t>(isa));
+  std::vector<std::pair<const char*, std::string>> configuration =
+      GetConfiguration(driver.GetCompilerOptions(), class_loader_context);
+  EncodeUnsignedLeb128(&header, configuration.size());
+  for (const auto& entry : configuration) {
+    EncodeString(&header, entry.second);
+  }
+  EncodeUnsignedLeb128(&header, table.GetDexFiles().size());
+  for (const DexFile* dex_file : table.GetDexFiles()) {
+    EncodeString(&header, dex_file->GetLocation());
+    EncodeUnsignedLeb128(&header, dex_file->GetLocationChecksum());
+  }
+  EncodeUnsignedLeb128(&header, num_methods);
+
+  if (!file->WriteFully(header.data(), header.size()) ||
+      !file->WriteFully(methods.data(), methods.size())) {
+    *error_msg = StringPrintf("Failed to write compiled methods archive '%s': %s",
+                              file->GetPath().c_str(),
+                              strerror(errno));
+    return false;
+  }
+  return true;
+}
+
+bool CompiledMethodArchive::Read(File* file,
+                                 const std::vector<const DexFile*>& dex_files,
+                                 const std::string& class_loader_context,
+                                 const std::vector<const DexFile*>& referenced_dex_files,
+                                 CompilerDriver* driver,
+                                 /*out*/ size_t* num_methods,
+                                 /*out*/ std::string* error_msg) {
+  *num_methods = 0u;
+  int64_t length = file->GetLength();
+  if (length < 0) {
+    *error_msg = StringPrintf("Failed to get the size of compiled methods archive '%s': %s",
+                              file->GetPath().c_str(),
+                              strerror(-length));
+    return false;
+  }
+  std::vector<uint8_t> data(static_cast<size_t>(length));
+  if (!file->PreadFully(data.data(), data.size(), /*offset=*/ 0)) {
+    *error_msg = StringPrintf("Failed to read compiled methods archive '%s': %s",
+                              file->GetPath().c_str(),
+                              strerror(errno));
+    return false;
+  }
+
+  ArchiveReader reader{ArrayRef<const uint8_t>(data)};
+  ArrayRef<const uint8_t> magic = reader.ReadBytes(sizeof(kArchiveMagic));
+  ArrayRef<const uint8_t> version = reader.ReadBytes(sizeof(kArchiveVersion));
+  if (!reader.IsValid() ||
+      magic != ArrayRef<const uint8_t>(kArchiveMagic) ||
+      version != ArrayRef<const uint8_t>(kArchiveVersion)) {
+    *error_msg = StringPrintf("Invalid compiled methods archive '%s'", file->GetPath().c_str());
+    return false;
+  }
+  const InstructionSet isa = driver->GetCompilerOptions().GetInstructionSet();
+  uint32_t archive_isa = reader.ReadUnsigned();
+  if (archive_isa != static_cast<uint32_t>(isa)) {
+    *error_msg = StringPrintf("Compiled methods archive '%s' is not compiled for %s",
+                              file->GetPath().c_str(),
+                              GetInstructionSetString(isa));
+    return false;
+  }
+  std::vector<std::pair<const char*, std::string>> configuration =
+      GetConfiguration(driver->GetCompilerOptions(), class_loader_context);
+  uint32_t num_configuration_entries = reader.ReadUnsigned();
+  if (reader.IsValid() && num_configuration_entries != configuration.size()) {
+    *error_msg = StringPrintf("Invalid compiled methods archive '%s'", file->GetPath().c_str());
+    return false;
+  }
+  for (const auto& [name, value] : configuration) {
+    std::string_view archive_value = reader.ReadString();
+    if (reader.IsValid() && archive_value != value) {
+      *error_msg = StringPrintf("Compiled methods archive '%s' has a different %s: '%s' vs '%s'",
+                                file->GetPath().c_str(),
+                                name,
+                                std::string(archive_value).c_str(),
+                                value.c_str());
+      return false;
+    }
+  }
+
+  // Resolve the dex files. Unresolved dex files are left null, and the methods referring to
+  // them are compiled again.
+  uint32_t num_dex_files = reader.ReadUnsigned();
+  std::vector<const DexFile*> table;
+  std::vector<bool> is_compiled_dex_file;
+  for (uint32_t i = 0; i != num_dex_files && reader.IsValid(); ++i) {
+    std::string_view location = reader.ReadString();
+    uint32_t location_checksum = reader.ReadUnsigned();
+    auto matches = [&](const DexFile* dex_file) {
+      return dex_file->GetLocation() == location &&
+             dex_file->GetLocationChecksum() == location_checksum;
+    };
+    auto it = std::find_if(dex_files.begin(), dex_files.end(), matches);
+    if (it != dex_files.end()) {
+      table.push_back(*it);
+      is_compiled_dex_file.push_back(true);
+      continue;
+    }
+    it = std::find_if(referenced_dex_files.begin(), referenced_dex_files.end(), matches);
+    table.push_back(it != referenced_dex_files.end() ? *it : nullptr);
+    is_compiled_dex_file.push_back(false);
+  }
+
+  // Decode all methods before adding any, so that a truncated archive does not leave the
+  // driver with only part of its methods.
+  uint32_t archived_methods = reader.ReadUnsigned();
+  std::vector<ArchivedMethod> methods;
+  for (uint32_t i = 0; i != archived_methods && reader.IsValid(); ++i) {
+    uint32_t dex_file_index = reader.ReadUnsigned();
+    uint32_t method_idx = reader.ReadUnsigned();
+    bool usable = dex_file_index < table.size() &&
+                  is_compiled_dex_file[dex_file_index] &&
+                  method_idx < table[dex_file_index]->NumMethodIds();
+    const DexFile* dex_file = usable ? table[dex_file_index] : nullptr;
+    auto read_dex_file = [&]() -> const DexFile* {
+      uint32_t index = reader.ReadUnsigned();
+      const DexFile* target_dex_file = (index < table.size()) ? table[index] : nullptr;
+      usable = usable && (target_dex_file != nullptr);
+      return target_dex_file;
+    };
+    bool is_intrinsic = reader.ReadUnsigned() != 0u;
+    ArrayRef<const uint8_t> code = reader.ReadBytes();
+    ArrayRef<const uint8_t> vmap_table = reader.ReadBytes();
+    ArrayRef<const uint8_t> cfi_info = reader.ReadBytes();
+    uint32_t num_patches = reader.ReadUnsigned();
+    std::vector<LinkerPatch> patches;
+    for (uint32_t j = 0; j != num_patches && reader.IsValid(); ++j) {
+      uint32_t type = reader.ReadUnsigned();
+      uint32_t literal_offset = reader.ReadUnsigned();
+      switch (static_cast<LinkerPatch::Type>(type)) {
+        case LinkerPatch::Type::kIntrinsicReference: {
+          uint32_t pc_insn_offset = reader.ReadUnsigned();
+          patches.push_back(LinkerPatch::IntrinsicReferencePatch(
+              literal_offset, pc_insn_offset, reader.ReadUnsigned()));
+          break;
+        }
+        case LinkerPatch::Type::kBootImageRelRo: {
+          uint32_t pc_insn_offset = reader.ReadUnsigned();
+          patches.push_back(LinkerPatch::BootImageRelRoPatch(
+              literal_offset, pc_insn_offset, reader.ReadUnsigned()));
+          break;
+        }
+        case LinkerPatch::Type::kCallRelative: {
+          const DexFile* target_dex_file = read_dex_file();
+          patches.push_back(LinkerPatch::RelativeCodePatch(
+              literal_offset, target_dex_file, reader.ReadUnsigned()));
+          break;
+        }
+        case LinkerPatch::Type::kCallEntrypoint:
+          patches.push_back(LinkerPatch::CallEntrypointPatch(
+              literal_offset, reader.ReadUnsigned()));
+          break;
+        case LinkerPatch::Type::kBakerReadBarrierBranch: {
+          uint32_t custom_value1 = reader.ReadUnsigned();
+          patches.push_back(LinkerPatch::BakerReadBarrierBranchPatch(
+              literal_offset, custom_value1, reader.ReadUnsigned()));
+          break;
+        }
+        default: {
+          using PatchFactory = LinkerPatch (*)(size_t, const DexFile*, uint32_t, uint32_t);
+          PatchFactory factory = nullptr;
+          switch (static_cast<LinkerPatch::Type>(type)) {
+            case LinkerPatch::Type::kMethodRelative:
+              factory = &LinkerPatch::RelativeMethodPatch;
+              break;
+            case LinkerPatch::Type::kMethodAppImageRelRo:
+              factory = &LinkerPatch::MethodAppImageRelRoPatch;
+              break;
+            case LinkerPatch::Type::kMethodBssEntry:
+              factory = &LinkerPatch::MethodBssEntryPatch;
+              break;
+            case LinkerPatch::Type::kJniEntrypointRelative:
+              factory = &LinkerPatch::RelativeJniEntrypointPatch;
+              break;
+            case LinkerPatch::Type::kTypeRelative:
+              factory = &LinkerPatch::RelativeTypePatch;
+              break;
+            case LinkerPatch::Type::kTypeAppImageRelRo:
+              factory = &LinkerPatch::TypeAppImageRelRoPatch;
+              break;
+            case LinkerPatch::Type::kTypeBssEntry:
+              factory = &LinkerPatch::TypeBssEntryPatch;
+              break;
+            case LinkerPatch::Type::kPublicTypeBssEntry:
+              factory = &LinkerPatch::PublicTypeBssEntryPatch;
+              break;
+            case LinkerPatch::Type::kPackageTypeBssEntry:
+              factory = &LinkerPatch::PackageTypeBssEntryPatch;
+              break;
+            case LinkerPatch::Type::kStringRelative:
+              factory = &LinkerPatch::RelativeStringPatch;
+              break;
+            case LinkerPatch::Type::kStringBssEntry:
+              factory = &LinkerPatch::StringBssEntryPatch;
+              break;
+            case LinkerPatch::Type::kMethodTypeBssEntry:
+              factory = &LinkerPatch::MethodTypeBssEntryPatch;
+              break;
+            default:
+              *error_msg = StringPrintf("Unknown linker patch type %u in compiled methods "
+                                        "archive '%s'",
+                                        type,
+                                        file->GetPath().c_str());
+              return false;
+          }
+          const DexFile* target_dex_file = read_dex_file();
+          uint32_t pc_insn_offset = reader.ReadUnsigned();
+          patches.push_back(
+              factory(literal_offset, target_dex_file, pc_insn_offset, reader.ReadUnsigned()));
+          break;
+        }
+      }
+    }
+    if (usable && reader.IsValid()) {
+      methods.push_back(ArchivedMethod{MethodReference(dex_file, method_idx),
+                                       is_intrinsic,
+                                       code,
+                                       vmap_table,
+                                       cfi_info,
+                                       std::move(patches)});
+    }
+  }
+  if (!reader.IsValid() || !reader.AtEnd()) {
+    *error_msg = StringPrintf("Truncated or corrupted compiled methods archive '%s'",
+                              file->GetPath().c_str());
+    return false;
+  }
+
+  for (const ArchivedMethod& method : methods) {
+    if (driver->GetCompiledMethod(method.method_ref) != nullptr) {
+      // Compiled by another shard, or listed twice. Keep the first one.
+      continue;
+    }
+    CompiledMethod* compiled_method =
+        CompiledMethod::SwapAllocCompiledMethod(driver->GetCompiledMethodStorage(),
+                                                isa,
+                                                method.code,
+                                                method.vmap_table,
+                                                method.cfi_info,
+                                                ArrayRef<const LinkerPatch>(method.patches));
+    if (method.is_intrinsic) {
+      compiled_method->MarkAsIntrinsic();
+    }
+    driver->AddCompiledMethod(method.method_ref, compiled_method);
+    ++*num_methods;
+  }
+  return true;
+}
+
+}  // namespace art
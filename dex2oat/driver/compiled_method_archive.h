@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_DEX2OAT_DRIVER_COMPILED_METHOD_ARCHIVE_H_
+#define ART_DEX2OAT_DRIVER_COMPILED_METHOD_ARCHIVE_H_
+
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/os.h"
+
+namespace art {
+
+class CompilerDriver;
+class DexFile;
+
+// Serializes the methods compiled by a dex2oat invocation that only compiled a shard of the
+// classes (see CompilerOptions::IsInCompileShard()), so that a later invocation can link the
+// code of all shards into a single oat file.
+//
+// Dex files are identified by their location and location checksum. The archive also records
+// the configuration the code was compiled for (instruction set and its features, boot class
+// path checksums, class loader context, compiler filter, debuggability, debug info, image
+// classes and profile), and an archive is only merged into an invocation with the same
+// configuration. The code itself is added to the CompiledMethodStorage like freshly compiled
+// code, so deduplication and the layout of the oat file do not depend on where a method came
+// from.
+class CompiledMethodArchive {
+ public:
+  // Writes the methods of `dex_files` compiled by `driver` to `file`. The
+  // `class_loader_context` is the encoded context of the compilation, as stored in the
+  // oat header.
+  static bool Write(const CompilerDriver& driver,
+                    const std::vector<const DexFile*>& dex_files,
+                    const std::string& class_loader_context,
+                    File* file,
+                    std::string* error_msg);
+
+  // Adds the methods of the archive in `file` that belong to `dex_files` to `driver`. Methods
+  // that are already compiled, or that refer to a dex file not found in `dex_files` or in
+  // `referenced_dex_files`, are skipped and left for the driver to compile. Returns false
+  // without adding any method if the archive is malformed or was compiled for another
+  // configuration.
+  static bool Read(File* file,
+                   const std::vector<const DexFile*>& dex_files,
+                   const std::string& class_loader_context,
+                   const std::vector<const DexFile*>& referenced_dex_files,
+                   CompilerDriver* driver,
+                   /*out*/ size_t* num_methods,
+                   /*out*/ std::string* error_msg);
+
+ private:
+  DISALLOW_IMPLICIT_CONSTRUCTORS(CompiledMethodArchive);
+};
+
+}  // namespace art
+
+#endif  // ART_DEX2OAT_DRIVER_COMPILED_METHOD_ARCHIVE_H_
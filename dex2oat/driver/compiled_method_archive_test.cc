@@ -0,0 +1,203 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "driver/compiled_method_archive.h"
+
+#include <utility>
+#include <vector>
+
+#include "base/array_ref.h"
+#include "common_compiler_driver_test.h"
+#include "compiled_method-inl.h"
+#include "dex/dex_file.h"
+#include "dex/method_reference.h"
+#include "driver/compiler_driver.h"
+#include "linker/linker_patch.h"
+#include "oat/oat.h"
+#include "scoped_thread_state_change-inl.h"
+
+namespace art {
+
+class CompiledMethodArchiveTest : public CommonCompilerDriverTest {
+ protected:
+  static constexpr const char* kClassLoaderContext = "PCL[]";
+
+  // Takes all compiled methods of `dex_files` out of the driver.
+  std::vector<std::pair<MethodReference, CompiledMethod*>> RemoveCompiledMethods(
+      const std::vector<const DexFile*>& dex_files) {
+    std::vector<std::pair<MethodReference, CompiledMethod*>> removed;
+    for (const DexFile* dex_file : dex_files) {
+      for (uint32_t method_idx = 0; method_idx != dex_file->NumMethodIds(); ++method_idx) {
+        MethodReference method_ref(dex_file, method_idx);
+        if (compiler_driver_->GetCompiledMethod(method_ref) != nullptr) {
+          removed.emplace_back(method_ref, compiler_driver_->RemoveCompiledMethod(method_ref));
+        }
+      }
+    }
+    return removed;
+  }
+};
+
+TEST_F(CompiledMethodArchiveTest, WriteRead) {
+  jobject class_loader;
+  {
+    ScopedObjectAccess soa(Thread::Current());
+    class_loader = LoadDex("ProfileTestMultiDex");
+  }
+  ASSERT_NE(class_loader, nullptr);
+  std::vector<const DexFile*> dex_files = GetDexFiles(class_loader);
+  TimingLogger timings("CompiledMethodArchiveTest::WriteRead", false, false);
+  CompileAll(class_loader, dex_files, &timings);
+
+  ScratchFile archive;
+  std::string error_msg;
+  ASSERT_TRUE(CompiledMethodArchive::Write(*compiler_driver_,
+                                           dex_files,
+                                           kClassLoaderContext,
+                                           archive.GetFile(),
+                                           &error_msg)) << error_msg;
+
+  std::vector<std::pair<MethodReference, CompiledMethod*>> removed =
+      RemoveCompiledMethods(dex_files);
+  ASSERT_FALSE(removed.empty());
+
+  size_t num_methods = 0u;
+  ASSERT_TRUE(CompiledMethodArchive::Read(archive.GetFile(),
+                                          dex_files,
+                                          kClassLoaderContext,
+                                          class_linker_->GetBootClassPath(),
+                                          compiler_driver_.get(),
+                                          &num_methods,
+                                          &error_msg)) << error_msg;
+  EXPECT_EQ(removed.size(), num_methods);
+  for (const auto& [method_ref, old_method] : removed) {
+    const CompiledMethod* new_method = compiler_driver_->GetCompiledMethod(method_ref);
+    ASSERT_NE(new_method, nullptr) << method_ref.PrettyMethod();
+    EXPECT_TRUE(*new_method == *old_method) << method_ref.PrettyMethod();
+    EXPECT_EQ(new_method->IsIntrinsic(), old_method->IsIntrinsic());
+    EXPECT_TRUE(new_method->GetVmapTable() == old_method->GetVmapTable());
+    EXPECT_TRUE(new_method->GetCFIInfo() == old_method->GetCFIInfo());
+    EXPECT_TRUE(new_method->GetPatches() == old_method->GetPatches());
+    CompiledMethod::ReleaseSwapAllocatedCompiledMethod(compiler_driver_->GetCompiledMethodStorage(),
+                                                       old_method);
+  }
+
+  // Methods that are already compiled are kept.
+  ASSERT_TRUE(CompiledMethodArchive::Read(archive.GetFile(),
+                                          dex_files,
+                                          kClassLoaderContext,
+                                          class_linker_->GetBootClassPath(),
+                                          compiler_driver_.get(),
+                                          &num_methods,
+                                          &error_msg)) << error_msg;
+  EXPECT_EQ(0u, num_methods);
+}
+
+TEST_F(CompiledMethodArchiveTest, Truncated) {
+  jobject class_loader;
+  {
+    ScopedObjectAccess soa(Thread::Current());
+    class_loader = LoadDex("ProfileTestMultiDex");
+  }
+  ASSERT_NE(class_loader, nullptr);
+  std::vector<const DexFile*> dex_files = GetDexFiles(class_loader);
+  TimingLogger timings("CompiledMethodArchiveTest::Truncated", false, false);
+  CompileAll(class_loader, dex_files, &timings);
+
+  ScratchFile archive;
+  std::string error_msg;
+  ASSERT_TRUE(CompiledMethodArchive::Write(*compiler_driver_,
+                                           dex_files,
+                                           kClassLoaderContext,
+                                           archive.GetFile(),
+                                           &error_msg)) << error_msg;
+  ASSERT_EQ(0, archive.GetFile()->SetLength(archive.GetFile()->GetLength() - 1));
+  std::vector<std::pair<MethodReference, CompiledMethod*>> removed =
+      RemoveCompiledMethods(dex_files);
+  ASSERT_FALSE(removed.empty());
+  for (const auto& entry : removed) {
+    CompiledMethod::ReleaseSwapAllocatedCompiledMethod(compiler_driver_->GetCompiledMethodStorage(),
+                                                       entry.second);
+  }
+
+  // No method is added from a truncated archive.
+  size_t num_methods = 0u;
+  EXPECT_FALSE(CompiledMethodArchive::Read(archive.GetFile(),
+                                           dex_files,
+                                           kClassLoaderContext,
+                                           class_linker_->GetBootClassPath(),
+                                           compiler_driver_.get(),
+                                           &num_methods,
+                                           &error_msg));
+  EXPECT_EQ(0u, num_methods);
+  EXPECT_TRUE(RemoveCompiledMethods(dex_files).empty());
+}
+
+TEST_F(CompiledMethodArchiveTest, ConfigurationMismatch) {
+  jobject class_loader;
+  {
+    ScopedObjectAccess soa(Thread::Current());
+    class_loader = LoadDex("ProfileTestMultiDex");
+  }
+  ASSERT_NE(class_loader, nullptr);
+  std::vector<const DexFile*> dex_files = GetDexFiles(class_loader);
+  TimingLogger timings("CompiledMethodArchiveTest::ConfigurationMismatch", false, false);
+  CompileAll(class_loader, dex_files, &timings);
+
+  ScratchFile archive;
+  std::string error_msg;
+  ASSERT_TRUE(CompiledMethodArchive::Write(*compiler_driver_,
+                                           dex_files,
+                                           kClassLoaderContext,
+                                           archive.GetFile(),
+                                           &error_msg)) << error_msg;
+  std::vector<std::pair<MethodReference, CompiledMethod*>> removed =
+      RemoveCompiledMethods(dex_files);
+  ASSERT_FALSE(removed.empty());
+  for (const auto& entry : removed) {
+    CompiledMethod::ReleaseSwapAllocatedCompiledMethod(compiler_driver_->GetCompiledMethodStorage(),
+                                                       entry.second);
+  }
+
+  // An archive compiled with another class loader context is rejected.
+  size_t num_methods = 0u;
+  EXPECT_FALSE(CompiledMethodArchive::Read(archive.GetFile(),
+                                           dex_files,
+                                           "PCL[other.jar*1234]",
+                                           class_linker_->GetBootClassPath(),
+                                           compiler_driver_.get(),
+                                           &num_methods,
+                                           &error_msg));
+  EXPECT_NE(error_msg.find(OatHeader::kClassPathKey), std::string::npos) << error_msg;
+  EXPECT_EQ(0u, num_methods);
+
+  // So is an archive compiled for a debuggable app.
+  bool debuggable = compiler_options_->GetDebuggable();
+  compiler_options_->SetDebuggable(!debuggable);
+  EXPECT_FALSE(CompiledMethodArchive::Read(archive.GetFile(),
+                                           dex_files,
+                                           kClassLoaderContext,
+                                           class_linker_->GetBootClassPath(),
+                                           compiler_driver_.get(),
+                                           &num_methods,
+                                           &error_msg));
+  EXPECT_NE(error_msg.find(OatHeader::kDebuggableKey), std::string::npos) << error_msg;
+  EXPECT_EQ(0u, num_methods);
+  compiler_options_->SetDebuggable(debuggable);
+  EXPECT_TRUE(RemoveCompiledMethods(dex_files).empty());
+}
+
+}  // namespace art
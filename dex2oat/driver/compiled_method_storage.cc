@@ -183,6 +183,15 @@ void CompiledMethodStorage::ReleaseCode(const LengthPrefixedArray<uint8_t>* code
   ReleaseArrayIfNotDeduplicated(code);
 }
 
+void CompiledMethodStorage::ReleaseWrittenCode(const LengthPrefixedArray<uint8_t>* code) {
+  DCHECK(code != nullptr);
+  if (DedupeEnabled()) {
+    dedupe_code_.Remove(Thread::Current(), ArrayRef<const uint8_t>(&code->At(0), code->size()));
+  } else {
+    ReleaseArray(swap_space_.get(), code);
+  }
+}
+
 size_t CompiledMethodStorage::UniqueCodeEntries() const {
   DCHECK(DedupeEnabled());
   return dedupe_code_.Size(Thread::Current());
@@ -55,6 +55,8 @@ class CompiledMethodStorage final : public CompiledCodeStorage {
 
   const LengthPrefixedArray<uint8_t>* DeduplicateCode(const ArrayRef<const uint8_t>& code);
   void ReleaseCode(const LengthPrefixedArray<uint8_t>* code);
+  // Unlike ReleaseCode(), frees the code also if it was deduplicated.
+  void ReleaseWrittenCode(const LengthPrefixedArray<uint8_t>* code);
   size_t UniqueCodeEntries() const;
 
   const LengthPrefixedArray<uint8_t>* DeduplicateVMapTable(const ArrayRef<const uint8_t>& table);
@@ -22,6 +22,8 @@
 #include <malloc.h>  // For mallinfo
 #endif
 
+#include <algorithm>
+#include <numeric>
 #include <string_view>
 #include <vector>
 
@@ -1825,6 +1827,42 @@ static void LoadAndUpdateStatus(const ClassAccessor& accessor,
   }
 }
 
+void CompilerDriver::RecordVerifierDepsStatus(const ClassAccessor& accessor,
+                                              ClassStatus status,
+                                              Handle<mirror::ClassLoader> class_loader,
+                                              Thread* self) {
+  bool compiler_only_verifies =
+      !GetCompilerOptions().IsAnyCompilationEnabled() &&
+      !GetCompilerOptions().IsGeneratingImage();
+
+  const bool is_generating_image = GetCompilerOptions().IsGeneratingImage();
+
+  if (compiler_only_verifies) {
+    // Just update the compiled_classes_ map. The compiler doesn't need to resolve
+    // the type.
+    ClassReference ref(&accessor.GetDexFile(), accessor.GetClassDefIndex());
+    const ClassStatus existing = ClassStatus::kNotReady;
+    // Note: when dex files are compiled inidividually, the class may have
+    // been verified in a previous stage. This means this insertion can
+    // fail, but that's OK.
+    compiled_classes_.Insert(ref, existing, status);
+  } else {
+    if (is_generating_image &&
+        status == ClassStatus::kVerifiedNeedsAccessChecks &&
+        GetCompilerOptions().IsImageClass(accessor.GetDescriptor())) {
+      // If the class will be in the image, we can rely on the ArtMethods
+      // telling that they need access checks.
+      VLOG(compiler) << "Promoting "
+                     << accessor.GetDescriptorView()
+                     << " from needs access checks to verified given it is an image class";
+      status = ClassStatus::kVerified;
+    }
+    // Update the class status, so later compilation stages know they don't need to verify
+    // the class.
+    LoadAndUpdateStatus(accessor, status, class_loader, self);
+  }
+}
+
 bool CompilerDriver::FastVerify(jobject jclass_loader,
                                 const std::vector<const DexFile*>& dex_files,
                                 TimingLogger* timings) {
@@ -1847,12 +1885,6 @@ bool CompilerDriver::FastVerify(jobject jclass_loader,
       class_loader,
       dex_files);
 
-  bool compiler_only_verifies =
-      !GetCompilerOptions().IsAnyCompilationEnabled() &&
-      !GetCompilerOptions().IsGeneratingImage();
-
-  const bool is_generating_image = GetCompilerOptions().IsGeneratingImage();
-
   // We successfully validated the dependencies, now update class status
   // of verified classes. Note that the dependencies also record which classes
   // could not be fully verified; we could try again, but that would hurt verification
@@ -1866,30 +1898,7 @@ bool CompilerDriver::FastVerify(jobject jclass_loader,
       ClassStatus status = verified_classes[accessor.GetClassDefIndex()]
           ? ClassStatus::kVerifiedNeedsAccessChecks
           : ClassStatus::kRetryVerificationAtRuntime;
-      if (compiler_only_verifies) {
-        // Just update the compiled_classes_ map. The compiler doesn't need to resolve
-        // the type.
-        ClassReference ref(dex_file, accessor.GetClassDefIndex());
-        const ClassStatus existing = ClassStatus::kNotReady;
-        // Note: when dex files are compiled inidividually, the class may have
-        // been verified in a previous stage. This means this insertion can
-        // fail, but that's OK.
-        compiled_classes_.Insert(ref, existing, status);
-      } else {
-        if (is_generating_image &&
-            status == ClassStatus::kVerifiedNeedsAccessChecks &&
-            GetCompilerOptions().IsImageClass(accessor.GetDescriptor())) {
-          // If the class will be in the image, we can rely on the ArtMethods
-          // telling that they need access checks.
-          VLOG(compiler) << "Promoting "
-                         << accessor.GetDescriptorView()
-                         << " from needs access checks to verified given it is an image class";
-          status = ClassStatus::kVerified;
-        }
-        // Update the class status, so later compilation stages know they don't need to verify
-        // the class.
-        LoadAndUpdateStatus(accessor, status, class_loader, soa.Self());
-      }
+      RecordVerifierDepsStatus(accessor, status, class_loader, soa.Self());
 
       // Vdex marks class as unverified for two reasons only:
       // 1. It has a hard failure, or
@@ -1907,6 +1916,39 @@ bool CompilerDriver::FastVerify(jobject jclass_loader,
   return true;
 }
 
+void CompilerDriver::ReuseVerifiedClasses(jobject jclass_loader,
+                                          const std::vector<const DexFile*>& dex_files,
+                                          verifier::VerifierDeps* verifier_deps,
+                                          TimingLogger* timings) {
+  auto has_verified_classes = [verifier_deps](const DexFile* dex_file) {
+    const std::vector<bool>& verified_classes = verifier_deps->GetVerifiedClasses(*dex_file);
+    return std::find(verified_classes.begin(), verified_classes.end(), true) !=
+           verified_classes.end();
+  };
+  if (std::none_of(dex_files.begin(), dex_files.end(), has_verified_classes)) {
+    return;
+  }
+  TimingLogger::ScopedTiming t("Reuse Verified Classes", timings);
+
+  ScopedObjectAccess soa(Thread::Current());
+  StackHandleScope<1> hs(soa.Self());
+  Handle<mirror::ClassLoader> class_loader(
+      hs.NewHandle(soa.Decode<mirror::ClassLoader>(jclass_loader)));
+  // Classes whose dependencies do not hold anymore are reset to unverified, and will go
+  // through the verifier like any other class, which records their dependencies again.
+  verifier_deps->ValidateDependenciesAndUpdateStatus(soa.Self(), class_loader, dex_files);
+  verifier_deps->ClearUnverifiedClasses(dex_files);
+  for (const DexFile* dex_file : dex_files) {
+    const std::vector<bool>& verified_classes = verifier_deps->GetVerifiedClasses(*dex_file);
+    for (ClassAccessor accessor : dex_file->GetClasses()) {
+      if (verified_classes[accessor.GetClassDefIndex()]) {
+        RecordVerifierDepsStatus(
+            accessor, ClassStatus::kVerifiedNeedsAccessChecks, class_loader, soa.Self());
+      }
+    }
+  }
+}
+
 void CompilerDriver::Verify(jobject jclass_loader,
                             const std::vector<const DexFile*>& dex_files,
                             TimingLogger* timings) {
@@ -1924,6 +1966,7 @@ void CompilerDriver::Verify(jobject jclass_loader,
       Runtime::Current()->GetCompilerCallbacks()->GetVerifierDeps();
   // Verifier deps can be null when unit testing.
   if (main_verifier_deps != nullptr) {
+    ReuseVerifiedClasses(jclass_loader, dex_files, main_verifier_deps, timings);
     Thread::Current()->SetVerifierDeps(main_verifier_deps);
     // Create per-thread VerifierDeps to avoid contention on the main one.
     // We will merge them after verification.
@@ -1974,6 +2017,14 @@ class VerifyClassVisitor : public CompilationVisitor {
     ScopedObjectAccess soa(Thread::Current());
     const DexFile& dex_file = *manager_->GetDexFile();
     const dex::ClassDef& class_def = dex_file.GetClassDef(class_def_index);
+    ClassReference ref(manager_->GetDexFile(), class_def_index);
+    ClassStatus recorded_status;
+    if (manager_->GetCompiler()->GetCompiledClass(ref, &recorded_status) &&
+        recorded_status >= ClassStatus::kVerifiedNeedsAccessChecks) {
+      // The status was reused from the input vdex when the compiler only verifies, see
+      // `CompilerDriver::ReuseVerifiedClasses()`. Its dependencies are already recorded.
+      return;
+    }
     ClassLinker* class_linker = manager_->GetClassLinker();
     jobject jclass_loader = manager_->GetClassLoader();
     StackHandleScope<3> hs(soa.Self());
@@ -1981,7 +2032,6 @@ class VerifyClassVisitor : public CompilationVisitor {
         hs.NewHandle(soa.Decode<mirror::ClassLoader>(jclass_loader)));
     Handle<mirror::Class> klass = hs.NewHandle(
         class_linker->FindClass(soa.Self(), dex_file, class_def.class_idx_, class_loader));
-    ClassReference ref(manager_->GetDexFile(), class_def_index);
     verifier::FailureKind failure_kind;
     if (klass == nullptr) {
       CHECK(soa.Self()->IsExceptionPending());
@@ -2216,6 +2266,34 @@ class InitializeClassVisitor : public CompilationVisitor {
     soa.Self()->ClearException();
   }
 
+  // Initializes the class only if that does not run any code, i.e. if it has neither a class
+  // initializer nor static field values and its superclass and interfaces are initialized.
+  // Unlike Visit(), this can run on multiple threads when compiling an image, as it does not
+  // need a transaction. The class status is recorded by a later Visit().
+  void VisitWithoutClassInitializer(size_t class_def_index) {
+    ScopedTrace trace(__FUNCTION__);
+    jobject jclass_loader = manager_->GetClassLoader();
+    const DexFile& dex_file = *manager_->GetDexFile();
+    const dex::ClassDef& class_def = dex_file.GetClassDef(class_def_index);
+
+    ScopedObjectAccess soa(Thread::Current());
+    StackHandleScope<2> hs(soa.Self());
+    Handle<mirror::ClassLoader> class_loader(
+        hs.NewHandle(soa.Decode<mirror::ClassLoader>(jclass_loader)));
+    Handle<mirror::Class> klass = hs.NewHandle(manager_->GetClassLinker()->FindClass(
+        soa.Self(), dex_file, class_def.class_idx_, class_loader));
+
+    if (klass != nullptr &&
+        klass->IsVerified() &&
+        !SkipClass(jclass_loader, dex_file, klass.Get()) &&
+        IsInitializedByThisCompilation(klass.Get())) {
+      manager_->GetClassLinker()->EnsureInitialized(soa.Self(), klass, false, false);
+      DCHECK(!soa.Self()->IsExceptionPending());
+    }
+    // Clear any class not found or verification exceptions.
+    soa.Self()->ClearException();
+  }
+
   // A helper function for initializing klass.
   void TryInitializeClass(Thread* self,
                           Handle<mirror::Class> klass,
@@ -2233,15 +2311,7 @@ class InitializeClassVisitor : public CompilationVisitor {
     const bool is_boot_image_extension = compiler_options.IsBootImageExtension();
     const bool is_app_image = compiler_options.IsAppImage();
 
-    // For boot image extension, do not initialize classes defined
-    // in dex files belonging to the boot image we're compiling against.
-    if (is_boot_image_extension &&
-        runtime->GetHeap()->ObjectIsInBootImageSpace(klass->GetDexCache())) {
-      // Also return early and don't store the class status in the recorded class status.
-      return;
-    }
-    // Do not initialize classes in boot space when compiling app (with or without image).
-    if ((!is_boot_image && !is_boot_image_extension) && klass->IsBootStrapClassLoaded()) {
+    if (!IsInitializedByThisCompilation(klass.Get())) {
       // Also return early and don't store the class status in the recorded class status.
       return;
     }
@@ -2537,6 +2607,24 @@ class InitializeClassVisitor : public CompilationVisitor {
     return true;
   }
 
+  bool IsInitializedByThisCompilation(ObjPtr<mirror::Class> klass)
+      REQUIRES_SHARED(Locks::mutator_lock_) {
+    const CompilerOptions& compiler_options = manager_->GetCompiler()->GetCompilerOptions();
+    const bool is_boot_image = compiler_options.IsBootImage();
+    const bool is_boot_image_extension = compiler_options.IsBootImageExtension();
+    // For boot image extension, do not initialize classes defined
+    // in dex files belonging to the boot image we're compiling against.
+    if (is_boot_image_extension &&
+        Runtime::Current()->GetHeap()->ObjectIsInBootImageSpace(klass->GetDexCache())) {
+      return false;
+    }
+    // Do not initialize classes in boot space when compiling app (with or without image).
+    if ((!is_boot_image && !is_boot_image_extension) && klass->IsBootStrapClassLoaded()) {
+      return false;
+    }
+    return true;
+  }
+
   // Initialize the klass's dependencies recursively before initializing itself.
   // Checking for interfaces is also necessary since interfaces that contain
   // default methods must be initialized before the class.
@@ -2610,6 +2698,67 @@ class InitializeClassVisitor : public CompilationVisitor {
   const ParallelCompilationManager* const manager_;
 };
 
+// Initializes the classes of `dex_file` that need no class initializer on all threads. A class
+// can only be initialized after its superclass and interfaces, so the class defs are processed
+// in waves: a class def is in the wave after the last wave of the superclass and interfaces
+// defined in the same dex file. Classes of a wave do not depend on each other.
+static void PreInitializeClasses(const DexFile& dex_file,
+                                 ParallelCompilationManager* context,
+                                 InitializeClassVisitor* visitor,
+                                 size_t thread_count,
+                                 TimingLogger* timings)
+    REQUIRES(!Locks::mutator_lock_) {
+  TimingLogger::ScopedTiming t("Pre-initialize Classes Dex File", timings);
+  const uint32_t num_class_defs = dex_file.NumClassDefs();
+  std::vector<uint32_t> waves(num_class_defs, 0u);
+  uint32_t num_waves = (num_class_defs != 0u) ? 1u : 0u;
+  auto depends_on = [&](uint32_t class_def_index, dex::TypeIndex type_idx) {
+    const dex::ClassDef* dependency = dex_file.FindClassDef(type_idx);
+    if (dependency != nullptr) {
+      uint32_t dependency_index = dex_file.GetIndexForClassDef(*dependency);
+      // The dex file verifier ensures that superclasses and interfaces are defined first.
+      if (dependency_index < class_def_index) {
+        waves[class_def_index] = std::max(waves[class_def_index], waves[dependency_index] + 1u);
+        num_waves = std::max(num_waves, waves[class_def_index] + 1u);
+      }
+    }
+  };
+  for (uint32_t i = 0; i != num_class_defs; ++i) {
+    const dex::ClassDef& class_def = dex_file.GetClassDef(i);
+    if (class_def.superclass_idx_.IsValid()) {
+      depends_on(i, class_def.superclass_idx_);
+    }
+    const dex::TypeList* interfaces = dex_file.GetInterfacesList(class_def);
+    if (interfaces != nullptr) {
+      for (size_t j = 0; j != interfaces->Size(); ++j) {
+        depends_on(i, interfaces->GetTypeItem(j).type_idx_);
+      }
+    }
+  }
+
+  // Order the class defs by wave, keeping the dex file order within a wave.
+  std::vector<uint32_t> wave_starts(num_waves + 1u, 0u);
+  for (uint32_t wave : waves) {
+    ++wave_starts[wave + 1u];
+  }
+  std::partial_sum(wave_starts.begin(), wave_starts.end(), wave_starts.begin());
+  std::vector<uint32_t> ordered_class_defs(num_class_defs);
+  {
+    std::vector<uint32_t> next = wave_starts;
+    for (uint32_t i = 0; i != num_class_defs; ++i) {
+      ordered_class_defs[next[waves[i]]++] = i;
+    }
+  }
+
+  for (uint32_t wave = 0; wave != num_waves; ++wave) {
+    context->ForAllLambda(
+        wave_starts[wave],
+        wave_starts[wave + 1u],
+        [&](size_t index) { visitor->VisitWithoutClassInitializer(ordered_class_defs[index]); },
+        thread_count);
+  }
+}
+
 void CompilerDriver::InitializeClasses(jobject jni_class_loader,
                                        const DexFile& dex_file,
                                        TimingLogger* timings) {
@@ -2635,6 +2784,17 @@ void CompilerDriver::InitializeClasses(jobject jni_class_loader,
     init_thread_count = 1U;
   }
   InitializeClassVisitor visitor(&context);
+  if (init_thread_count == 1U && parallel_thread_count_ > 1U) {
+    // Classes that do not need a transaction can still be initialized in parallel beforehand,
+    // leaving only the class initializers to the single-threaded pass below. This runs no
+    // class initializer and initializes the same classes for any thread count, so it is also
+    // done with --force-determinism.
+    ParallelCompilationManager pre_init_context(
+        class_linker, jni_class_loader, this, &dex_file, parallel_thread_pool_.get());
+    InitializeClassVisitor pre_init_visitor(&pre_init_context);
+    PreInitializeClasses(
+        dex_file, &pre_init_context, &pre_init_visitor, parallel_thread_count_, timings);
+  }
   context.ForAll(0, dex_file.NumClassDefs(), &visitor, init_thread_count);
 
   // Make initialized classes visibly initialized.
@@ -2686,6 +2846,10 @@ static void CompileDexFile(CompilerDriver* driver,
     const dex::ClassDef& class_def = dex_file.GetClassDef(class_def_index);
     ClassAccessor accessor(dex_file, class_def_index);
     CompilerDriver* const driver = context.GetCompiler();
+    // Leave classes of other shards to the dex2oat invocations compiling them.
+    if (!driver->GetCompilerOptions().IsInCompileShard(class_def_index)) {
+      return;
+    }
     // Skip compiling classes with generic verifier failures since they will still fail at runtime
     DCHECK(driver->GetVerificationResults() != nullptr);
     if (driver->GetVerificationResults()->IsClassRejected(ref)) {
@@ -2728,6 +2892,10 @@ static void CompileDexFile(CompilerDriver* driver,
         continue;
       }
       previous_method_idx = method_idx;
+      if (driver->GetCompiledMethod(MethodReference(&dex_file, method_idx)) != nullptr) {
+        // Already compiled by a shard, see CompiledMethodArchive.
+        continue;
+      }
       compile_fn(soa.Self(),
                  driver,
                  method.GetCodeItem(),
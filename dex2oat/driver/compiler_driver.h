@@ -53,11 +53,13 @@ class DexCache;
 
 namespace verifier {
 class MethodVerifier;
+class VerifierDeps;
 class VerifierDepsTest;
 }  // namespace verifier
 
 class ArtField;
 class BitVector;
+class ClassAccessor;
 class CompiledMethod;
 class CompilerOptions;
 class DexCompilationUnit;
@@ -251,6 +253,22 @@ class CompilerDriver {
                   const std::vector<const DexFile*>& dex_files,
                   TimingLogger* timings);
 
+  // Record the status of a class as read from VerifierDeps: only in `compiled_classes_` when
+  // the compiler only verifies, otherwise on the loaded class.
+  void RecordVerifierDepsStatus(const ClassAccessor& accessor,
+                                ClassStatus status,
+                                Handle<mirror::ClassLoader> class_loader,
+                                Thread* self)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
+  // Mark the classes that the main VerifierDeps already records as verified, i.e. the ones
+  // imported from a previous build, as verified if their dependencies still hold. The
+  // verifier then skips them. Only verification results are reused, not compiled code.
+  void ReuseVerifiedClasses(jobject class_loader,
+                            const std::vector<const DexFile*>& dex_files,
+                            verifier::VerifierDeps* verifier_deps,
+                            TimingLogger* timings);
+
   void Verify(jobject class_loader,
               const std::vector<const DexFile*>& dex_files,
               TimingLogger* timings);
@@ -47,7 +47,8 @@ class DebugInfoTask : public Task {
                 size_t text_section_size,
                 uint64_t dex_section_address,
                 size_t dex_section_size,
-                const debug::DebugInfo& debug_info)
+                const debug::DebugInfo& debug_info,
+                ThreadPool* thread_pool)
       : owner_(owner),
         isa_(isa),
         instruction_set_features_(features),
@@ -55,7 +56,8 @@ class DebugInfoTask : public Task {
         text_section_size_(text_section_size),
         dex_section_address_(dex_section_address),
         dex_section_size_(dex_section_size),
-        debug_info_(debug_info) {}
+        debug_info_(debug_info),
+        thread_pool_(thread_pool) {}
 
   void Run(Thread*) override {
     result_ = debug::MakeMiniDebugInfo(isa_,
@@ -64,7 +66,8 @@ class DebugInfoTask : public Task {
                                        text_section_size_,
                                        dex_section_address_,
                                        dex_section_size_,
-                                       debug_info_);
+                                       debug_info_,
+                                       thread_pool_);
   }
 
   std::vector<uint8_t>* WaitAndGetMiniDebugInfo() {
@@ -81,6 +84,7 @@ class DebugInfoTask : public Task {
   uint64_t dex_section_address_;
   size_t dex_section_size_;
   const debug::DebugInfo& debug_info_;
+  ThreadPool* thread_pool_;
   std::vector<uint8_t> result_;
 };
 
@@ -88,7 +92,8 @@ template <typename ElfTypes>
 class ElfWriterQuick final : public ElfWriter {
  public:
   ElfWriterQuick(const CompilerOptions& compiler_options,
-                 File* elf_file);
+                 File* elf_file,
+                 size_t thread_count);
   ~ElfWriterQuick();
 
   void Start() override;
@@ -122,6 +127,7 @@ class ElfWriterQuick final : public ElfWriter {
  private:
   const CompilerOptions& compiler_options_;
   File* const elf_file_;
+  const size_t thread_count_;
   size_t rodata_size_;
   size_t text_size_;
   size_t data_img_rel_ro_size_;
@@ -129,27 +135,34 @@ class ElfWriterQuick final : public ElfWriter {
   size_t dex_section_size_;
   std::unique_ptr<BufferedOutputStream> output_stream_;
   std::unique_ptr<ElfBuilder<ElfTypes>> builder_;
+  // Workers helping to generate the debug info, created on first use.
+  std::unique_ptr<ThreadPool> debug_info_thread_pool_;
   std::unique_ptr<DebugInfoTask> debug_info_task_;
 
+  ThreadPool* GetDebugInfoThreadPool();
   void ComputeFileBuildId(uint8_t (*build_id)[ElfBuilder<ElfTypes>::kBuildIdLen]);
 
   DISALLOW_IMPLICIT_CONSTRUCTORS(ElfWriterQuick);
 };
 
 std::unique_ptr<ElfWriter> CreateElfWriterQuick(const CompilerOptions& compiler_options,
-                                                File* elf_file) {
+                                                File* elf_file,
+                                                size_t thread_count) {
   if (Is64BitInstructionSet(compiler_options.GetInstructionSet())) {
-    return std::make_unique<ElfWriterQuick<ElfTypes64>>(compiler_options, elf_file);
+    return std::make_unique<ElfWriterQuick<ElfTypes64>>(compiler_options, elf_file, thread_count);
   } else {
-    return std::make_unique<ElfWriterQuick<ElfTypes32>>(compiler_options, elf_file);
+    return std::make_unique<ElfWriterQuick<ElfTypes32>>(compiler_options, elf_file, thread_count);
   }
 }
 
 template <typename ElfTypes>
-ElfWriterQuick<ElfTypes>::ElfWriterQuick(const CompilerOptions& compiler_options, File* elf_file)
+ElfWriterQuick<ElfTypes>::ElfWriterQuick(const CompilerOptions& compiler_options,
+                                         File* elf_file,
+                                         size_t thread_count)
     : ElfWriter(),
       compiler_options_(compiler_options),
       elf_file_(elf_file),
+      thread_count_(thread_count),
       rodata_size_(0u),
       text_size_(0u),
       data_img_rel_ro_size_(0u),
@@ -247,6 +260,15 @@ void ElfWriterQuick<ElfTypes>::WriteDynamicSection() {
   builder_->WriteDynamicSection();
 }
 
+template <typename ElfTypes>
+ThreadPool* ElfWriterQuick<ElfTypes>::GetDebugInfoThreadPool() {
+  // The thread using the pool works too, see ThreadPool::ForAll().
+  if (debug_info_thread_pool_ == nullptr && thread_count_ > 1u) {
+    debug_info_thread_pool_.reset(ThreadPool::Create("Debug info writer", thread_count_ - 1u));
+  }
+  return debug_info_thread_pool_.get();
+}
+
 template <typename ElfTypes>
 std::unique_ptr<ThreadPool> ElfWriterQuick<ElfTypes>::PrepareDebugInfo(
     const debug::DebugInfo& debug_info) {
@@ -263,7 +285,8 @@ std::unique_ptr<ThreadPool> ElfWriterQuick<ElfTypes>::PrepareDebugInfo(
         text_size_,
         builder_->GetDex()->Exists() ? builder_->GetDex()->GetAddress() : 0,
         dex_section_size_,
-        debug_info);
+        debug_info,
+        GetDebugInfoThreadPool());
     thread_pool->AddTask(self, debug_info_task_.get());
     thread_pool->StartWorkers(self);
   }
@@ -283,7 +306,7 @@ void ElfWriterQuick<ElfTypes>::WriteDebugInfo(const debug::DebugInfo& debug_info
   // The Strip method expects debug info to be last (mini-debug-info is not stripped).
   if (!debug_info.Empty() && compiler_options_.GetGenerateDebugInfo()) {
     // Generate all the debug information we can.
-    debug::WriteDebugInfo(builder_.get(), debug_info);
+    debug::WriteDebugInfo(builder_.get(), debug_info, GetDebugInfoThreadPool());
   }
 }
 
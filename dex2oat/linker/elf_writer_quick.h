@@ -30,8 +30,10 @@ class InstructionSetFeatures;
 
 namespace linker {
 
+// The debug info is generated using up to `thread_count` threads.
 std::unique_ptr<ElfWriter> CreateElfWriterQuick(const CompilerOptions& compiler_options,
-                                                File* elf_file);
+                                                File* elf_file,
+                                                size_t thread_count = 1u);
 
 }  // namespace linker
 }  // namespace art
@@ -28,10 +28,13 @@
 #include "common_compiler_driver_test.h"
 #include "driver/compiler_driver.h"
 #include "elf/elf_builder.h"
+#include "elf/xz_utils.h"
 #include "elf_writer_quick.h"
 #include "oat/elf_file.h"
 #include "oat/elf_file_impl.h"
 #include "oat/oat.h"
+#include "thread-current-inl.h"
+#include "thread_pool.h"
 
 namespace art {
 namespace linker {
@@ -413,5 +416,35 @@ TEST_F(ElfWriterTest, CheckDynamicSection) {
   }
 }
 
+TEST_F(ElfWriterTest, XzCompressParallel) {
+  // Some data which compresses well, spanning a few chunks.
+  std::vector<uint8_t> data(3 * kXzParallelChunkSize + 12345u);
+  for (size_t i = 0; i != data.size(); ++i) {
+    data[i] = static_cast<uint8_t>((i * i) >> 7);
+  }
+  std::vector<uint8_t> serial;
+  XzCompressParallel(ArrayRef<const uint8_t>(data),
+                     &serial,
+                     [](size_t n, const std::function<void(size_t)>& fn) {
+                       for (size_t i = n; i != 0u; --i) {
+                         fn(i - 1u);
+                       }
+                     });
+  std::unique_ptr<ThreadPool> thread_pool(ThreadPool::Create("XzCompressParallel test", 3u));
+  std::vector<uint8_t> parallel;
+  XzCompressParallel(ArrayRef<const uint8_t>(data),
+                     &parallel,
+                     [&](size_t n, const std::function<void(size_t)>& fn) {
+                       thread_pool->ForAll(Thread::Current(), n, fn);
+                     });
+  // The output does not depend on the order in which the chunks are compressed.
+  EXPECT_TRUE(serial == parallel);
+  EXPECT_LT(serial.size(), data.size());
+
+  std::vector<uint8_t> decompressed;
+  XzDecompress(ArrayRef<const uint8_t>(parallel), &decompressed);
+  EXPECT_TRUE(decompressed == data);
+}
+
 }  // namespace linker
 }  // namespace art
@@ -678,9 +678,11 @@ void ImageWriter::SetImageBinSlot(mirror::Object* object, BinSlot bin_slot) {
   switch (lw.GetState()) {
     case LockWord::kFatLocked:
       FALLTHROUGH_INTENDED;
+    case LockWord::kReserved:
+      FALLTHROUGH_INTENDED;
     case LockWord::kThinLocked: {
       std::ostringstream oss;
-      bool thin = (lw.GetState() == LockWord::kThinLocked);
+      bool thin = (lw.GetState() != LockWord::kFatLocked);
       oss << (thin ? "Thin" : "Fat")
           << " locked object " << object << "(" << object->PrettyTypeOf()
           << ") found during object copy";
@@ -1133,18 +1135,30 @@ class ImageWriter::PruneClassesVisitor : public ClassVisitor {
     // pruning these boot image classes, so all classes to remove are in the last set.
     DCHECK(!class_table->classes_.empty());
     ClassTable::ClassSet& last_class_set = class_table->classes_.back();
-    for (mirror::Class* klass : classes_to_prune_) {
-      uint32_t hash = klass->DescriptorHash();
-      auto it = last_class_set.FindWithHash(ClassTable::TableSlot(klass, hash), hash);
-      DCHECK(it != last_class_set.end());
-      last_class_set.erase(it);
-      DCHECK(std::none_of(class_table->classes_.begin(),
-                          class_table->classes_.end(),
-                          [klass, hash](ClassTable::ClassSet& class_set)
-                              REQUIRES_SHARED(Locks::mutator_lock_) {
-                            ClassTable::TableSlot slot(klass, hash);
-                            return class_set.FindWithHash(slot, hash) != class_set.end();
-                          }));
+    // Lock-free lookups may be probing the buckets of the last set, and erasing from it in place
+    // would shift the remaining classes under them. Fill a new set instead.
+    ClassTable::ClassSet new_class_set(last_class_set.GetMinLoadFactor(),
+                                       last_class_set.GetMaxLoadFactor());
+    for (const ClassTable::TableSlot& slot : last_class_set) {
+      mirror::Class* klass = slot.Read<kWithoutReadBarrier>().Ptr();
+      if (classes_to_prune_.find(klass) == classes_to_prune_.end()) {
+        new_class_set.Put(slot);
+      }
+    }
+    DCHECK_EQ(new_class_set.size() + classes_to_prune_.size(), last_class_set.size());
+    class_table->reader_view_.Replace(&last_class_set, std::move(new_class_set));
+    class_table->UpdateReaderView();
+    if (kIsDebugBuild) {
+      for (mirror::Class* klass : classes_to_prune_) {
+        uint32_t hash = klass->DescriptorHash();
+        DCHECK(std::none_of(class_table->classes_.begin(),
+                            class_table->classes_.end(),
+                            [klass, hash](ClassTable::ClassSet& class_set)
+                                REQUIRES_SHARED(Locks::mutator_lock_) {
+                              ClassTable::TableSlot slot(klass, hash);
+                              return class_set.FindWithHash(slot, hash) != class_set.end();
+                            }));
+      }
     }
     return defined_class_count_;
   }
@@ -1268,7 +1282,7 @@ void ImageWriter::PromoteWeakInternsToStrong(Thread* self) {
     uint32_t hash = static_cast<uint32_t>(s->GetStoredHashCode());
     intern_table->InsertStrong(s, hash);
   }
-  intern_table->weak_interns_.tables_.front().set_.clear();
+  intern_table->weak_interns_.Clear();
 }
 
 void ImageWriter::DumpImageClasses() {
@@ -2856,6 +2870,12 @@ void ImageWriter::CreateHeader(size_t oat_index, size_t component_count) {
       boot_image_components,
       boot_image_checksums,
       target_ptr_size_);
+  ImageHeader* header = reinterpret_cast<ImageHeader*>(image_info.image_.Begin());
+  if (image_info.GetBinSlotSize(Bin::kKnownDirty) != 0u) {
+    header->known_dirty_objects_end_ = dchecked_integral_cast<uint32_t>(
+        image_info.GetBinSlotOffset(Bin::kKnownDirty) +
+        image_info.GetBinSlotSize(Bin::kKnownDirty));
+  }
 }
 
 ArtMethod* ImageWriter::GetImageMethodAddress(ArtMethod* method) const {
@@ -21,6 +21,8 @@
 
 #include <algorithm>
 #include <memory>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "arch/arm64/instruction_set_features_arm64.h"
@@ -1028,6 +1030,11 @@ class OatWriter::OrderedMethodVisitor {
     return std::move(ordered_methods_);
   }
 
+ protected:
+  const OrderedMethodList& GetOrderedMethods() const {
+    return ordered_methods_;
+  }
+
  private:
   // List of compiled methods, sorted by the order defined in OrderedMethodData.
   // Methods can be inserted more than once in case of duplicated methods.
@@ -1580,8 +1587,11 @@ class OatWriter::WriteCodeMethodVisitor : public OrderedMethodVisitor {
         file_offset_(file_offset),
         class_linker_(Runtime::Current()->GetClassLinker()),
         dex_cache_(nullptr),
+        release_code_(writer->GetCompilerOptions().StreamCompiledCode()),
         no_thread_suspension_("OatWriter patching") {
     patched_code_.reserve(16 * KB);
+    // Deduplicated code may be shared with methods written to another oat file.
+    DCHECK_IMPLIES(release_code_, !writer->GetCompilerOptions().IsMultiImage());
     if (writer_->GetCompilerOptions().IsBootImage() ||
         writer_->GetCompilerOptions().IsBootImageExtension()) {
       // If we're creating the image, the address space must be ready so that we can apply patches.
@@ -1590,6 +1600,18 @@ class OatWriter::WriteCodeMethodVisitor : public OrderedMethodVisitor {
   }
 
   bool VisitStart() override {
+    if (release_code_) {
+      // Code deduplicated by the CompiledMethodStorage is shared by methods that are written
+      // separately when their stack maps, patches or intrinsic flag differ. Count the compiled
+      // methods using each code array, so that it is freed only after the last one is written.
+      std::unordered_set<const CompiledMethod*> seen_methods;
+      for (const OrderedMethodData& method_data : GetOrderedMethods()) {
+        const CompiledMethod* compiled_method = method_data.compiled_method;
+        if (seen_methods.insert(compiled_method).second) {
+          ++code_users_[compiled_method->GetQuickCode().data()];
+        }
+      }
+    }
     return true;
   }
 
@@ -1629,18 +1651,18 @@ class OatWriter::WriteCodeMethodVisitor : public OrderedMethodVisitor {
 
     // No thread suspension since dex_cache_ that may get invalidated if that occurs.
     ScopedAssertNoThreadSuspension tsc(__FUNCTION__);
-    DCHECK(HasCompiledCode(compiled_method)) << method_ref.PrettyMethod();
 
     // TODO: cleanup DCHECK_OFFSET_ to accept file_offset as parameter.
     size_t file_offset = file_offset_;  // Used by DCHECK_OFFSET_ macro.
     OutputStream* out = out_;
 
-    ArrayRef<const uint8_t> quick_code = compiled_method->GetQuickCode();
-    uint32_t code_size = quick_code.size() * sizeof(uint8_t);
-
     // Deduplicate code arrays.
     const OatMethodOffsets& method_offsets = oat_class->method_offsets_[method_offsets_index];
     if (method_offsets.code_offset_ > offset_) {
+      DCHECK(HasCompiledCode(compiled_method)) << method_ref.PrettyMethod();
+      ArrayRef<const uint8_t> quick_code = compiled_method->GetQuickCode();
+      uint32_t code_size = quick_code.size() * sizeof(uint8_t);
+
       offset_ = writer_->relative_patcher_->WriteThunks(out, offset_);
       if (offset_ == 0u) {
         ReportWriteFailure("relative call thunk", method_ref);
@@ -1846,6 +1868,15 @@ class OatWriter::WriteCodeMethodVisitor : public OrderedMethodVisitor {
     }
     DCHECK_OFFSET_();
 
+    // A method listed more than once has released its code at the first visit.
+    if (release_code_ && HasCompiledCode(compiled_method)) {
+      auto it = code_users_.find(compiled_method->GetQuickCode().data());
+      DCHECK(it != code_users_.end());
+      DCHECK_NE(it->second, 0u);
+      --it->second;
+      compiled_method->ReleaseWrittenQuickCode(/*is_last_user=*/ it->second == 0u);
+    }
+
     return true;
   }
 
@@ -1873,6 +1904,11 @@ class OatWriter::WriteCodeMethodVisitor : public OrderedMethodVisitor {
   ClassLinker* const class_linker_;
   ObjPtr<mirror::DexCache> dex_cache_;
   std::vector<uint8_t> patched_code_;
+  // Whether to free the code of each method once written.
+  const bool release_code_;
+  // With `release_code_`, the number of compiled methods using each code array that have not
+  // been written yet.
+  std::unordered_map<const uint8_t*, size_t> code_users_;
   const ScopedAssertNoThreadSuspension no_thread_suspension_;
 
   void ReportWriteFailure(const char* what, const MethodReference& method_ref) {
@@ -82,6 +82,16 @@ class DedupeSet<InKey, StoreKey, Alloc, HashType, HashFunc, kShard>::Shard {
     return store_key;
   }
 
+  void Remove(Thread* self, size_t hash, const InKey& in_key) REQUIRES(!lock_) {
+    MutexLock lock(self, lock_);
+    HashedKey<InKey> hashed_in_key(hash, &in_key);
+    auto it = keys_.find(hashed_in_key);
+    DCHECK(it != keys_.end());
+    const StoreKey* store_key = it->Key();
+    keys_.erase(it);
+    alloc_.Destroy(store_key);
+  }
+
   size_t Size(Thread* self) {
     MutexLock lock(self, lock_);
     return keys_.size();
@@ -208,6 +218,20 @@ const StoreKey* DedupeSet<InKey, StoreKey, Alloc, HashType, HashFunc, kShard>::A
   return shards_[shard_bin]->Add(self, shard_hash, key);
 }
 
+template <typename InKey,
+          typename StoreKey,
+          typename Alloc,
+          typename HashType,
+          typename HashFunc,
+          HashType kShard>
+void DedupeSet<InKey, StoreKey, Alloc, HashType, HashFunc, kShard>::Remove(
+    Thread* self, const InKey& key) {
+  HashType raw_hash = HashFunc()(key);
+  HashType shard_hash = raw_hash / kShard;
+  HashType shard_bin = raw_hash % kShard;
+  shards_[shard_bin]->Remove(self, shard_hash, key);
+}
+
 template <typename InKey,
           typename StoreKey,
           typename Alloc,
@@ -41,6 +41,10 @@ class DedupeSet {
   // Add a new key to the dedupe set if not present. Return the equivalent deduplicated stored key.
   const StoreKey* Add(Thread* self, const InKey& key);
 
+  // Remove the stored key equivalent to `key` from the dedupe set and destroy it. The key must be
+  // present and no longer referenced; `key` itself may be a view of the stored key.
+  void Remove(Thread* self, const InKey& key);
+
   DedupeSet(const char* set_name, const Alloc& alloc);
 
   ~DedupeSet();
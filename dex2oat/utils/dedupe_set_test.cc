@@ -87,6 +87,21 @@ TEST(DedupeSetTest, Test) {
     ASSERT_NE(array3, array1);
     ASSERT_TRUE(std::equal(test3.begin(), test3.end(), array3->begin()));
   }
+
+  ASSERT_EQ(2u, deduplicator.Size(self));
+  deduplicator.Remove(self, ArrayRef<const uint8_t>(*array1));
+  ASSERT_EQ(1u, deduplicator.Size(self));
+
+  // The removed key is allocated again.
+  {
+    uint8_t raw_test4[] = { 10u, 20u, 30u, 45u };
+    ArrayRef<const uint8_t> test4(raw_test4);
+    const std::vector<uint8_t>* array4 = deduplicator.Add(self, test4);
+    ASSERT_NE(array4, nullptr);
+    ASSERT_NE(array4, array3);
+    ASSERT_TRUE(std::equal(test4.begin(), test4.end(), array4->begin()));
+  }
+  ASSERT_EQ(2u, deduplicator.Size(self));
 }
 
 }  // namespace art
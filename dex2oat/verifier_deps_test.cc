@@ -492,6 +492,44 @@ TEST_F(VerifierDepsTest, EncodeDecode) {
   ASSERT_TRUE(verifier_deps_->Equals(decoded_deps));
 }
 
+TEST_F(VerifierDepsTest, EncodeDecodeSetVector) {
+  VerifyDexFile();
+
+  ASSERT_EQ(1u, NumberOfCompiledDexFiles());
+  ASSERT_TRUE(HasEachKindOfRecord());
+  const std::vector<bool>& verified_classes =
+      verifier_deps_->GetVerifiedClasses(*primary_dex_file_);
+
+  std::vector<uint8_t> buffer;
+  verifier_deps_->Encode(dex_files_, &buffer);
+  ASSERT_FALSE(buffer.empty());
+
+  // The assignability records of a verified class end where the next class starts, even if
+  // that class is not verified.
+  VerifierDeps decoded_deps(dex_files_, /*output_only=*/ false);
+  ASSERT_TRUE(decoded_deps.ParseStoredData(dex_files_, ArrayRef<const uint8_t>(buffer)));
+  ASSERT_TRUE(verifier_deps_->Equals(decoded_deps));
+
+  std::vector<std::vector<bool>> verified_classes_per_dex;
+  ASSERT_TRUE(VerifierDeps::ParseVerifiedClasses(
+      dex_files_, ArrayRef<const uint8_t>(buffer), &verified_classes_per_dex));
+  ASSERT_EQ(1u, verified_classes_per_dex.size());
+  ASSERT_EQ(verified_classes, verified_classes_per_dex[0]);
+
+  // The offsets of the classes must fit in the data.
+  const uint32_t deps_offset = reinterpret_cast<const uint32_t*>(buffer.data())[0];
+  std::vector<uint8_t> truncated(buffer.begin(), buffer.begin() + deps_offset + sizeof(uint32_t));
+  VerifierDeps truncated_deps(dex_files_, /*output_only=*/ false);
+  ASSERT_FALSE(truncated_deps.ParseStoredData(dex_files_, ArrayRef<const uint8_t>(truncated)));
+
+  // The end of the assignability records must be in the data.
+  std::vector<uint8_t> corrupted = buffer;
+  reinterpret_cast<uint32_t*>(corrupted.data() + deps_offset)[verified_classes.size()] =
+      corrupted.size() + 1u;
+  VerifierDeps corrupted_deps(dex_files_, /*output_only=*/ false);
+  ASSERT_FALSE(corrupted_deps.ParseStoredData(dex_files_, ArrayRef<const uint8_t>(corrupted)));
+}
+
 TEST_F(VerifierDepsTest, EncodeDecodeMulti) {
   VerifyDexFile("MultiDex");
 
@@ -672,6 +672,11 @@ class HashSet {
     return num_buckets_;
   }
 
+  // The buckets, including the empty ones. Valid until the hash set is resized or destroyed.
+  const T* data() const {
+    return data_;
+  }
+
  private:
   T& ElementForIndex(size_t index) {
     DCHECK_LT(index, NumBuckets());
@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_LIBARTBASE_BASE_HASH_SET_READER_VIEW_H_
+#define ART_LIBARTBASE_BASE_HASH_SET_READER_VIEW_H_
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "atomic.h"
+#include "hash_set.h"
+#include "iteration_range.h"
+#include "logging.h"
+#include "macros.h"
+
+namespace art {
+
+// Lock-free lookups in a sequence of HashSet<>s that are only modified by one writer at a time.
+//
+// The writer publishes an immutable view of the buckets of the sets whenever it adds, removes or
+// replaces a set. Readers probe the published buckets the same way as `HashSet<>::FindIndex()`.
+// Since readers may be probing them at any time, a published set must never be resized in place:
+// the writer replaces a full set with a bigger copy, see GrowIfFull(). The storage of replaced sets
+// and old views is only released with the HashSetReaderView. Moving a HashSet<> keeps its
+// storage, so the sets may be kept in a growing vector.
+//
+// Readers copy elements while the writer may be storing to them, so an element must be copied
+// with a single load, for example a pointer or a word with an atomic copy. If an element refers
+// to other data, the writer must make that data visible with a release fence before inserting
+// the element; FindLockFree() issues the pairing acquire fence. Inserting in place is safe, but
+// erasing in place moves other elements and readers may then miss them, so misses must be
+// confirmed by the writer if it ever erases from published sets.
+template <class HashSetType>
+class HashSetReaderView;
+
+template <class T, class EmptyFn, class HashFn, class Pred, class Alloc>
+class HashSetReaderView<HashSet<T, EmptyFn, HashFn, Pred, Alloc>> {
+ public:
+  using HashSetType = HashSet<T, EmptyFn, HashFn, Pred, Alloc>;
+
+  HashSetReaderView() : view_(nullptr) {}
+
+  // Publish the buckets of `get_set(entry)` for each entry in `sets`, in the same order.
+  // Must be called before any reader can see the sets and after each change of the sequence.
+  template <typename Range, typename GetSet>
+  void Publish(const Range& sets, GetSet&& get_set) {
+    std::unique_ptr<View> view(new View());
+    for (const auto& entry : sets) {
+      const HashSetType& set = get_set(entry);
+      view->sets.emplace_back(set.data(), set.NumBuckets());
+    }
+    // Pairs with the acquire load in FindLockFree(), making the view and the buckets visible.
+    view_.store(view.get(), std::memory_order_release);
+    views_.push_back(std::move(view));
+  }
+
+  // Replace `*set` with `new_set` and keep the old storage alive. Publish() must be called before
+  // the set is modified again.
+  void Replace(HashSetType* set, HashSetType&& new_set) {
+    set->swap(new_set);
+    retired_sets_.push_back(std::move(new_set));
+  }
+
+  // Make room for inserting one more element into `*set` without resizing it in place. Returns
+  // true if `*set` was replaced with a bigger copy, which must be published before the insertion.
+  bool GrowIfFull(HashSetType* set) {
+    if (set->size() < set->ElementsUntilExpand()) {
+      return false;
+    }
+    // Grow the same way as `HashSet<>::Expand()`.
+    HashSetType new_set(set->GetMinLoadFactor(), set->GetMaxLoadFactor());
+    new_set.reserve(
+        static_cast<size_t>(set->size() / set->GetMinLoadFactor() * set->GetMaxLoadFactor()));
+    for (const T& element : *set) {
+      new_set.Put(element);
+    }
+    DCHECK_LT(new_set.size(), new_set.ElementsUntilExpand());
+    Replace(set, std::move(new_set));
+    return true;
+  }
+
+  // Search the published sets from the last one for an element with the given `hash` for which
+  // `pred(element)` returns true. Returns an empty element if there is none. Optionally returns
+  // the number of searched sets in `num_searched_sets`.
+  template <typename Predicate>
+  T FindLockFree(size_t hash,
+                 Predicate&& pred,
+                 /*out*/ size_t* num_searched_sets = nullptr) const {
+    const View* view = view_.load(std::memory_order_acquire);
+    DCHECK(view != nullptr);
+    if (num_searched_sets != nullptr) {
+      *num_searched_sets = view->sets.size();
+    }
+    EmptyFn empty_fn;
+    for (const auto& [buckets, num_buckets] : ReverseRange(view->sets)) {
+      if (num_buckets == 0u) {
+        continue;
+      }
+      // Published sets are never full, so the probing ends at an empty bucket.
+      size_t index = hash % num_buckets;
+      while (true) {
+        // Copy the element, the writer may be storing to the bucket.
+        const T element(buckets[index]);
+        if (empty_fn.IsEmpty(element)) {
+          break;
+        }
+        // Pairs with the writer's release fence before the insertion.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (pred(element)) {
+          return element;
+        }
+        index = (index + 1u != num_buckets) ? index + 1u : 0u;
+      }
+    }
+    T result;
+    empty_fn.MakeEmpty(result);
+    return result;
+  }
+
+ private:
+  // The buckets and the number of buckets of each published set.
+  struct View {
+    std::vector<std::pair<const T*, size_t>> sets;
+  };
+
+  Atomic<const View*> view_;
+  // All published views and the replaced sets, readers may still be using them.
+  std::vector<std::unique_ptr<const View>> views_;
+  std::vector<HashSetType> retired_sets_;
+
+  DISALLOW_COPY_AND_ASSIGN(HashSetReaderView);
+};
+
+}  // namespace art
+
+#endif  // ART_LIBARTBASE_BASE_HASH_SET_READER_VIEW_H_
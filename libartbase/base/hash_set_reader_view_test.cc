@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hash_set_reader_view.h"
+
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace art {
+
+class HashSetReaderViewTest : public testing::Test {
+ protected:
+  // Zero is the empty element.
+  using Set = HashSet<size_t>;
+
+  HashSetReaderViewTest() : sets_(1u) {
+    Publish();
+  }
+
+  void Publish() {
+    view_.Publish(sets_, [](const Set& set) -> const Set& { return set; });
+  }
+
+  void Insert(size_t value) {
+    Set& set = sets_.back();
+    if (view_.GrowIfFull(&set)) {
+      Publish();
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    set.Insert(value);
+  }
+
+  void AddSet() {
+    sets_.emplace_back();
+    Publish();
+  }
+
+  size_t Find(size_t value, /*out*/ size_t* num_searched_sets = nullptr) const {
+    return view_.FindLockFree(std::hash<size_t>()(value),
+                              [value](size_t element) { return element == value; },
+                              num_searched_sets);
+  }
+
+  std::vector<Set> sets_;
+  HashSetReaderView<Set> view_;
+};
+
+TEST_F(HashSetReaderViewTest, FindLockFree) {
+  static constexpr size_t kNumValues = 1000u;
+  size_t num_searched_sets = 0u;
+  EXPECT_EQ(Find(1u, &num_searched_sets), 0u);
+  EXPECT_EQ(num_searched_sets, 1u);
+  for (size_t value = 1u; value <= kNumValues; ++value) {
+    if (value == kNumValues / 2u) {
+      AddSet();
+    }
+    Insert(value);
+  }
+  for (size_t value = 1u; value <= kNumValues; ++value) {
+    ASSERT_EQ(Find(value, &num_searched_sets), value);
+    EXPECT_EQ(num_searched_sets, 2u);
+  }
+  EXPECT_EQ(Find(kNumValues + 1u), 0u);
+
+  // The replaced set stays unpublished until Publish().
+  view_.Replace(&sets_.back(), Set());
+  EXPECT_EQ(Find(kNumValues), kNumValues);
+  Publish();
+  EXPECT_EQ(Find(kNumValues), 0u);
+  EXPECT_EQ(Find(1u), 1u);
+}
+
+// Readers never miss an element inserted before their lookup started, while the writer inserts
+// in place, replaces full sets with bigger copies and adds new sets.
+TEST_F(HashSetReaderViewTest, ConcurrentFindLockFree) {
+  static constexpr size_t kNumThreads = 4u;
+  static constexpr size_t kNumValues = 20000u;
+  static constexpr size_t kNewSetInterval = 3000u;
+  std::atomic<size_t> num_inserted(0u);
+  std::atomic<bool> done(false);
+  std::atomic<size_t> num_failures(0u);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i != kNumThreads; ++i) {
+    threads.emplace_back([&]() {
+      while (!done.load(std::memory_order_acquire)) {
+        size_t num = num_inserted.load(std::memory_order_acquire);
+        for (size_t value = 1u; value <= num; ++value) {
+          if (Find(value) != value) {
+            num_failures.fetch_add(1u, std::memory_order_relaxed);
+          }
+        }
+        if (Find(kNumValues + 1u) != 0u) {
+          num_failures.fetch_add(1u, std::memory_order_relaxed);
+        }
+      }
+    });
+  }
+  for (size_t value = 1u; value <= kNumValues; ++value) {
+    if (value % kNewSetInterval == 0u) {
+      AddSet();
+    }
+    Insert(value);
+    num_inserted.store(value, std::memory_order_release);
+  }
+  done.store(true, std::memory_order_release);
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(num_failures.load(std::memory_order_relaxed), 0u);
+}
+
+}  // namespace art
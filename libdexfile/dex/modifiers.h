@@ -81,6 +81,10 @@ static constexpr uint32_t kAccDefault =               0x00400000;  // method (ru
 // for native methods.
 static constexpr uint32_t kAccFastNative =            0x00080000;  // method (runtime; native only)
 static constexpr uint32_t kAccCriticalNative =        0x00100000;  // method (runtime; native only)
+// Set together with kAccFastNative for native methods annotated with
+// @dalvik.annotation.optimization.ReferenceFreeNative with build visibility. Reuses the value
+// of kAccMustCountLocks which is not used for native methods. Not valid for intrinsics.
+static constexpr uint32_t kAccReferenceFreeNative =   0x04000000;  // method (runtime; native only)
 
 // Set by the JIT when clearing profiling infos to denote that a method was previously warm.
 static constexpr uint32_t kAccPreviouslyWarm =        0x00800000;  // method (runtime)
@@ -97,6 +101,7 @@ static_assert(kAccPreCompiled == kAccPreviouslyWarm);
 
 // Set by the verifier for a method that could not be verified to follow structured locking.
 static constexpr uint32_t kAccMustCountLocks =        0x04000000;  // method (runtime)
+static_assert(kAccReferenceFreeNative == kAccMustCountLocks);
 
 // Set by the class linker for a method that has only one implementation for a
 // virtual call.
@@ -21,6 +21,7 @@
 
 #include "base/array_ref.h"
 #include "base/bit_utils.h"
+#include "base/casts.h"
 #include "base/globals.h"
 #include "base/leb128.h"
 #include "dwarf/writer.h"
@@ -41,10 +42,10 @@ static void XzInitCrc() {
   });
 }
 
-void XzCompress(ArrayRef<const uint8_t> src,
-                std::vector<uint8_t>* dst,
-                int level,
-                size_t block_size) {
+static void XzCompressStream(ArrayRef<const uint8_t> src,
+                             std::vector<uint8_t>* dst,
+                             int level,
+                             size_t block_size) {
   // Configure the compression library.
   XzInitCrc();
   CLzma2EncProps lzma2Props;
@@ -88,16 +89,98 @@ void XzCompress(ArrayRef<const uint8_t> src,
   // Compress.
   SRes res = Xz_Encode(&callbacks, &callbacks, &props, &callbacks);
   CHECK_EQ(res, SZ_OK);
+}
 
-  // Decompress the data back and check that we get the original.
+// Decompress the data back and check that we get the original.
+static void XzCheckRoundTrip(ArrayRef<const uint8_t> src, ArrayRef<const uint8_t> compressed) {
   if (kIsDebugBuild) {
     std::vector<uint8_t> decompressed;
-    XzDecompress(ArrayRef<const uint8_t>(*dst), &decompressed);
+    XzDecompress(compressed, &decompressed);
     DCHECK_EQ(decompressed.size(), src.size());
     DCHECK_EQ(memcmp(decompressed.data(), src.data(), src.size()), 0);
   }
 }
 
+void XzCompress(ArrayRef<const uint8_t> src,
+                std::vector<uint8_t>* dst,
+                int level,
+                size_t block_size) {
+  XzCompressStream(src, dst, level, block_size);
+  XzCheckRoundTrip(src, ArrayRef<const uint8_t>(*dst));
+}
+
+// Appends the blocks of the complete XZ `streams` to `dst` as a single stream.
+// Each stream consists of a 12 byte header, the blocks, the index and a 12 byte footer.
+// The index lists the sizes of the blocks, so the merged index is just their concatenation.
+static void XzMergeStreams(const std::vector<std::vector<uint8_t>>& streams,
+                           std::vector<uint8_t>* dst) {
+  constexpr size_t kHeaderSize = 12u;
+  constexpr size_t kFooterSize = 12u;
+  dwarf::Writer<> writer(dst);
+  writer.PushData(streams[0].data(), kHeaderSize);  // Identical for all streams.
+  std::vector<uint8_t> records;
+  size_t num_records = 0u;
+  for (const std::vector<uint8_t>& stream : streams) {
+    CHECK_GE(stream.size(), kHeaderSize + kFooterSize);
+    CHECK_EQ(memcmp(stream.data(), streams[0].data(), kHeaderSize), 0);
+    const uint8_t* footer = stream.data() + stream.size() - kFooterSize;
+    uint32_t backward_size;  // Little-endian, as is the rest of the format.
+    memcpy(&backward_size, footer + 4u, sizeof(backward_size));
+    size_t index_size = (static_cast<size_t>(backward_size) + 1u) * 4u;
+    CHECK_LE(kHeaderSize + index_size + kFooterSize, stream.size());
+    const uint8_t* index = footer - index_size;
+    writer.PushData(stream.data() + kHeaderSize, index - (stream.data() + kHeaderSize));
+    CHECK_EQ(index[0], 0u);  // Index indicator.
+    const uint8_t* ptr = index + 1u;
+    uint32_t count = DecodeUnsignedLeb128(&ptr);
+    const uint8_t* records_begin = ptr;
+    for (uint32_t i = 0; i != 2u * count; ++i) {
+      DecodeUnsignedLeb128(&ptr);  // Unpadded size and uncompressed size.
+    }
+    CHECK_LE(ptr, footer);
+    records.insert(records.end(), records_begin, ptr);
+    num_records += count;
+  }
+  // Write the index with the records of all the blocks.
+  size_t index_begin = writer.size();
+  writer.PushUint8(0);  // Index indicator.
+  writer.PushUleb128(dchecked_integral_cast<uint32_t>(num_records));
+  writer.PushData(records.data(), records.size());
+  writer.Pad(4);
+  size_t index_size = writer.size() - index_begin + 4u;
+  writer.PushUint32(CrcCalc(dst->data() + index_begin, writer.size() - index_begin));
+  // Write the footer: CRC32 of the backward size and the flags, which follow it.
+  size_t footer_begin = writer.size();
+  writer.PushUint32(0u);
+  writer.PushUint32(dchecked_integral_cast<uint32_t>(index_size / 4u - 1u));
+  writer.PushData(streams[0].data() + 6u, 2u);  // Stream flags, same as in the header.
+  writer.UpdateUint32(footer_begin, CrcCalc(dst->data() + footer_begin + 4u, 6u));
+  writer.PushData("YZ", 2u);
+}
+
+void XzCompressParallel(ArrayRef<const uint8_t> src,
+                        std::vector<uint8_t>* dst,
+                        const XzParallelFor& parallel_for,
+                        int level,
+                        size_t block_size) {
+  // The split does not depend on the scheduling of the chunks, so neither does the output.
+  const size_t num_chunks = RoundUp(src.size(), kXzParallelChunkSize) / kXzParallelChunkSize;
+  if (num_chunks <= 1u) {
+    XzCompress(src, dst, level, block_size);
+    return;
+  }
+  std::vector<std::vector<uint8_t>> streams(num_chunks);
+  parallel_for(num_chunks, [&](size_t i) {
+    size_t begin = i * kXzParallelChunkSize;
+    ArrayRef<const uint8_t> chunk =
+        src.SubArray(begin, std::min(kXzParallelChunkSize, src.size() - begin));
+    streams[i].reserve(chunk.size() / 4);
+    XzCompressStream(chunk, &streams[i], level, block_size);
+  });
+  XzMergeStreams(streams, dst);
+  XzCheckRoundTrip(src, ArrayRef<const uint8_t>(*dst));
+}
+
 void XzDecompress(ArrayRef<const uint8_t> src, std::vector<uint8_t>* dst) {
   static const size_t page_size = GetPageSizeSlow();
   CHECK_NE(page_size, 0U);
@@ -17,6 +17,7 @@
 #ifndef ART_LIBELFFILE_ELF_XZ_UTILS_H_
 #define ART_LIBELFFILE_ELF_XZ_UTILS_H_
 
+#include <functional>
 #include <vector>
 
 #include "base/array_ref.h"
@@ -31,6 +32,22 @@ void XzCompress(ArrayRef<const uint8_t> src,
                 int level = 1 /* speed */,
                 size_t block_size = kXzDefaultBlockSize);
 
+// Size of the independently compressed parts of the input of XzCompressParallel().
+constexpr size_t kXzParallelChunkSize = 1 * MB;
+
+// Calls `fn(i)` for each `i` in [0, n), possibly concurrently, and returns when all calls
+// are done.
+using XzParallelFor = std::function<void(size_t n, const std::function<void(size_t)>& fn)>;
+
+// Compresses `src` into a single XZ stream like XzCompress(), but splits the input into
+// chunks of kXzParallelChunkSize bytes which are compressed as separate XZ blocks using
+// `parallel_for`. The output does not depend on how `parallel_for` schedules the chunks.
+void XzCompressParallel(ArrayRef<const uint8_t> src,
+                        std::vector<uint8_t>* dst,
+                        const XzParallelFor& parallel_for,
+                        int level = 1 /* speed */,
+                        size_t block_size = kXzDefaultBlockSize);
+
 void XzDecompress(ArrayRef<const uint8_t> src, std::vector<uint8_t>* dst);
 
 }  // namespace art
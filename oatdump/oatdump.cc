@@ -27,6 +27,7 @@
 #include <optional>
 #include <set>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -44,6 +45,7 @@
 #include "base/bit_utils_iterator.h"
 #include "base/file_utils.h"
 #include "base/indenter.h"
+#include "base/mem_map.h"
 #include "base/os.h"
 #include "base/safe_map.h"
 #include "base/stats-inl.h"
@@ -85,6 +87,7 @@
 #include "oat/oat_file_assistant_context.h"
 #include "oat/oat_file_manager.h"
 #include "oat/stack_map.h"
+#include "profile/profile_compilation_info.h"
 #include "scoped_thread_state_change-inl.h"
 #include "stack.h"
 #include "stream/buffered_output_stream.h"
@@ -342,6 +345,7 @@ class OatDumperOptions {
  public:
   OatDumperOptions(bool dump_vmap,
                    bool dump_code_info_stack_maps,
+                   bool dump_repeated_code,
                    bool disassemble_code,
                    bool absolute_addresses,
                    const char* class_filter,
@@ -350,6 +354,7 @@ class OatDumperOptions {
                    bool list_methods,
                    bool dump_header_only,
                    bool dump_method_and_offset_as_json,
+                   const char* code_layout_profile,
                    const char* export_dex_location,
                    const char* app_image,
                    const char* oat_filename,
@@ -357,6 +362,7 @@ class OatDumperOptions {
                    uint32_t addr2instr)
       : dump_vmap_(dump_vmap),
         dump_code_info_stack_maps_(dump_code_info_stack_maps),
+        dump_repeated_code_(dump_repeated_code),
         disassemble_code_(disassemble_code),
         absolute_addresses_(absolute_addresses),
         class_filter_(class_filter),
@@ -365,6 +371,7 @@ class OatDumperOptions {
         list_methods_(list_methods),
         dump_header_only_(dump_header_only),
         dump_method_and_offset_as_json(dump_method_and_offset_as_json),
+        code_layout_profile_(code_layout_profile),
         export_dex_location_(export_dex_location),
         app_image_(app_image),
         oat_filename_(oat_filename != nullptr ? std::make_optional(oat_filename) : std::nullopt),
@@ -374,6 +381,7 @@ class OatDumperOptions {
 
   const bool dump_vmap_;
   const bool dump_code_info_stack_maps_;
+  const bool dump_repeated_code_;
   const bool disassemble_code_;
   const bool absolute_addresses_;
   const char* const class_filter_;
@@ -382,6 +390,7 @@ class OatDumperOptions {
   const bool list_methods_;
   const bool dump_header_only_;
   const bool dump_method_and_offset_as_json;
+  const char* const code_layout_profile_;
   const char* const export_dex_location_;
   const char* const app_image_;
   const std::optional<std::string> oat_filename_;
@@ -435,6 +444,9 @@ class OatDumper {
     if (options_.dump_method_and_offset_as_json) {
       return DumpMethodAndOffsetAsJson(os);
     }
+    if (options_.code_layout_profile_ != nullptr) {
+      return DumpCodeLayout(os);
+    }
 
     bool success = true;
     const OatHeader& oat_header = oat_file_.GetOatHeader();
@@ -730,6 +742,106 @@ class OatDumper {
     return true;
   }
 
+  // Reports how the code of the methods in the profile is spread over the pages of .text.
+  // Methods are grouped the way OatWriter bins them, so a method that is both startup and hot
+  // is only counted as startup.
+  bool DumpCodeLayout(std::ostream& os) {
+    ProfileCompilationInfo profile;
+    if (!profile.Load(options_.code_layout_profile_, /*clear_if_invalid=*/ false)) {
+      os << "Failed to load profile '" << options_.code_layout_profile_ << "'\n";
+      return false;
+    }
+
+    enum CodeLayoutGroup : size_t {
+      kStartup,
+      kHot,
+      kPostStartup,
+      kOther,
+      kNumCodeLayoutGroups
+    };
+    static constexpr const char* kGroupNames[] = { "startup", "hot", "post-startup", "other" };
+    struct GroupStats {
+      size_t num_methods = 0u;
+      size_t code_size = 0u;
+      std::set<size_t> pages;
+      // Deduplicated code is counted once per group.
+      std::set<uint32_t> code_offsets;
+    };
+    GroupStats groups[kNumCodeLayoutGroups];
+    // Offsets in the ELF file and in memory are congruent modulo the page size.
+    const size_t page_size = MemMap::GetPageSize();
+
+    bool success = true;
+    for (const OatDexFile* oat_dex_file : oat_dex_files_) {
+      CHECK(oat_dex_file != nullptr);
+      std::string error_msg;
+      const DexFile* const dex_file = OpenDexFile(oat_dex_file, &error_msg);
+      if (dex_file == nullptr) {
+        os << "Failed to open dex file '" << oat_dex_file->GetDexFileLocation() << "': "
+           << error_msg << "\n";
+        success = false;
+        continue;
+      }
+      ProfileCompilationInfo::ProfileIndexType profile_index = profile.FindDexFile(*dex_file);
+      for (ClassAccessor accessor : dex_file->GetClasses()) {
+        const OatFile::OatClass oat_class = oat_dex_file->GetOatClass(accessor.GetClassDefIndex());
+        uint32_t class_method_index = 0;
+        for (const ClassAccessor::Method& method : accessor.GetMethods()) {
+          const OatFile::OatMethod oat_method = oat_class.GetOatMethod(class_method_index++);
+          uint32_t code_size = oat_method.GetQuickCodeSize();
+          if (code_size == 0u) {
+            continue;
+          }
+          CodeLayoutGroup group = kOther;
+          uint32_t method_index = method.GetIndex();
+          if (profile_index != ProfileCompilationInfo::MaxProfileIndex()) {
+            if (profile.IsStartupMethod(profile_index, method_index)) {
+              group = kStartup;
+            } else if (profile.IsHotMethod(profile_index, method_index)) {
+              group = kHot;
+            } else if (profile.IsPostStartupMethod(profile_index, method_index)) {
+              group = kPostStartup;
+            }
+          }
+          GroupStats& stats = groups[group];
+          ++stats.num_methods;
+          uint32_t code_offset = AlignCodeOffset(oat_method.GetCodeOffset());
+          if (!stats.code_offsets.insert(code_offset).second) {
+            continue;
+          }
+          stats.code_size += code_size;
+          size_t code_begin = AdjustOffset(code_offset);
+          for (size_t page = code_begin / page_size;
+               page <= (code_begin + code_size - 1u) / page_size;
+               ++page) {
+            stats.pages.insert(page);
+          }
+        }
+      }
+    }
+
+    os << "CODE LAYOUT:\n";
+    os << "profile: " << options_.code_layout_profile_ << "\n";
+    os << "page size: " << page_size << "\n";
+    for (size_t i = 0; i != kNumCodeLayoutGroups; ++i) {
+      const GroupStats& stats = groups[i];
+      os << StringPrintf("%s: %zu methods, %zu bytes of code, %zu pages (%zu if packed)",
+                         kGroupNames[i],
+                         stats.num_methods,
+                         stats.code_size,
+                         stats.pages.size(),
+                         RoundUp(stats.code_size, page_size) / page_size);
+      if (!stats.pages.empty()) {
+        os << StringPrintf(", 0x%08zx-0x%08zx",
+                           *stats.pages.begin() * page_size,
+                           (*stats.pages.rbegin() + 1u) * page_size);
+      }
+      os << "\n";
+    }
+    os << std::flush;
+    return success;
+  }
+
   size_t ComputeSize(const void* oat_data) {
     if (reinterpret_cast<const uint8_t*>(oat_data) < oat_file_.Begin() ||
         reinterpret_cast<const uint8_t*>(oat_data) > oat_file_.End()) {
@@ -1286,6 +1398,9 @@ class OatDumper {
         uint32_t aligned_code_end = aligned_code_begin + code_size;
         if (AddStatsObject(code)) {
           stats_["Code"].AddBytes(code_size);
+          if (options_.dump_repeated_code_ && aligned_code_end <= oat_file_.Size()) {
+            AddRepeatedCodeStats(oat_file_.Begin() + aligned_code_begin, code_size);
+          }
         }
 
         if (options_.absolute_addresses_) {
@@ -1338,6 +1453,30 @@ class OatDumper {
     return success;
   }
 
+  // Counts the code covered by sequences of `kRepeatedCodeSequenceSize` bytes that were seen
+  // before, in this or another method. This estimates how much code an outliner could replace
+  // with calls to shared functions. Matches are not aligned to instruction boundaries on ISAs
+  // with variable length instructions, and may cover patched or PC-relative instructions.
+  void AddRepeatedCodeStats(const uint8_t* code, size_t code_size) {
+    static constexpr size_t kRepeatedCodeSequenceSize = 16u;
+    const size_t alignment = GetInstructionSetInstructionAlignment(instruction_set_);
+    size_t repeated_bytes = 0u;
+    size_t pos = 0u;
+    while (pos + kRepeatedCodeSequenceSize <= code_size) {
+      std::string_view sequence(reinterpret_cast<const char*>(code + pos),
+                                kRepeatedCodeSequenceSize);
+      if (seen_code_sequences_.insert(sequence).second) {
+        pos += alignment;
+      } else {
+        repeated_bytes += kRepeatedCodeSequenceSize;
+        pos += kRepeatedCodeSequenceSize;
+      }
+    }
+    if (repeated_bytes != 0u) {
+      stats_["Code"]["RepeatedSequences"].AddBytes(repeated_bytes);
+    }
+  }
+
   void DumpSpillMask(std::ostream& os, uint32_t spill_mask, bool is_float) {
     if (spill_mask == 0) {
       return;
@@ -1784,6 +1923,8 @@ class OatDumper {
   Disassembler* disassembler_;
   Stats stats_;
   std::unordered_set<const void*> seen_stats_objects_;
+  // Code sequences seen by AddRepeatedCodeStats(). These point into `oat_file_`.
+  std::unordered_set<std::string_view> seen_code_sequences_;
 };
 
 class ImageDumper {
@@ -3193,6 +3334,8 @@ struct OatdumpArgs : public CmdlineArgs {
       dump_vmap_ = false;
     } else if (option =="--dump:code_info_stack_maps") {
       dump_code_info_stack_maps_ = true;
+    } else if (option == "--dump:repeated_code") {
+      dump_repeated_code_ = true;
     } else if (option == "--no-disassemble") {
       disassemble_code_ = false;
     } else if (option =="--header-only") {
@@ -3227,6 +3370,8 @@ struct OatdumpArgs : public CmdlineArgs {
       imt_stat_dump_ = true;
     } else if (option == "--dump-method-and-offset-as-json") {
       dump_method_and_offset_as_json = true;
+    } else if (option.starts_with("--code-layout-profile=")) {
+      code_layout_profile_ = raw_option + strlen("--code-layout-profile=");
     } else {
       return kParseUnknownArgument;
     }
@@ -3344,6 +3489,10 @@ Options:
         "  --dump:code_info_stack_maps enables dumping of stack maps in CodeInfo sections.\n"
         "      Example: --dump:code_info_stack_maps\n"
         "\n"
+        "  --dump:repeated_code adds the size of code repeating sequences seen in other\n"
+        "      methods to the oat file stats, an estimate of the gains of code outlining.\n"
+        "      Example: --dump:repeated_code\n"
+        "\n"
         "  --no-disassemble may be used to disable disassembly.\n"
         "      Example: --no-disassemble\n"
         "\n"
@@ -3375,6 +3524,11 @@ Options:
         "                                    signatures ONLY, in a standard json format.\n"
         "      Example: --dump-method-and-offset-as-json\n"
         "\n"
+        "  --code-layout-profile=<file.prof>: dumps ONLY the number of .text pages holding\n"
+        "      the code of the startup, hot and post-startup methods of the profile, i.e. the\n"
+        "      code pages faulted in when running them, and the minimum if the code was packed.\n"
+        "      Example: --code-layout-profile=/data/misc/profiles/ref/com.example/primary.prof\n"
+        "\n"
         "  --export-dex-to=<directory>: may be used to export oat embedded dex files.\n"
         "      Example: --export-dex-to=/data/local/tmp\n"
         "\n"
@@ -3422,6 +3576,7 @@ Options:
   std::string imt_dump_;
   bool dump_vmap_ = true;
   bool dump_code_info_stack_maps_ = false;
+  bool dump_repeated_code_ = false;
   bool disassemble_code_ = true;
   bool symbolize_ = false;
   bool only_keep_debug_ = false;
@@ -3430,6 +3585,7 @@ Options:
   bool dump_header_only_ = false;
   bool imt_stat_dump_ = false;
   bool dump_method_and_offset_as_json = false;
+  const char* code_layout_profile_ = nullptr;
   uint32_t addr2instr_ = 0;
   const char* export_dex_location_ = nullptr;
   const char* app_image_ = nullptr;
@@ -3447,6 +3603,7 @@ struct OatdumpMain : public CmdlineMain<OatdumpArgs> {
 
     oat_dumper_options_.reset(new OatDumperOptions(args_->dump_vmap_,
                                                    args_->dump_code_info_stack_maps_,
+                                                   args_->dump_repeated_code_,
                                                    args_->disassemble_code_,
                                                    absolute_addresses,
                                                    args_->class_filter_,
@@ -3455,6 +3612,7 @@ struct OatdumpMain : public CmdlineMain<OatdumpArgs> {
                                                    args_->list_methods_,
                                                    args_->dump_header_only_,
                                                    args_->dump_method_and_offset_as_json,
+                                                   args_->code_layout_profile_,
                                                    args_->export_dex_location_,
                                                    args_->app_image_,
                                                    args_->oat_filename_,
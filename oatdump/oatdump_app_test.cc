@@ -16,6 +16,10 @@
 
 #include "oatdump_test.h"
 
+#include <numeric>
+
+#include "profile/profile_compilation_info.h"
+
 namespace art {
 
 // Oat file compiled with a boot image. oatdump invoked with a boot image.
@@ -84,6 +88,30 @@ TEST_P(OatDumpTest, TestDumpOatWithoutRuntimeDexSpecified) {
       GetParam(), kArgOatApp | kArgDexApp, {}, kExpectOat | kExpectCode | kExpectBssOffsetsForBcp));
 }
 
+// Oat file compiled with a profile. oatdump reports the code layout for the same profile.
+TEST_P(OatDumpTest, TestDumpCodeLayout) {
+  ProfileCompilationInfo profile;
+  std::vector<std::unique_ptr<const DexFile>> dex_files =
+      OpenTestDexFiles(GetAppBaseName().c_str());
+  for (const std::unique_ptr<const DexFile>& dex_file : dex_files) {
+    std::vector<uint16_t> method_indexes(dex_file->NumMethodIds() / 2u);
+    std::iota(method_indexes.begin(), method_indexes.end(), 0u);
+    ASSERT_TRUE(profile.AddMethodsForDex(
+        static_cast<ProfileCompilationInfo::MethodHotness::Flag>(
+            ProfileCompilationInfo::MethodHotness::kFlagHot |
+            ProfileCompilationInfo::MethodHotness::kFlagStartup),
+        dex_file.get(),
+        method_indexes.begin(),
+        method_indexes.end()));
+  }
+  ASSERT_TRUE(profile.Save(GetAppProfileName(), /*bytes_written=*/ nullptr));
+  ASSERT_TRUE(GenerateAppOdexFile(GetParam(), {"--profile-file=" + GetAppProfileName()}));
+  ASSERT_TRUE(Exec(GetParam(),
+                   kArgOatApp | kArgBootImage | kArgBcp | kArgIsa,
+                   {"--code-layout-profile=" + GetAppProfileName()},
+                   kExpectCodeLayout));
+}
+
 TEST_P(OatDumpTest, TestDumpAppImageWithBootImage) {
   TEST_DISABLED_WITHOUT_BAKER_READ_BARRIERS();  // GC bug, b/126305867
   const std::string app_image_arg = "--app-image-file=" + GetAppImageName();
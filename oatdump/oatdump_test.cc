@@ -53,6 +53,15 @@ TEST_P(OatDumpTest, TestNoDisassemble) {
                    kExpectImage | kExpectOat | kExpectCode));
 }
 
+TEST_P(OatDumpTest, TestDumpRepeatedCode) {
+  TEST_DISABLED_FOR_RISCV64();
+  std::string error_msg;
+  ASSERT_TRUE(Exec(GetParam(),
+                   kArgImage | kArgBcp | kArgIsa,
+                   {"--no-disassemble", "--dump:repeated_code"},
+                   kExpectImage | kExpectOat | kExpectCode | kExpectRepeatedCode));
+}
+
 TEST_P(OatDumpTest, TestListClasses) {
   TEST_DISABLED_FOR_RISCV64();
   TEST_DISABLED_FOR_ARM_AND_ARM64();
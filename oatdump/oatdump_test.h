@@ -119,6 +119,8 @@ class OatDumpTest : public CommonRuntimeTest, public ::testing::WithParamInterfa
     kExpectBssMappingsForBcp = 1 << 3,
     kExpectBssOffsetsForBcp = 1 << 4,
     kExpectMethodAndOffsetAsJson = 1 << 5,
+    kExpectCodeLayout = 1 << 6,
+    kExpectRepeatedCode = 1 << 7,
   };
 
   static std::string GetAppBaseName() {
@@ -131,6 +133,8 @@ class OatDumpTest : public CommonRuntimeTest, public ::testing::WithParamInterfa
 
   std::string GetAppOdexName() const { return tmp_dir_ + "/" + GetAppBaseName() + ".odex"; }
 
+  std::string GetAppProfileName() const { return tmp_dir_ + "/" + GetAppBaseName() + ".prof"; }
+
   ::testing::AssertionResult GenerateAppOdexFile(Flavor flavor,
                                                  const std::vector<std::string>& args = {}) const {
     std::string dex2oat_path =
@@ -212,6 +216,15 @@ class OatDumpTest : public CommonRuntimeTest, public ::testing::WithParamInterfa
                                                                               // differ between dex
                                                                               // files
     }
+    if ((expects & kExpectCodeLayout) != 0) {
+      expected_prefixes.push_back("CODE LAYOUT:");
+      expected_prefixes.push_back("startup: ");
+      expected_prefixes.push_back("other: ");
+    }
+    if ((expects & kExpectRepeatedCode) != 0) {
+      // Printed as a child of the "Code" stats, which is a child of the "OatFile" stats.
+      expected_prefixes.push_back("    RepeatedSequences ");
+    }
 
     std::vector<std::string> exec_argv = {file_path};
     if ((args & kArgSymbolize) != 0) {
@@ -676,6 +676,67 @@ TEST_F(StubTest, UnlockObject) {
   TestUnlockObject(this);
 }
 
+class StubReservationTest : public StubTest {
+ protected:
+  void SetUpRuntimeOptions(RuntimeOptions* options) override {
+    StubTest::SetUpRuntimeOptions(options);
+    options->push_back(std::make_pair("-XX:LockReservation=true", nullptr));
+  }
+};
+
+TEST_F(StubReservationTest, LockAndUnlockReservedObject) {
+  // The arm fast path leaves reserving unlocked objects to the runtime.
+#if defined(__i386__) || defined(__aarch64__) || (defined(__x86_64__) && !defined(__APPLE__))
+  if (gUseReadBarrier) {
+    GTEST_SKIP() << "Locks are not reserved with read barriers";
+  }
+  // This will lead to monitor error messages in the log.
+  ScopedLogSeverity sls(LogSeverity::FATAL);
+  static constexpr size_t kLockDepth = 3;
+
+  Thread* self = Thread::Current();
+
+  const uintptr_t art_quick_lock_object = StubTest::GetEntrypoint(self, kQuickLockObject);
+  const uintptr_t art_quick_unlock_object = StubTest::GetEntrypoint(self, kQuickUnlockObject);
+  ScopedObjectAccess soa(self);
+  StackHandleScope<1> hs(soa.Self());
+  Handle<mirror::String> obj(
+      hs.NewHandle(mirror::String::AllocFromModifiedUtf8(soa.Self(), "hello, world!")));
+  EXPECT_EQ(LockWord::LockState::kUnlocked, obj->GetLockWord(false).GetState());
+
+  // The first lock reserves the object, the owner then changes only the lock depth.
+  for (size_t i = 1; i <= kLockDepth; ++i) {
+    Invoke3(reinterpret_cast<size_t>(obj.Get()), 0U, 0U, art_quick_lock_object, self);
+    LockWord lock = obj->GetLockWord(false);
+    ASSERT_EQ(LockWord::LockState::kReserved, lock.GetState());
+    EXPECT_EQ(lock.ThinLockOwner(), self->GetThreadId());
+    EXPECT_EQ(lock.ReservedLockDepth(), i);
+  }
+  for (size_t i = kLockDepth; i != 0u; --i) {
+    Invoke3(reinterpret_cast<size_t>(obj.Get()), 0U, 0U, art_quick_unlock_object, self);
+    EXPECT_FALSE(self->IsExceptionPending());
+    LockWord lock = obj->GetLockWord(false);
+    ASSERT_EQ(LockWord::LockState::kReserved, lock.GetState());
+    EXPECT_EQ(lock.ReservedLockDepth(), i - 1u);
+  }
+
+  // The object stays reserved but is not held, so unlocking it is an illegal monitor state.
+  Invoke3(reinterpret_cast<size_t>(obj.Get()), 0U, 0U, art_quick_unlock_object, self);
+  EXPECT_TRUE(self->IsExceptionPending());
+  self->ClearException();
+  LockWord lock = obj->GetLockWord(false);
+  ASSERT_EQ(LockWord::LockState::kReserved, lock.GetState());
+  EXPECT_EQ(lock.ReservedLockDepth(), 0u);
+
+  // Test done.
+#else
+  LOG(INFO) << "Skipping reserved lock_object as I don't know how to do that on " << kRuntimeISA;
+  // Force-print to std::cout so it's also outside the logcat.
+  std::cout << "Skipping reserved lock_object as I don't know how to do that on " << kRuntimeISA
+            << std::endl;
+#endif
+}
+
 #if defined(__i386__) || defined(__arm__) || defined(__aarch64__) || \
     (defined(__x86_64__) && !defined(__APPLE__))
 extern "C" void art_quick_check_instance_of(void);
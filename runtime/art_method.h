@@ -486,6 +486,22 @@ class EXPORT ArtMethod final {
 #endif
   }
 
+  // Checks to see if the method was annotated with both @dalvik.annotation.optimization.FastNative
+  // and @dalvik.annotation.optimization.ReferenceFreeNative, i.e. the native code does not create
+  // any local references and the JNI stub does not need to push and pop a local reference frame.
+  bool IsReferenceFreeNative() const {
+    return IsReferenceFreeNative(GetAccessFlags());
+  }
+
+  static bool IsReferenceFreeNative(uint32_t access_flags) {
+    // The kAccReferenceFreeNative flag value overlaps the intrinsic ordinal bits.
+    if (IsIntrinsic(access_flags)) {
+      return false;
+    }
+    constexpr uint32_t mask = kAccReferenceFreeNative | kAccFastNative | kAccNative;
+    return (access_flags & mask) == mask;
+  }
+
   // Returns true if the method is managed (not native).
   bool IsManaged() const {
     return IsManaged(GetAccessFlags());
@@ -582,7 +598,8 @@ class EXPORT ArtMethod final {
     if (IsIntrinsic(access_flags)) {
       return false;
     }
-    return (access_flags & kAccMustCountLocks) != 0;
+    // Native methods use the same bit for kAccReferenceFreeNative.
+    return (access_flags & (kAccMustCountLocks | kAccNative)) == kAccMustCountLocks;
   }
 
   void ClearMustCountLocks() REQUIRES_SHARED(Locks::mutator_lock_) {
@@ -590,6 +607,7 @@ class EXPORT ArtMethod final {
   }
 
   void SetMustCountLocks() REQUIRES_SHARED(Locks::mutator_lock_) {
+    DCHECK(!IsNative());
     ClearAccessFlags(kAccSkipAccessChecks);
     AddAccessFlags(kAccMustCountLocks);
   }
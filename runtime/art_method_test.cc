@@ -157,4 +157,18 @@ TEST_F(ArtMethodTest, ArrayList) {
   self->ClearException();
 }
 
+TEST_F(ArtMethodTest, ReferenceFreeNativeFlags) {
+  constexpr uint32_t kFastNative = kAccNative | kAccFastNative;
+  EXPECT_FALSE(ArtMethod::IsReferenceFreeNative(kFastNative));
+  EXPECT_TRUE(ArtMethod::IsReferenceFreeNative(kFastNative | kAccReferenceFreeNative));
+  // Only valid together with @FastNative.
+  EXPECT_FALSE(ArtMethod::IsReferenceFreeNative(kAccNative | kAccReferenceFreeNative));
+  // The flag overlaps the intrinsic ordinal bits.
+  EXPECT_FALSE(
+      ArtMethod::IsReferenceFreeNative(kFastNative | kAccReferenceFreeNative | kAccIntrinsic));
+  // The flag shares its bit with kAccMustCountLocks, which is only valid for managed methods.
+  EXPECT_TRUE(ArtMethod::MustCountLocks(kAccMustCountLocks));
+  EXPECT_FALSE(ArtMethod::MustCountLocks(kFastNative | kAccReferenceFreeNative));
+}
+
 }  // namespace art
@@ -191,7 +191,10 @@ class EXPORT LOCKABLE Mutex : public BaseMutex {
   bool ExclusiveTryLock(Thread* self) TRY_ACQUIRE(true);
   bool TryLock(Thread* self) TRY_ACQUIRE(true) { return ExclusiveTryLock(self); }
   // Equivalent to ExclusiveTryLock, but retry for a short period before giving up.
-  bool ExclusiveTryLockWithSpinning(Thread* self) TRY_ACQUIRE(true);
+  // Waits for the mutex to be released at most `max_spins` times.
+  static constexpr size_t kDefaultMaxSpins = 5u;
+  bool ExclusiveTryLockWithSpinning(Thread* self, size_t max_spins = kDefaultMaxSpins)
+      TRY_ACQUIRE(true);
 
   // Release exclusive access.
   void ExclusiveUnlock(Thread* self) RELEASE();
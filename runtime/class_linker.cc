@@ -139,10 +139,12 @@
 #include "mirror/string-inl.h"
 #include "mirror/throwable.h"
 #include "mirror/var_handle.h"
+#include "monitor_contention_profile.h"
 #include "native/dalvik_system_DexFile.h"
 #include "nativehelper/scoped_local_ref.h"
 #include "nterp_helpers-inl.h"
 #include "nterp_helpers.h"
+#include "oat/code_info_cache.h"
 #include "oat/image-inl.h"
 #include "oat/jni_stub_hash_map-inl.h"
 #include "oat/oat.h"
@@ -156,6 +158,7 @@
 #include "runtime_callbacks.h"
 #include "scoped_assert_no_transaction_checks.h"
 #include "scoped_thread_state_change-inl.h"
+#include "stack_trace_frame_cache.h"
 #include "startup_completed_task.h"
 #include "thread-inl.h"
 #include "thread.h"
@@ -5043,11 +5046,12 @@ ObjPtr<mirror::Class> ClassLinker::LookupClass(Thread* self,
   return LookupClass(self, descriptor, ComputeModifiedUtf8Hash(descriptor), class_loader);
 }
 
-ObjPtr<mirror::Class> ClassLinker::LookupClass(Thread* self,
+ObjPtr<mirror::Class> ClassLinker::LookupClass([[maybe_unused]] Thread* self,
                                                std::string_view descriptor,
                                                size_t hash,
                                                ObjPtr<mirror::ClassLoader> class_loader) {
-  ReaderMutexLock mu(self, *Locks::classlinker_classes_lock_);
+  // No locks needed. The class table of a live class loader is never deleted, it is published
+  // by RegisterClassLoader() and ClassTable::Lookup() is lock-free.
   ClassTable* const class_table = ClassTableForClassLoader(class_loader);
   if (class_table != nullptr) {
     ObjPtr<mirror::Class> result = class_table->Lookup(descriptor, hash);
@@ -6498,8 +6502,9 @@ void ClassLinker::RegisterClassLoader(ObjPtr<mirror::ClassLoader> class_loader)
   Thread* const self = Thread::Current();
   ClassLoaderData data;
   data.weak_root = self->GetJniEnv()->GetVm()->AddWeakGlobalRef(self, class_loader);
-  // Create and set the class table.
+  // Create and set the class table. Lock-free lookups may use it as soon as it is set.
   data.class_table = new ClassTable;
+  std::atomic_thread_fence(std::memory_order_release);
   class_loader->SetClassTable(data.class_table);
   // Create and set the linear allocator.
   data.allocator = Runtime::Current()->CreateLinearAlloc();
@@ -11241,6 +11246,13 @@ void ClassLinker::CleanupClassLoaders() {
       PrepareToDeleteClassLoader(self, data, /*cleanup_cha=*/true);
     }
   }
+  // The methods and their code may be reused for other classes.
+  StackTraceFrameCache::InvalidateAll();
+  CodeInfoCache::Clear();
+  MonitorContentionProfile* contention_profile = Runtime::Current()->GetMonitorContentionProfile();
+  if (contention_profile != nullptr) {
+    contention_profile->Clear();
+  }
   for (const ClassLoaderData& data : to_delete) {
     delete data.allocator;
     delete data.class_table;
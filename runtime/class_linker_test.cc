@@ -27,6 +27,7 @@
 #include "base/pointer_size.h"
 #include "class_linker-inl.h"
 #include "class_root-inl.h"
+#include "class_table-inl.h"
 #include "common_runtime_test.h"
 #include "dex/dex_file_types.h"
 #include "dex/signature-inl.h"
@@ -58,6 +59,7 @@
 #include "mirror/var_handle.h"
 #include "scoped_thread_state_change-inl.h"
 #include "thread-current-inl.h"
+#include "thread_pool.h"
 
 namespace art HIDDEN {
 
@@ -1656,6 +1658,111 @@ TEST_F(ClassLinkerTest, JniShortName_JniLongName) {
   EXPECT_EQ("Java_java_lang_String_copyValueOf___3CII", m->JniLongName());
 }
 
+class ClassTableLookupTask : public Task {
+ public:
+  ClassTableLookupTask(ClassTable* table,
+                       const std::vector<std::string>* descriptors,
+                       const std::atomic<size_t>* num_inserted,
+                       const std::atomic<bool>* done,
+                       std::atomic<size_t>* num_failures)
+      : table_(table),
+        descriptors_(descriptors),
+        num_inserted_(num_inserted),
+        done_(done),
+        num_failures_(num_failures) {}
+
+  void Run(Thread* self) override {
+    ScopedObjectAccess soa(self);
+    while (!done_->load(std::memory_order_acquire)) {
+      // Every class inserted before must be found, whatever the writer does meanwhile.
+      size_t num_inserted = num_inserted_->load(std::memory_order_acquire);
+      for (size_t i = 0; i != num_inserted; ++i) {
+        const std::string& descriptor = (*descriptors_)[i];
+        ObjPtr<mirror::Class> klass =
+            table_->Lookup(descriptor, ComputeModifiedUtf8Hash(descriptor));
+        if (klass == nullptr || !klass->DescriptorEquals(descriptor)) {
+          num_failures_->fetch_add(1u, std::memory_order_relaxed);
+        }
+      }
+      if (table_->Lookup("LNotThere;", ComputeModifiedUtf8Hash("LNotThere;")) != nullptr) {
+        num_failures_->fetch_add(1u, std::memory_order_relaxed);
+      }
+      // Lookups through the class linker take no locks either.
+      if (Runtime::Current()->GetClassLinker()->LookupClass(
+              self, "Ljava/lang/Object;", /*class_loader=*/ nullptr) == nullptr) {
+        num_failures_->fetch_add(1u, std::memory_order_relaxed);
+      }
+      self->AllowThreadSuspension();
+    }
+  }
+
+  void Finalize() override {
+    delete this;
+  }
+
+ private:
+  ClassTable* const table_;
+  const std::vector<std::string>* const descriptors_;
+  const std::atomic<size_t>* const num_inserted_;
+  const std::atomic<bool>* const done_;
+  std::atomic<size_t>* const num_failures_;
+};
+
+// ClassTable::Lookup() does not take the table lock. Readers probe an immutable view of the
+// class set buckets while the writer inserts in place, replaces a full set by a bigger copy
+// or starts a new set with FreezeSnapshot(). Check that concurrent readers never miss a class
+// that was inserted before their lookup started.
+TEST_F(ClassLinkerTest, ConcurrentClassTableLookup) {
+  static constexpr size_t kNumThreads = 4u;
+  static constexpr size_t kSnapshotInterval = 300u;
+  Thread* self = Thread::Current();
+  std::vector<std::string> descriptors;
+  {
+    ScopedObjectAccess soa(self);
+    ClassFuncVisitor visitor([&](ObjPtr<mirror::Class> klass)
+                                 REQUIRES_SHARED(Locks::mutator_lock_) {
+      std::string temp;
+      descriptors.push_back(klass->GetDescriptor(&temp));
+      return true;
+    });
+    class_linker_->VisitClasses(&visitor);
+  }
+  ASSERT_GT(descriptors.size(), kSnapshotInterval);
+
+  ClassTable table;
+  std::atomic<size_t> num_inserted(0u);
+  std::atomic<bool> done(false);
+  std::atomic<size_t> num_failures(0u);
+  std::unique_ptr<ThreadPool> thread_pool(
+      ThreadPool::Create("Class table lookup test thread pool", kNumThreads));
+  for (size_t i = 0; i != kNumThreads; ++i) {
+    thread_pool->AddTask(
+        self, new ClassTableLookupTask(&table, &descriptors, &num_inserted, &done, &num_failures));
+  }
+  thread_pool->StartWorkers(self);
+  {
+    ScopedObjectAccess soa(self);
+    for (size_t i = 0; i != descriptors.size(); ++i) {
+      if (i % kSnapshotInterval == 0u) {
+        table.FreezeSnapshot();
+      }
+      ObjPtr<mirror::Class> klass =
+          class_linker_->LookupClass(self, descriptors[i], /*class_loader=*/ nullptr);
+      CHECK(klass != nullptr) << descriptors[i];
+      table.Insert(klass);
+      num_inserted.store(i + 1u, std::memory_order_release);
+    }
+  }
+  done.store(true, std::memory_order_release);
+  thread_pool->Wait(self, /*do_work=*/ false, /*may_hold_locks=*/ false);
+  thread_pool->StopWorkers(self);
+  EXPECT_EQ(num_failures.load(std::memory_order_relaxed), 0u);
+
+  ScopedObjectAccess soa(self);
+  EXPECT_EQ(table.NumReferencedZygoteClasses() + table.NumReferencedNonZygoteClasses(),
+            descriptors.size());
+}
+
 class ClassLinkerClassLoaderTest : public ClassLinkerTest {
  protected:
   // Verifies that the class identified by the given descriptor is loaded with
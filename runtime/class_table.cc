@@ -27,6 +27,14 @@ ClassTable::ClassTable() : lock_("Class loader classes", kClassLoaderClassesLock
   Runtime* const runtime = Runtime::Current();
   classes_.push_back(ClassSet(runtime->GetHashTableMinLoadFactor(),
                               runtime->GetHashTableMaxLoadFactor()));
+  // No other thread can see the table yet.
+  UpdateReaderView();
+}
+
+void ClassTable::UpdateReaderView() {
+  reader_view_.Publish(classes_, [](const ClassSet& class_set) -> const ClassSet& {
+    return class_set;
+  });
 }
 
 void ClassTable::FreezeSnapshot() {
@@ -36,6 +44,7 @@ void ClassTable::FreezeSnapshot() {
   const ClassSet& last_set = classes_.back();
   ClassSet new_set(last_set.GetMinLoadFactor(), last_set.GetMaxLoadFactor());
   classes_.push_back(std::move(new_set));
+  UpdateReaderView();
 }
 
 ObjPtr<mirror::Class> ClassTable::UpdateClass(ObjPtr<mirror::Class> klass, size_t hash) {
@@ -60,7 +69,8 @@ ObjPtr<mirror::Class> ClassTable::UpdateClass(ObjPtr<mirror::Class> klass, size_
   CHECK(!klass->IsTemp()) << klass->PrettyDescriptor();
   VerifyObject(klass);
   // Update the element in the hash set with the new class. This is safe to do since the descriptor
-  // doesn't change.
+  // doesn't change. Lock-free readers may load the new class right away, see InsertWithHash().
+  std::atomic_thread_fence(std::memory_order_release);
   *existing_it = slot;
   return existing;
 }
@@ -105,20 +115,21 @@ size_t ClassTable::NumReferencedNonZygoteClasses() const {
 }
 
 ObjPtr<mirror::Class> ClassTable::Lookup(std::string_view descriptor, size_t hash) {
-  DescriptorHashPair pair(descriptor, hash);
-  ReaderMutexLock mu(Thread::Current(), lock_);
+  DCHECK_EQ(ComputeModifiedUtf8Hash(descriptor), hash);
   // Search from the last table, assuming that apps shall search for their own classes
   // more often than for boot image classes. For prebuilt boot images, this also helps
   // by searching the large table from the framework boot image extension compiled as
   // single-image before the individual small tables from the primary boot image
   // compiled as multi-image.
-  for (ClassSet& class_set : ReverseRange(classes_)) {
-    auto it = class_set.FindWithHash(pair, hash);
-    if (it != class_set.end()) {
-      return it->Read();
-    }
-  }
-  return nullptr;
+  TableSlot slot = reader_view_.FindLockFree(
+      hash,
+      // NO_THREAD_SAFETY_ANALYSIS: Called by FindLockFree() with the mutator lock held.
+      [descriptor, hash](const TableSlot& candidate) NO_THREAD_SAFETY_ANALYSIS {
+        // No read barrier needed for the comparison, see `ClassDescriptorEquals`.
+        return candidate.MaskedHashEquals(static_cast<uint32_t>(hash)) &&
+               candidate.Read<kWithoutReadBarrier>()->DescriptorEquals(descriptor);
+      });
+  return slot.IsNull() ? nullptr : slot.Read();
 }
 
 void ClassTable::Insert(ObjPtr<mirror::Class> klass) {
@@ -127,7 +138,15 @@ void ClassTable::Insert(ObjPtr<mirror::Class> klass) {
 
 void ClassTable::InsertWithHash(ObjPtr<mirror::Class> klass, size_t hash) {
   WriterMutexLock mu(Thread::Current(), lock_);
-  classes_.back().InsertWithHash(TableSlot(klass, hash), hash);
+  ClassSet& class_set = classes_.back();
+  if (reader_view_.GrowIfFull(&class_set)) {
+    // Publish the new buckets before adding the class, so that it cannot be missed.
+    UpdateReaderView();
+  }
+  // Pairs with the acquire fence in `HashSetReaderView<>::FindLockFree()`. The slot itself is
+  // stored with a relaxed store, so the class must be fully constructed before it.
+  std::atomic_thread_fence(std::memory_order_release);
+  class_set.InsertWithHash(TableSlot(klass, hash), hash);
 }
 
 bool ClassTable::InsertStrongRoot(ObjPtr<mirror::Object> obj) {
@@ -179,6 +198,7 @@ void ClassTable::AddClassSet(ClassSet&& set) {
   // TODO: Make use of this in `ClassLinker::FindClass()`.
   DCHECK(!classes_.empty());
   classes_.insert(classes_.end() - 1, std::move(set));
+  UpdateReaderView();
 }
 
 void ClassTable::ClearStrongRoots() {
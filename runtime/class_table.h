@@ -23,6 +23,7 @@
 
 #include "base/gc_visited_arena_pool.h"
 #include "base/hash_set.h"
+#include "base/hash_set_reader_view.h"
 #include "base/macros.h"
 #include "base/mutex.h"
 #include "gc_root.h"
@@ -46,7 +47,10 @@ class ClassLoader;
 class Object;
 }  // namespace mirror
 
-// Each loader has a ClassTable
+// Each loader has a ClassTable.
+//
+// Lookups do not take any lock. Writers modify the class sets under `lock_` and publish their
+// buckets for lock-free readers with a HashSetReaderView<>, which never resizes them in place.
 class ClassTable {
  public:
   class TableSlot {
@@ -222,8 +226,8 @@ class ClassTable {
       REQUIRES_SHARED(Locks::mutator_lock_);
 
   // Return the first class that matches the descriptor. Returns null if there are none.
+  // Lock-free, see the class comment.
   ObjPtr<mirror::Class> Lookup(std::string_view descriptor, size_t hash)
-      REQUIRES(!lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
   // Return the first class that matches the descriptor of klass. Returns null if there are none.
@@ -276,6 +280,9 @@ class ClassTable {
   }
 
  private:
+  // Publish `classes_` for lock-free lookups after class sets were added or replaced.
+  void UpdateReaderView() REQUIRES(lock_);
+
   size_t CountDefiningLoaderClasses(ObjPtr<mirror::ClassLoader> defining_loader,
                                     const ClassSet& set) const
       REQUIRES(lock_)
@@ -296,6 +303,8 @@ class ClassTable {
   std::vector<GcRoot<mirror::Object>> strong_roots_ GUARDED_BY(lock_);
   // Keep track of oat files with GC roots associated with dex caches in `strong_roots_`.
   std::vector<const OatFile*> oat_files_ GUARDED_BY(lock_);
+  // The published buckets of `classes_` for lock-free lookups. Only modified under `lock_`.
+  HashSetReaderView<ClassSet> reader_view_;
 
   friend class linker::ImageWriter;  // for InsertWithoutLocks.
 };
@@ -1321,6 +1321,14 @@ static uint32_t GetNativeMethodAnnotationAccessFlags(const DexFile& dex_file,
     access_flags |= kAccCriticalNative;
   }
   CHECK_NE(access_flags, kAccFastNative | kAccCriticalNative);
+  // The annotation class is not a well-known class, there is nothing to check it against.
+  if (IsMethodBuildAnnotationPresent(
+          dex_file,
+          annotation_set,
+          "Ldalvik/annotation/optimization/ReferenceFreeNative;",
+          /*annotation_class=*/ nullptr)) {
+    access_flags |= kAccReferenceFreeNative;
+  }
   return access_flags;
 }
 
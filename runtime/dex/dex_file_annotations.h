@@ -83,6 +83,8 @@ bool IsMethodAnnotationPresent(ArtMethod* method,
 // is annotated with @dalvik.annotation.optimization.FastNative or
 // @dalvik.annotation.optimization.CriticalNative with build visibility.
 // If yes, return the associated access flags, i.e. kAccFastNative or kAccCriticalNative.
+// Also return kAccReferenceFreeNative if annotated with
+// @dalvik.annotation.optimization.ReferenceFreeNative with build visibility.
 EXPORT uint32_t GetNativeMethodAnnotationAccessFlags(const DexFile& dex_file,
                                                      const dex::ClassDef& class_def,
                                                      uint32_t method_index);
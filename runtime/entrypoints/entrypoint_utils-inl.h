@@ -509,7 +509,7 @@ static inline bool IsStringInit(const Instruction& instr, ArtMethod* caller)
 }
 
 LIBART_PROTECTED
-extern "C" size_t NterpGetMethod(Thread* self, ArtMethod* caller, const uint16_t* dex_pc_ptr);
+extern "C" size_t NterpResolveMethod(Thread* self, ArtMethod* caller, const uint16_t* dex_pc_ptr);
 
 template <InvokeType type>
 ArtMethod* FindMethodToCall(Thread* self,
@@ -528,10 +528,10 @@ ArtMethod* FindMethodToCall(Thread* self,
       return nullptr;
     }
     DCHECK(!self->IsExceptionPending());
-    // NterpGetMethod can suspend, so save this_object.
+    // NterpResolveMethod can suspend, so save this_object.
     StackHandleScope<1> hs(self);
     HandleWrapperObjPtr<mirror::Object> h_this(hs.NewHandleWrapper(this_object));
-    tls_value = NterpGetMethod(self, caller, reinterpret_cast<const uint16_t*>(&inst));
+    tls_value = NterpResolveMethod(self, caller, reinterpret_cast<const uint16_t*>(&inst));
     if (self->IsExceptionPending()) {
       return nullptr;
     }
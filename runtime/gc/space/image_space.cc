@@ -751,6 +751,7 @@ class ImageSpace::Loader {
     // avoid reading proc maps for a mapping failure and slowing everything down.
     // For the boot image, we have already reserved the memory and we load the image
     // into the `image_reservation`.
+    std::unique_ptr<LazyImageDecompressor> lazy_decompressor;
     MemMap map = LoadImageFile(image_filename,
                                image_location,
                                image_header,
@@ -759,6 +760,7 @@ class ImageSpace::Loader {
                                allow_direct_mapping,
                                logger,
                                image_reservation,
+                               &lazy_decompressor,
                                error_msg);
     if (!map.IsValid()) {
       DCHECK(!error_msg->empty());
@@ -807,6 +809,7 @@ class ImageSpace::Loader {
                                                      std::move(map),
                                                      std::move(bitmap),
                                                      image_end));
+    space->lazy_decompressor_ = std::move(lazy_decompressor);
     return space;
   }
 
@@ -987,6 +990,16 @@ class ImageSpace::Loader {
     return true;
   }
 
+  // Returns whether the boot image is loaded at the address the app image was compiled
+  // against, so that no boot image reference in the app image needs to be relocated.
+  static bool IsBootImageAtCompiledAddress(const ImageHeader& image_header) {
+    const std::vector<ImageSpace*>& boot_image_spaces =
+        Runtime::Current()->GetHeap()->GetBootImageSpaces();
+    return !boot_image_spaces.empty() &&
+           reinterpret_cast32<uint32_t>(boot_image_spaces.front()->Begin()) ==
+               image_header.GetBootImageBegin();
+  }
+
   static MemMap LoadImageFile(const char* image_filename,
                               const char* image_location,
                               const ImageHeader& image_header,
@@ -995,6 +1008,7 @@ class ImageSpace::Loader {
                               bool allow_direct_mapping,
                               TimingLogger* logger,
                               /*inout*/ MemMap* image_reservation,
+                              /*out*/ std::unique_ptr<LazyImageDecompressor>* lazy_decompressor,
                               /*out*/ std::string* error_msg) {
     TimingLogger::ScopedTiming timing("MapImageFile", logger);
 
@@ -1030,13 +1044,35 @@ class ImageSpace::Loader {
     // Reserve output and copy/decompress into it.
     // The reserved memory size is aligned up to kElfSegmentAlignment to ensure
     // that the next reserved area will be aligned to the value.
-    MemMap map = MemMap::MapAnonymous(image_location,
-                                      CondRoundUp<kPageSizeAgnostic>(image_header.GetImageSize(),
-                                                                     kElfSegmentAlignment),
-                                      PROT_READ | PROT_WRITE,
-                                      /*low_4gb=*/ true,
-                                      image_reservation,
-                                      error_msg);
+    const size_t map_size =
+        CondRoundUp<kPageSizeAgnostic>(image_header.GetImageSize(), kElfSegmentAlignment);
+    // Boot images are loaded into a reservation and relocated as a whole. Relocating an app
+    // image visits all of its objects, which would take a fault for each chunk right away,
+    // so only app images used at the address they were compiled for are decompressed lazily.
+    const bool try_lazy_decompression = is_compressed &&
+                                        image_reservation == nullptr &&
+                                        LazyImageDecompressor::IsSupported() &&
+                                        IsBootImageAtCompiledAddress(image_header);
+    MemMap map;
+    if (try_lazy_decompression) {
+      std::string unused_error_msg;
+      map = MemMap::MapAnonymous(image_location,
+                                 image_header.GetImageBegin(),
+                                 map_size,
+                                 PROT_READ | PROT_WRITE,
+                                 /*low_4gb=*/ true,
+                                 /*reuse=*/ false,
+                                 /*reservation=*/ nullptr,
+                                 &unused_error_msg);
+    }
+    if (!map.IsValid()) {
+      map = MemMap::MapAnonymous(image_location,
+                                 map_size,
+                                 PROT_READ | PROT_WRITE,
+                                 /*low_4gb=*/ true,
+                                 image_reservation,
+                                 error_msg);
+    }
     if (map.IsValid()) {
       const size_t stored_size = image_header.GetDataSize();
       MemMap temp_map = MemMap::MapFile(sizeof(ImageHeader) + stored_size,
@@ -1055,6 +1091,29 @@ class ImageSpace::Loader {
       Runtime::MadviseFileForRange(
           madvise_size_limit, temp_map.Size(), temp_map.Begin(), temp_map.End(), image_filename);
 
+      if (try_lazy_decompression && map.Begin() == image_header.GetImageBegin()) {
+        std::string lazy_error_msg;
+        *lazy_decompressor =
+            LazyImageDecompressor::Create(image_header, &map, &temp_map, &lazy_error_msg);
+        if (*lazy_decompressor != nullptr) {
+          // Decompress the header and the objects known to be written at startup right away
+          // instead of taking a fault for each of their chunks.
+          const size_t objects_begin = image_header.GetObjectsSection().Offset();
+          const size_t known_dirty_end = image_header.GetKnownDirtyObjectsEnd();
+          if (!(*lazy_decompressor)->Prefetch(0u, sizeof(ImageHeader), &lazy_error_msg) ||
+              (known_dirty_end != 0u &&
+               !(*lazy_decompressor)->Prefetch(objects_begin, known_dirty_end, &lazy_error_msg))) {
+            if (error_msg != nullptr) {
+              *error_msg = "Failed to decompress image block " + lazy_error_msg;
+            }
+            lazy_decompressor->reset();
+            return MemMap::Invalid();
+          }
+          return map;
+        }
+        VLOG(image) << "Not decompressing " << image_filename << " lazily: " << lazy_error_msg;
+      }
+
       if (is_compressed) {
         memcpy(map.Begin(), &image_header, sizeof(ImageHeader));
 
@@ -20,6 +20,7 @@
 #include "android-base/unique_fd.h"
 #include "base/array_ref.h"
 #include "gc/accounting/space_bitmap.h"
+#include "lazy_image_decompressor.h"
 #include "oat/image.h"
 #include "runtime.h"
 #include "space.h"
@@ -512,6 +513,10 @@ class ImageSpace : public MemMapSpace {
   const std::string image_location_;
   const std::vector<std::string> profile_files_;
 
+  // Decompresses the image on access if it was loaded lazily. Destroyed before the image memory
+  // is unmapped by the base class.
+  std::unique_ptr<LazyImageDecompressor> lazy_decompressor_;
+
   friend class Space;
 
  private:
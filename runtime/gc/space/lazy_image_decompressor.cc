@@ -0,0 +1,310 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "lazy_image_decompressor.h"
+
+#include <fcntl.h>
+#include <linux/userfaultfd.h>
+#include <poll.h>
+#include <pthread.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "android-base/logging.h"
+#include "android-base/stringprintf.h"
+#include "base/bit_utils.h"
+#include "base/systrace.h"
+#include "gc/collector/mark_compact.h"
+#include "runtime.h"
+
+namespace art HIDDEN {
+namespace gc {
+namespace space {
+
+using android::base::StringPrintf;
+
+// The live decompressors, to populate before a fork(). Held from the prepare handler of
+// pthread_atfork() until the fork() is done so that no image is registered in between.
+static std::mutex gDecompressorsLock;
+static std::vector<LazyImageDecompressor*>* gDecompressors = nullptr;
+
+bool LazyImageDecompressor::IsSupported() {
+  Runtime* runtime = Runtime::Current();
+  return runtime != nullptr &&
+         runtime->IsLazyImageDecompressionEnabled() &&
+         !runtime->IsZygote() &&
+         !runtime->IsAotCompiler() &&
+         KernelSupportsUffd();
+}
+
+std::unique_ptr<LazyImageDecompressor> LazyImageDecompressor::Create(
+    const ImageHeader& image_header,
+    MemMap* image_map,
+    MemMap* compressed_map,
+    std::string* error_msg) {
+  const size_t page_size = MemMap::GetPageSize();
+  DCHECK_ALIGNED_PARAM(image_map->Size(), page_size);
+  DCHECK_LE(image_header.GetImageSize(), image_map->Size());
+  auto block_range = image_header.GetBlocks(compressed_map->Begin());
+  ArrayRef<const ImageHeader::Block> blocks(block_range.begin(), image_header.GetBlockCount());
+
+  // Group the blocks into chunks that can be installed with whole pages.
+  std::vector<Chunk> chunks;
+  size_t chunk_begin = 0u;
+  size_t first_block = 0u;
+  size_t image_offset = sizeof(ImageHeader);
+  for (size_t i = 0; i != blocks.size(); ++i) {
+    const ImageHeader::Block& block = blocks[i];
+    if (block.GetImageOffset() != image_offset ||
+        block.GetDataOffset() + block.GetDataSize() > compressed_map->Size()) {
+      *error_msg =
+          StringPrintf("Unexpected image block %zu at offset %u", i, block.GetImageOffset());
+      return nullptr;
+    }
+    image_offset += block.GetImageSize();
+    const bool is_last = (i + 1u == blocks.size());
+    if (is_last || IsAlignedParam(image_offset, page_size)) {
+      size_t chunk_end = is_last ? image_map->Size() : image_offset;
+      chunks.push_back({chunk_begin, chunk_end, first_block, i + 1u, /*populated=*/ false});
+      chunk_begin = image_offset;
+      first_block = i + 1u;
+    }
+  }
+  if (image_offset != image_header.GetImageSize()) {
+    *error_msg = StringPrintf("Image blocks end at %zu instead of %zu",
+                              image_offset,
+                              image_header.GetImageSize());
+    return nullptr;
+  }
+
+  // Kernel mode faults must be resolved as well, a system call may read image memory that
+  // was never accessed. Without the privilege to handle them, decompress eagerly.
+  android::base::unique_fd uffd(syscall(__NR_userfaultfd, O_CLOEXEC | O_NONBLOCK));
+  if (uffd.get() < 0) {
+    *error_msg = StringPrintf("Failed to create userfaultfd: %s", strerror(errno));
+    return nullptr;
+  }
+  struct uffdio_api api = {.api = UFFD_API, .features = 0, .ioctls = 0};
+  if (ioctl(uffd.get(), UFFDIO_API, &api) != 0) {
+    *error_msg = StringPrintf("ioctl_userfaultfd: API: %s", strerror(errno));
+    return nullptr;
+  }
+  android::base::unique_fd stop_fd(eventfd(0, EFD_CLOEXEC));
+  if (stop_fd.get() < 0) {
+    *error_msg = StringPrintf("Failed to create eventfd: %s", strerror(errno));
+    return nullptr;
+  }
+  struct uffdio_register uffd_register;
+  uffd_register.range.start = reinterpret_cast<uintptr_t>(image_map->Begin());
+  uffd_register.range.len = image_map->Size();
+  uffd_register.mode = UFFDIO_REGISTER_MODE_MISSING;
+  if (ioctl(uffd.get(), UFFDIO_REGISTER, &uffd_register) != 0) {
+    *error_msg = StringPrintf("ioctl_userfaultfd: register image: %s", strerror(errno));
+    return nullptr;
+  }
+
+  std::unique_ptr<LazyImageDecompressor> decompressor(
+      new LazyImageDecompressor(image_map->Begin(),
+                                image_header.GetImageSize(),
+                                std::move(*compressed_map),
+                                blocks,
+                                std::move(chunks)));
+  decompressor->uffd_ = std::move(uffd);
+  decompressor->stop_fd_ = std::move(stop_fd);
+  decompressor->handler_thread_.reset(new std::thread([d = decompressor.get()]() { d->Run(); }));
+
+  static std::once_flag register_fork_handlers;
+  std::call_once(register_fork_handlers, []() {
+    gDecompressors = new std::vector<LazyImageDecompressor*>();
+    CHECK_EQ(pthread_atfork(PrepareForFork, FinishFork, FinishForkInChild), 0);
+  });
+  std::lock_guard<std::mutex> lock(gDecompressorsLock);
+  gDecompressors->push_back(decompressor.get());
+  return decompressor;
+}
+
+void LazyImageDecompressor::PrepareForFork() {
+  gDecompressorsLock.lock();
+  for (LazyImageDecompressor* decompressor : *gDecompressors) {
+    std::lock_guard<std::mutex> lock(decompressor->lock_);
+    for (Chunk& chunk : decompressor->chunks_) {
+      std::string error_msg;
+      if (!chunk.populated && !decompressor->Populate(&chunk, &error_msg)) {
+        LOG(FATAL) << "Failed to decompress image before fork: " << error_msg;
+        UNREACHABLE();
+      }
+    }
+  }
+}
+
+void LazyImageDecompressor::FinishFork() {
+  gDecompressorsLock.unlock();
+}
+
+void LazyImageDecompressor::FinishForkInChild() {
+  // The images are fully decompressed and the child does not inherit the registration nor
+  // the handler threads. Drop the state shared with the parent, writing to `stop_fd_` would
+  // stop the handler thread of the parent.
+  for (LazyImageDecompressor* decompressor : *gDecompressors) {
+    // The thread does not exist in the child, so it can be neither joined nor detached.
+    // Leak the std::thread object, its destructor would abort on a joinable thread.
+    UNUSED(decompressor->handler_thread_.release());
+    decompressor->stop_fd_.reset();
+    decompressor->uffd_.reset();
+  }
+  gDecompressorsLock.unlock();
+}
+
+LazyImageDecompressor::LazyImageDecompressor(uint8_t* image_begin,
+                                             size_t image_size,
+                                             MemMap&& compressed_map,
+                                             ArrayRef<const ImageHeader::Block> blocks,
+                                             std::vector<Chunk>&& chunks)
+    : image_begin_(image_begin),
+      image_size_(image_size),
+      compressed_map_(std::move(compressed_map)),
+      blocks_(blocks),
+      chunks_(std::move(chunks)) {}
+
+LazyImageDecompressor::~LazyImageDecompressor() {
+  {
+    std::lock_guard<std::mutex> lock(gDecompressorsLock);
+    auto it = std::find(gDecompressors->begin(), gDecompressors->end(), this);
+    DCHECK(it != gDecompressors->end());
+    gDecompressors->erase(it);
+  }
+  if (handler_thread_ == nullptr) {
+    // Disowned in a forked child, see FinishForkInChild().
+    return;
+  }
+  // Closing `uffd_` afterwards unregisters the image, so any page not decompressed by then
+  // reads as zero. The image is being unmapped anyway.
+  uint64_t value = 1u;
+  CHECK_EQ(TEMP_FAILURE_RETRY(write(stop_fd_.get(), &value, sizeof(value))),
+           static_cast<ssize_t>(sizeof(value)));
+  handler_thread_->join();
+}
+
+bool LazyImageDecompressor::Prefetch(size_t begin_offset,
+                                     size_t end_offset,
+                                     std::string* error_msg) {
+  std::lock_guard<std::mutex> lock(lock_);
+  for (Chunk& chunk : chunks_) {
+    if (chunk.begin < end_offset && begin_offset < chunk.end && !chunk.populated) {
+      if (!Populate(&chunk, error_msg)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+LazyImageDecompressor::Chunk* LazyImageDecompressor::FindChunk(size_t offset) {
+  auto it = std::upper_bound(chunks_.begin(),
+                             chunks_.end(),
+                             offset,
+                             [](size_t o, const Chunk& chunk) { return o < chunk.begin; });
+  DCHECK(it != chunks_.begin());
+  Chunk* chunk = &*(it - 1);
+  DCHECK_LT(offset, chunk->end);
+  return chunk;
+}
+
+bool LazyImageDecompressor::Populate(Chunk* chunk, std::string* error_msg) {
+  ScopedTrace trace("LZ4 decompress image chunk");
+  const size_t size = chunk->end - chunk->begin;
+  std::unique_ptr<uint8_t[]> buffer(new uint8_t[size]);
+  if (chunk->begin == 0u) {
+    // The header is stored uncompressed in front of the blocks.
+    memcpy(buffer.get(), compressed_map_.Begin(), sizeof(ImageHeader));
+  }
+  // Blocks decompress to `out_ptr + image offset`.
+  uint8_t* out_ptr = buffer.get() - chunk->begin;
+  for (size_t i = chunk->first_block; i != chunk->end_block; ++i) {
+    if (!blocks_[i].Decompress(out_ptr, compressed_map_.Begin(), error_msg)) {
+      return false;
+    }
+  }
+  const size_t data_end = std::min(chunk->end, image_size_);
+  std::fill(buffer.get() + (data_end - chunk->begin), buffer.get() + size, 0u);
+
+  size_t copied = 0u;
+  while (copied != size) {
+    struct uffdio_copy uffd_copy;
+    uffd_copy.dst = reinterpret_cast<uintptr_t>(image_begin_ + chunk->begin + copied);
+    uffd_copy.src = reinterpret_cast<uintptr_t>(buffer.get() + copied);
+    uffd_copy.len = size - copied;
+    uffd_copy.mode = 0;
+    uffd_copy.copy = 0;
+    if (ioctl(uffd_.get(), UFFDIO_COPY, &uffd_copy) == 0) {
+      break;
+    }
+    // The copy can be interrupted by concurrent changes to the address space.
+    if (errno != EAGAIN || uffd_copy.copy <= 0) {
+      *error_msg = StringPrintf("ioctl_userfaultfd: copy: %s", strerror(errno));
+      return false;
+    }
+    copied += static_cast<size_t>(uffd_copy.copy);
+  }
+  chunk->populated = true;
+  return true;
+}
+
+void LazyImageDecompressor::Run() {
+  pthread_setname_np(pthread_self(), "ImageDecompress");
+  struct pollfd fds[] = {
+      {.fd = uffd_.get(), .events = POLLIN, .revents = 0},
+      {.fd = stop_fd_.get(), .events = POLLIN, .revents = 0},
+  };
+  while (true) {
+    int ret = TEMP_FAILURE_RETRY(poll(fds, arraysize(fds), /*timeout=*/ -1));
+    CHECK_GT(ret, 0) << "poll: " << strerror(errno);
+    if (fds[1].revents != 0) {
+      return;
+    }
+    struct uffd_msg msg;
+    ssize_t size = TEMP_FAILURE_RETRY(read(uffd_.get(), &msg, sizeof(msg)));
+    if (size < 0 && errno == EAGAIN) {
+      continue;
+    }
+    CHECK_EQ(size, static_cast<ssize_t>(sizeof(msg))) << "read userfaultfd: " << strerror(errno);
+    if (msg.event != UFFD_EVENT_PAGEFAULT) {
+      continue;
+    }
+    size_t offset = msg.arg.pagefault.address - reinterpret_cast<uintptr_t>(image_begin_);
+    std::lock_guard<std::mutex> lock(lock_);
+    Chunk* chunk = FindChunk(offset);
+    if (chunk->populated) {
+      // Raced with Prefetch(), which woke the faulting thread up already.
+      continue;
+    }
+    std::string error_msg;
+    if (!Populate(chunk, &error_msg)) {
+      // The faulting thread cannot make progress without the data.
+      LOG(FATAL) << "Failed to decompress image on access: " << error_msg;
+      UNREACHABLE();
+    }
+  }
+}
+
+}  // namespace space
+}  // namespace gc
+}  // namespace art
@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_GC_SPACE_LAZY_IMAGE_DECOMPRESSOR_H_
+#define ART_RUNTIME_GC_SPACE_LAZY_IMAGE_DECOMPRESSOR_H_
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "android-base/unique_fd.h"
+#include "base/array_ref.h"
+#include "base/macros.h"
+#include "base/mem_map.h"
+#include "oat/image.h"
+
+namespace art HIDDEN {
+namespace gc {
+namespace space {
+
+// Decompresses the blocks of a compressed image when they are first accessed instead of when
+// the image is loaded. The image memory is registered with a userfaultfd in missing mode and a
+// handler thread resolves each fault by decompressing the blocks covering the faulting page
+// and installing them with UFFDIO_COPY.
+//
+// Compressed blocks never cross a multiple of ImageHeader::kCompressedBlockAlignment, and the
+// blocks between two page-aligned image offsets are decompressed together as one chunk.
+//
+// The userfaultfd also handles kernel mode faults, so that a system call reading image memory
+// that was never accessed waits for the data. Creating such a userfaultfd may need privileges
+// the process does not have, the image is then decompressed eagerly.
+//
+// The registration is not inherited over fork(), where untouched pages would read as zero in the
+// child. All images are fully decompressed before a fork() and the child disowns the handler
+// thread and the file descriptors of the parent. This is not used in the zygote.
+class LazyImageDecompressor {
+ public:
+  // Returns whether lazy decompression can be used for images in this process.
+  static bool IsSupported();
+
+  // Registers `image_map` so that its contents are decompressed from `compressed_map` on
+  // access, and takes ownership of `compressed_map`. `image_map` must not have been written.
+  // Returns null, leaving `compressed_map` untouched, if lazy decompression cannot be set up;
+  // the caller should then decompress the image eagerly.
+  static std::unique_ptr<LazyImageDecompressor> Create(const ImageHeader& image_header,
+                                                       MemMap* image_map,
+                                                       MemMap* compressed_map,
+                                                       std::string* error_msg);
+
+  ~LazyImageDecompressor();
+
+  // Decompresses the chunks overlapping the image range [begin_offset, end_offset) now.
+  bool Prefetch(size_t begin_offset, size_t end_offset, std::string* error_msg);
+
+ private:
+  // Consecutive blocks whose page-aligned extent shares no page with other blocks.
+  struct Chunk {
+    size_t begin;
+    size_t end;
+    size_t first_block;
+    size_t end_block;
+    bool populated;
+  };
+
+  LazyImageDecompressor(uint8_t* image_begin,
+                        size_t image_size,
+                        MemMap&& compressed_map,
+                        ArrayRef<const ImageHeader::Block> blocks,
+                        std::vector<Chunk>&& chunks);
+
+  void Run();
+  // Must be called with `lock_` held.
+  bool Populate(Chunk* chunk, std::string* error_msg);
+  Chunk* FindChunk(size_t offset);
+
+  // pthread_atfork() handlers decompressing all live images before a fork().
+  static void PrepareForFork();
+  static void FinishFork();
+  static void FinishForkInChild();
+
+  uint8_t* const image_begin_;
+  // Size of the image data, the mapping beyond it is zero filled.
+  const size_t image_size_;
+  MemMap compressed_map_;
+  // The block table, stored in `compressed_map_`.
+  const ArrayRef<const ImageHeader::Block> blocks_;
+  std::vector<Chunk> chunks_;
+
+  // Guards the `populated` flags of the chunks. The handler thread is not attached to the
+  // runtime, so this cannot be an art::Mutex.
+  std::mutex lock_;
+
+  android::base::unique_fd uffd_;
+  android::base::unique_fd stop_fd_;
+  // Null in a forked child, which does not have the thread.
+  std::unique_ptr<std::thread> handler_thread_;
+
+  DISALLOW_COPY_AND_ASSIGN(LazyImageDecompressor);
+};
+
+}  // namespace space
+}  // namespace gc
+}  // namespace art
+
+#endif  // ART_RUNTIME_GC_SPACE_LAZY_IMAGE_DECOMPRESSOR_H_
@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "lazy_image_decompressor.h"
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <limits>
+#include <vector>
+
+#include "base/bit_utils.h"
+#include "base/globals.h"
+#include "base/mem_map.h"
+#include "common_runtime_test.h"
+#include "gc/collector/mark_compact.h"
+#include "oat/image.h"
+
+namespace art HIDDEN {
+namespace gc {
+namespace space {
+
+class LazyImageDecompressorTest : public CommonRuntimeTest {
+ protected:
+  static constexpr size_t kChunkSize = ImageHeader::kCompressedBlockAlignment;
+  // Four chunks, the last one partially filled.
+  static constexpr size_t kImageSize = 3u * kChunkSize + 1000u;
+
+  void SetUp() override {
+    CommonRuntimeTest::SetUp();
+    image_data_.resize(kImageSize);
+    for (size_t i = 0; i != kImageSize; ++i) {
+      image_data_[i] = static_cast<uint8_t>((i * 7u) ^ (i >> 12));
+    }
+  }
+
+  // Writes `image_data_` as an LZ4 compressed image and maps the resulting file.
+  MemMap WriteCompressedImage(/*out*/ ImageHeader* header) {
+    ImageSection sections[ImageHeader::kSectionCount];
+    *header = ImageHeader(/*image_reservation_size=*/ RoundUp(kImageSize, kElfSegmentAlignment),
+                          /*component_count=*/ 1u,
+                          /*image_begin=*/ 0u,
+                          kImageSize,
+                          sections,
+                          /*image_roots=*/ 0u,
+                          /*oat_checksum=*/ 0u,
+                          /*oat_file_begin=*/ 0u,
+                          /*oat_data_begin=*/ 0u,
+                          /*oat_data_end=*/ 0u,
+                          /*oat_file_end=*/ 0u,
+                          /*boot_image_begin=*/ 0u,
+                          /*boot_image_size=*/ 0u,
+                          /*boot_image_component_count=*/ 0u,
+                          /*boot_image_checksum=*/ 0u,
+                          kRuntimePointerSize);
+    ImageFileGuard image_file;
+    image_file.reset(OS::CreateEmptyFile(image_file_.GetFilename().c_str()));
+    std::string error_msg;
+    CHECK(header->WriteData(image_file,
+                            image_data_.data(),
+                            /*bitmap_data=*/ nullptr,
+                            ImageHeader::kStorageModeLZ4,
+                            /*max_image_block_size=*/ std::numeric_limits<uint32_t>::max(),
+                            /*update_checksum=*/ false,
+                            &error_msg)) << error_msg;
+    CHECK(image_file.WriteHeaderAndClose(image_file_.GetFilename(), header, &error_msg))
+        << error_msg;
+    std::unique_ptr<File> file(OS::OpenFileForReading(image_file_.GetFilename().c_str()));
+    CHECK(file != nullptr);
+    MemMap map = MemMap::MapFile(file->GetLength(),
+                                 PROT_READ,
+                                 MAP_PRIVATE,
+                                 file->Fd(),
+                                 /*start=*/ 0,
+                                 /*low_4gb=*/ false,
+                                 image_file_.GetFilename().c_str(),
+                                 &error_msg);
+    CHECK(map.IsValid()) << error_msg;
+    return map;
+  }
+
+  // Returns whether each chunk of `image_map` is backed by memory, that is decompressed.
+  static std::vector<bool> GetPopulatedChunks(const MemMap& image_map) {
+    const size_t page_size = MemMap::GetPageSize();
+    std::vector<unsigned char> residency(image_map.Size() / page_size);
+    CHECK_EQ(mincore(image_map.Begin(), image_map.Size(), residency.data()), 0);
+    std::vector<bool> populated;
+    for (size_t offset = 0; offset < image_map.Size(); offset += kChunkSize) {
+      populated.push_back((residency[offset / page_size] & 1u) != 0u);
+    }
+    return populated;
+  }
+
+  ScratchFile image_file_;
+  std::vector<uint8_t> image_data_;
+};
+
+TEST_F(LazyImageDecompressorTest, DecompressOnAccess) {
+  if (!KernelSupportsUffd()) {
+    GTEST_SKIP() << "userfaultfd is not supported";
+  }
+  ImageHeader header;
+  MemMap compressed_map = WriteCompressedImage(&header);
+  ASSERT_EQ(header.GetBlockCount(), 4u);
+
+  std::string error_msg;
+  MemMap image_map = MemMap::MapAnonymous("lazy image",
+                                          RoundUp(kImageSize, MemMap::GetPageSize()),
+                                          PROT_READ | PROT_WRITE,
+                                          /*low_4gb=*/ false,
+                                          &error_msg);
+  ASSERT_TRUE(image_map.IsValid()) << error_msg;
+  std::unique_ptr<LazyImageDecompressor> decompressor =
+      LazyImageDecompressor::Create(header, &image_map, &compressed_map, &error_msg);
+  ASSERT_TRUE(decompressor != nullptr) << error_msg;
+  EXPECT_EQ(GetPopulatedChunks(image_map), std::vector<bool>({false, false, false, false}));
+
+  // Prefetching the header only decompresses the first chunk.
+  ASSERT_TRUE(decompressor->Prefetch(0u, sizeof(ImageHeader), &error_msg)) << error_msg;
+  EXPECT_EQ(GetPopulatedChunks(image_map), std::vector<bool>({true, false, false, false}));
+  EXPECT_EQ(memcmp(image_map.Begin(), &header, sizeof(ImageHeader)), 0);
+
+  // Reading from the third chunk decompresses only that chunk.
+  const size_t offset = 2u * kChunkSize + 5u;
+  EXPECT_EQ(image_map.Begin()[offset], image_data_[offset]);
+  EXPECT_EQ(GetPopulatedChunks(image_map), std::vector<bool>({true, false, true, false}));
+
+  // A forked child sees the whole image, not zero pages, and can destroy the decompressor
+  // without touching the handler thread of the parent.
+  pid_t pid = fork();
+  if (pid == 0) {
+    bool same = memcmp(image_map.Begin() + sizeof(ImageHeader),
+                       image_data_.data() + sizeof(ImageHeader),
+                       kImageSize - sizeof(ImageHeader)) == 0;
+    decompressor.reset();
+    _exit(same ? 0 : 1);
+  }
+  ASSERT_GT(pid, 0);
+  int status;
+  ASSERT_EQ(TEMP_FAILURE_RETRY(waitpid(pid, &status, 0)), pid);
+  ASSERT_TRUE(WIFEXITED(status));
+  EXPECT_EQ(WEXITSTATUS(status), 0);
+  EXPECT_EQ(GetPopulatedChunks(image_map), std::vector<bool>({true, true, true, true}));
+
+  // The remainder of the mapping reads as zero.
+  for (size_t i = kImageSize; i != image_map.Size(); ++i) {
+    ASSERT_EQ(image_map.Begin()[i], 0u) << i;
+  }
+  EXPECT_EQ(memcmp(image_map.Begin() + sizeof(ImageHeader),
+                   image_data_.data() + sizeof(ImageHeader),
+                   kImageSize - sizeof(ImageHeader)),
+            0);
+}
+
+}  // namespace space
+}  // namespace gc
+}  // namespace art
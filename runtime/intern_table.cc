@@ -103,6 +103,26 @@ void InternTable::VisitRoots(RootVisitor* visitor, VisitRootFlags flags) {
   // Note: we deliberately don't visit the weak_interns_ table and the immutable image roots.
 }
 
+bool InternTable::CanReadWeakInternsLockFree(Thread* self) const {
+  // With the read barrier, weak reference access is disabled with a checkpoint, so it cannot
+  // change during a lookup. Otherwise, weak reads are disallowed in a GC pause and only allowed
+  // again with a release store after sweeping.
+  return gUseReadBarrier
+      ? self->GetWeakRefAccessEnabled()
+      : weak_root_state_.load(std::memory_order_acquire) == gc::kWeakRootStateNormal;
+}
+
+template <typename Key>
+ObjPtr<mirror::String> InternTable::LookupStrongLockFree(const Key& key,
+                                                         uint32_t hash,
+                                                         size_t* num_searched_frozen_tables) {
+  return strong_interns_.FindLockFree(key, hash, num_searched_frozen_tables);
+}
+
+ObjPtr<mirror::String> InternTable::LookupWeakLockFree(ObjPtr<mirror::String> s, uint32_t hash) {
+  return weak_interns_.FindLockFree(GcRoot<mirror::String>(s), hash);
+}
+
 ObjPtr<mirror::String> InternTable::LookupWeak(Thread* self, ObjPtr<mirror::String> s) {
   DCHECK(s != nullptr);
   // `String::GetHashCode()` ensures that the stored hash is calculated.
@@ -115,6 +135,10 @@ ObjPtr<mirror::String> InternTable::LookupStrong(Thread* self, ObjPtr<mirror::St
   DCHECK(s != nullptr);
   // `String::GetHashCode()` ensures that the stored hash is calculated.
   uint32_t hash = static_cast<uint32_t>(s->GetHashCode());
+  ObjPtr<mirror::String> result = LookupStrongLockFree(GcRoot<mirror::String>(s), hash);
+  if (result != nullptr) {
+    return result;
+  }
   MutexLock mu(self, *Locks::intern_table_lock_);
   return strong_interns_.Find(s, hash);
 }
@@ -123,8 +147,13 @@ ObjPtr<mirror::String> InternTable::LookupStrong(Thread* self,
                                                  uint32_t utf16_length,
                                                  const char* utf8_data) {
   uint32_t hash = Utf8String::Hash(utf16_length, utf8_data);
+  Utf8String string(utf16_length, utf8_data);
+  ObjPtr<mirror::String> result = LookupStrongLockFree(string, hash);
+  if (result != nullptr) {
+    return result;
+  }
   MutexLock mu(self, *Locks::intern_table_lock_);
-  return strong_interns_.Find(Utf8String(utf16_length, utf8_data), hash);
+  return strong_interns_.Find(string, hash);
 }
 
 ObjPtr<mirror::String> InternTable::LookupWeakLocked(ObjPtr<mirror::String> s) {
@@ -191,7 +220,9 @@ void InternTable::WaitUntilAccessible(Thread* self) {
   {
     ScopedThreadSuspension sts(self, ThreadState::kWaitingWeakGcRootRead);
     MutexLock mu(self, *Locks::intern_table_lock_);
-    while ((!gUseReadBarrier && weak_root_state_ == gc::kWeakRootStateNoReadsOrWrites) ||
+    while ((!gUseReadBarrier &&
+            weak_root_state_.load(std::memory_order_relaxed) ==
+                gc::kWeakRootStateNoReadsOrWrites) ||
            (gUseReadBarrier && !self->GetWeakRefAccessEnabled())) {
       weak_intern_condition_.Wait(self);
     }
@@ -220,7 +251,8 @@ ObjPtr<mirror::String> InternTable::Insert(ObjPtr<mirror::String> s,
       return strong;
     }
     if (gUseReadBarrier ? self->GetWeakRefAccessEnabled()
-                        : weak_root_state_ != gc::kWeakRootStateNoReadsOrWrites) {
+                        : weak_root_state_.load(std::memory_order_relaxed) !=
+                              gc::kWeakRootStateNoReadsOrWrites) {
       break;
     }
     num_searched_strong_frozen_tables = strong_interns_.tables_.size() - 1u;
@@ -232,7 +264,7 @@ ObjPtr<mirror::String> InternTable::Insert(ObjPtr<mirror::String> s,
     WaitUntilAccessible(self);
   }
   if (!gUseReadBarrier) {
-    CHECK_EQ(weak_root_state_, gc::kWeakRootStateNormal);
+    CHECK_EQ(weak_root_state_.load(std::memory_order_relaxed), gc::kWeakRootStateNormal);
   } else {
     CHECK(self->GetWeakRefAccessEnabled());
   }
@@ -254,15 +286,10 @@ ObjPtr<mirror::String> InternTable::InternStrong(uint32_t utf16_length, const ch
   DCHECK(utf8_data != nullptr);
   uint32_t hash = Utf8String::Hash(utf16_length, utf8_data);
   Thread* self = Thread::Current();
-  ObjPtr<mirror::String> s;
+  // Try to avoid allocation. A miss in the last table is confirmed by Insert() under the lock.
   size_t num_searched_strong_frozen_tables;
-  {
-    // Try to avoid allocation. If we need to allocate, release the mutex before the allocation.
-    MutexLock mu(self, *Locks::intern_table_lock_);
-    DCHECK(!strong_interns_.tables_.empty());
-    num_searched_strong_frozen_tables = strong_interns_.tables_.size() - 1u;
-    s = strong_interns_.Find(Utf8String(utf16_length, utf8_data), hash);
-  }
+  ObjPtr<mirror::String> s = LookupStrongLockFree(
+      Utf8String(utf16_length, utf8_data), hash, &num_searched_strong_frozen_tables);
   if (s != nullptr) {
     return s;
   }
@@ -293,7 +320,13 @@ ObjPtr<mirror::String> InternTable::InternStrong(ObjPtr<mirror::String> s) {
   DCHECK(s != nullptr);
   // `String::GetHashCode()` ensures that the stored hash is calculated.
   uint32_t hash = static_cast<uint32_t>(s->GetHashCode());
-  return Insert(s, hash, /*is_strong=*/ true);
+  size_t num_searched_strong_frozen_tables;
+  ObjPtr<mirror::String> strong =
+      LookupStrongLockFree(GcRoot<mirror::String>(s), hash, &num_searched_strong_frozen_tables);
+  if (strong != nullptr) {
+    return strong;
+  }
+  return Insert(s, hash, /*is_strong=*/ true, num_searched_strong_frozen_tables);
 }
 
 ObjPtr<mirror::String> InternTable::InternWeak(const char* utf8_data) {
@@ -311,7 +344,20 @@ ObjPtr<mirror::String> InternTable::InternWeak(ObjPtr<mirror::String> s) {
   DCHECK(s != nullptr);
   // `String::GetHashCode()` ensures that the stored hash is calculated.
   uint32_t hash = static_cast<uint32_t>(s->GetHashCode());
-  return Insert(s, hash, /*is_strong=*/ false);
+  // Most calls intern strings that are interned already. Find them without the lock.
+  size_t num_searched_strong_frozen_tables;
+  ObjPtr<mirror::String> result =
+      LookupStrongLockFree(GcRoot<mirror::String>(s), hash, &num_searched_strong_frozen_tables);
+  if (result != nullptr) {
+    return result;
+  }
+  if (CanReadWeakInternsLockFree(Thread::Current())) {
+    result = LookupWeakLockFree(s, hash);
+    if (result != nullptr) {
+      return result;
+    }
+  }
+  return Insert(s, hash, /*is_strong=*/ false, num_searched_strong_frozen_tables);
 }
 
 void InternTable::SweepInternTableWeaks(IsMarkedVisitor* visitor) {
@@ -332,6 +378,27 @@ void InternTable::Table::Remove(ObjPtr<mirror::String> s, uint32_t hash) {
   LOG(FATAL) << "Attempting to remove non-interned string " << s->ToModifiedUtf8();
 }
 
+template <typename Key>
+ObjPtr<mirror::String> InternTable::Table::FindLockFree(const Key& key,
+                                                        uint32_t hash,
+                                                        size_t* num_searched_frozen_tables) const {
+  // Search from the last table, assuming that apps shall search for their own
+  // strings more often than for boot image strings.
+  size_t num_searched_tables;
+  GcRoot<mirror::String> root = reader_view_.FindLockFree(
+      hash,
+      // NO_THREAD_SAFETY_ANALYSIS: Called by FindLockFree() with the mutator lock held.
+      [&key](const GcRoot<mirror::String>& candidate) NO_THREAD_SAFETY_ANALYSIS {
+        return StringEquals()(candidate, key);
+      },
+      &num_searched_tables);
+  DCHECK_NE(num_searched_tables, 0u);
+  if (num_searched_frozen_tables != nullptr) {
+    *num_searched_frozen_tables = num_searched_tables - 1u;
+  }
+  return root.IsNull() ? nullptr : root.Read();
+}
+
 FLATTEN
 ObjPtr<mirror::String> InternTable::Table::Find(ObjPtr<mirror::String> s,
                                                 uint32_t hash,
@@ -373,13 +440,40 @@ void InternTable::Table::AddNewTable() {
   InternalTable new_table;
   new_table.set_.SetLoadFactor(last_set.GetMinLoadFactor(), last_set.GetMaxLoadFactor());
   tables_.push_back(std::move(new_table));
+  UpdateReaderView();
 }
 
 void InternTable::Table::Insert(ObjPtr<mirror::String> s, uint32_t hash) {
   // Always insert the last table, the image tables are before and we avoid inserting into these
   // to prevent dirty pages.
   DCHECK(!tables_.empty());
-  tables_.back().set_.PutWithHash(GcRoot<mirror::String>(s), hash);
+  UnorderedSet& set = tables_.back().set_;
+  if (reader_view_.GrowIfFull(&set)) {
+    // Publish the new buckets before adding the string, so that it cannot be missed.
+    UpdateReaderView();
+  }
+  // Pairs with the acquire fence in `HashSetReaderView<>::FindLockFree()`. The root itself is
+  // stored with a plain store, so the string must be fully constructed before it.
+  std::atomic_thread_fence(std::memory_order_release);
+  set.PutWithHash(GcRoot<mirror::String>(s), hash);
+}
+
+void InternTable::Table::Clear() {
+  for (InternalTable& table : tables_) {
+    RetireSet(&table);
+  }
+  UpdateReaderView();
+}
+
+void InternTable::Table::RetireSet(InternalTable* table) {
+  UnorderedSet empty_set(table->set_.GetMinLoadFactor(), table->set_.GetMaxLoadFactor());
+  reader_view_.Replace(&table->set_, std::move(empty_set));
+}
+
+void InternTable::Table::UpdateReaderView() {
+  reader_view_.Publish(tables_, [](const InternalTable& table) -> const UnorderedSet& {
+    return table.set_;
+  });
 }
 
 void InternTable::Table::VisitRoots(RootVisitor* visitor) {
@@ -431,7 +525,8 @@ void InternTable::ChangeWeakRootState(gc::WeakRootState new_state) {
 
 void InternTable::ChangeWeakRootStateLocked(gc::WeakRootState new_state) {
   CHECK(!gUseReadBarrier);
-  weak_root_state_ = new_state;
+  // Pairs with the acquire load in CanReadWeakInternsLockFree().
+  weak_root_state_.store(new_state, std::memory_order_release);
   if (new_state != gc::kWeakRootStateNoReadsOrWrites) {
     weak_intern_condition_.Broadcast(Thread::Current());
   }
@@ -443,6 +538,8 @@ InternTable::Table::Table() {
   initial_table.set_.SetLoadFactor(runtime->GetHashTableMinLoadFactor(),
                                    runtime->GetHashTableMaxLoadFactor());
   tables_.push_back(std::move(initial_table));
+  // No other thread can see the table yet.
+  UpdateReaderView();
 }
 
 }  // namespace art
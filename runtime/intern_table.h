@@ -17,9 +17,11 @@
 #ifndef ART_RUNTIME_INTERN_TABLE_H_
 #define ART_RUNTIME_INTERN_TABLE_H_
 
+#include "base/atomic.h"
 #include "base/dchecked_vector.h"
 #include "base/gc_visited_arena_pool.h"
 #include "base/hash_set.h"
+#include "base/hash_set_reader_view.h"
 #include "base/macros.h"
 #include "base/mutex.h"
 #include "gc/weak_root_state.h"
@@ -55,6 +57,12 @@ class Transaction;
  * String.intern. Some code (XML parsers being a prime example) relies on being able to intern
  * arbitrarily many strings for the duration of a parse without permanently increasing the memory
  * footprint.
+ *
+ * Lookups of existing interns, including the image intern sections, do not take the
+ * `Locks::intern_table_lock_`. Each table publishes its hash set storage with a
+ * HashSetReaderView<>, which never resizes a set in place, see `Table::FindLockFree()`.
+ * A lock-free miss is confirmed under the lock before a new intern is inserted, so inserts
+ * stay serialized.
  */
 class InternTable {
  public:
@@ -237,6 +245,15 @@ class InternTable {
     };
 
     Table();
+    // Lookup without holding the `Locks::intern_table_lock_`. A match is always valid but a miss
+    // must be confirmed with Find() under the lock, since another thread may be moving entries
+    // around while removing interns. Returns the number of frozen tables searched, which stay
+    // unchanged, in `num_searched_frozen_tables`.
+    template <typename Key>
+    ObjPtr<mirror::String> FindLockFree(const Key& key,
+                                        uint32_t hash,
+                                        /*out*/ size_t* num_searched_frozen_tables = nullptr) const
+        REQUIRES_SHARED(Locks::mutator_lock_);
     ObjPtr<mirror::String> Find(ObjPtr<mirror::String> s,
                                 uint32_t hash,
                                 size_t num_searched_frozen_tables = 0u)
@@ -253,6 +270,8 @@ class InternTable {
         REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
     // Add a new intern table that will only be inserted into from now on.
     void AddNewTable() REQUIRES(Locks::intern_table_lock_);
+    // Remove all interns.
+    void Clear() REQUIRES(Locks::intern_table_lock_);
     size_t Size() const REQUIRES(Locks::intern_table_lock_);
     // Read and add an intern table from ptr.
     // Tables read are inserted at the front of the table array. Only checks for conflicts in
@@ -263,6 +282,12 @@ class InternTable {
         REQUIRES(!Locks::intern_table_lock_) REQUIRES_SHARED(Locks::mutator_lock_);
 
    private:
+    // Publish `tables_` for lock-free lookups after sets were added or replaced.
+    void UpdateReaderView() REQUIRES(Locks::intern_table_lock_);
+
+    // Replace the set of `table` with an empty one, keeping the old storage alive.
+    void RetireSet(InternalTable* table) REQUIRES(Locks::intern_table_lock_);
+
     void SweepWeaks(UnorderedSet* set, IsMarkedVisitor* visitor)
         REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
 
@@ -273,6 +298,8 @@ class InternTable {
     // We call AddNewTable when we create the zygote to reduce private dirty pages caused by
     // modifying the zygote intern table. The back of table is modified when strings are interned.
     dchecked_vector<InternalTable> tables_;
+    // The published storage of `tables_` for lock-free lookups.
+    HashSetReaderView<UnorderedSet> reader_view_;
 
     friend class InternTable;
     friend class linker::ImageWriter;
@@ -309,6 +336,19 @@ class InternTable {
   void WaitUntilAccessible(Thread* self)
       REQUIRES(Locks::intern_table_lock_) REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Whether weak interns can be read without holding the `Locks::intern_table_lock_`.
+  bool CanReadWeakInternsLockFree(Thread* self) const REQUIRES_SHARED(Locks::mutator_lock_);
+
+  // Lock-free lookups, see `Table::FindLockFree()`.
+  // NO_THREAD_SAFETY_ANALYSIS: The tables are published for reading without the lock.
+  template <typename Key>
+  ObjPtr<mirror::String> LookupStrongLockFree(const Key& key,
+                                              uint32_t hash,
+                                              /*out*/ size_t* num_searched_frozen_tables = nullptr)
+      REQUIRES_SHARED(Locks::mutator_lock_) NO_THREAD_SAFETY_ANALYSIS;
+  ObjPtr<mirror::String> LookupWeakLockFree(ObjPtr<mirror::String> s, uint32_t hash)
+      REQUIRES_SHARED(Locks::mutator_lock_) NO_THREAD_SAFETY_ANALYSIS;
+
   bool log_new_roots_ GUARDED_BY(Locks::intern_table_lock_);
   ConditionVariable weak_intern_condition_ GUARDED_BY(Locks::intern_table_lock_);
   // Since this contains (strong) roots, they need a read barrier to
@@ -322,8 +362,9 @@ class InternTable {
   // not directly access the strings in it. Use functions that contain
   // read barriers.
   Table weak_interns_ GUARDED_BY(Locks::intern_table_lock_);
-  // Weak root state, used for concurrent system weak processing and more.
-  gc::WeakRootState weak_root_state_ GUARDED_BY(Locks::intern_table_lock_);
+  // Weak root state, used for concurrent system weak processing and more. Only changed with
+  // the `Locks::intern_table_lock_` held but read without it by lock-free lookups.
+  Atomic<gc::WeakRootState> weak_root_state_;
 
   friend class gc::space::ImageSpace;
   friend class linker::ImageWriter;
@@ -16,14 +16,23 @@
 
 #include "intern_table-inl.h"
 
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "base/hash_set.h"
+#include "class_root-inl.h"
 #include "common_runtime_test.h"
 #include "dex/utf.h"
 #include "gc_root-inl.h"
 #include "handle_scope-inl.h"
 #include "mirror/object.h"
+#include "mirror/object_array-alloc-inl.h"
+#include "mirror/object_array-inl.h"
 #include "mirror/string.h"
 #include "scoped_thread_state_change-inl.h"
+#include "thread_pool.h"
 
 namespace art HIDDEN {
 
@@ -263,4 +272,107 @@ TEST_F(InternTableTest, InternStrongFrozenWeak) {
   ASSERT_TRUE(strong_foo == foo.Get());
 }
 
+class InternLookupTask : public Task {
+ public:
+  InternLookupTask(InternTable* intern_table,
+                   const std::vector<std::string>* strings,
+                   const std::atomic<size_t>* num_interned,
+                   const std::atomic<bool>* done,
+                   std::atomic<size_t>* num_failures)
+      : intern_table_(intern_table),
+        strings_(strings),
+        num_interned_(num_interned),
+        done_(done),
+        num_failures_(num_failures) {}
+
+  void Run(Thread* self) override {
+    ScopedObjectAccess soa(self);
+    while (!done_->load(std::memory_order_acquire)) {
+      // Every string interned before must be found, whatever the writer does meanwhile.
+      size_t num_interned = num_interned_->load(std::memory_order_acquire);
+      for (size_t i = 0; i != num_interned; ++i) {
+        const std::string& string = (*strings_)[i];
+        ObjPtr<mirror::String> s = intern_table_->LookupStrong(
+            self, static_cast<uint32_t>(string.size()), string.c_str());
+        if (s == nullptr || !s->Equals(string.c_str())) {
+          num_failures_->fetch_add(1u, std::memory_order_relaxed);
+        } else if (intern_table_->LookupStrong(self, s) != s) {
+          num_failures_->fetch_add(1u, std::memory_order_relaxed);
+        }
+      }
+      if (intern_table_->LookupStrong(self, 8, "notthere") != nullptr) {
+        num_failures_->fetch_add(1u, std::memory_order_relaxed);
+      }
+      self->AllowThreadSuspension();
+    }
+  }
+
+  void Finalize() override {
+    delete this;
+  }
+
+ private:
+  InternTable* const intern_table_;
+  const std::vector<std::string>* const strings_;
+  const std::atomic<size_t>* const num_interned_;
+  const std::atomic<bool>* const done_;
+  std::atomic<size_t>* const num_failures_;
+};
+
+// Lookups of strong interns do not take the intern table lock. Readers probe an immutable view
+// of the set buckets while the writer inserts in place, replaces a full set by a bigger copy
+// or adds a new table. Check that concurrent readers never miss a string that was interned
+// before their lookup started.
+TEST_F(InternTableTest, ConcurrentLookupStrong) {
+  static constexpr size_t kNumThreads = 4u;
+  static constexpr size_t kNumStrings = 2000u;
+  static constexpr size_t kNewTableInterval = 300u;
+  Thread* self = Thread::Current();
+  std::vector<std::string> strings;
+  for (size_t i = 0; i != kNumStrings; ++i) {
+    strings.push_back("intern" + std::to_string(i));
+  }
+
+  InternTable intern_table;
+  std::atomic<size_t> num_interned(0u);
+  std::atomic<bool> done(false);
+  std::atomic<size_t> num_failures(0u);
+  std::unique_ptr<ThreadPool> thread_pool(
+      ThreadPool::Create("Intern table lookup test thread pool", kNumThreads));
+  for (size_t i = 0; i != kNumThreads; ++i) {
+    thread_pool->AddTask(
+        self, new InternLookupTask(&intern_table, &strings, &num_interned, &done, &num_failures));
+  }
+  thread_pool->StartWorkers(self);
+  ScopedObjectAccess soa(self);
+  // Keep the strings alive until the readers are done. The test intern table is not a GC root.
+  StackHandleScope<1> hs(self);
+  Handle<mirror::ObjectArray<mirror::String>> array =
+      hs.NewHandle(mirror::ObjectArray<mirror::String>::Alloc(
+          self, GetClassRoot<mirror::ObjectArray<mirror::String>>(), kNumStrings));
+  CHECK(array != nullptr);
+  for (size_t i = 0; i != kNumStrings; ++i) {
+    ObjPtr<mirror::String> s = mirror::String::AllocFromModifiedUtf8(self, strings[i].c_str());
+    CHECK(s != nullptr);
+    array->Set(i, s);
+  }
+  // Nothing is allocated on the managed heap from here on, so the strings do not move.
+  for (size_t i = 0; i != kNumStrings; ++i) {
+    if (i % kNewTableInterval == 0u) {
+      intern_table.AddNewTable();
+    }
+    ObjPtr<mirror::String> s = array->Get(i);
+    CHECK(intern_table.InternStrong(s) == s) << strings[i];
+    num_interned.store(i + 1u, std::memory_order_release);
+  }
+  done.store(true, std::memory_order_release);
+  {
+    ScopedThreadSuspension sts(self, ThreadState::kNative);
+    thread_pool->Wait(self, /*do_work=*/ false, /*may_hold_locks=*/ false);
+    thread_pool->StopWorkers(self);
+  }
+  EXPECT_EQ(num_failures.load(std::memory_order_relaxed), 0u);
+  EXPECT_EQ(intern_table.StrongSize(), kNumStrings);
+}
+
 }  // namespace art
@@ -19,25 +19,65 @@
 
 #include "interpreter_cache.h"
 
+#include <algorithm>
+
 #include "thread.h"
 
 namespace art HIDDEN {
 
 inline bool InterpreterCache::Get(Thread* self, const void* key, /* out */ size_t* value) {
   DCHECK(self->GetInterpreterCache() == this) << "Must be called from owning thread";
-  Entry& entry = data_[IndexOf(key)];
+  size_t index = IndexOf(key);
+  Entry& entry = data_[index];
   if (LIKELY(entry.first == key)) {
     *value = entry.second;
+    IncrementCounter(&hits_);
     return true;
   }
+  return GetFromOtherWays(index, key, value);
+}
+
+inline bool InterpreterCache::GetFromOtherWays(size_t index,
+                                               const void* key,
+                                               /* out */ size_t* value) {
+  Entry* other_ways = OtherWaysOf(index);
+  for (size_t way = 0; way != kNumWays - 1u; ++way) {
+    if (other_ways[way].first == key) {
+      // Move the entry to way 0 so that nterp finds it on the fast path and
+      // shift the more recently used entries down.
+      Entry hit = other_ways[way];
+      std::copy_backward(other_ways, other_ways + way, other_ways + way + 1u);
+      other_ways[0] = data_[index];
+      data_[index] = hit;
+      *value = hit.second;
+      IncrementCounter(&secondary_hits_);
+      return true;
+    }
+  }
+  IncrementCounter(&misses_);
   return false;
 }
 
 inline void InterpreterCache::Set(Thread* self, const void* key, size_t value) {
   DCHECK(self->GetInterpreterCache() == this) << "Must be called from owning thread";
-  // Simple store works here as the cache is always read/written by the owning
+  // Simple stores work here as the cache is always read/written by the owning
   // thread only (or in a stop-the-world pause).
-  data_[IndexOf(key)] = Entry{key, value};
+  size_t index = IndexOf(key);
+  if (kNumWays != 1u && data_[index].first != key) {
+    // Evict the LRU entry, or the stale entry for the same key if any,
+    // and demote the entry in way 0.
+    Entry* other_ways = OtherWaysOf(index);
+    size_t victim = kNumWays - 2u;
+    for (size_t way = 0; way != kNumWays - 2u; ++way) {
+      if (other_ways[way].first == key) {
+        victim = way;
+        break;
+      }
+    }
+    std::copy_backward(other_ways, other_ways + victim, other_ways + victim + 1u);
+    other_ways[0] = data_[index];
+  }
+  data_[index] = Entry{key, value};
 }
 
 }  // namespace art
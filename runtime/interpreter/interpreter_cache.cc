@@ -15,21 +15,64 @@
  */
 
 #include "interpreter_cache.h"
+
+#include "dex/dex_instruction.h"
 #include "thread-inl.h"
 
 namespace art HIDDEN {
 
-void InterpreterCache::Clear(Thread* owning_thread) {
-  DCHECK(owning_thread->GetInterpreterCache() == this);
+static void DCheckOwningThread(InterpreterCache* cache, Thread* owning_thread) {
+  DCHECK(owning_thread->GetInterpreterCache() == cache);
   DCHECK(owning_thread == Thread::Current() || owning_thread->IsSuspended() ||
          owning_thread->ReadFlag(ThreadFlag::kRunningFlipFunction, std::memory_order_relaxed));
+}
+
+void InterpreterCache::ClearEntry(Entry* entry) {
+  std::atomic<const void*>* atomic_key_addr =
+      reinterpret_cast<std::atomic<const void*>*>(&entry->first);
+  atomic_key_addr->store(nullptr, std::memory_order_relaxed);
+}
+
+void InterpreterCache::Clear(Thread* owning_thread) {
+  DCheckOwningThread(this, owning_thread);
   // Avoid using std::fill (or its variant) as there could be a concurrent sweep
   // happening by the GC thread and these functions may clear partially.
-  for (Entry& entry : data_) {
-    std::atomic<const void*>* atomic_key_addr =
-        reinterpret_cast<std::atomic<const void*>*>(&entry.first);
-    atomic_key_addr->store(nullptr, std::memory_order_relaxed);
-  }
+  VisitEntries([](Entry& entry) { ClearEntry(&entry); });
+}
+
+void InterpreterCache::ClearKeysInRange(Thread* owning_thread,
+                                        const void* begin,
+                                        const void* end) {
+  DCheckOwningThread(this, owning_thread);
+  VisitEntries([=](Entry& entry) {
+    if (begin <= entry.first && entry.first < end) {
+      ClearEntry(&entry);
+    }
+  });
+}
+
+void InterpreterCache::ClearReferenceEntries(Thread* owning_thread) {
+  DCheckOwningThread(this, owning_thread);
+  VisitEntries([](Entry& entry) {
+    const Instruction* inst = reinterpret_cast<const Instruction*>(entry.first);
+    if (inst == nullptr) {
+      return;
+    }
+    // Keep in sync with the reference-holding opcodes in `SweepCacheEntry()`.
+    switch (inst->Opcode()) {
+      case Instruction::NEW_INSTANCE:
+      case Instruction::CHECK_CAST:
+      case Instruction::INSTANCE_OF:
+      case Instruction::NEW_ARRAY:
+      case Instruction::CONST_CLASS:
+      case Instruction::CONST_STRING:
+      case Instruction::CONST_STRING_JUMBO:
+        ClearEntry(&entry);
+        break;
+      default:
+        break;
+    }
+  });
 }
 
 }  // namespace art
@@ -19,6 +19,7 @@
 
 #include <array>
 #include <atomic>
+#include <cstdint>
 
 #include "base/bit_utils.h"
 #include "base/macros.h"
@@ -38,9 +39,17 @@ class Thread;
 //   iget/iput: The field offset. The field must be non-volatile.
 //   sget/sput: The ArtField* pointer. The field must be non-volitile.
 //   invoke: The ArtMethod* pointer (before vtable indirection, etc).
+//   new-instance/check-cast/instance-of/new-array/const-class: The mirror::Class* pointer.
+//   const-string: The mirror::String* pointer.
 //
-// We ensure consistency of the cache by clearing it
-// whenever any dex file is unloaded.
+// The cache is set-associative. Way 0 of each set is kept in a separate direct-mapped
+// array which nterp reads directly from assembly, so it always holds the most recently
+// used entry of the set. The other ways hold entries evicted from way 0 in LRU order
+// and are only searched from C++, i.e. by the switch interpreter and on nterp slow paths.
+//
+// We ensure consistency of the cache by removing entries keyed by dex instructions of
+// any dex file that is unloaded. Entries holding references are removed when the GC
+// moves objects, other entries remain valid.
 //
 // Aligned to 16-bytes to make it easier to get the address of the cache
 // from assembly (it ensures that the offset is valid immediate value).
@@ -49,25 +58,73 @@ class ALIGNED(16) InterpreterCache {
   // Aligned since we load the whole entry in single assembly instruction.
   using Entry ALIGNED(2 * sizeof(size_t)) = std::pair<const void*, size_t>;
 
-  // 2x size increase/decrease corresponds to ~0.5% interpreter performance change.
-  // Value of 256 has around 75% cache hit rate.
+  // Number of sets. 2x size increase/decrease corresponds to ~0.5% interpreter performance
+  // change. Value of 256 has around 75% cache hit rate when direct-mapped.
   static constexpr size_t kSize = 256;
 
+  // Number of entries per set, must be 1, 2 or 4. Extra ways only cost space in the
+  // `Thread` and time on misses of way 0, the nterp fast path is not affected.
+  static constexpr size_t kNumWays = 2;
+  static_assert(kNumWays == 1u || kNumWays == 2u || kNumWays == 4u);
+
+  // Whether to count the lookups of the C++ accessors, see `GetStats()`.
+  static constexpr bool kCountLookups = false;
+
+  // Lookup counters of the C++ accessors. Hits in way 0 from nterp assembly are not counted.
+  struct Stats {
+    uint64_t hits = 0u;            // Hits in way 0.
+    uint64_t secondary_hits = 0u;  // Hits in the other ways.
+    uint64_t misses = 0u;
+
+    Stats& operator+=(const Stats& other) {
+      hits += other.hits;
+      secondary_hits += other.secondary_hits;
+      misses += other.misses;
+      return *this;
+    }
+  };
+
   InterpreterCache() {
     // We can not use the Clear() method since the constructor will not
     // be called from the owning thread.
     data_.fill(Entry{});
+    other_ways_.fill(Entry{});
   }
 
   // Clear the whole cache. It requires the owning thread for DCHECKs.
   EXPORT void Clear(Thread* owning_thread);
 
+  // Remove entries keyed by addresses in the range [begin, end), i.e. dex instructions
+  // of a dex file that is being unloaded. It requires the owning thread for DCHECKs.
+  void ClearKeysInRange(Thread* owning_thread, const void* begin, const void* end);
+
+  // Remove entries which hold references to heap objects, for moving collectors.
+  // It requires the owning thread for DCHECKs.
+  void ClearReferenceEntries(Thread* owning_thread);
+
   ALWAYS_INLINE bool Get(Thread* self, const void* key, /* out */ size_t* value);
 
   ALWAYS_INLINE void Set(Thread* self, const void* key, size_t value);
 
-  std::array<Entry, kSize>& GetArray() {
-    return data_;
+  // Visit all entries of all ways.
+  template <typename Visitor>
+  void VisitEntries(const Visitor& visitor) {
+    for (Entry& entry : data_) {
+      visitor(entry);
+    }
+    for (Entry& entry : other_ways_) {
+      visitor(entry);
+    }
+  }
+
+  // The counters are updated only by the owning thread, other threads may read stale values.
+  // They stay zero unless `kCountLookups` is set.
+  Stats GetStats() const {
+    Stats stats;
+    stats.hits = hits_.load(std::memory_order_relaxed);
+    stats.secondary_hits = secondary_hits_.load(std::memory_order_relaxed);
+    stats.misses = misses_.load(std::memory_order_relaxed);
+    return stats;
   }
 
  private:
@@ -78,7 +135,32 @@ class ALIGNED(16) InterpreterCache {
     return index;
   }
 
+  // Returns the other ways of the set with the given index, in LRU order.
+  ALWAYS_INLINE Entry* OtherWaysOf(size_t index) {
+    return other_ways_.data() + index * (kNumWays - 1u);
+  }
+
+  // Search the other ways of the set and move the entry to way 0 if found.
+  bool GetFromOtherWays(size_t index, const void* key, /* out */ size_t* value);
+
+  // Clear the key with an atomic store, see `Clear()`.
+  static void ClearEntry(Entry* entry);
+
+  static ALWAYS_INLINE void IncrementCounter(std::atomic<uint64_t>* counter) {
+    if (kCountLookups) {
+      // Only the owning thread writes the counters, no need for an atomic increment.
+      counter->store(counter->load(std::memory_order_relaxed) + 1u, std::memory_order_relaxed);
+    }
+  }
+
+  // Way 0 of each set, read by nterp assembly. Must stay the first field.
   std::array<Entry, kSize> data_;
+  // Ways 1 to kNumWays - 1 of each set, in that order.
+  std::array<Entry, kSize * (kNumWays - 1u)> other_ways_;
+
+  std::atomic<uint64_t> hits_ = 0u;
+  std::atomic<uint64_t> secondary_hits_ = 0u;
+  std::atomic<uint64_t> misses_ = 0u;
 };
 
 }  // namespace art
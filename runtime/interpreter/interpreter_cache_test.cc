@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "interpreter_cache-inl.h"
+
+#include "common_runtime_test.h"
+#include "thread-current-inl.h"
+
+namespace art HIDDEN {
+
+class InterpreterCacheTest : public CommonRuntimeTest {};
+
+TEST_F(InterpreterCacheTest, SetAssociative) {
+  if (InterpreterCache::kNumWays == 1u) {
+    GTEST_SKIP() << "The cache is direct-mapped.";
+  }
+  // Keys `kSize * 4` bytes apart map to the same set.
+  static uint32_t keys[InterpreterCache::kNumWays + 1u][InterpreterCache::kSize];
+  Thread* self = Thread::Current();
+  InterpreterCache* cache = self->GetInterpreterCache();
+  cache->Clear(self);
+  InterpreterCache::Stats stats = cache->GetStats();
+
+  for (size_t i = 0; i != InterpreterCache::kNumWays; ++i) {
+    cache->Set(self, &keys[i][0], i);
+  }
+  // All entries of the set are present, the most recently set one in way 0.
+  size_t value;
+  ASSERT_TRUE(cache->Get(self, &keys[InterpreterCache::kNumWays - 1u][0], &value));
+  EXPECT_EQ(InterpreterCache::kNumWays - 1u, value);
+  // Each of these hits in another way since the previous lookup moved its entry to way 0.
+  for (size_t i = 0; i != InterpreterCache::kNumWays; ++i) {
+    ASSERT_TRUE(cache->Get(self, &keys[i][0], &value));
+    EXPECT_EQ(i, value);
+  }
+  InterpreterCache::Stats new_stats = cache->GetStats();
+  if (InterpreterCache::kCountLookups) {
+    EXPECT_EQ(stats.hits + 1u, new_stats.hits);
+    EXPECT_EQ(stats.secondary_hits + InterpreterCache::kNumWays, new_stats.secondary_hits);
+    EXPECT_EQ(stats.misses, new_stats.misses);
+  }
+
+  // Setting one more key evicts the least recently used entry.
+  cache->Set(self, &keys[InterpreterCache::kNumWays][0], InterpreterCache::kNumWays);
+  EXPECT_FALSE(cache->Get(self, &keys[0][0], &value));
+  if (InterpreterCache::kCountLookups) {
+    EXPECT_EQ(new_stats.misses + 1u, cache->GetStats().misses);
+  }
+  for (size_t i = 1; i != InterpreterCache::kNumWays + 1u; ++i) {
+    ASSERT_TRUE(cache->Get(self, &keys[i][0], &value));
+    EXPECT_EQ(i, value);
+  }
+
+  // Removing a range keeps the entries outside of it.
+  cache->ClearKeysInRange(self, &keys[1][0], &keys[2][0]);
+  EXPECT_FALSE(cache->Get(self, &keys[1][0], &value));
+  ASSERT_TRUE(cache->Get(self, &keys[InterpreterCache::kNumWays][0], &value));
+  EXPECT_EQ(InterpreterCache::kNumWays, value);
+
+  cache->Clear(self);
+  EXPECT_FALSE(cache->Get(self, &keys[InterpreterCache::kNumWays][0], &value));
+}
+
+}  // namespace art
@@ -30,6 +30,7 @@
 #include "interpreter/shadow_frame-inl.h"
 #include "mirror/string-alloc-inl.h"
 #include "nterp_helpers.h"
+#include "read_barrier-inl.h"
 
 namespace art HIDDEN {
 namespace interpreter {
@@ -139,6 +140,29 @@ inline void UpdateCache(Thread* self, const uint16_t* dex_pc_ptr, T* value) {
   UpdateCache(self, dex_pc_ptr, reinterpret_cast<size_t>(value));
 }
 
+// The assembly fast paths only look at the first way of the cache. Look at the
+// other ways before resolving, a hit also moves the entry to the first way.
+// The C++ interpreter has already searched all ways when it falls back to the
+// resolution, so it calls the `NterpResolve*()` helpers directly.
+inline bool LookupCache(Thread* self, const uint16_t* dex_pc_ptr, /*out*/ size_t* value) {
+  return self->GetInterpreterCache()->Get(self, dex_pc_ptr, value);
+}
+
+// Same as above for cached references, which need a read barrier like on the fast paths.
+template<typename T>
+inline T* LookupCachedReference(Thread* self, const uint16_t* dex_pc_ptr)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  size_t value;
+  if (!LookupCache(self, dex_pc_ptr, &value)) {
+    return nullptr;
+  }
+  mirror::Object* ref = reinterpret_cast<mirror::Object*>(value);
+  if (gUseReadBarrier && self->GetIsGcMarking()) {
+    ref = ReadBarrier::Mark(ref);
+  }
+  return down_cast<T*>(ref);
+}
+
 #ifdef __arm__
 
 extern "C" void NterpStoreArm32Fprs(const char* shorty,
@@ -321,7 +345,7 @@ static constexpr std::array<uint8_t, 256u> GenerateOpcodeInvokeTypes() {
 static constexpr std::array<uint8_t, 256u> kOpcodeInvokeTypes = GenerateOpcodeInvokeTypes();
 
 LIBART_PROTECTED FLATTEN
-extern "C" size_t NterpGetMethod(Thread* self, ArtMethod* caller, const uint16_t* dex_pc_ptr)
+extern "C" size_t NterpResolveMethod(Thread* self, ArtMethod* caller, const uint16_t* dex_pc_ptr)
     REQUIRES_SHARED(Locks::mutator_lock_) {
   UpdateHotness(caller);
   const Instruction* inst = Instruction::At(dex_pc_ptr);
@@ -391,6 +415,16 @@ extern "C" size_t NterpGetMethod(Thread* self, ArtMethod* caller, const uint16_t
   }
 }
 
+LIBART_PROTECTED FLATTEN
+extern "C" size_t NterpGetMethod(Thread* self, ArtMethod* caller, const uint16_t* dex_pc_ptr)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  size_t cached_value;
+  if (LookupCache(self, dex_pc_ptr, &cached_value)) {
+    return cached_value;
+  }
+  return NterpResolveMethod(self, caller, dex_pc_ptr);
+}
+
 ALWAYS_INLINE FLATTEN
 static ArtField* FindFieldFast(ArtMethod* caller, uint16_t field_index)
     REQUIRES_SHARED(Locks::mutator_lock_) {
@@ -426,10 +460,10 @@ static ArtField* FindFieldSlow(Thread* self,
 }
 
 LIBART_PROTECTED
-extern "C" size_t NterpGetStaticField(Thread* self,
-                                      ArtMethod* caller,
-                                      const uint16_t* dex_pc_ptr,
-                                      size_t resolve_field_type)  // Resolve if not zero
+extern "C" size_t NterpResolveStaticField(Thread* self,
+                                          ArtMethod* caller,
+                                          const uint16_t* dex_pc_ptr,
+                                          size_t resolve_field_type)  // Resolve if not zero
     REQUIRES_SHARED(Locks::mutator_lock_) {
   const Instruction* inst = Instruction::At(dex_pc_ptr);
   uint16_t field_index = inst->VRegB_21c();
@@ -489,10 +523,24 @@ extern "C" size_t NterpGetStaticField(Thread* self,
 }
 
 LIBART_PROTECTED
-extern "C" uint32_t NterpGetInstanceFieldOffset(Thread* self,
-                                                ArtMethod* caller,
-                                                const uint16_t* dex_pc_ptr,
-                                                size_t resolve_field_type)  // Resolve if not zero
+extern "C" size_t NterpGetStaticField(Thread* self,
+                                      ArtMethod* caller,
+                                      const uint16_t* dex_pc_ptr,
+                                      size_t resolve_field_type)  // Resolve if not zero
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  // A cached field does not need its type resolved, see `NterpResolveStaticField()`.
+  size_t cached_value;
+  if (resolve_field_type == 0u && LookupCache(self, dex_pc_ptr, &cached_value)) {
+    return cached_value;
+  }
+  return NterpResolveStaticField(self, caller, dex_pc_ptr, resolve_field_type);
+}
+
+LIBART_PROTECTED
+extern "C" uint32_t NterpResolveInstanceFieldOffset(Thread* self,
+                                                    ArtMethod* caller,
+                                                    const uint16_t* dex_pc_ptr,
+                                                    size_t resolve_field_type)  // Resolve if not 0
     REQUIRES_SHARED(Locks::mutator_lock_) {
   const Instruction* inst = Instruction::At(dex_pc_ptr);
   uint16_t field_index = inst->VRegC_22c();
@@ -537,8 +585,26 @@ extern "C" uint32_t NterpGetInstanceFieldOffset(Thread* self,
   return resolved_field->GetOffset().Uint32Value();
 }
 
+LIBART_PROTECTED
+extern "C" uint32_t NterpGetInstanceFieldOffset(Thread* self,
+                                                ArtMethod* caller,
+                                                const uint16_t* dex_pc_ptr,
+                                                size_t resolve_field_type)  // Resolve if not zero
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  // A cached field does not need its type resolved, see `NterpResolveInstanceFieldOffset()`.
+  size_t cached_value;
+  if (resolve_field_type == 0u && LookupCache(self, dex_pc_ptr, &cached_value)) {
+    return static_cast<uint32_t>(cached_value);
+  }
+  return NterpResolveInstanceFieldOffset(self, caller, dex_pc_ptr, resolve_field_type);
+}
+
 extern "C" mirror::Object* NterpGetClass(Thread* self, ArtMethod* caller, uint16_t* dex_pc_ptr)
     REQUIRES_SHARED(Locks::mutator_lock_) {
+  mirror::Class* cached_class = LookupCachedReference<mirror::Class>(self, dex_pc_ptr);
+  if (cached_class != nullptr) {
+    return cached_class;
+  }
   UpdateHotness(caller);
   const Instruction* inst = Instruction::At(dex_pc_ptr);
   Instruction::Code opcode = inst->Opcode();
@@ -573,6 +639,12 @@ extern "C" mirror::Object* NterpAllocateObject(Thread* self,
                                                ArtMethod* caller,
                                                uint16_t* dex_pc_ptr)
     REQUIRES_SHARED(Locks::mutator_lock_) {
+  gc::AllocatorType allocator_type = Runtime::Current()->GetHeap()->GetCurrentAllocator();
+  mirror::Class* cached_class = LookupCachedReference<mirror::Class>(self, dex_pc_ptr);
+  if (cached_class != nullptr) {
+    // Only non-finalizable instantiable classes are cached, see below.
+    return AllocObjectFromCode(cached_class, self, allocator_type).Ptr();
+  }
   UpdateHotness(caller);
   const Instruction* inst = Instruction::At(dex_pc_ptr);
   DCHECK_EQ(inst->Opcode(), Instruction::NEW_INSTANCE);
@@ -588,7 +660,6 @@ extern "C" mirror::Object* NterpAllocateObject(Thread* self,
     return nullptr;
   }
 
-  gc::AllocatorType allocator_type = Runtime::Current()->GetHeap()->GetCurrentAllocator();
   if (UNLIKELY(c->IsStringClass())) {
     // We don't cache the class for strings as we need to special case their
     // allocation.
@@ -609,6 +680,10 @@ extern "C" mirror::Object* NterpLoadObject(Thread* self, ArtMethod* caller, uint
   switch (inst->Opcode()) {
     case Instruction::CONST_STRING:
     case Instruction::CONST_STRING_JUMBO: {
+      mirror::String* cached_string = LookupCachedReference<mirror::String>(self, dex_pc_ptr);
+      if (cached_string != nullptr) {
+        return cached_string;
+      }
       UpdateHotness(caller);
       dex::StringIndex string_index(
           (inst->Opcode() == Instruction::CONST_STRING)
@@ -51,12 +51,14 @@
 #include "jit/jit_scoped_code_cache_write.h"
 #include "linear_alloc.h"
 #include "mirror/method_type.h"
+#include "oat/code_info_cache.h"
 #include "oat/oat_file-inl.h"
 #include "oat/oat_quick_method_header.h"
 #include "object_callbacks.h"
 #include "profile/profile_compilation_info.h"
 #include "scoped_thread_state_change-inl.h"
 #include "stack.h"
+#include "stack_trace_frame_cache.h"
 #include "thread-current-inl.h"
 #include "thread-inl.h"
 #include "thread_list.h"
@@ -75,6 +77,7 @@ class JitCodeCache::JniStubKey {
         is_static_(method->IsStatic()),
         is_fast_native_(method->IsFastNative()),
         is_critical_native_(method->IsCriticalNative()),
+        is_reference_free_native_(method->IsReferenceFreeNative()),
         is_synchronized_(method->IsSynchronized()) {
     DCHECK(!(is_fast_native_ && is_critical_native_));
   }
@@ -92,6 +95,9 @@ class JitCodeCache::JniStubKey {
     if (is_critical_native_ != rhs.is_critical_native_) {
       return rhs.is_critical_native_;
     }
+    if (is_reference_free_native_ != rhs.is_reference_free_native_) {
+      return rhs.is_reference_free_native_;
+    }
     return strcmp(shorty_, rhs.shorty_) < 0;
   }
 
@@ -112,6 +118,7 @@ class JitCodeCache::JniStubKey {
   const bool is_static_;
   const bool is_fast_native_;
   const bool is_critical_native_;
+  const bool is_reference_free_native_;
   const bool is_synchronized_;
 };
 
@@ -507,6 +514,9 @@ void JitCodeCache::FreeAllMethodHeaders(
         ->RemoveDependentsWithMethodHeaders(method_headers);
   }
 
+  // Cached stack trace frames are keyed by code address.
+  StackTraceFrameCache::InvalidateAll();
+
   {
     ScopedCodeCacheWrite scc(private_region_);
     for (const OatQuickMethodHeader* method_header : method_headers) {
@@ -1088,6 +1098,8 @@ void JitCodeCache::Free(Thread* self,
 
 void JitCodeCache::FreeLocked(JitMemoryRegion* region, const uint8_t* code, const uint8_t* data) {
   if (code != nullptr) {
+    // The method header may be reused for other code.
+    CodeInfoCache::Clear();
     RemoveNativeDebugInfoForJit(reinterpret_cast<const void*>(FromAllocationToCode(code)));
     region->FreeCode(code);
   }
@@ -33,6 +33,9 @@ inline T JNIEnvExt::AddLocalReference(ObjPtr<mirror::Object> obj) {
     LOG(FATAL) << error_msg;
     UNREACHABLE();
   }
+  if (UNLIKELY(check_jni_)) {
+    CheckLocalReferenceAllowed();
+  }
 
   // TODO: fix this to understand PushLocalFrame, so we can turn it on.
   if (false) {
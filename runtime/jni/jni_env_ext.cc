@@ -21,6 +21,7 @@
 
 #include "android-base/stringprintf.h"
 
+#include "art_method.h"
 #include "base/mutex.h"
 #include "base/to_str.h"
 #include "check_jni.h"
@@ -28,6 +29,7 @@
 #include "indirect_reference_table.h"
 #include "java_vm_ext.h"
 #include "jni_internal.h"
+#include "local_reference_table-inl.h"
 #include "lock_word.h"
 #include "mirror/object-inl.h"
 #include "nth_caller_visitor.h"
@@ -190,10 +192,11 @@ void JNIEnvExt::RecordMonitorEnter(jobject obj) {
 static std::string ComputeMonitorDescription(Thread* self,
                                              jobject obj) REQUIRES_SHARED(Locks::mutator_lock_) {
   ObjPtr<mirror::Object> o = self->DecodeJObject(obj);
-  if ((o->GetLockWord(false).GetState() == LockWord::kThinLocked) &&
+  LockWord::LockState state = o->GetLockWord(false).GetState();
+  if ((state == LockWord::kThinLocked || state == LockWord::kReserved) &&
       Locks::mutator_lock_->IsExclusiveHeld(self)) {
-    // Getting the identity hashcode here would result in lock inflation and suspension of the
-    // current thread, which isn't safe if this is the only runnable thread.
+    // Getting the identity hashcode here would result in lock inflation or reservation revocation
+    // and suspension of the current thread, which isn't safe if this is the only runnable thread.
     return StringPrintf("<@addr=0x%" PRIxPTR "> (a %s)",
                         reinterpret_cast<intptr_t>(o.Ptr()),
                         o->PrettyTypeOf().c_str());
@@ -286,6 +289,15 @@ void JNIEnvExt::CheckNoHeldMonitors() {
   }
 }
 
+void JNIEnvExt::CheckLocalReferenceAllowed() {
+  // The JNI stub of a reference-free @FastNative method does not push a local reference frame,
+  // so a local reference created by its native code would leak into the caller's frame.
+  ArtMethod** sp = self_->GetManagedStack()->GetTopQuickFrame();
+  if (sp != nullptr && (*sp)->IsReferenceFreeNative()) {
+    vm_->JniAbortF(nullptr, "Local reference created in a reference-free native method");
+  }
+}
+
 void ThreadResetFunctionTable(Thread* thread, [[maybe_unused]] void* arg)
     REQUIRES(Locks::jni_function_table_lock_) {
   JNIEnvExt* env = thread->GetJniEnv();
@@ -120,6 +120,10 @@ class JNIEnvExt : public JNIEnv {
   // Check that no monitors are held that have been acquired in this JNI "segment."
   void CheckNoHeldMonitors() REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Check that the current native method is not reference-free, that is, it may create local
+  // references. Used in CheckJNI mode.
+  void CheckLocalReferenceAllowed() REQUIRES_SHARED(Locks::mutator_lock_);
+
   void VisitMonitorRoots(RootVisitor* visitor, const RootInfo& root_info)
       REQUIRES_SHARED(Locks::mutator_lock_) {
     monitors_.VisitRoots(visitor, root_info);
@@ -138,6 +138,20 @@ inline void LocalReferenceTable::DCheckValidReference(IndirectRef iref) const {
   }
 }
 
+inline IndirectRef LocalReferenceTable::Add(ObjPtr<mirror::Object> obj, std::string* error_msg) {
+  uint32_t top_index = segment_state_.top_index;
+  LrtEntry* free_entry = GetTopTableEntry(top_index);
+  if (LIKELY(free_entry != nullptr) && LIKELY(HasNoHolesInCurrentSegment())) {
+    DCHECK(obj != nullptr);
+    VerifyObject(obj);
+    DCHECK_EQ(free_entry, GetEntry(top_index));
+    free_entry->SetReference(obj);
+    segment_state_.top_index = top_index + 1u;
+    return ToIndirectRef(free_entry);
+  }
+  return AddSlow(obj, error_msg);
+}
+
 inline ObjPtr<mirror::Object> LocalReferenceTable::Get(IndirectRef iref) const {
   DCheckValidReference(iref);
   return ToLrtEntry(iref)->GetReference();
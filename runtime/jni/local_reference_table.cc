@@ -39,6 +39,9 @@ namespace jni {
 
 static constexpr bool kDumpStackOnNonLocalReference = false;
 
+// Value stored in removed entries above the top index.
+static constexpr uint32_t kDeadLocalValue = 0xdead10c0;
+
 // Mmap an "indirect ref table region. Table_bytes is a multiple of a page size.
 static inline MemMap NewLRTMap(size_t table_bytes, std::string* error_msg) {
   return MemMap::MapAnonymous("local ref table",
@@ -146,6 +149,9 @@ LocalReferenceTable::LocalReferenceTable(bool check_jni)
           FirstFreeField::Update(kFreeListEnd, check_jni ? 1u << kFlagCheckJni : 0u)),
       small_table_(nullptr),
       tables_(),
+      top_table_(nullptr),
+      top_table_start_index_(0u),
+      top_table_size_(0u),
       table_mem_maps_() {
 }
 
@@ -173,9 +179,27 @@ bool LocalReferenceTable::Initialize(size_t max_count, std::string* error_msg) {
   DCHECK_ALIGNED(first_table, kCheckJniEntriesPerReference * sizeof(LrtEntry));
   small_table_ = first_table;
   max_entries_ = kSmallLrtEntries;
+  UpdateTopTable();
   return (max_count <= kSmallLrtEntries) || Resize(max_count, error_msg);
 }
 
+void LocalReferenceTable::UpdateTopTable() {
+  DCHECK_NE(max_entries_, 0u);
+  uint32_t index = std::min(segment_state_.top_index, max_entries_ - 1u);
+  if (small_table_ != nullptr || index < kSmallLrtEntries) {
+    top_table_ = (small_table_ != nullptr) ? small_table_ : tables_[0];
+    top_table_start_index_ = 0u;
+    top_table_size_ = kSmallLrtEntries;
+  } else {
+    // Same as `GetEntry()`, the table starting at index `2^n` holds `2^n` entries.
+    size_t table_start_index = TruncToPowerOfTwo(index);
+    top_table_ = tables_[NumTablesForSize(table_start_index)];
+    top_table_start_index_ = dchecked_integral_cast<uint32_t>(table_start_index);
+    top_table_size_ = dchecked_integral_cast<uint32_t>(table_start_index);
+  }
+  DCHECK_EQ(GetTopTableEntry(index), GetEntry(index));
+}
+
 LocalReferenceTable::~LocalReferenceTable() {
   SmallLrtAllocator* small_lrt_allocator =
       max_entries_ != 0u ? Runtime::Current()->GetSmallLrtAllocator() : nullptr;
@@ -248,6 +272,10 @@ inline void LocalReferenceTable::PrunePoppedFreeEntries(EntryGetter&& get_entry)
   free_entries_list_ = FirstFreeField::Update(free_entry_index, free_entries_list);
 }
 
+void LocalReferenceTable::PrunePoppedFreeEntries() {
+  PrunePoppedFreeEntries([&](size_t index) { return GetEntry(index); });
+}
+
 inline uint32_t LocalReferenceTable::IncrementSerialNumber(LrtEntry* serial_number_entry) {
   DCHECK_EQ(serial_number_entry, GetCheckJniSerialNumberEntry(serial_number_entry));
   // The old serial number can be 0 if it was not used before. It can also be bits from the
@@ -262,7 +290,7 @@ inline uint32_t LocalReferenceTable::IncrementSerialNumber(LrtEntry* serial_numb
   return new_serial_number;
 }
 
-IndirectRef LocalReferenceTable::Add(ObjPtr<mirror::Object> obj, std::string* error_msg) {
+IndirectRef LocalReferenceTable::AddSlow(ObjPtr<mirror::Object> obj, std::string* error_msg) {
   if (kDebugLRT) {
     LOG(INFO) << "+++ Add: previous_state=" << previous_state_.top_index
               << " top_index=" << segment_state_.top_index;
@@ -277,6 +305,7 @@ IndirectRef LocalReferenceTable::Add(ObjPtr<mirror::Object> obj, std::string* er
   auto store_obj = [obj, this](LrtEntry* free_entry, const char* tag)
       REQUIRES_SHARED(Locks::mutator_lock_) {
     free_entry->SetReference(obj);
+    UpdateTopTable();
     IndirectRef result = ToIndirectRef(free_entry);
     if (kDebugLRT) {
       LOG(INFO) << "+++ " << tag << ": added at index " << GetReferenceEntryIndex(result)
@@ -463,10 +492,25 @@ bool LocalReferenceTable::Remove(IndirectRef iref) {
   DCheckValidReference(iref);
 
   LrtEntry* entry = ToLrtEntry(iref);
-  uint32_t entry_index = GetReferenceEntryIndex(iref);
   uint32_t top_index = segment_state_.top_index;
   const uint32_t bottom_index = previous_state_.top_index;
 
+  // Fast path for removing the top entry of a segment without holes. There are no free
+  // entries below it to prune.
+  if (top_index != bottom_index &&
+      entry == GetTopTableEntry(top_index - 1u) &&
+      HasNoHolesInCurrentSegment() &&
+      !GetCheckJniSerialNumberEntry(entry)->IsSerialNumber()) {
+    entry->SetReference(reinterpret_cast32<mirror::Object*>(kDeadLocalValue));
+    segment_state_.top_index = top_index - 1u;
+    if (kDebugLRT) {
+      LOG(INFO) << "+++ removed last entry, new top= " << segment_state_.top_index;
+    }
+    return true;
+  }
+
+  uint32_t entry_index = GetReferenceEntryIndex(iref);
+
   if (entry_index < bottom_index) {
     // Wrong segment.
     LOG(WARNING) << "Attempt to remove index outside index area (" << entry_index
@@ -512,7 +556,6 @@ bool LocalReferenceTable::Remove(IndirectRef iref) {
   }
   if (is_top_entry) {
     // Top-most entry. Scan up and consume holes created with the current CheckJNI setting.
-    constexpr uint32_t kDeadLocalValue = 0xdead10c0;
     entry->SetReference(reinterpret_cast32<mirror::Object*>(kDeadLocalValue));
 
     // TODO: Maybe we should not prune free entries from the top of the segment
@@ -581,6 +624,7 @@ bool LocalReferenceTable::Remove(IndirectRef iref) {
           << "free_index=" << free_index << ", prune_start=" << prune_start;
     }
     segment_state_.top_index = prune_start;
+    UpdateTopTable();
     if (kDebugLRT) {
       LOG(INFO) << "+++ removed last entry, pruned " << prune_count
                 << ", new top= " << segment_state_.top_index;
@@ -268,7 +268,10 @@ class LocalReferenceTable {
 
   // Add a new entry. The `obj` must be a valid non-null object reference. This function
   // will return null if an error happened (with an appropriate error message set).
-  EXPORT IndirectRef Add(ObjPtr<mirror::Object> obj, std::string* error_msg)
+  //
+  // With CheckJNI disabled and no holes in the current segment, the entry is added right
+  // at the top of the table holding the top entry, without looking at the segment state.
+  ALWAYS_INLINE IndirectRef Add(ObjPtr<mirror::Object> obj, std::string* error_msg)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
   // Given an `IndirectRef` in the table, return the `Object` it refers to.
@@ -344,6 +347,11 @@ class LocalReferenceTable {
     }
     segment_state_ = previous_state_;
     previous_state_ = previous_state;
+    // Release the holes of the popped segment in bulk, so that `Add()` can use the fast path.
+    if (UNLIKELY(GetFirstFreeIndex() >= segment_state_.top_index) &&
+        GetFirstFreeIndex() != kFreeListEnd) {
+      PrunePoppedFreeEntries();
+    }
   }
 
   static MemberOffset PreviousStateOffset() {
@@ -458,6 +466,27 @@ class LocalReferenceTable {
   // Debug mode check that the reference is valid.
   void DCheckValidReference(IndirectRef iref) const REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Whether CheckJNI is disabled and there are no holes in the current segment, so that
+  // entries are added and removed only at the top.
+  bool HasNoHolesInCurrentSegment() const {
+    uint32_t first_free_index = GetFirstFreeIndex();
+    return !IsCheckJniEnabled() &&
+           (first_free_index < previous_state_.top_index || first_free_index == kFreeListEnd);
+  }
+
+  // Return the entry at `index` if it is in the `top_table_`, otherwise null.
+  LrtEntry* GetTopTableEntry(uint32_t index) const {
+    uint32_t offset = index - top_table_start_index_;
+    return LIKELY(offset < top_table_size_) ? &top_table_[offset] : nullptr;
+  }
+
+  // Set `top_table_` to the table holding the entry at the top index, or the last table
+  // if the table is full.
+  void UpdateTopTable();
+
+  EXPORT IndirectRef AddSlow(ObjPtr<mirror::Object> obj, std::string* error_msg)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
   // Resize the backing table to be at least `new_size` elements long. The `new_size`
   // must be larger than the current size. After return max_entries_ >= new_size.
   bool Resize(size_t new_size, std::string* error_msg);
@@ -471,6 +500,7 @@ class LocalReferenceTable {
   // Called only if `free_entries_list_` points to a popped entry.
   template <typename EntryGetter>
   void PrunePoppedFreeEntries(EntryGetter&& get_entry);
+  EXPORT void PrunePoppedFreeEntries();
 
   // Helper template function for visiting roots.
   template <typename Visitor>
@@ -499,6 +529,13 @@ class LocalReferenceTable {
   LrtEntry* small_table_;  // For optimizing the fast-path.
   dchecked_vector<LrtEntry*> tables_;
 
+  // The table at the top and the range of entry indexes it holds, for adding and removing
+  // entries at the top without searching `tables_`. Compiled JNI stubs push and pop segments
+  // without updating it, so the top index must be checked against the range before use.
+  LrtEntry* top_table_;
+  uint32_t top_table_start_index_;
+  uint32_t top_table_size_;
+
   // Mem maps where we store tables allocated directly with `MemMap`
   // rather than the `SmallLrtAllocator`.
   dchecked_vector<MemMap> table_mem_maps_;
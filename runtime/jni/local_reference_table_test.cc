@@ -1024,5 +1024,58 @@ TEST_F(LocalReferenceTableTest, PruneBeforeTrim) {
   ASSERT_EQ(new_ref, refs[0]);
 }
 
+
+TEST_F(LocalReferenceTableTest, AddRemoveAtTopAcrossTables) {
+  LocalReferenceTable lrt(/*check_jni=*/ false);
+  std::string error_msg;
+  bool success = lrt.Initialize(kSmallLrtEntries, &error_msg);
+  ASSERT_TRUE(success) << error_msg;
+  ScopedObjectAccess soa(Thread::Current());
+  ObjPtr<mirror::Class> c = GetClassRoot<mirror::Object>();
+
+  // Fill the first three tables and start the fourth.
+  const LRTSegmentState cookie0 = lrt.PushFrame();
+  const size_t num_refs = 4u * kSmallLrtEntries + 1u;
+  std::vector<IndirectRef> refs;
+  for (size_t i = 0; i != num_refs; ++i) {
+    refs.push_back(lrt.Add(c, &error_msg));
+    ASSERT_TRUE(refs.back() != nullptr) << error_msg;
+    ASSERT_EQ(i + 1u, lrt.Capacity());
+  }
+  for (IndirectRef ref : refs) {
+    EXPECT_OBJ_PTR_EQ(c, lrt.Get(ref));
+  }
+
+  // Popping a segment with a hole releases the hole, the next addition goes to the top.
+  const LRTSegmentState cookie1 = lrt.PushFrame();
+  IndirectRef inner0 = lrt.Add(c, &error_msg);
+  IndirectRef inner1 = lrt.Add(c, &error_msg);
+  ASSERT_TRUE(inner0 != nullptr);
+  ASSERT_TRUE(inner1 != nullptr);
+  ASSERT_TRUE(lrt.Remove(inner0));
+  lrt.PopFrame(cookie1);
+  ASSERT_EQ(num_refs, lrt.Capacity());
+  IndirectRef top_ref = lrt.Add(c, &error_msg);
+  EXPECT_EQ(inner0, top_ref);
+  ASSERT_TRUE(lrt.Remove(top_ref));
+  ASSERT_EQ(num_refs, lrt.Capacity());
+
+  // A hole in the current segment is reused before adding at the top.
+  IndirectRef removed = refs[num_refs - 2u];
+  ASSERT_TRUE(lrt.Remove(removed));
+  ASSERT_EQ(num_refs, lrt.Capacity());
+  IndirectRef reused = lrt.Add(c, &error_msg);
+  EXPECT_EQ(removed, reused);
+  ASSERT_EQ(num_refs, lrt.Capacity());
+
+  // Removing from the top shrinks the table across table boundaries.
+  for (size_t i = num_refs; i != 0u; --i) {
+    ASSERT_TRUE(lrt.Remove(refs[i - 1u]));
+    ASSERT_EQ(i - 1u, lrt.Capacity());
+  }
+  lrt.PopFrame(cookie0);
+  ASSERT_EQ(0u, lrt.Capacity());
+}
+
 }  // namespace jni
 }  // namespace art
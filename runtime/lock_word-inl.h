@@ -23,7 +23,7 @@
 namespace art HIDDEN {
 
 inline uint32_t LockWord::ThinLockOwner() const {
-  DCHECK_EQ(GetState(), kThinLocked);
+  DCHECK(GetState() == kThinLocked || GetState() == kReserved) << GetState();
   CheckReadBarrierState();
   return (value_ >> kThinLockOwnerShift) & kThinLockOwnerMask;
 }
@@ -34,6 +34,20 @@ inline uint32_t LockWord::ThinLockCount() const {
   return (value_ >> kThinLockCountShift) & kThinLockCountMask;
 }
 
+inline uint32_t LockWord::ReservedLockDepth() const {
+  DCHECK_EQ(GetState(), kReserved);
+  CheckReadBarrierState();
+  return (value_ >> kThinLockCountShift) & kThinLockCountMask;
+}
+
+inline LockWord LockWord::WithoutReservation() const {
+  uint32_t depth = ReservedLockDepth();
+  if (depth == 0u) {
+    return FromDefault(GCState());
+  }
+  return FromThinLockId(ThinLockOwner(), depth - 1u, GCState());
+}
+
 inline Monitor* LockWord::FatLockMonitor() const {
   DCHECK_EQ(GetState(), kFatLocked);
   CheckReadBarrierState();
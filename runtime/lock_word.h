@@ -39,11 +39,20 @@ class Monitor;
  *
  * When the lock word is in the "thin" state and its bits are formatted as follows:
  *
- *  |33|2|2|222222221111|1111110000000000|
- *  |10|9|8|765432109876|5432109876543210|
- *  |00|m|r| lock count |thread id owner |
+ *  |33|2|2|2|22222221111|1111110000000000|
+ *  |10|9|8|7|65432109876|5432109876543210|
+ *  |00|m|r|0| lock count|thread id owner |
  *
  * The lock count is zero, but the owner is nonzero for a simply held lock.
+ * When the lock word is in the "reserved" state and its bits are formatted as follows:
+ *
+ *  |33|2|2|2|22222221111|1111110000000000|
+ *  |10|9|8|7|65432109876|5432109876543210|
+ *  |00|m|r|1| lock depth|thread id owner |
+ *
+ * A reserved lock word belongs to the owner thread even while the lock is not held (depth zero),
+ * so that the owner can lock and unlock it with plain stores. The depth is the number of times
+ * the lock is held. Other threads must revoke the reservation, see Monitor::RevokeReservation().
  * When the lock word is in the "fat" state and its bits are formatted as follows:
  *
  *  |33|2|2|2222222211111111110000000000|
@@ -74,10 +83,12 @@ class LockWord {
     kMarkBitStateSize = 1,
     // Number of bits to encode the thin lock owner.
     kThinLockOwnerSize = 16,
+    // Number of bits to mark a thin lock as reserved.
+    kThinLockReservedSize = 1,
     // Remaining bits are the recursive lock count. Zero means it is locked exactly once
     // and not recursively.
-    kThinLockCountSize = 32 - kThinLockOwnerSize - kStateSize - kReadBarrierStateSize -
-        kMarkBitStateSize,
+    kThinLockCountSize = 32 - kThinLockOwnerSize - kThinLockReservedSize - kStateSize -
+        kReadBarrierStateSize - kMarkBitStateSize,
 
     // Thin lock bits. Owner in lowest bits.
     kThinLockOwnerShift = 0,
@@ -90,9 +101,14 @@ class LockWord {
     kThinLockMaxCount = kThinLockCountMask,
     kThinLockCountOne = 1 << kThinLockCountShift,  // == 65536 (0x10000)
     kThinLockCountMaskShifted = kThinLockCountMask << kThinLockCountShift,
+    // Reserved bit above the count. The count field holds the lock depth of a reserved lock.
+    kThinLockReservedShift = kThinLockCountSize + kThinLockCountShift,
+    kThinLockReservedMask = (1 << kThinLockReservedSize) - 1,
+    kThinLockReservedMaskShifted = kThinLockReservedMask << kThinLockReservedShift,
+    kThinLockMaxReservedDepth = kThinLockCountMask,
 
     // State in the highest bits.
-    kStateShift = kReadBarrierStateSize + kThinLockCountSize + kThinLockCountShift +
+    kStateShift = kReadBarrierStateSize + kThinLockReservedSize + kThinLockReservedShift +
         kMarkBitStateSize,
     kStateMask = (1 << kStateSize) - 1,
     kStateMaskShifted = kStateMask << kStateShift,
@@ -104,7 +120,7 @@ class LockWord {
     kStateForwardingAddressOverflow = (1 + kStateMask - kStateForwardingAddress) << kStateShift,
 
     // Read barrier bit.
-    kReadBarrierStateShift = kThinLockCountSize + kThinLockCountShift,
+    kReadBarrierStateShift = kThinLockReservedSize + kThinLockReservedShift,
     kReadBarrierStateMask = (1 << kReadBarrierStateSize) - 1,
     kReadBarrierStateMaskShifted = kReadBarrierStateMask << kReadBarrierStateShift,
     kReadBarrierStateMaskShiftedToggled = ~kReadBarrierStateMaskShifted,
@@ -149,6 +165,16 @@ class LockWord {
                     (kStateThinOrUnlocked << kStateShift));
   }
 
+  static LockWord FromReservedThinLockId(uint32_t thread_id, uint32_t depth, uint32_t gc_state) {
+    CHECK_LE(thread_id, static_cast<uint32_t>(kThinLockMaxOwner));
+    CHECK_LE(depth, static_cast<uint32_t>(kThinLockMaxReservedDepth));
+    return LockWord((thread_id << kThinLockOwnerShift) |
+                    (depth << kThinLockCountShift) |
+                    kThinLockReservedMaskShifted |
+                    (gc_state << kGCStateShift) |
+                    (kStateThinOrUnlocked << kStateShift));
+  }
+
   static LockWord FromForwardingAddress(size_t target) {
     DCHECK_ALIGNED(target, (1 << kStateSize));
     return LockWord((target >> kForwardingAddressShift) | kStateForwardingAddressShifted);
@@ -177,6 +203,7 @@ class LockWord {
   enum LockState {
     kUnlocked,    // No lock owners.
     kThinLocked,  // Single uncontended owner.
+    kReserved,    // Reserved for a thread, which may or may not hold the lock.
     kFatLocked,   // See associated monitor.
     kHashCode,    // Lock word contains an identity hash.
     kForwardingAddress,  // Lock word contains the forwarding address of an object.
@@ -194,7 +221,7 @@ class LockWord {
     uint32_t internal_state = (value_ >> kStateShift) & kStateMask;
     switch (internal_state) {
       case kStateThinOrUnlocked:
-        return kThinLocked;
+        return ((value_ & kThinLockReservedMaskShifted) != 0) ? kReserved : kThinLocked;
       case kStateHash:
         return kHashCode;
       case kStateForwardingAddress:
@@ -243,6 +270,13 @@ class LockWord {
   // If the lock is held only once the return value is zero.
   uint32_t ThinLockCount() const;
 
+  // Return the number of times a reserved lock is held by its owner. Only valid in reserved state.
+  uint32_t ReservedLockDepth() const;
+
+  // Return the lock word with the reservation dropped: unlocked if the lock is not held,
+  // otherwise thin locked by the owner. Only valid in reserved state.
+  LockWord WithoutReservation() const;
+
   // Return the Monitor encoded in a fat lock.
   Monitor* FatLockMonitor() const;
 
@@ -217,6 +217,19 @@ int32_t Object::IdentityHashCodeHelper() {
         current_this = h_this.Get();
         break;
       }
+      case LockWord::kReserved: {
+        if (!kAllowInflation) {
+          return 0;
+        }
+        // Drop the reservation, then install the hash as for an unlocked or thin locked object.
+        Thread* self = Thread::Current();
+        StackHandleScope<1> hs(self);
+        Handle<mirror::Object> h_this(hs.NewHandle(current_this));
+        Monitor::RevokeReservation(self, h_this, lw);
+        // A GC may have occurred when we switched to kBlocked.
+        current_this = h_this.Get();
+        break;
+      }
       case LockWord::kFatLocked: {
         // Already inflated, return the hash stored in the monitor.
         Monitor* monitor = lw.FatLockMonitor();
@@ -36,6 +36,7 @@
 #include "mirror/class-inl.h"
 #include "mirror/object-inl.h"
 #include "monitor-inl.h"
+#include "monitor_contention_profile.h"
 #include "object_callbacks.h"
 #include "scoped_thread_state_change-inl.h"
 #include "stack.h"
@@ -83,15 +84,29 @@ static constexpr uint64_t kLongWaitMs = 100 * kDebugThresholdFudgeFactor;
 
 uint32_t Monitor::lock_profiling_threshold_ = 0;
 uint32_t Monitor::stack_dump_lock_profiling_threshold_ = 0;
+std::atomic<uint32_t> Monitor::num_reservation_revocations_(0u);
+std::atomic<uint32_t> Monitor::lock_reservation_bits_(0u);
+
+// The lock fast paths in assembly load the bits with a plain 32-bit load.
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t));
 
 void Monitor::Init(uint32_t lock_profiling_threshold,
-                   uint32_t stack_dump_lock_profiling_threshold) {
+                   uint32_t stack_dump_lock_profiling_threshold,
+                   bool use_lock_reservation) {
   // It isn't great to always include the debug build fudge factor for command-
   // line driven arguments, but it's easier to adjust here than in the build.
   lock_profiling_threshold_ =
       lock_profiling_threshold * kDebugThresholdFudgeFactor;
   stack_dump_lock_profiling_threshold_ =
       stack_dump_lock_profiling_threshold * kDebugThresholdFudgeFactor;
+  // The owner updates a reserved lock word with plain stores, which would lose the read barrier
+  // state that the concurrent copying collector sets concurrently.
+  lock_reservation_bits_.store(
+      (use_lock_reservation && !gUseReadBarrier)
+          ? static_cast<uint32_t>(LockWord::kThinLockReservedMaskShifted |
+                                  LockWord::kThinLockCountOne)
+          : 0u,
+      std::memory_order_relaxed);
 }
 
 Monitor::Monitor(Thread* self, Thread* owner, ObjPtr<mirror::Object> obj, int32_t hash_code)
@@ -103,6 +118,8 @@ Monitor::Monitor(Thread* self, Thread* owner, ObjPtr<mirror::Object> obj, int32_
       wait_set_(nullptr),
       wake_set_(nullptr),
       hash_code_(hash_code),
+      spin_limit_(kInitialSpinLimit),
+      spin_retry_countdown_(kSpinRetryInterval),
       lock_owner_(nullptr),
       lock_owner_method_(nullptr),
       lock_owner_dex_pc_(0),
@@ -137,6 +154,8 @@ Monitor::Monitor(Thread* self,
       wait_set_(nullptr),
       wake_set_(nullptr),
       hash_code_(hash_code),
+      spin_limit_(kInitialSpinLimit),
+      spin_retry_countdown_(kSpinRetryInterval),
       lock_owner_(nullptr),
       lock_owner_method_(nullptr),
       lock_owner_dex_pc_(0),
@@ -426,7 +445,7 @@ bool Monitor::TryLock(Thread* self, bool spin) {
     lock_count_++;
     CHECK_NE(lock_count_, 0u);  // Abort on overflow.
   } else {
-    bool success = spin ? monitor_lock_.ExclusiveTryLockWithSpinning(self)
+    bool success = spin ? TryLockWithAdaptiveSpinning(self)
         : monitor_lock_.ExclusiveTryLock(self);
     if (!success) {
       return false;
@@ -443,6 +462,41 @@ bool Monitor::TryLock(Thread* self, bool spin) {
   return true;
 }
 
+bool Monitor::TryLockWithAdaptiveSpinning(Thread* self) {
+  size_t spin_limit = spin_limit_.load(std::memory_order_relaxed);
+  if (spin_limit == 0u) {
+    // Spinning did not pay off recently, so block right away. Still spin now and then
+    // to notice when the monitor is held for shorter periods again.
+    uint8_t countdown = spin_retry_countdown_.load(std::memory_order_relaxed);
+    if (countdown != 0u) {
+      spin_retry_countdown_.store(static_cast<uint8_t>(countdown - 1u), std::memory_order_relaxed);
+      return monitor_lock_.ExclusiveTryLock(self);
+    }
+    spin_retry_countdown_.store(kSpinRetryInterval, std::memory_order_relaxed);
+    spin_limit = 1u;
+  }
+  // Raise the limit slowly while spinning succeeds and back off quickly when it fails.
+  auto update_spin_limit = [this](size_t new_spin_limit) {
+    if (new_spin_limit != spin_limit_.load(std::memory_order_relaxed)) {
+      spin_limit_.store(static_cast<uint8_t>(new_spin_limit), std::memory_order_relaxed);
+    }
+  };
+  if (monitor_lock_.ExclusiveTryLockWithSpinning(self, spin_limit)) {
+    update_spin_limit(std::min<size_t>(spin_limit + 1u, kMaxSpinLimit));
+    return true;
+  }
+  update_spin_limit(spin_limit / 2u);
+  return false;
+}
+
+void Monitor::UpdateThinLockSpinIters(Thread* self, bool success) {
+  // Same policy as for `spin_limit_`, with finer steps since busy spins are much shorter.
+  uint32_t spin_iters = self->GetThinLockSpinIters();
+  self->SetThinLockSpinIters(
+      success ? std::min<uint32_t>(spin_iters + spin_iters / 8u + 1u, kMaxThinLockSpinIters)
+              : std::max<uint32_t>(spin_iters / 2u, kMinThinLockSpinIters));
+}
+
 template <LockReason reason>
 void Monitor::Lock(Thread* self) {
   bool called_monitors_callback = false;
@@ -456,11 +510,12 @@ void Monitor::Lock(Thread* self) {
   }
   // Contended; not reentrant. We hold no locks, so tread carefully.
   const bool log_contention = (lock_profiling_threshold_ != 0);
-  uint64_t wait_start_ms = log_contention ? MilliTime() : 0;
+  uint64_t wait_start_ns = log_contention ? NanoTime() : 0;
+  uint64_t wait_ns = 0u;
 
   Thread *orig_owner = nullptr;
-  ArtMethod* owners_method;
-  uint32_t owners_dex_pc;
+  ArtMethod* owners_method = nullptr;
+  uint32_t owners_dex_pc = 0u;
 
   // Do this before releasing the mutator lock so that we don't get deflated.
   size_t num_waiters = num_waiters_.fetch_add(1, std::memory_order_relaxed);
@@ -525,19 +580,19 @@ void Monitor::Lock(Thread* self) {
 
     if (log_contention && orig_owner != nullptr) {
       // Woken from contention.
-      uint64_t wait_ms = MilliTime() - wait_start_ms;
+      wait_ns = NanoTime() - wait_start_ns;
+      uint64_t wait_ms = NsToMs(wait_ns);
       uint32_t sample_percent;
       if (wait_ms >= lock_profiling_threshold_) {
         sample_percent = 100;
       } else {
         sample_percent = 100 * wait_ms / lock_profiling_threshold_;
       }
+      // Do this unconditionally for consistency. It's possible another thread
+      // snuck in in the middle, and tracing was enabled. In that case, we may get its
+      // MonitorEnter information. We can live with that.
+      GetLockOwnerInfo(&owners_method, &owners_dex_pc, orig_owner);
       if (sample_percent != 0 && (static_cast<uint32_t>(rand() % 100) < sample_percent)) {
-        // Do this unconditionally for consistency. It's possible another thread
-        // snuck in in the middle, and tracing was enabled. In that case, we may get its
-        // MonitorEnter information. We can live with that.
-        GetLockOwnerInfo(&owners_method, &owners_dex_pc, orig_owner);
-
         // Reacquire mutator_lock_ for logging.
         ScopedObjectAccess soa(self);
 
@@ -628,6 +683,18 @@ void Monitor::Lock(Thread* self) {
   owner_.store(self, std::memory_order_relaxed);
   DCHECK_EQ(lock_count_, 0u);
 
+  if (wait_ns != 0u) {
+    // Unlike the logging above, aggregate every contended acquisition.
+    MonitorContentionProfile* contention_profile =
+        Runtime::Current()->GetMonitorContentionProfile();
+    if (contention_profile != nullptr) {
+      ArtMethod* waiters_method = self->GetCurrentMethod(/*dex_pc=*/ nullptr,
+                                                         /*check_suspended=*/ true,
+                                                         /*abort_on_error=*/ false);
+      contention_profile->Record(owners_method, waiters_method, wait_ns);
+    }
+  }
+
   if (ATraceEnabled()) {
     SetLockingMethodNoProxy(self);
   }
@@ -1091,6 +1158,57 @@ void Monitor::InflateThinLocked(Thread* self,
   }
 }
 
+void Monitor::RevokeReservation(Thread* self, Handle<mirror::Object> obj, LockWord lock_word) {
+  DCHECK_EQ(lock_word.GetState(), LockWord::kReserved);
+  uint32_t owner_thread_id = lock_word.ThinLockOwner();
+  if (owner_thread_id == self->GetThreadId()) {
+    // Only the owner changes a reserved lock word without suspending the owner first.
+    obj->SetLockWord(lock_word.WithoutReservation(), /* as_volatile= */ false);
+    return;
+  }
+  uint32_t revocations = num_reservation_revocations_.fetch_add(1u, std::memory_order_relaxed);
+  if (revocations + 1u == kMaxReservationRevocations) {
+    VLOG(monitor) << "monitor: too many revoked lock reservations, no longer reserving locks";
+    lock_reservation_bits_.store(0u, std::memory_order_relaxed);
+  }
+  ThreadList* thread_list = Runtime::Current()->GetThreadList();
+  // Suspend the owner, so that it cannot update the lock word while we rewrite it. First change
+  // to blocked and give up mutator_lock_.
+  self->SetMonitorEnterObject(obj.Get());
+  Thread* owner;
+  {
+    ScopedThreadSuspension sts(self, ThreadState::kWaitingForLockInflation);
+    owner = thread_list->SuspendThreadByThreadId(owner_thread_id, SuspendReason::kInternal);
+  }
+  if (owner != nullptr) {
+    // Other threads may be revoking the reservation at the same time, so use a CAS.
+    lock_word = obj->GetLockWord(true);
+    if (lock_word.GetState() == LockWord::kReserved &&
+        lock_word.ThinLockOwner() == owner_thread_id) {
+      obj->CasLockWord(lock_word,
+                       lock_word.WithoutReservation(),
+                       CASMode::kStrong,
+                       std::memory_order_release);
+    }
+    bool resumed = thread_list->Resume(owner, SuspendReason::kInternal);
+    DCHECK(resumed);
+  } else {
+    // The owner may have exited. A thread cannot use the reservation before it is registered
+    // with the thread list, so the reservation can be dropped while no thread has that id.
+    MutexLock mu(self, *Locks::thread_list_lock_);
+    lock_word = obj->GetLockWord(true);
+    if (thread_list->FindThreadByThreadId(owner_thread_id) == nullptr &&
+        lock_word.GetState() == LockWord::kReserved &&
+        lock_word.ThinLockOwner() == owner_thread_id) {
+      obj->CasLockWord(lock_word,
+                       lock_word.WithoutReservation(),
+                       CASMode::kStrong,
+                       std::memory_order_release);
+    }
+  }
+  self->SetMonitorEnterObject(nullptr);
+}
+
 // Fool annotalysis into thinking that the lock on obj is acquired.
 static ObjPtr<mirror::Object> FakeLock(ObjPtr<mirror::Object> obj)
     EXCLUSIVE_LOCK_FUNCTION(obj.Ptr()) NO_THREAD_SAFETY_ANALYSIS {
@@ -1112,7 +1230,7 @@ ObjPtr<mirror::Object> Monitor::MonitorEnter(Thread* self,
   obj = FakeLock(obj);
   uint32_t thread_id = self->GetThreadId();
   size_t contention_count = 0;
-  constexpr size_t kExtraSpinIters = 100;
+  size_t extra_spin_iters = 0;
   int inflation_attempt = 1;
   StackHandleScope<1> hs(self);
   Handle<mirror::Object> h_obj(hs.NewHandle(obj));
@@ -1124,8 +1242,16 @@ ObjPtr<mirror::Object> Monitor::MonitorEnter(Thread* self,
     switch (lock_word.GetState()) {
       case LockWord::kUnlocked: {
         // No ordering required for preceding lockword read, since we retest.
-        LockWord thin_locked(LockWord::FromThinLockId(thread_id, 0, lock_word.GCState()));
+        LockWord thin_locked(
+            ShouldReserve()
+                ? LockWord::FromReservedThinLockId(thread_id, 1u, lock_word.GCState())
+                : LockWord::FromThinLockId(thread_id, 0, lock_word.GCState()));
         if (h_obj->CasLockWord(lock_word, thin_locked, CASMode::kWeak, std::memory_order_acquire)) {
+          if (contention_count != 0u && contention_count <= extra_spin_iters) {
+            // Busy spinning paid off. Acquisitions after yielding do not count, the owner
+            // held the lock for longer than the busy spins.
+            UpdateThinLockSpinIters(self, /*success=*/ true);
+          }
           AtraceMonitorLock(self, h_obj.Get(), /* is_wait= */ false);
           return h_obj.Get();  // Success!
         }
@@ -1168,17 +1294,21 @@ ObjPtr<mirror::Object> Monitor::MonitorEnter(Thread* self,
           }
           // Contention.
           contention_count++;
+          if (contention_count == 1u) {
+            extra_spin_iters = self->GetThinLockSpinIters();
+          }
           Runtime* runtime = Runtime::Current();
           if (contention_count
-              <= kExtraSpinIters + runtime->GetMaxSpinsBeforeThinLockInflation()) {
+              <= extra_spin_iters + runtime->GetMaxSpinsBeforeThinLockInflation()) {
             // TODO: Consider switching the thread state to kWaitingForLockInflation when we are
             // yielding.  Use sched_yield instead of NanoSleep since NanoSleep can wait much longer
             // than the parameter you pass in. This can cause thread suspension to take excessively
             // long and make long pauses. See b/16307460.
-            if (contention_count > kExtraSpinIters) {
+            if (contention_count > extra_spin_iters) {
               sched_yield();
             }
           } else {
+            UpdateThinLockSpinIters(self, /*success=*/ false);
             contention_count = 0;
             // No ordering required for initial lockword read. Install rereads it anyway.
             InflateThinLocked(self, h_obj, lock_word, 0, inflation_attempt++);
@@ -1186,6 +1316,24 @@ ObjPtr<mirror::Object> Monitor::MonitorEnter(Thread* self,
         }
         continue;  // Start from the beginning.
       }
+      case LockWord::kReserved: {
+        if (lock_word.ThinLockOwner() == thread_id) {
+          uint32_t new_depth = lock_word.ReservedLockDepth() + 1;
+          if (LIKELY(new_depth <= LockWord::kThinLockMaxReservedDepth)) {
+            // Other threads suspend us before touching the lock word, so a plain store suffices.
+            DCHECK(!gUseReadBarrier);
+            h_obj->SetLockWord(
+                LockWord::FromReservedThinLockId(thread_id, new_depth, lock_word.GCState()),
+                /* as_volatile= */ false);
+            AtraceMonitorLock(self, h_obj.Get(), /* is_wait= */ false);
+            return h_obj.Get();  // Success!
+          }
+          // We'd overflow the lock depth, continue with an ordinary thin lock.
+        }
+        // Nobody else may take a lock reserved for its owner, even if the owner does not hold it.
+        RevokeReservation(self, h_obj, lock_word);
+        continue;  // Start from the beginning.
+      }
       case LockWord::kFatLocked: {
         // We should have done an acquire read of the lockword initially, to ensure
         // visibility of the monitor data structure. Use an explicit fence instead.
@@ -1263,6 +1411,26 @@ bool Monitor::MonitorExit(Thread* self, ObjPtr<mirror::Object> obj) {
           continue;  // Go again.
         }
       }
+      case LockWord::kReserved: {
+        uint32_t thread_id = self->GetThreadId();
+        uint32_t owner_thread_id = lock_word.ThinLockOwner();
+        if (owner_thread_id != thread_id || lock_word.ReservedLockDepth() == 0u) {
+          FailedUnlock(h_obj.Get(),
+                       thread_id,
+                       lock_word.ReservedLockDepth() != 0u ? owner_thread_id : 0u,
+                       nullptr);
+          return false;  // Failure.
+        }
+        // We own the lock, decrease the depth and keep the reservation. Other threads suspend
+        // us before acquiring the lock, so a plain store without release semantics suffices.
+        DCHECK(!gUseReadBarrier);
+        h_obj->SetLockWord(LockWord::FromReservedThinLockId(thread_id,
+                                                            lock_word.ReservedLockDepth() - 1u,
+                                                            lock_word.GCState()),
+                           /* as_volatile= */ false);
+        AtraceMonitorUnlock();
+        return true;  // Success!
+      }
       case LockWord::kFatLocked: {
         Monitor* mon = lock_word.FatLockMonitor();
         return mon->Unlock(self);
@@ -1314,6 +1482,17 @@ void Monitor::Wait(Thread* self,
         }
         break;
       }
+      case LockWord::kReserved: {
+        if (lock_word.ThinLockOwner() != self->GetThreadId() ||
+            lock_word.ReservedLockDepth() == 0u) {
+          ThrowIllegalMonitorStateExceptionF("object not locked by thread before wait()");
+          return;  // Failure.
+        }
+        // We hold the lock. Turn it into an ordinary thin lock and inflate that.
+        RevokeReservation(self, h_obj, lock_word);
+        lock_word = h_obj->GetLockWord(true);
+        break;
+      }
       case LockWord::kFatLocked:  // Unreachable given the loop condition above. Fall-through.
       default: {
         LOG(FATAL) << "Invalid monitor state " << lock_word.GetState();
@@ -1346,6 +1525,15 @@ void Monitor::DoNotify(Thread* self, ObjPtr<mirror::Object> obj, bool notify_all
         return;  // Success.
       }
     }
+    case LockWord::kReserved: {
+      if (lock_word.ThinLockOwner() != self->GetThreadId() ||
+          lock_word.ReservedLockDepth() == 0u) {
+        ThrowIllegalMonitorStateExceptionF("object not locked by thread before notify()");
+        return;  // Failure.
+      }
+      // We own the lock but there's no Monitor and therefore no waiters.
+      return;  // Success.
+    }
     case LockWord::kFatLocked: {
       Monitor* mon = lock_word.FatLockMonitor();
       if (notify_all) {
@@ -1373,6 +1561,10 @@ uint32_t Monitor::GetLockOwnerThreadId(ObjPtr<mirror::Object> obj) {
       return ThreadList::kInvalidThreadId;
     case LockWord::kThinLocked:
       return lock_word.ThinLockOwner();
+    case LockWord::kReserved:
+      return (lock_word.ReservedLockDepth() != 0u)
+          ? lock_word.ThinLockOwner()
+          : ThreadList::kInvalidThreadId;
     case LockWord::kFatLocked: {
       Monitor* mon = lock_word.FatLockMonitor();
       // Since we hold a share of the mutator lock, the obj lock cannot be deflated here.
@@ -1562,6 +1754,8 @@ bool Monitor::IsValidLockWord(LockWord lock_word) {
       // Nothing to check.
       return true;
     case LockWord::kThinLocked:
+      // Fall-through.
+    case LockWord::kReserved:
       // Basic consistency check of owner.
       return lock_word.ThinLockOwner() != ThreadList::kInvalidThreadId;
     case LockWord::kFatLocked: {
@@ -1741,6 +1935,16 @@ MonitorInfo::MonitorInfo(ObjPtr<mirror::Object> obj) : owner_(nullptr), entry_co
       entry_count_ = 1 + lock_word.ThinLockCount();
       // Thin locks have no waiters.
       break;
+    case LockWord::kReserved:
+      // A reservation alone does not make the owner hold the lock.
+      if (lock_word.ReservedLockDepth() != 0u) {
+        owner_ =
+            Runtime::Current()->GetThreadList()->FindThreadByThreadId(lock_word.ThinLockOwner());
+        DCHECK(owner_ != nullptr) << "Reserved and held without owner!";
+        entry_count_ = lock_word.ReservedLockDepth();
+      }
+      // Reserved locks have no waiters.
+      break;
     case LockWord::kFatLocked: {
       Monitor* mon = lock_word.FatLockMonitor();
       owner_ = mon->owner_.load(std::memory_order_relaxed);
@@ -68,9 +68,19 @@ class Monitor {
 
   static constexpr int kMonitorTimeoutMaxMs = 1000;  // 1 second
 
+  // Bounds for the number of busy spins on a contended thin lock before yielding. Each thread
+  // learns its own number from whether its recent contended thin lock acquisitions succeeded
+  // while busy spinning or had to inflate, see Thread::GetThinLockSpinIters(). There is no
+  // monitor yet to keep this in. Once inflated, a monitor learns its own `spin_limit_`.
+  static constexpr uint32_t kInitialThinLockSpinIters = 100u;
+  static constexpr uint32_t kMinThinLockSpinIters = 10u;
+  static constexpr uint32_t kMaxThinLockSpinIters = 1000u;
+
   ~Monitor();
 
-  static void Init(uint32_t lock_profiling_threshold, uint32_t stack_dump_lock_profiling_threshold);
+  static void Init(uint32_t lock_profiling_threshold,
+                   uint32_t stack_dump_lock_profiling_threshold,
+                   bool use_lock_reservation);
 
   // Return the thread id of the lock owner or 0 when there is no owner.
   EXPORT static uint32_t GetLockOwnerThreadId(ObjPtr<mirror::Object> obj)
@@ -165,6 +175,12 @@ class Monitor {
                                 uint32_t hash_code,
                                 int attempt_of_4 = 0) REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Drop the reservation of a reserved lock word, see LockWord. A lock held by the owner stays
+  // thin locked by it. Suspends the owner unless it is the current thread. May fail spuriously,
+  // the caller must re-read the lock word.
+  static void RevokeReservation(Thread* self, Handle<mirror::Object> obj, LockWord lock_word)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
   // Try to deflate the monitor associated with obj. Only called when we logically hold
   // mutator_lock_ exclusively. ImageWriter calls this without actually invoking SuspendAll, but
   // it is already entirely single-threaded.
@@ -238,6 +254,14 @@ class Monitor {
       TRY_ACQUIRE(true, monitor_lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Try to lock `monitor_lock_`, spinning as long as recent acquisitions suggest that the
+  // owner releases it soon enough. Updates `spin_limit_` with the outcome.
+  bool TryLockWithAdaptiveSpinning(Thread* self) TRY_ACQUIRE(true, monitor_lock_);
+
+  // Record whether busy spinning on a contended thin lock acquired it (`success`) or the lock
+  // had to be inflated. Updates the spin count of `self`.
+  static void UpdateThinLockSpinIters(Thread* self, bool success);
+
   template<LockReason reason = LockReason::kForLock>
   void Lock(Thread* self)
       ACQUIRE(monitor_lock_)
@@ -322,6 +346,27 @@ class Monitor {
   static uint32_t stack_dump_lock_profiling_threshold_;
   static bool capture_method_eagerly_;
 
+  // Bounds for `spin_limit_`, in spins of Mutex::ExclusiveTryLockWithSpinning().
+  static constexpr uint8_t kInitialSpinLimit = Mutex::kDefaultMaxSpins;
+  static constexpr uint8_t kMaxSpinLimit = 2u * Mutex::kDefaultMaxSpins;
+  // While spinning does not pay off, spin anyway once in this many acquisitions.
+  static constexpr uint8_t kSpinRetryInterval = 16u;
+
+  // Whether MonitorEnter() reserves unlocked objects for the locking thread, see LockWord.
+  // Reservation is given up for good once this many reservations had to be revoked, since
+  // every revocation suspends the owner.
+  static constexpr uint32_t kMaxReservationRevocations = 1000u;
+  static std::atomic<uint32_t> num_reservation_revocations_;
+
+  // The bits that the locking thread adds to its thread id when it locks an unlocked object:
+  // the reserved bit and a depth of one while locks are reserved, otherwise none for a thin lock.
+  // Also read by the lock fast paths in assembly, see LOCK_OBJECT_FAST_PATH.
+  static std::atomic<uint32_t> lock_reservation_bits_;
+
+  static bool ShouldReserve() {
+    return lock_reservation_bits_.load(std::memory_order_relaxed) != 0u;
+  }
+
   // Holding the monitor N times is represented by holding monitor_lock_ N times.
   Mutex monitor_lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
 
@@ -356,6 +401,13 @@ class Monitor {
   // Stored object hash code, generated lazily by GetHashCode.
   AtomicInteger hash_code_;
 
+  // How long to spin on a contended `monitor_lock_`. Raised when spinning acquires it and
+  // halved when it does not, so monitors held for long never spin. Updated without
+  // synchronization, lost updates only delay the adaptation.
+  std::atomic<uint8_t> spin_limit_;
+  // Acquisitions left until the next spin while `spin_limit_` is zero.
+  std::atomic<uint8_t> spin_retry_countdown_;
+
   // Data structure used to remember the method and dex pc of a recent holder of the
   // lock. Used for tracing and contention reporting. Setting these is expensive, since it
   // involves a partial stack walk. We set them only as follows, to minimize the cost:
@@ -441,6 +493,7 @@ class Monitor {
   friend class MonitorList;
   friend class MonitorPool;
   friend class mirror::Object;
+  ART_FRIEND_TEST(MonitorTest, AdaptiveSpinning);
   DISALLOW_COPY_AND_ASSIGN(Monitor);
 };
 
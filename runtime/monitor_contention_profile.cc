@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "monitor_contention_profile.h"
+
+#include <algorithm>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "art_method-inl.h"
+#include "base/time_utils.h"
+#include "scoped_thread_state_change-inl.h"
+#include "thread-current-inl.h"
+
+namespace art HIDDEN {
+
+static std::string PrettyMethodOrUnknown(ArtMethod* method)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  return method != nullptr ? method->PrettyMethod() : "<unknown>";
+}
+
+MonitorContentionProfile::MonitorContentionProfile()
+    : lock_("Monitor contention profile lock", kPostMonitorLock) {}
+
+void MonitorContentionProfile::Record(ArtMethod* owner_method,
+                                      ArtMethod* waiter_method,
+                                      uint64_t wait_ns) {
+  MutexLock mu(Thread::Current(), lock_);
+  total_.Add(wait_ns);
+  auto key = std::make_pair(owner_method, waiter_method);
+  auto it = entries_.find(key);
+  if (it != entries_.end()) {
+    it->second.Add(wait_ns);
+  } else if (entries_.size() < kMaxEntries) {
+    entries_[key].Add(wait_ns);
+  }
+}
+
+void MonitorContentionProfile::Clear() {
+  MutexLock mu(Thread::Current(), lock_);
+  entries_.clear();
+  total_ = Stats();
+}
+
+void MonitorContentionProfile::DumpForSigQuit(std::ostream& os) {
+  ScopedObjectAccess soa(Thread::Current());
+  Dump(os, kMaxDumpedEntries);
+}
+
+void MonitorContentionProfile::Dump(std::ostream& os, size_t max_entries) {
+  std::vector<std::pair<std::string, Stats>> lines;
+  Stats total;
+  {
+    // Format the methods with the lock held, Clear() must not return while they are in use.
+    MutexLock mu(Thread::Current(), lock_);
+    std::vector<std::pair<std::pair<ArtMethod*, ArtMethod*>, Stats>> sorted(entries_.begin(),
+                                                                            entries_.end());
+    auto by_total_wait = [](const auto& lhs, const auto& rhs) {
+      return lhs.second.total_wait_ns > rhs.second.total_wait_ns;
+    };
+    size_t num_lines = std::min(max_entries, sorted.size());
+    std::partial_sort(sorted.begin(), sorted.begin() + num_lines, sorted.end(), by_total_wait);
+    for (size_t i = 0; i != num_lines; ++i) {
+      const auto& [methods, stats] = sorted[i];
+      lines.emplace_back(
+          PrettyMethodOrUnknown(methods.first) + " <- " + PrettyMethodOrUnknown(methods.second),
+          stats);
+    }
+    total = total_;
+  }
+  os << "Monitor contention: count=" << total.count
+     << " total wait=" << PrettyDuration(total.total_wait_ns)
+     << " max wait=" << PrettyDuration(total.max_wait_ns) << "\n";
+  for (const auto& [line, stats] : lines) {
+    os << "  count=" << stats.count
+       << " total wait=" << PrettyDuration(stats.total_wait_ns)
+       << " max wait=" << PrettyDuration(stats.max_wait_ns)
+       << " owner <- waiter: " << line << "\n";
+  }
+}
+
+}  // namespace art
@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_MONITOR_CONTENTION_PROFILE_H_
+#define ART_RUNTIME_MONITOR_CONTENTION_PROFILE_H_
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <iosfwd>
+#include <map>
+#include <utility>
+
+#include "base/macros.h"
+#include "base/mutex.h"
+
+namespace art HIDDEN {
+
+class ArtMethod;
+
+// Aggregated monitor contention, keyed by the method that held the monitor and the method
+// that waited for it. Unlike the sampled contention logging, every contended acquisition
+// is counted, so that frequent short waits show up as well as the rare long ones.
+//
+// Enabled together with the contention logging by -Xlockprofthreshold and dumped on SIGQUIT.
+// The methods are not visited as roots, so the profile is cleared when classes are unloaded.
+class MonitorContentionProfile {
+ public:
+  // Number of distinct (owner method, waiter method) pairs kept. Later pairs are only counted
+  // in the total.
+  static constexpr size_t kMaxEntries = 1024u;
+  // Number of pairs with the longest total wait time printed by DumpForSigQuit().
+  static constexpr size_t kMaxDumpedEntries = 20u;
+
+  MonitorContentionProfile();
+
+  // Record a contended acquisition. Either method may be null if it is unknown.
+  void Record(ArtMethod* owner_method, ArtMethod* waiter_method, uint64_t wait_ns)
+      REQUIRES(!lock_);
+
+  // Remove all entries. Must be called before methods are freed.
+  void Clear() REQUIRES(!lock_);
+
+  void DumpForSigQuit(std::ostream& os) REQUIRES(!lock_) REQUIRES(!Locks::mutator_lock_);
+
+  void Dump(std::ostream& os, size_t max_entries)
+      REQUIRES(!lock_) REQUIRES_SHARED(Locks::mutator_lock_);
+
+ private:
+  struct Stats {
+    uint64_t count = 0u;
+    uint64_t total_wait_ns = 0u;
+    uint64_t max_wait_ns = 0u;
+
+    void Add(uint64_t wait_ns) {
+      ++count;
+      total_wait_ns += wait_ns;
+      max_wait_ns = std::max(max_wait_ns, wait_ns);
+    }
+  };
+
+  // Taken while holding a monitor lock.
+  Mutex lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
+  std::map<std::pair<ArtMethod*, ArtMethod*>, Stats> entries_ GUARDED_BY(lock_);
+  // All recorded acquisitions, including the ones without an entry.
+  Stats total_ GUARDED_BY(lock_);
+
+  DISALLOW_COPY_AND_ASSIGN(MonitorContentionProfile);
+};
+
+}  // namespace art
+
+#endif  // ART_RUNTIME_MONITOR_CONTENTION_PROFILE_H_
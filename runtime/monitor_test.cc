@@ -16,18 +16,25 @@
 
 #include "monitor.h"
 
+#include <sched.h>
+
+#include <atomic>
 #include <memory>
+#include <sstream>
 #include <string>
 
 #include "base/atomic.h"
 #include "barrier.h"
 #include "base/time_utils.h"
 #include "class_linker-inl.h"
+#include "class_root-inl.h"
 #include "common_runtime_test.h"
 #include "handle_scope-inl.h"
 #include "jni/java_vm_ext.h"
+#include "lock_word-inl.h"
 #include "mirror/class-inl.h"
 #include "mirror/string-inl.h"  // Strings are easiest to allocate
+#include "monitor_contention_profile.h"
 #include "object_lock.h"
 #include "scoped_thread_state_change-inl.h"
 #include "thread_pool.h"
@@ -391,5 +398,279 @@ TEST_F(MonitorTest, TestTryLock) {
   thread_pool->StopWorkers(self);
 }
 
+TEST_F(MonitorTest, ContentionProfile) {
+  Thread* const self = Thread::Current();
+  ScopedObjectAccess soa(self);
+  ObjPtr<mirror::Class> object_class = GetClassRoot<mirror::Object>();
+  ArtMethod* to_string =
+      object_class->FindClassMethod("toString", "()Ljava/lang/String;", kRuntimePointerSize);
+  ArtMethod* hash_code = object_class->FindClassMethod("hashCode", "()I", kRuntimePointerSize);
+  ASSERT_TRUE(to_string != nullptr);
+  ASSERT_TRUE(hash_code != nullptr);
+
+  MonitorContentionProfile profile;
+  profile.Record(to_string, hash_code, MsToNs(1));
+  profile.Record(to_string, hash_code, MsToNs(3));
+  profile.Record(hash_code, to_string, MsToNs(10));
+  profile.Record(/*owner_method=*/ nullptr, hash_code, MsToNs(2));
+
+  std::ostringstream oss;
+  profile.Dump(oss, /*max_entries=*/ 2u);
+  std::string dump = oss.str();
+  EXPECT_NE(dump.find("count=4 total wait=16ms max wait=10ms"), std::string::npos) << dump;
+  // Sorted by total wait time, only the two longest.
+  size_t first = dump.find("count=1 total wait=10ms");
+  size_t second = dump.find("count=2 total wait=4ms max wait=3ms");
+  EXPECT_NE(first, std::string::npos) << dump;
+  EXPECT_NE(second, std::string::npos) << dump;
+  EXPECT_LT(first, second) << dump;
+  EXPECT_EQ(dump.find("<unknown>"), std::string::npos) << dump;
+  EXPECT_NE(dump.find(to_string->PrettyMethod() + " <- " + hash_code->PrettyMethod()),
+            std::string::npos) << dump;
+
+  profile.Clear();
+  std::ostringstream cleared_oss;
+  profile.Dump(cleared_oss, /*max_entries=*/ 2u);
+  EXPECT_EQ(cleared_oss.str(), "Monitor contention: count=0 total wait=0 max wait=0\n");
+}
+
+
+// Holds the lock of an object until `release` is set or, if `waiter` is not null, until the
+// waiter blocks on the lock.
+class LockHolderTask : public Task {
+ public:
+  LockHolderTask(jobject obj,
+                 Thread* waiter,
+                 std::atomic<bool>* locked,
+                 const std::atomic<bool>* release)
+      : obj_(obj), waiter_(waiter), locked_(locked), release_(release) {}
+
+  void Run(Thread* self) override {
+    ScopedObjectAccess soa(self);
+    StackHandleScope<1> hs(self);
+    Handle<mirror::Object> obj(hs.NewHandle(soa.Decode<mirror::Object>(obj_)));
+    ObjectLock<mirror::Object> lock(self, obj);
+    locked_->store(true, std::memory_order_release);
+    // Stay suspended so that the waiter can inflate the lock.
+    ScopedThreadSuspension sts(self, ThreadState::kSuspended);
+    while (!release_->load(std::memory_order_acquire) &&
+           (waiter_ == nullptr || waiter_->GetState() != ThreadState::kBlocked)) {
+      sched_yield();
+    }
+  }
+
+  void Finalize() override {
+    delete this;
+  }
+
+ private:
+  jobject obj_;
+  Thread* waiter_;
+  std::atomic<bool>* locked_;
+  const std::atomic<bool>* release_;
+};
+
+TEST_F(MonitorTest, AdaptiveSpinning) {
+  Thread* const self = Thread::Current();
+  std::unique_ptr<ThreadPool> thread_pool(ThreadPool::Create("the pool", 1));
+  ScopedObjectAccess soa(self);
+  StackHandleScope<1> hs(self);
+  Handle<mirror::Object> obj(
+      hs.NewHandle<mirror::Object>(mirror::String::AllocFromModifiedUtf8(self, "hello, world!")));
+  jobject g_obj = soa.Vm()->AddGlobalRef(self, obj.Get());
+  ASSERT_TRUE(g_obj != nullptr);
+
+  // Busy spinning on thin locks grows slowly while it acquires the lock and halves when the
+  // lock has to be inflated, within bounds.
+  self->SetThinLockSpinIters(Monitor::kInitialThinLockSpinIters);
+  Monitor::UpdateThinLockSpinIters(self, /*success=*/ false);
+  EXPECT_EQ(self->GetThinLockSpinIters(), Monitor::kInitialThinLockSpinIters / 2u);
+  for (size_t i = 0; i != 10u; ++i) {
+    Monitor::UpdateThinLockSpinIters(self, /*success=*/ false);
+  }
+  EXPECT_EQ(self->GetThinLockSpinIters(), Monitor::kMinThinLockSpinIters);
+  Monitor::UpdateThinLockSpinIters(self, /*success=*/ true);
+  EXPECT_GT(self->GetThinLockSpinIters(), Monitor::kMinThinLockSpinIters);
+  for (size_t i = 0; i != 100u; ++i) {
+    Monitor::UpdateThinLockSpinIters(self, /*success=*/ true);
+  }
+  EXPECT_EQ(self->GetThinLockSpinIters(), Monitor::kMaxThinLockSpinIters);
+
+  // A thin lock held for longer than the busy spins and yields gets inflated. Only the
+  // spin count of the waiting thread is lowered.
+  self->SetThinLockSpinIters(Monitor::kInitialThinLockSpinIters);
+  std::atomic<bool> locked(false);
+  std::atomic<bool> release(false);
+  thread_pool->AddTask(self, new LockHolderTask(g_obj, self, &locked, &release));
+  thread_pool->StartWorkers(self);
+  {
+    ScopedThreadSuspension sts(self, ThreadState::kSuspended);
+    while (!locked.load(std::memory_order_acquire)) {
+      sched_yield();
+    }
+  }
+  ASSERT_EQ(obj->GetLockWord(true).GetState(), LockWord::kThinLocked);
+  {
+    ObjectLock<mirror::Object> lock(self, obj);
+    EXPECT_EQ(obj->GetLockWord(true).GetState(), LockWord::kFatLocked);
+  }
+  EXPECT_EQ(self->GetThinLockSpinIters(), Monitor::kInitialThinLockSpinIters / 2u);
+  {
+    ScopedThreadSuspension sts(self, ThreadState::kSuspended);
+    thread_pool->Wait(self, /*do_work=*/ false, /*may_hold_locks=*/ false);
+  }
+  ASSERT_EQ(obj->GetLockWord(true).GetState(), LockWord::kFatLocked);
+  Monitor* monitor = obj->GetLockWord(true).FatLockMonitor();
+
+  // An inflated monitor that keeps being held for long stops spinning, except once in
+  // `kSpinRetryInterval` acquisitions.
+  locked.store(false, std::memory_order_relaxed);
+  thread_pool->AddTask(self, new LockHolderTask(g_obj, /*waiter=*/ nullptr, &locked, &release));
+  {
+    ScopedThreadSuspension sts(self, ThreadState::kSuspended);
+    while (!locked.load(std::memory_order_acquire)) {
+      sched_yield();
+    }
+  }
+  auto try_lock = [&]() NO_THREAD_SAFETY_ANALYSIS {
+    bool acquired = monitor->TryLockWithAdaptiveSpinning(self);
+    if (acquired) {
+      monitor->monitor_lock_.ExclusiveUnlock(self);
+    }
+    return acquired;
+  };
+  monitor->spin_limit_.store(Monitor::kInitialSpinLimit, std::memory_order_relaxed);
+  monitor->spin_retry_countdown_.store(Monitor::kSpinRetryInterval, std::memory_order_relaxed);
+  for (size_t spin_limit = Monitor::kInitialSpinLimit / 2u; ; spin_limit /= 2u) {
+    EXPECT_FALSE(try_lock());
+    EXPECT_EQ(monitor->spin_limit_.load(std::memory_order_relaxed), spin_limit);
+    if (spin_limit == 0u) {
+      break;
+    }
+  }
+  for (size_t i = 0; i != Monitor::kSpinRetryInterval; ++i) {
+    EXPECT_FALSE(try_lock());
+    EXPECT_EQ(monitor->spin_retry_countdown_.load(std::memory_order_relaxed),
+              Monitor::kSpinRetryInterval - 1u - i);
+  }
+  // The retry spins once more and fails again.
+  EXPECT_FALSE(try_lock());
+  EXPECT_EQ(monitor->spin_limit_.load(std::memory_order_relaxed), 0u);
+  EXPECT_EQ(monitor->spin_retry_countdown_.load(std::memory_order_relaxed),
+            Monitor::kSpinRetryInterval);
+  release.store(true, std::memory_order_release);
+  {
+    ScopedThreadSuspension sts(self, ThreadState::kSuspended);
+    thread_pool->Wait(self, /*do_work=*/ false, /*may_hold_locks=*/ false);
+  }
+
+  // Spinning that acquires the monitor raises the limit again.
+  monitor->spin_limit_.store(1u, std::memory_order_relaxed);
+  EXPECT_TRUE(try_lock());
+  EXPECT_EQ(monitor->spin_limit_.load(std::memory_order_relaxed), 2u);
+
+  thread_pool->StopWorkers(self);
+  soa.Vm()->DeleteGlobalRef(self, g_obj);
+}
+
+
+class MonitorReservationTest : public MonitorTest {
+ protected:
+  void SetUpRuntimeOptions(RuntimeOptions *options) override {
+    MonitorTest::SetUpRuntimeOptions(options);
+    options->push_back(std::make_pair("-XX:LockReservation=true", nullptr));
+  }
+};
+
+class ReservedLockTask : public Task {
+ public:
+  explicit ReservedLockTask(jobject obj) : obj_(obj) {}
+
+  void Run(Thread* self) override {
+    ScopedObjectAccess soa(self);
+    StackHandleScope<1> hs(self);
+    Handle<mirror::Object> obj(hs.NewHandle(soa.Decode<mirror::Object>(obj_)));
+    // Revokes the reservation of the main thread, then reserves the lock for this thread.
+    {
+      ObjectLock<mirror::Object> lock(self, obj);
+      EXPECT_EQ(Monitor::GetLockOwnerThreadId(obj.Get()), self->GetThreadId());
+    }
+    LockWord lock_word = obj->GetLockWord(true);
+    EXPECT_EQ(lock_word.GetState(), LockWord::kReserved);
+    EXPECT_EQ(lock_word.ThinLockOwner(), self->GetThreadId());
+  }
+
+  void Finalize() override {
+    delete this;
+  }
+
+ private:
+  jobject obj_;
+};
+
+TEST_F(MonitorReservationTest, ReserveAndRevoke) {
+  if (gUseReadBarrier) {
+    GTEST_SKIP() << "Locks are not reserved with read barriers.";
+  }
+  Thread* const self = Thread::Current();
+  std::unique_ptr<ThreadPool> thread_pool(ThreadPool::Create("the pool", 1));
+  ScopedObjectAccess soa(self);
+  StackHandleScope<2> hs(self);
+  Handle<mirror::Object> obj1(
+      hs.NewHandle<mirror::Object>(mirror::String::AllocFromModifiedUtf8(self, "hello, world!")));
+  Handle<mirror::Object> obj2(
+      hs.NewHandle<mirror::Object>(mirror::String::AllocFromModifiedUtf8(self, "goodbye!")));
+  jobject g_obj1 = soa.Vm()->AddGlobalRef(self, obj1.Get());
+  ASSERT_TRUE(g_obj1 != nullptr);
+
+  // The first lock reserves the object, recursive locking only changes the depth.
+  {
+    ObjectLock<mirror::Object> lock1(self, obj1);
+    {
+      ObjectLock<mirror::Object> lock2(self, obj1);
+      LockWord lock_word = obj1->GetLockWord(true);
+      ASSERT_EQ(lock_word.GetState(), LockWord::kReserved);
+      EXPECT_EQ(lock_word.ThinLockOwner(), self->GetThreadId());
+      EXPECT_EQ(lock_word.ReservedLockDepth(), 2u);
+    }
+    EXPECT_EQ(Monitor::GetLockOwnerThreadId(obj1.Get()), self->GetThreadId());
+  }
+  // The reservation survives unlocking.
+  LockWord lock_word = obj1->GetLockWord(true);
+  ASSERT_EQ(lock_word.GetState(), LockWord::kReserved);
+  EXPECT_EQ(lock_word.ReservedLockDepth(), 0u);
+  EXPECT_EQ(Monitor::GetLockOwnerThreadId(obj1.Get()), ThreadList::kInvalidThreadId);
+  obj1->Notify(self);
+  EXPECT_TRUE(self->IsExceptionPending());
+  self->ClearException();
+
+  // Another thread revokes the reservation by suspending us.
+  thread_pool->AddTask(self, new ReservedLockTask(g_obj1));
+  thread_pool->StartWorkers(self);
+  {
+    ScopedThreadSuspension sts(self, ThreadState::kSuspended);
+    thread_pool->Wait(self, /*do_work=*/false, /*may_hold_locks=*/false);
+  }
+  lock_word = obj1->GetLockWord(true);
+  ASSERT_EQ(lock_word.GetState(), LockWord::kReserved);
+  EXPECT_NE(lock_word.ThinLockOwner(), self->GetThreadId());
+  // Hashing revokes the reservation of the worker thread.
+  int32_t hash_code = obj1->IdentityHashCode();
+  EXPECT_EQ(obj1->GetLockWord(true).GetState(), LockWord::kHashCode);
+  EXPECT_EQ(obj1->IdentityHashCode(), hash_code);
+
+  // Hashing an object held through a reservation inflates it.
+  {
+    ObjectLock<mirror::Object> lock(self, obj2);
+    ASSERT_EQ(obj2->GetLockWord(true).GetState(), LockWord::kReserved);
+    obj2->IdentityHashCode();
+    EXPECT_EQ(obj2->GetLockWord(true).GetState(), LockWord::kFatLocked);
+    EXPECT_EQ(Monitor::GetLockOwnerThreadId(obj2.Get()), self->GetThreadId());
+  }
+  EXPECT_EQ(Monitor::GetLockOwnerThreadId(obj2.Get()), ThreadList::kInvalidThreadId);
+
+  thread_pool->StopWorkers(self);
+  soa.Vm()->DeleteGlobalRef(self, g_obj1);
+}
 
 }  // namespace art
@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "code_info_cache.h"
+
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+
+#include "base/bit_utils.h"
+#include "base/casts.h"
+#include "oat_quick_method_header.h"
+#include "stack_map.h"
+
+namespace art HIDDEN {
+
+namespace {
+
+// The stack mask region is stored as raw words so that every field can be accessed atomically.
+static_assert(std::is_trivially_copyable_v<BitMemoryRegion>);
+static_assert(sizeof(BitMemoryRegion) % sizeof(uintptr_t) == 0u);
+constexpr size_t kStackMaskWords = sizeof(BitMemoryRegion) / sizeof(uintptr_t);
+
+struct Entry {
+  // Odd while the entry is being written.
+  std::atomic<uint32_t> sequence;
+  // The entry is only valid in the epoch it was written in, see CodeInfoCache::Clear().
+  std::atomic<uint32_t> epoch;
+  std::atomic<const OatQuickMethodHeader*> method_header;
+  std::atomic<uint32_t> native_pc_offset;
+  std::atomic<uint32_t> stack_map_index;
+  std::atomic<uint32_t> register_mask;
+  std::array<std::atomic<uintptr_t>, kStackMaskWords> stack_mask;
+};
+
+// 2048 entries take 96KiB on 64-bit targets.
+static_assert(IsPowerOfTwo(CodeInfoCache::kNumEntries));
+
+Entry gEntries[CodeInfoCache::kNumEntries];
+
+// Zero-initialized entries are never valid.
+std::atomic<uint32_t> gEpoch{1u};
+
+Entry* EntryFor(const OatQuickMethodHeader* method_header, uintptr_t native_pc_offset) {
+  // Return addresses are spread out, the low bits are mostly instruction alignment.
+  uintptr_t key = reinterpret_cast<uintptr_t>(method_header) + native_pc_offset;
+  return &gEntries[(key >> 2) & (CodeInfoCache::kNumEntries - 1u)];
+}
+
+bool TryLockEntry(Entry* entry, /*out*/ uint32_t* sequence) {
+  uint32_t old_sequence = entry->sequence.load(std::memory_order_relaxed);
+  if ((old_sequence & 1u) != 0u ||
+      !entry->sequence.compare_exchange_strong(
+          old_sequence, old_sequence + 1u, std::memory_order_acquire)) {
+    return false;
+  }
+  // Order the data stores below after making the sequence odd.
+  std::atomic_thread_fence(std::memory_order_release);
+  *sequence = old_sequence;
+  return true;
+}
+
+void UnlockEntry(Entry* entry, uint32_t sequence) {
+  entry->sequence.store(sequence + 2u, std::memory_order_release);
+}
+
+}  // namespace
+
+bool CodeInfoCache::Lookup(const OatQuickMethodHeader* method_header,
+                           uintptr_t native_pc_offset,
+                           /*out*/ StackMapInfo* info) {
+  // Entries written before the last Clear() have an older epoch.
+  uint32_t epoch = gEpoch.load(std::memory_order_acquire);
+  Entry* entry = EntryFor(method_header, native_pc_offset);
+  uint32_t sequence = entry->sequence.load(std::memory_order_acquire);
+  if ((sequence & 1u) != 0u ||
+      entry->epoch.load(std::memory_order_relaxed) != epoch ||
+      entry->method_header.load(std::memory_order_relaxed) != method_header ||
+      entry->native_pc_offset.load(std::memory_order_relaxed) != native_pc_offset) {
+    return false;
+  }
+  uint32_t stack_map_index = entry->stack_map_index.load(std::memory_order_relaxed);
+  uint32_t register_mask = entry->register_mask.load(std::memory_order_relaxed);
+  uintptr_t stack_mask[kStackMaskWords];
+  for (size_t i = 0; i != kStackMaskWords; ++i) {
+    stack_mask[i] = entry->stack_mask[i].load(std::memory_order_relaxed);
+  }
+  // Order the data loads above before checking that the sequence did not change.
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (entry->sequence.load(std::memory_order_relaxed) != sequence) {
+    return false;
+  }
+  info->stack_map_index = stack_map_index;
+  info->register_mask = register_mask;
+  memcpy(&info->stack_mask, stack_mask, sizeof(info->stack_mask));
+  return true;
+}
+
+CodeInfoCache::StackMapInfo CodeInfoCache::GetStackMapInfo(
+    const OatQuickMethodHeader* method_header, uintptr_t native_pc_offset) {
+  StackMapInfo info;
+  if (Lookup(method_header, native_pc_offset, &info)) {
+    return info;
+  }
+  // Read the epoch before decoding, so that the entry is stale if the code is freed meanwhile.
+  uint32_t epoch = gEpoch.load(std::memory_order_acquire);
+  CodeInfo code_info = CodeInfo::DecodeGcMasksOnly(method_header);
+  StackMap stack_map = code_info.GetStackMapForNativePcOffset(native_pc_offset);
+  if (!stack_map.IsValid()) {
+    info.stack_map_index = StackMap::kNoValue;
+    info.register_mask = 0u;
+    info.stack_mask = BitMemoryRegion();
+    return info;  // Not worth caching.
+  }
+  info.stack_map_index = stack_map.Row();
+  info.register_mask = code_info.GetRegisterMaskOf(stack_map);
+  info.stack_mask = code_info.GetStackMaskOf(stack_map);
+
+  Entry* entry = EntryFor(method_header, native_pc_offset);
+  uint32_t sequence;
+  if (TryLockEntry(entry, &sequence)) {
+    uintptr_t stack_mask[kStackMaskWords];
+    memcpy(stack_mask, &info.stack_mask, sizeof(info.stack_mask));
+    entry->epoch.store(epoch, std::memory_order_relaxed);
+    entry->method_header.store(method_header, std::memory_order_relaxed);
+    entry->native_pc_offset.store(dchecked_integral_cast<uint32_t>(native_pc_offset),
+                                  std::memory_order_relaxed);
+    entry->stack_map_index.store(info.stack_map_index, std::memory_order_relaxed);
+    entry->register_mask.store(info.register_mask, std::memory_order_relaxed);
+    for (size_t i = 0; i != kStackMaskWords; ++i) {
+      entry->stack_mask[i].store(stack_mask[i], std::memory_order_relaxed);
+    }
+    UnlockEntry(entry, sequence);
+  }
+  return info;
+}
+
+void CodeInfoCache::Clear() {
+  // Entries of older epochs are ignored by Lookup() and overwritten by GetStackMapInfo().
+  gEpoch.fetch_add(1u, std::memory_order_release);
+}
+
+}  // namespace art
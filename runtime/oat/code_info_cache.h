@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_OAT_CODE_INFO_CACHE_H_
+#define ART_RUNTIME_OAT_CODE_INFO_CACHE_H_
+
+#include <cstdint>
+
+#include "base/bit_memory_region.h"
+#include "base/macros.h"
+
+namespace art HIDDEN {
+
+class OatQuickMethodHeader;
+
+// Process-wide cache of stack map lookups in the CodeInfo of compiled code.
+//
+// Stack walks decode the CodeInfo of every compiled frame and search its stack maps for the
+// native pc. The GC root visiting in particular does that for all threads on every collection,
+// and deep stacks mostly consist of the same few call sites of hot methods.
+//
+// The cache is direct-mapped, keyed by the OatQuickMethodHeader and the native pc offset, and
+// lock-free. Each entry is guarded by a sequence counter: a reader that races with a writer sees
+// a miss and a writer that finds the entry busy leaves it alone. The entries point into the
+// CodeInfo and a method header may be reused for other code once freed, so Clear() must be
+// called whenever compiled code is freed or unmapped.
+class CodeInfoCache {
+ public:
+  // The entry of a lookup is at index ((method header address + native pc offset) / 4) modulo
+  // the number of entries.
+  static constexpr size_t kNumEntries = 2048;
+
+  struct StackMapInfo {
+    uint32_t stack_map_index;  // StackMap::kNoValue if there is no stack map for the pc.
+    uint32_t register_mask;
+    BitMemoryRegion stack_mask;
+  };
+
+  // Returns the stack map at `native_pc_offset` of `method_header` with its GC masks,
+  // decoding the CodeInfo if the lookup is not cached yet.
+  EXPORT static StackMapInfo GetStackMapInfo(const OatQuickMethodHeader* method_header,
+                                             uintptr_t native_pc_offset);
+
+  // Returns whether the lookup for `native_pc_offset` of `method_header` is cached
+  // and if so, stores it in `info`. Never decodes the CodeInfo.
+  EXPORT static bool Lookup(const OatQuickMethodHeader* method_header,
+                            uintptr_t native_pc_offset,
+                            /*out*/ StackMapInfo* info);
+
+  // Invalidates all entries. Must be called before any compiled code is freed or unmapped.
+  // This only starts a new epoch, so it is cheap enough to call for every freed method.
+  EXPORT static void Clear();
+
+ private:
+  DISALLOW_IMPLICIT_CONSTRUCTORS(CodeInfoCache);
+};
+
+}  // namespace art
+
+#endif  // ART_RUNTIME_OAT_CODE_INFO_CACHE_H_
@@ -35,8 +35,8 @@
 namespace art HIDDEN {
 
 const uint8_t ImageHeader::kImageMagic[] = { 'a', 'r', 't', '\n' };
-// Revert dex cache change.
-const uint8_t ImageHeader::kImageVersion[] = { '1', '1', '8', '\0' };
+// Record the end of the known dirty objects.
+const uint8_t ImageHeader::kImageVersion[] = { '1', '1', '9', '\0' };
 
 ImageHeader::ImageHeader(uint32_t image_reservation_size,
                          uint32_t component_count,
@@ -345,10 +345,16 @@ bool ImageHeader::WriteData(const ImageFileGuard& image_file,
   dchecked_vector<ImageHeader::Block> blocks;
 
   // Add a set of solid blocks such that no block is larger than the maximum size. A solid block
-  // is a block that must be decompressed all at once.
+  // is a block that must be decompressed all at once. Compressed blocks are also split at
+  // multiples of kCompressedBlockAlignment.
   auto add_blocks = [&](uint32_t offset, uint32_t size) {
     while (size != 0u) {
-      const uint32_t cur_size = std::min(size, max_image_block_size);
+      uint32_t cur_size = std::min(size, max_image_block_size);
+      if (is_compressed) {
+        const uint32_t next_boundary = RoundDown(offset, kCompressedBlockAlignment) +
+                                       kCompressedBlockAlignment;
+        cur_size = std::min(cur_size, next_boundary - offset);
+      }
       block_sources.emplace_back(offset, cur_size);
       offset += cur_size;
       size -= cur_size;
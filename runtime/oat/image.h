@@ -88,6 +88,11 @@ class PACKED(8) ImageHeader {
   };
   static constexpr StorageMode kDefaultStorageMode = kStorageModeUncompressed;
 
+  // Compressed blocks never cross a multiple of this image offset, so that a compressed image
+  // can be decompressed lazily in page-aligned chunks of at most this size. LZ4 only refers
+  // back to the previous 64KiB, so splitting the blocks there hardly affects compression.
+  static constexpr uint32_t kCompressedBlockAlignment = 64 * KB;
+
   // Solid block of the image. May be compressed or uncompressed.
   class PACKED(4) Block final {
    public:
@@ -108,10 +113,18 @@ class PACKED(8) ImageHeader {
       return storage_mode_;
     }
 
+    uint32_t GetDataOffset() const {
+      return data_offset_;
+    }
+
     uint32_t GetDataSize() const {
       return data_size_;
     }
 
+    uint32_t GetImageOffset() const {
+      return image_offset_;
+    }
+
     uint32_t GetImageSize() const {
       return image_size_;
     }
@@ -428,6 +441,13 @@ class PACKED(8) ImageHeader {
     return blocks_count_;
   }
 
+  // End of the objects listed in the dirty image objects profile given to dex2oat. These objects
+  // are placed at the start of the objects section, so [objects start, end) is accessed early
+  // and often. Zero if there is no such profile.
+  uint32_t GetKnownDirtyObjectsEnd() const {
+    return known_dirty_objects_end_;
+  }
+
   // Helper for writing `data` and `bitmap_data` into `image_file`, following
   // the information stored in this header and passed as arguments.
   EXPORT bool WriteData(const ImageFileGuard& image_file,
@@ -514,6 +534,9 @@ class PACKED(8) ImageHeader {
   uint32_t blocks_offset_ = 0u;
   uint32_t blocks_count_ = 0u;
 
+  // See GetKnownDirtyObjectsEnd().
+  uint32_t known_dirty_objects_end_ = 0u;
+
   friend class linker::ImageWriter;
   friend class RuntimeImageHelper;
 };
@@ -24,7 +24,8 @@
 namespace art {
 
 inline JniStubKey::JniStubKey(uint32_t flags, std::string_view shorty)
-    : flags_(flags & (kAccStatic | kAccSynchronized | kAccFastNative | kAccCriticalNative)),
+    : flags_((flags & (kAccStatic | kAccSynchronized | kAccFastNative | kAccCriticalNative)) |
+             (ArtMethod::IsReferenceFreeNative(flags) ? kAccReferenceFreeNative : 0u)),
       shorty_(shorty) {
   DCHECK(ArtMethod::IsNative(flags));
 }
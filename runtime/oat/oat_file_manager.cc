@@ -36,6 +36,7 @@
 #include "base/systrace.h"
 #include "class_linker.h"
 #include "class_loader_context.h"
+#include "code_info_cache.h"
 #include "dex/art_dex_file_loader.h"
 #include "dex/dex_file-inl.h"
 #include "dex/dex_file_loader.h"
@@ -108,6 +109,7 @@ void OatFileManager::UnRegisterAndDeleteOatFile(const OatFile* oat_file) {
   std::unique_ptr<const OatFile> compare(oat_file);
   auto it = oat_files_.find(compare);
   CHECK(it != oat_files_.end());
+  CodeInfoCache::Clear();
   oat_files_.erase(it);
   compare.release();  // NOLINT b/117926937
 }
@@ -257,6 +257,10 @@ std::unique_ptr<RuntimeParser> ParsedOptions::MakeParser(bool ignore_unrecognize
       .Define("-XMadviseWillNeedArtFileSize:_")
           .WithType<unsigned int>()
           .IntoKey(M::MadviseWillNeedArtFileSize)
+      .Define("-Xlazy-image-decompression:_")
+          .WithType<bool>()
+          .WithValueMap({{"false", false}, {"true", true}})
+          .IntoKey(M::LazyImageDecompression)
       .Define("-Xusejit:_")
           .WithType<bool>()
           .WithValueMap({{"false", false}, {"true", true}})
@@ -412,6 +416,10 @@ std::unique_ptr<RuntimeParser> ParsedOptions::MakeParser(bool ignore_unrecognize
       .Define("-XX:MonitorTimeout=_")  // in ms
           .WithType<int>()
           .IntoKey(M::MonitorTimeout)
+      .Define("-XX:LockReservation=_")
+          .WithType<bool>()
+          .WithValueMap({{"false", false}, {"true", true}})
+          .IntoKey(M::LockReservation)
       .Define("-XX:GlobalRefAllocStackTraceLimit=_")  // Number of free slots to enable tracing.
           .WithType<unsigned int>()
           .IntoKey(M::GlobalRefAllocStackTraceLimit)
@@ -117,6 +117,7 @@
 #include "mirror/throwable.h"
 #include "mirror/var_handle.h"
 #include "monitor.h"
+#include "monitor_contention_profile.h"
 #include "native/dalvik_system_BaseDexClassLoader.h"
 #include "native/dalvik_system_DexFile.h"
 #include "native/dalvik_system_VMDebug.h"
@@ -310,6 +311,7 @@ Runtime::Runtime()
       madvise_willneed_total_dex_size_(0),
       madvise_willneed_odex_filesize_(0),
       madvise_willneed_art_filesize_(0),
+      lazy_image_decompression_(false),
       safe_mode_(false),
       hidden_api_policy_(hiddenapi::EnforcementPolicy::kDisabled),
       core_platform_api_policy_(hiddenapi::EnforcementPolicy::kDisabled),
@@ -1622,8 +1624,11 @@ bool Runtime::Init(RuntimeArgumentMap&& runtime_options_in) {
   jni_id_manager_.reset(new jni::JniIdManager());
 
   Thread::SetSensitiveThreadHook(runtime_options.GetOrDefault(Opt::HookIsSensitiveThread));
+  // Reserved lock words must not end up in images, so the compiler never reserves locks.
   Monitor::Init(runtime_options.GetOrDefault(Opt::LockProfThreshold),
-                runtime_options.GetOrDefault(Opt::StackDumpLockProfThreshold));
+                runtime_options.GetOrDefault(Opt::StackDumpLockProfThreshold),
+                runtime_options.GetOrDefault(Opt::LockReservation) &&
+                    runtime_options.GetOrDefault(Opt::CompilerCallbacksPtr) == nullptr);
 
   image_locations_ = runtime_options.ReleaseOrDefault(Opt::Image);
 
@@ -1698,6 +1703,9 @@ bool Runtime::Init(RuntimeArgumentMap&& runtime_options_in) {
 
   monitor_list_ = new MonitorList;
   monitor_pool_ = MonitorPool::Create();
+  if (runtime_options.GetOrDefault(Opt::LockProfThreshold) != 0u) {
+    monitor_contention_profile_.reset(new MonitorContentionProfile());
+  }
   thread_list_ = new ThreadList(GetThreadSuspendTimeout(&runtime_options));
   intern_table_ = new InternTable;
 
@@ -1752,6 +1760,7 @@ bool Runtime::Init(RuntimeArgumentMap&& runtime_options_in) {
   madvise_willneed_total_dex_size_ = runtime_options.GetOrDefault(Opt::MadviseWillNeedVdexFileSize);
   madvise_willneed_odex_filesize_ = runtime_options.GetOrDefault(Opt::MadviseWillNeedOdexFileSize);
   madvise_willneed_art_filesize_ = runtime_options.GetOrDefault(Opt::MadviseWillNeedArtFileSize);
+  lazy_image_decompression_ = runtime_options.GetOrDefault(Opt::LazyImageDecompression);
 
   jni_ids_indirection_ = runtime_options.GetOrDefault(Opt::OpaqueJniIds);
   automatically_set_jni_ids_indirection_ =
@@ -2470,6 +2479,9 @@ void Runtime::DumpForSigQuit(std::ostream& os) {
   GetInternTable()->DumpForSigQuit(os);
   GetJavaVM()->DumpForSigQuit(os);
   GetHeap()->DumpForSigQuit(os);
+  if (monitor_contention_profile_ != nullptr) {
+    monitor_contention_profile_->DumpForSigQuit(os);
+  }
   oat_file_manager_->DumpForSigQuit(os);
   if (GetJit() != nullptr) {
     GetJit()->DumpForSigQuit(os);
@@ -106,6 +106,7 @@ class InternTable;
 class IsMarkedVisitor;
 class JavaVMExt;
 class LinearAlloc;
+class MonitorContentionProfile;
 class MonitorList;
 class MonitorPool;
 class NullPointerHandler;
@@ -423,6 +424,11 @@ class Runtime {
     return monitor_pool_;
   }
 
+  // Null unless lock contention profiling is enabled with -Xlockprofthreshold.
+  MonitorContentionProfile* GetMonitorContentionProfile() const {
+    return monitor_contention_profile_.get();
+  }
+
   // Is the given object the special object used to mark a cleared JNI weak global?
   bool IsClearedJniWeakGlobal(ObjPtr<mirror::Object> obj) REQUIRES_SHARED(Locks::mutator_lock_);
 
@@ -976,6 +982,10 @@ class Runtime {
     return madvise_willneed_art_filesize_;
   }
 
+  bool IsLazyImageDecompressionEnabled() const {
+    return lazy_image_decompression_;
+  }
+
   const std::string& GetJdwpOptions() {
     return jdwp_options_;
   }
@@ -1275,6 +1285,7 @@ class Runtime {
   size_t max_spins_before_thin_lock_inflation_;
   MonitorList* monitor_list_;
   MonitorPool* monitor_pool_;
+  std::unique_ptr<MonitorContentionProfile> monitor_contention_profile_;
 
   ThreadList* thread_list_;
 
@@ -1448,6 +1459,9 @@ class Runtime {
   // A 0 for this will turn off madvising to MADV_WILLNEED
   size_t madvise_willneed_art_filesize_;
 
+  // Whether compressed images are decompressed on first access, see LazyImageDecompressor.
+  bool lazy_image_decompression_;
+
   // Whether the application should run in safe mode, that is, interpreter only.
   bool safe_mode_;
 
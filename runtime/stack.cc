@@ -42,6 +42,7 @@
 #include "mirror/object-inl.h"
 #include "mirror/object_array-inl.h"
 #include "nterp_helpers.h"
+#include "oat/code_info_cache.h"
 #include "oat/oat_quick_method_header.h"
 #include "obj_ptr-inl.h"
 #include "quick/quick_method_frame_info.h"
@@ -97,8 +98,11 @@ StackMap* StackVisitor::GetCurrentStackMap() const {
   const OatQuickMethodHeader* header = GetCurrentOatQuickMethodHeader();
   if (cur_stack_map_.first != cur_quick_frame_pc_) {
     uint32_t pc = header->NativeQuickPcOffset(cur_quick_frame_pc_);
-    cur_stack_map_ = std::make_pair(cur_quick_frame_pc_,
-                                    GetCurrentInlineInfo()->GetStackMapForNativePcOffset(pc));
+    CodeInfoCache::StackMapInfo info;
+    StackMap stack_map = CodeInfoCache::Lookup(header, pc, &info)
+        ? GetCurrentInlineInfo()->GetStackMapAt(info.stack_map_index)
+        : GetCurrentInlineInfo()->GetStackMapForNativePcOffset(pc);
+    cur_stack_map_ = std::make_pair(cur_quick_frame_pc_, stack_map);
   }
   return &cur_stack_map_.second;
 }
@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_STACK_TRACE_FRAME_CACHE_H_
+#define ART_RUNTIME_STACK_TRACE_FRAME_CACHE_H_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <utility>
+
+#include "base/array_ref.h"
+#include "base/bit_utils.h"
+#include "base/macros.h"
+
+namespace art HIDDEN {
+
+class ArtMethod;
+
+// Small thread-local cache of the stack trace frames that an optimized frame expands to,
+// that is the methods inlined at the current native pc, innermost first, followed by the
+// outer method, each with its dex pc. Building a stack trace otherwise decodes the stack
+// maps and resolves the inlined methods of every compiled frame, which is expensive when
+// exceptions are thrown repeatedly from the same sites.
+//
+// The cache is keyed by the native pc of the frame. It must only be used by its owning thread.
+// All caches are invalidated by InvalidateAll() whenever compiled code is freed or classes
+// are unloaded, since different code may later be placed at the same address.
+class StackTraceFrameCache {
+ public:
+  using Frame = std::pair<ArtMethod*, uint32_t>;
+
+  // Number of entries, must be a power of two.
+  static constexpr size_t kSize = 64;
+  // Maximum number of frames of an entry. Sites with deeper inlining are not cached.
+  static constexpr size_t kMaxFrames = 4;
+
+  StackTraceFrameCache() {
+    entries_.fill(Entry{});
+  }
+
+  // Returns the cached frames for `pc` in `outer_method`, or an empty array if there are none.
+  ArrayRef<const Frame> Lookup(uintptr_t pc, ArtMethod* outer_method) const {
+    const Entry& entry = entries_[IndexOf(pc)];
+    if (entry.pc != pc ||
+        entry.epoch != epoch_.load(std::memory_order_acquire) ||
+        entry.frames[entry.num_frames - 1u].first != outer_method) {
+      return ArrayRef<const Frame>();
+    }
+    return ArrayRef<const Frame>(entry.frames.data(), entry.num_frames);
+  }
+
+  // Caches `frames` for `pc`. The last frame must be the outer method.
+  void Insert(uintptr_t pc, ArrayRef<const Frame> frames) {
+    if (frames.empty() || frames.size() > kMaxFrames) {
+      return;
+    }
+    Entry& entry = entries_[IndexOf(pc)];
+    entry.pc = pc;
+    entry.epoch = epoch_.load(std::memory_order_acquire);
+    entry.num_frames = frames.size();
+    std::copy(frames.begin(), frames.end(), entry.frames.begin());
+  }
+
+  // Invalidate the caches of all threads.
+  static void InvalidateAll() {
+    epoch_.fetch_add(1u, std::memory_order_release);
+  }
+
+ private:
+  struct Entry {
+    uintptr_t pc = 0u;
+    uint32_t epoch = 0u;  // Never a valid epoch.
+    uint32_t num_frames = 1u;
+    std::array<Frame, kMaxFrames> frames = {};
+  };
+
+  static_assert(IsPowerOfTwo(kSize));
+
+  static size_t IndexOf(uintptr_t pc) {
+    // Return addresses are spread out, the low bits are mostly instruction alignment.
+    return (pc >> 2) & (kSize - 1u);
+  }
+
+  static inline std::atomic<uint32_t> epoch_{1u};
+
+  std::array<Entry, kSize> entries_;
+
+  DISALLOW_COPY_AND_ASSIGN(StackTraceFrameCache);
+};
+
+}  // namespace art
+
+#endif  // ART_RUNTIME_STACK_TRACE_FRAME_CACHE_H_
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "stack_trace_frame_cache.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace art HIDDEN {
+
+using Frame = StackTraceFrameCache::Frame;
+
+static ArtMethod* FakeMethod(uintptr_t value) {
+  return reinterpret_cast<ArtMethod*>(value);
+}
+
+TEST(StackTraceFrameCacheTest, LookupInsert) {
+  StackTraceFrameCache cache;
+  ArtMethod* outer = FakeMethod(0x1000);
+  const uintptr_t pc = 0x7000;
+  EXPECT_TRUE(cache.Lookup(pc, outer).empty());
+
+  std::vector<Frame> frames = {{FakeMethod(0x2000), 3u}, {outer, 7u}};
+  cache.Insert(pc, ArrayRef<const Frame>(frames));
+  ArrayRef<const Frame> cached = cache.Lookup(pc, outer);
+  ASSERT_EQ(frames.size(), cached.size());
+  EXPECT_TRUE(std::equal(frames.begin(), frames.end(), cached.begin()));
+
+  // Another outer method or pc does not match.
+  EXPECT_TRUE(cache.Lookup(pc, FakeMethod(0x3000)).empty());
+  EXPECT_TRUE(cache.Lookup(pc + 4u * StackTraceFrameCache::kSize, outer).empty());
+
+  // An entry for a pc with the same index replaces the old one.
+  uintptr_t other_pc = pc + 4u * StackTraceFrameCache::kSize;
+  std::vector<Frame> other_frames = {{outer, 9u}};
+  cache.Insert(other_pc, ArrayRef<const Frame>(other_frames));
+  EXPECT_TRUE(cache.Lookup(pc, outer).empty());
+  EXPECT_EQ(1u, cache.Lookup(other_pc, outer).size());
+}
+
+TEST(StackTraceFrameCacheTest, DeepInlining) {
+  StackTraceFrameCache cache;
+  ArtMethod* outer = FakeMethod(0x1000);
+  std::vector<Frame> frames(StackTraceFrameCache::kMaxFrames + 1u, {FakeMethod(0x2000), 1u});
+  frames.back() = {outer, 2u};
+  cache.Insert(0x7000, ArrayRef<const Frame>(frames));
+  EXPECT_TRUE(cache.Lookup(0x7000, outer).empty());
+}
+
+TEST(StackTraceFrameCacheTest, InvalidateAll) {
+  StackTraceFrameCache cache;
+  ArtMethod* outer = FakeMethod(0x1000);
+  std::vector<Frame> frames = {{outer, 7u}};
+  cache.Insert(0x7000, ArrayRef<const Frame>(frames));
+  EXPECT_FALSE(cache.Lookup(0x7000, outer).empty());
+  StackTraceFrameCache::InvalidateAll();
+  EXPECT_TRUE(cache.Lookup(0x7000, outer).empty());
+}
+
+}  // namespace art
@@ -62,6 +62,7 @@
 #include "dex/dex_file-inl.h"
 #include "dex/dex_file_annotations.h"
 #include "dex/dex_file_types.h"
+#include "entrypoints/entrypoint_utils-inl.h"
 #include "entrypoints/entrypoint_utils.h"
 #include "entrypoints/quick/quick_alloc_entrypoints.h"
 #include "entrypoints/quick/runtime_entrypoints_list.h"
@@ -93,6 +94,7 @@
 #include "nativehelper/scoped_utf_chars.h"
 #include "nterp_helpers.h"
 #include "nth_caller_visitor.h"
+#include "oat/code_info_cache.h"
 #include "oat/oat_quick_method_header.h"
 #include "oat/stack_map.h"
 #include "obj_ptr-inl.h"
@@ -109,6 +111,7 @@
 #include "scoped_thread_state_change-inl.h"
 #include "scoped_disable_public_sdk_checker.h"
 #include "stack.h"
+#include "stack_trace_frame_cache.h"
 #include "thread-inl.h"
 #include "thread_list.h"
 #include "trace.h"
@@ -2555,7 +2558,8 @@ void Thread::SignalExitFlags() {
 Thread::Thread(bool daemon)
     : tls32_(daemon),
       wait_monitor_(nullptr),
-      is_runtime_thread_(false) {
+      is_runtime_thread_(false),
+      thin_lock_spin_iters_(Monitor::kInitialThinLockSpinIters) {
   wait_mutex_ = new Mutex("a thread wait mutex", LockLevel::kThreadWaitLock);
   wait_cond_ = new ConditionVariable("a thread wait condition variable", *wait_mutex_);
   tlsPtr_.mutator_lock = Locks::mutator_lock_;
@@ -2967,22 +2971,84 @@ void Thread::SetClassLoaderOverride(jobject class_loader_override) {
 
 using ArtMethodDexPcPair = std::pair<ArtMethod*, uint32_t>;
 
+// Visits the frames of a stack trace, including inlined frames, with their dex pcs.
+// Optimized frames are expanded using the stack trace frame cache of the current thread,
+// so that throwing repeatedly from the same sites does not decode the same stack maps and
+// resolve the same inlined methods over and over.
+class StackTraceVisitor : public StackVisitor {
+ public:
+  explicit StackTraceVisitor(Thread* thread) REQUIRES_SHARED(Locks::mutator_lock_)
+      : StackVisitor(thread, nullptr, StackVisitor::StackWalkKind::kSkipInlinedFrames),
+        cache_(Thread::Current()->GetStackTraceFrameCache()) {}
+
+  bool VisitFrame() final REQUIRES_SHARED(Locks::mutator_lock_) {
+    ArtMethod* m = GetMethod();
+    const OatQuickMethodHeader* header = GetCurrentOatQuickMethodHeader();
+    if (GetCurrentQuickFrame() == nullptr ||
+        header == nullptr ||
+        m->IsNative() ||
+        !header->IsOptimized()) {
+      uint32_t dex_pc =
+          (m->IsRuntimeMethod() || m->IsProxyMethod()) ? dex::kDexNoIndex : GetDexPc();
+      return VisitTraceFrame(m, dex_pc);
+    }
+    uintptr_t pc = GetCurrentQuickFramePc();
+    ArrayRef<const ArtMethodDexPcPair> frames = cache_->Lookup(pc, m);
+    if (frames.empty()) {
+      CodeInfo code_info = CodeInfo::DecodeInlineInfoOnly(header);
+      StackMap stack_map = code_info.GetStackMapForNativePcOffset(header->NativeQuickPcOffset(pc));
+      if (!stack_map.IsValid()) {
+        return VisitTraceFrame(m, GetDexPc());  // Reports the missing stack map.
+      }
+      std::vector<ArtMethodDexPcPair> decoded;
+      for (BitTableRange<InlineInfo> inline_infos = code_info.GetInlineInfosOf(stack_map);
+           !inline_infos.empty();
+           inline_infos.pop_back()) {
+        decoded.emplace_back(GetResolvedMethod(m, code_info, inline_infos),
+                             inline_infos.back().GetDexPc());
+      }
+      decoded.emplace_back(m, stack_map.GetDexPc());
+      cache_->Insert(pc, ArrayRef<const ArtMethodDexPcPair>(decoded));
+      return VisitTraceFrames(ArrayRef<const ArtMethodDexPcPair>(decoded));
+    }
+    return VisitTraceFrames(frames);
+  }
+
+ protected:
+  // Called for each frame, innermost first. Runtime methods are visited with kDexNoIndex.
+  virtual bool VisitTraceFrame(ArtMethod* m, uint32_t dex_pc)
+      REQUIRES_SHARED(Locks::mutator_lock_) = 0;
+
+ private:
+  bool VisitTraceFrames(ArrayRef<const ArtMethodDexPcPair> frames)
+      REQUIRES_SHARED(Locks::mutator_lock_) {
+    for (const ArtMethodDexPcPair& frame : frames) {
+      if (!VisitTraceFrame(frame.first, frame.second)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  StackTraceFrameCache* const cache_;
+};
+
 // Counts the stack trace depth and also fetches the first max_saved_frames frames.
-class FetchStackTraceVisitor : public StackVisitor {
+class FetchStackTraceVisitor : public StackTraceVisitor {
  public:
   explicit FetchStackTraceVisitor(Thread* thread,
                                   ArtMethodDexPcPair* saved_frames = nullptr,
                                   size_t max_saved_frames = 0)
       REQUIRES_SHARED(Locks::mutator_lock_)
-      : StackVisitor(thread, nullptr, StackVisitor::StackWalkKind::kIncludeInlinedFrames),
+      : StackTraceVisitor(thread),
         saved_frames_(saved_frames),
         max_saved_frames_(max_saved_frames) {}
 
-  bool VisitFrame() override REQUIRES_SHARED(Locks::mutator_lock_) {
+  bool VisitTraceFrame(ArtMethod* m, uint32_t dex_pc) override
+      REQUIRES_SHARED(Locks::mutator_lock_) {
     // We want to skip frames up to and including the exception's constructor.
     // Note we also skip the frame if it doesn't have a method (namely the callee
     // save frame)
-    ArtMethod* m = GetMethod();
     if (skipping_ && !m->IsRuntimeMethod() &&
         !GetClassRoot<mirror::Throwable>()->IsAssignableFrom(m->GetDeclaringClass())) {
       skipping_ = false;
@@ -2991,7 +3057,7 @@ class FetchStackTraceVisitor : public StackVisitor {
       if (!m->IsRuntimeMethod()) {  // Ignore runtime frames (in particular callee save).
         if (depth_ < max_saved_frames_) {
           saved_frames_[depth_].first = m;
-          saved_frames_[depth_].second = m->IsProxyMethod() ? dex::kDexNoIndex : GetDexPc();
+          saved_frames_[depth_].second = dex_pc;
         }
         ++depth_;
       }
@@ -3019,10 +3085,11 @@ class FetchStackTraceVisitor : public StackVisitor {
   DISALLOW_COPY_AND_ASSIGN(FetchStackTraceVisitor);
 };
 
-class BuildInternalStackTraceVisitor : public StackVisitor {
+class BuildInternalStackTraceVisitor : public StackTraceVisitor {
  public:
   BuildInternalStackTraceVisitor(Thread* self, Thread* thread, uint32_t skip_depth)
-      : StackVisitor(thread, nullptr, StackVisitor::StackWalkKind::kIncludeInlinedFrames),
+      REQUIRES_SHARED(Locks::mutator_lock_)
+      : StackTraceVisitor(thread),
         self_(self),
         skip_depth_(skip_depth),
         pointer_size_(Runtime::Current()->GetClassLinker()->GetImagePointerSize()) {}
@@ -3065,7 +3132,8 @@ class BuildInternalStackTraceVisitor : public StackVisitor {
     self_->EndAssertNoThreadSuspension(nullptr);
   }
 
-  bool VisitFrame() override REQUIRES_SHARED(Locks::mutator_lock_) {
+  bool VisitTraceFrame(ArtMethod* m, uint32_t dex_pc) override
+      REQUIRES_SHARED(Locks::mutator_lock_) {
     if (trace_ == nullptr) {
       return true;  // We're probably trying to fillInStackTrace for an OutOfMemoryError.
     }
@@ -3073,11 +3141,10 @@ class BuildInternalStackTraceVisitor : public StackVisitor {
       skip_depth_--;
       return true;
     }
-    ArtMethod* m = GetMethod();
     if (m->IsRuntimeMethod()) {
       return true;  // Ignore runtime frames (in particular callee save).
     }
-    AddFrame(m, m->IsProxyMethod() ? dex::kDexNoIndex : GetDexPc());
+    AddFrame(m, dex_pc);
     return true;
   }
 
@@ -3174,6 +3241,14 @@ ObjPtr<mirror::ObjectArray<mirror::Object>> Thread::CreateInternalStackTrace(
   return trace;
 }
 
+StackTraceFrameCache* Thread::GetStackTraceFrameCache() {
+  DCHECK(this == Thread::Current());
+  if (UNLIKELY(stack_trace_frame_cache_ == nullptr)) {
+    stack_trace_frame_cache_ = std::make_unique<StackTraceFrameCache>();
+  }
+  return stack_trace_frame_cache_.get();
+}
+
 bool Thread::IsExceptionThrownByCurrentMethod(ObjPtr<mirror::Throwable> exception) const {
   // Only count the depth since we do not pass a stack frame array as an argument.
   FetchStackTraceVisitor count_visitor(const_cast<Thread*>(this));
@@ -4328,16 +4403,28 @@ class ReferenceMapVisitor : public StackVisitor {
       StackReference<mirror::Object>* vreg_base =
           reinterpret_cast<StackReference<mirror::Object>*>(cur_quick_frame);
       uintptr_t native_pc_offset = method_header->NativeQuickPcOffset(GetCurrentQuickFramePc());
-      CodeInfo code_info = kPrecise
-          ? CodeInfo(method_header)  // We will need dex register maps.
-          : CodeInfo::DecodeGcMasksOnly(method_header);
-      StackMap map = code_info.GetStackMapForNativePcOffset(native_pc_offset);
-      DCHECK(map.IsValid());
+      CodeInfo code_info;
+      StackMap map;
+      BitMemoryRegion stack_mask;
+      uint32_t register_mask;
+      if (kPrecise) {
+        code_info = CodeInfo(method_header);  // We will need dex register maps.
+        map = code_info.GetStackMapForNativePcOffset(native_pc_offset);
+        DCHECK(map.IsValid());
+        stack_mask = code_info.GetStackMaskOf(map);
+        register_mask = code_info.GetRegisterMaskOf(map);
+      } else {
+        // Only the GC masks are needed, which are usually cached for hot call sites.
+        CodeInfoCache::StackMapInfo info =
+            CodeInfoCache::GetStackMapInfo(method_header, native_pc_offset);
+        DCHECK_NE(info.stack_map_index, StackMap::kNoValue);
+        stack_mask = info.stack_mask;
+        register_mask = info.register_mask;
+      }
 
       T vreg_info(m, code_info, map, visitor_);
 
       // Visit stack entries that hold pointers.
-      BitMemoryRegion stack_mask = code_info.GetStackMaskOf(map);
       for (size_t i = 0; i < stack_mask.size_in_bits(); ++i) {
         if (stack_mask.LoadBit(i)) {
           StackReference<mirror::Object>* ref_addr = vreg_base + i;
@@ -4352,7 +4439,6 @@ class ReferenceMapVisitor : public StackVisitor {
         }
       }
       // Visit callee-save registers that hold pointers.
-      uint32_t register_mask = code_info.GetRegisterMaskOf(map);
       for (uint32_t i = 0; i < BitSizeOf<uint32_t>(); ++i) {
         if (register_mask & (1 << i)) {
           mirror::Object** ref_addr = reinterpret_cast<mirror::Object**>(GetGPRAddress(i));
@@ -4642,9 +4728,10 @@ static void SweepCacheEntry(IsMarkedVisitor* visitor, const Instruction* inst, s
 }
 
 void Thread::SweepInterpreterCache(IsMarkedVisitor* visitor) {
-  for (InterpreterCache::Entry& entry : GetInterpreterCache()->GetArray()) {
+  auto sweep = [=](InterpreterCache::Entry& entry) REQUIRES_SHARED(Locks::mutator_lock_) {
     SweepCacheEntry(visitor, reinterpret_cast<const Instruction*>(entry.first), &entry.second);
-  }
+  };
+  GetInterpreterCache()->VisitEntries(sweep);
 }
 
 // FIXME: clang-r433403 reports the below function exceeds frame size limit.
@@ -4876,12 +4963,30 @@ void Thread::SetReadBarrierEntrypoints() {
   UpdateReadBarrierEntrypoints(&tlsPtr_.quick_entrypoints, /* is_active=*/ true);
 }
 
-void Thread::ClearAllInterpreterCaches() {
-  static struct ClearInterpreterCacheClosure : Closure {
+void Thread::ClearInterpreterCachesForDexFiles(const std::vector<const DexFile*>& dex_files) {
+  class ClearInterpreterCacheForDexFilesClosure : public Closure {
+   public:
+    explicit ClearInterpreterCacheForDexFilesClosure(const std::vector<const DexFile*>& dex_files)
+        : dex_files_(dex_files) {}
+
     void Run(Thread* thread) override {
-      thread->GetInterpreterCache()->Clear(thread);
+      InterpreterCache* cache = thread->GetInterpreterCache();
+      for (const DexFile* dex_file : dex_files_) {
+        if (dex_file == nullptr) {
+          continue;
+        }
+        // Code items of compact dex files may be in the shared data section.
+        cache->ClearKeysInRange(thread, dex_file->Begin(), dex_file->Begin() + dex_file->Size());
+        if (dex_file->DataBegin() != dex_file->Begin()) {
+          cache->ClearKeysInRange(
+              thread, dex_file->DataBegin(), dex_file->DataBegin() + dex_file->DataSize());
+        }
+      }
     }
-  } closure;
+
+   private:
+    const std::vector<const DexFile*>& dex_files_;
+  } closure(dex_files);
   Runtime::Current()->GetThreadList()->RunCheckpoint(&closure);
 }
 
@@ -101,6 +101,7 @@ class Monitor;
 class RootVisitor;
 class ScopedObjectAccessAlreadyRunnable;
 class ShadowFrame;
+class StackTraceFrameCache;
 class StackedShadowFrameRecord;
 class Thread;
 class ThreadList;
@@ -911,6 +912,10 @@ class EXPORT Thread {
       const ScopedObjectAccessAlreadyRunnable& soa) const
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Returns the cache of decoded stack trace frames of this thread, allocating it on first use.
+  // Must only be called by this thread.
+  StackTraceFrameCache* GetStackTraceFrameCache();
+
   // Convert an internal stack trace representation (returned by CreateInternalStackTrace) to a
   // StackTraceElement[]. If output_array is null, a new array is created, otherwise as many
   // frames as will fit are written into the given array. If stack_depth is non-null, it's updated
@@ -1334,6 +1339,15 @@ class EXPORT Thread {
     core_platform_api_cookie_ = cookie;
   }
 
+  // Number of busy spins on a contended thin lock before yielding, see Monitor::MonitorEnter().
+  uint32_t GetThinLockSpinIters() const {
+    return thin_lock_spin_iters_;
+  }
+
+  void SetThinLockSpinIters(uint32_t spin_iters) {
+    thin_lock_spin_iters_ = spin_iters;
+  }
+
   // Returns true if the thread is allowed to load java classes.
   bool CanLoadClasses() const;
 
@@ -1645,15 +1659,13 @@ class EXPORT Thread {
     return &interpreter_cache_;
   }
 
-  // Clear all thread-local interpreter caches.
+  // Remove the entries keyed by dex instructions of `dex_files` from all thread-local
+  // interpreter caches.
   //
   // Since the caches are keyed by memory pointer to dex instructions, this must be
-  // called when any dex code is unloaded (before different code gets loaded at the
+  // called when the dex files are unloaded (before different code gets loaded at the
   // same memory location).
-  //
-  // If presence of cache entry implies some pre-conditions, this must also be
-  // called if the pre-conditions might no longer hold true.
-  static void ClearAllInterpreterCaches();
+  static void ClearInterpreterCachesForDexFiles(const std::vector<const DexFile*>& dex_files);
 
   template<PointerSize pointer_size>
   static constexpr ThreadOffset<pointer_size> InterpreterCacheOffset() {
@@ -2435,6 +2447,9 @@ class EXPORT Thread {
   // All fields below this line should not be accessed by native code. This means these fields can
   // be modified, rearranged, added or removed without having to modify asm_support.h
 
+  // Cache of decoded stack trace frames, see GetStackTraceFrameCache().
+  std::unique_ptr<StackTraceFrameCache> stack_trace_frame_cache_;
+
   // Guards the 'wait_monitor_' members.
   Mutex* wait_mutex_ DEFAULT_MUTEX_ACQUIRED_AFTER;
 
@@ -2480,6 +2495,10 @@ class EXPORT Thread {
   // the caller is allowed to access all fields and methods in the Core Platform API.
   uint32_t core_platform_api_cookie_ = 0;
 
+  // Learned from the recent contended thin lock acquisitions of this thread. Kept per thread
+  // to avoid sharing a cache line between all contending threads. Only used by this thread.
+  uint32_t thin_lock_spin_iters_;
+
   friend class gc::collector::SemiSpace;  // For getting stack traces.
   friend class Runtime;  // For CreatePeer.
   friend class QuickExceptionHandler;  // For dumping the stack.
@@ -140,6 +140,14 @@ void ThreadList::DumpForSigQuit(std::ostream& os) {
       suspend_all_histogram_.PrintConfidenceIntervals(os, 0.99, data);  // Dump time to suspend.
     }
   }
+  InterpreterCache::Stats cache_stats = GetInterpreterCacheStats();
+  uint64_t cache_lookups = cache_stats.hits + cache_stats.secondary_hits + cache_stats.misses;
+  if (cache_lookups != 0u) {
+    os << "Interpreter cache lookups=" << cache_lookups
+       << " hits=" << cache_stats.hits
+       << " secondary_hits=" << cache_stats.secondary_hits
+       << " misses=" << cache_stats.misses << "\n";
+  }
   bool dump_native_stack = Runtime::Current()->GetDumpNativeStackOnSigQuit();
   Dump(os, dump_native_stack);
   DumpUnattachedThreads(os, dump_native_stack && kDumpUnattachedThreadNativeStackForSigQuit);
@@ -1692,13 +1700,22 @@ void ThreadList::SweepInterpreterCaches(IsMarkedVisitor* visitor) const {
   }
 }
 
-void ThreadList::ClearInterpreterCaches() const {
+void ThreadList::ClearInterpreterCacheReferences() const {
   Thread* self = Thread::Current();
   Locks::mutator_lock_->AssertExclusiveHeld(self);
   MutexLock mu(self, *Locks::thread_list_lock_);
   for (const auto& thread : list_) {
-    thread->GetInterpreterCache()->Clear(thread);
+    thread->GetInterpreterCache()->ClearReferenceEntries(thread);
+  }
+}
+
+InterpreterCache::Stats ThreadList::GetInterpreterCacheStats() const {
+  InterpreterCache::Stats stats;
+  MutexLock mu(Thread::Current(), *Locks::thread_list_lock_);
+  for (const auto& thread : list_) {
+    stats += thread->GetInterpreterCache()->GetStats();
   }
+  return stats;
 }
 
 uint32_t ThreadList::AllocThreadId(Thread* self) {
@@ -26,6 +26,7 @@
 #include "base/mutex.h"
 #include "base/macros.h"
 #include "base/value_object.h"
+#include "interpreter/interpreter_cache.h"
 #include "jni.h"
 #include "reflective_handle_scope.h"
 #include "suspend_reason.h"
@@ -227,7 +228,13 @@ class ThreadList {
   EXPORT void SweepInterpreterCaches(IsMarkedVisitor* visitor) const
       REQUIRES(Locks::mutator_lock_, !Locks::thread_list_lock_);
 
-  void ClearInterpreterCaches() const REQUIRES(Locks::mutator_lock_, !Locks::thread_list_lock_);
+  // Remove the interpreter cache entries holding references, for moving collectors. Other
+  // entries (field offsets, method indices) stay valid and are kept.
+  void ClearInterpreterCacheReferences() const
+      REQUIRES(Locks::mutator_lock_, !Locks::thread_list_lock_);
+
+  // Sum of the interpreter cache lookup counters of all threads.
+  InterpreterCache::Stats GetInterpreterCacheStats() const REQUIRES(!Locks::thread_list_lock_);
   // Return a copy of the thread list.
   std::list<Thread*> GetList() REQUIRES(Locks::thread_list_lock_) {
     return list_;
@@ -23,6 +23,9 @@
 
 #include <pthread.h>
 
+#include <algorithm>
+#include <memory>
+
 #include <android-base/logging.h>
 #include <android-base/stringprintf.h>
 
@@ -346,6 +349,349 @@ size_t ThreadPool::GetTaskCount(Thread* self) {
   return tasks_.size();
 }
 
+void ThreadPool::ForAll(Thread* self, size_t n, const std::function<void(size_t)>& fn) {
+  std::atomic<size_t> next(0u);
+  auto work = [&next, n, &fn](Thread*) {
+    for (size_t i = next.fetch_add(1u, std::memory_order_relaxed);
+         i < n;
+         i = next.fetch_add(1u, std::memory_order_relaxed)) {
+      fn(i);
+    }
+  };
+  // One task per thread, including the calling thread, each taking indexes until none is left.
+  for (size_t i = 0, num_tasks = std::min(n, GetThreadCount() + 1u); i != num_tasks; ++i) {
+    AddTask(self, new FunctionTask(work));
+  }
+  StartWorkers(self);
+  Wait(self, /*do_work=*/ true, /*may_hold_locks=*/ false);
+}
+
+// A Chase-Lev deque of tasks with a fixed capacity. The owner pushes and pops at the bottom,
+// other threads steal from the top.
+class WorkStealingThreadPool::WorkerQueue {
+ public:
+  static constexpr int64_t kCapacity = 1024;
+  static_assert(IsPowerOfTwo(kCapacity));
+
+  explicit WorkerQueue(size_t index)
+      : index_(index),
+        owner_(nullptr),
+        top_(0),
+        bottom_(0),
+        random_(static_cast<uint32_t>(index) + 1u) {
+    for (std::atomic<Task*>& slot : tasks_) {
+      slot.store(nullptr, std::memory_order_relaxed);
+    }
+  }
+
+  size_t GetIndex() const {
+    return index_;
+  }
+
+  Thread* GetOwner() const {
+    return owner_.load(std::memory_order_relaxed);
+  }
+
+  void SetOwner(Thread* owner) {
+    owner_.store(owner, std::memory_order_relaxed);
+  }
+
+  // Owner only. Returns false if the deque is full.
+  bool Push(Task* task) {
+    int64_t bottom = bottom_.load(std::memory_order_relaxed);
+    int64_t top = top_.load(std::memory_order_acquire);
+    if (bottom - top >= kCapacity) {
+      return false;
+    }
+    tasks_[bottom & (kCapacity - 1)].store(task, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom_.store(bottom + 1, std::memory_order_relaxed);
+    return true;
+  }
+
+  // Owner only.
+  Task* Pop() {
+    int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+    bottom_.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t top = top_.load(std::memory_order_relaxed);
+    if (top > bottom) {
+      bottom_.store(bottom + 1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    Task* task = tasks_[bottom & (kCapacity - 1)].load(std::memory_order_relaxed);
+    if (top == bottom) {
+      // Last task, race with the thieves for it.
+      if (!top_.compare_exchange_strong(
+              top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        task = nullptr;
+      }
+      bottom_.store(bottom + 1, std::memory_order_relaxed);
+    }
+    return task;
+  }
+
+  // Any thread. Returns null if the deque is empty or another thread took the task first.
+  Task* Steal() {
+    int64_t top = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t bottom = bottom_.load(std::memory_order_acquire);
+    if (top >= bottom) {
+      return nullptr;
+    }
+    Task* task = tasks_[top & (kCapacity - 1)].load(std::memory_order_relaxed);
+    if (!top_.compare_exchange_strong(
+            top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+      return nullptr;
+    }
+    return task;
+  }
+
+  // Any thread, approximate while the owner or thieves are active.
+  size_t Size() const {
+    int64_t bottom = bottom_.load(std::memory_order_acquire);
+    int64_t top = top_.load(std::memory_order_acquire);
+    return (bottom > top) ? static_cast<size_t>(bottom - top) : 0u;
+  }
+
+  // Owner only, xorshift.
+  uint32_t NextRandom() {
+    random_ ^= random_ << 13;
+    random_ ^= random_ >> 17;
+    random_ ^= random_ << 5;
+    return random_;
+  }
+
+ private:
+  const size_t index_;
+  std::atomic<Thread*> owner_;
+  std::atomic<int64_t> top_;
+  std::atomic<int64_t> bottom_;
+  uint32_t random_;
+  std::atomic<Task*> tasks_[kCapacity];
+};
+
+WorkStealingThreadPool::WorkStealingThreadPool(const char* name,
+                                               size_t num_threads,
+                                               bool create_peers,
+                                               size_t worker_stack_size)
+    : AbstractThreadPool(name, num_threads, create_peers, worker_stack_size),
+      running_(false),
+      num_running_workers_(num_threads),
+      num_parked_workers_(0u) {
+  worker_queues_.reserve(num_threads);
+  for (size_t i = 0; i != num_threads; ++i) {
+    worker_queues_.push_back(std::make_unique<WorkerQueue>(i));
+  }
+}
+
+WorkStealingThreadPool::~WorkStealingThreadPool() {
+  DeleteThreads();
+  RemoveAllTasks(Thread::Current());
+}
+
+void WorkStealingThreadPool::StartWorkers(Thread* self) {
+  AbstractThreadPool::StartWorkers(self);
+  running_.store(true, std::memory_order_release);
+}
+
+void WorkStealingThreadPool::StopWorkers(Thread* self) {
+  AbstractThreadPool::StopWorkers(self);
+  running_.store(false, std::memory_order_release);
+}
+
+void WorkStealingThreadPool::SetMaxActiveWorkers(size_t max_workers) {
+  AbstractThreadPool::SetMaxActiveWorkers(max_workers);
+  num_running_workers_.store(max_workers, std::memory_order_relaxed);
+}
+
+thread_local WorkStealingThreadPool::WorkerQueue*
+    WorkStealingThreadPool::current_worker_queue_ = nullptr;
+
+WorkStealingThreadPool::WorkerQueue* WorkStealingThreadPool::FindWorkerQueue() const {
+  WorkerQueue* queue = current_worker_queue_;
+  // The current thread may be a worker of another pool.
+  if (queue != nullptr &&
+      queue->GetIndex() < worker_queues_.size() &&
+      worker_queues_[queue->GetIndex()].get() == queue) {
+    return queue;
+  }
+  return nullptr;
+}
+
+WorkStealingThreadPool::WorkerQueue* WorkStealingThreadPool::RegisterWorker(Thread* self) {
+  for (const std::unique_ptr<WorkerQueue>& queue : worker_queues_) {
+    if (queue->GetOwner() == nullptr) {
+      queue->SetOwner(self);
+      current_worker_queue_ = queue.get();
+      return queue.get();
+    }
+  }
+  LOG(FATAL) << "More workers than queues in " << name_;
+  UNREACHABLE();
+}
+
+void WorkStealingThreadPool::AddTask(Thread* self, Task* task) {
+  WorkerQueue* queue = FindWorkerQueue();
+  if (queue != nullptr && queue->Push(task)) {
+    // Pairs with the fence in GetTask(): either the parking worker sees the task or we see it.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (num_parked_workers_.load(std::memory_order_relaxed) != 0u) {
+      WakeParkedWorker(self);
+    }
+    return;
+  }
+  MutexLock mu(self, task_queue_lock_);
+  shared_tasks_.push_back(task);
+  if (started_ && waiting_count_ != 0) {
+    task_queue_condition_.Signal(self);
+  }
+}
+
+void WorkStealingThreadPool::WakeParkedWorker(Thread* self) {
+  MutexLock mu(self, task_queue_lock_);
+  if (started_ && waiting_count_ != 0) {
+    task_queue_condition_.Signal(self);
+  }
+}
+
+Task* WorkStealingThreadPool::Steal(WorkerQueue* thief) {
+  const size_t num_queues = worker_queues_.size();
+  size_t start = (thief != nullptr) ? thief->NextRandom() % num_queues : 0u;
+  for (size_t i = 0; i != num_queues; ++i) {
+    WorkerQueue* victim = worker_queues_[(start + i) % num_queues].get();
+    if (victim != thief) {
+      Task* task = victim->Steal();
+      if (task != nullptr) {
+        return task;
+      }
+    }
+  }
+  return nullptr;
+}
+
+Task* WorkStealingThreadPool::TakeSharedTasksLocked(WorkerQueue* queue) {
+  if (!started_ || shared_tasks_.empty()) {
+    return nullptr;
+  }
+  Task* task = shared_tasks_.front();
+  shared_tasks_.pop_front();
+  // Leave a share for each of the other workers.
+  size_t share = shared_tasks_.size() / worker_queues_.size();
+  for (size_t i = 0; i != share && queue->Push(shared_tasks_.front()); ++i) {
+    shared_tasks_.pop_front();
+  }
+  return task;
+}
+
+Task* WorkStealingThreadPool::GetTask(Thread* self) {
+  WorkerQueue* queue = FindWorkerQueue();
+  if (queue == nullptr) {
+    MutexLock mu(self, task_queue_lock_);
+    queue = RegisterWorker(self);
+  }
+  while (true) {
+    if (running_.load(std::memory_order_acquire) &&
+        queue->GetIndex() < num_running_workers_.load(std::memory_order_relaxed)) {
+      Task* task = queue->Pop();
+      if (task == nullptr) {
+        task = Steal(queue);
+      }
+      if (task != nullptr) {
+        return task;
+      }
+    }
+
+    MutexLock mu(self, task_queue_lock_);
+    if (IsShuttingDown()) {
+      // Tasks left in the deque are finalized by RemoveAllTasks().
+      queue->SetOwner(nullptr);
+      current_worker_queue_ = nullptr;
+      return nullptr;
+    }
+    const bool active = queue->GetIndex() < max_active_workers_;
+    if (active) {
+      Task* task = TakeSharedTasksLocked(queue);
+      if (task != nullptr) {
+        return task;
+      }
+    }
+    ++waiting_count_;
+    num_parked_workers_.fetch_add(1u, std::memory_order_relaxed);
+    // Pairs with the fence in AddTask(): either we see the task or the adding thread sees us.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    // A failed steal may have lost a race with another thief, only park if there is no task.
+    if (!active || !HasOutstandingTasks()) {
+      if (waiting_count_ == GetThreadCount() && !HasOutstandingTasks()) {
+        // We may be done, lets broadcast to the completion condition.
+        completion_condition_.Broadcast(self);
+      }
+      const uint64_t wait_start = kMeasureWaitTime ? NanoTime() : 0;
+      task_queue_condition_.Wait(self);
+      if (kMeasureWaitTime) {
+        const uint64_t wait_end = NanoTime();
+        total_wait_time_ += wait_end - std::max(wait_start, start_time_);
+      }
+    }
+    num_parked_workers_.fetch_sub(1u, std::memory_order_relaxed);
+    --waiting_count_;
+  }
+}
+
+Task* WorkStealingThreadPool::TryGetTaskLocked() {
+  if (!started_) {
+    return nullptr;
+  }
+  if (!shared_tasks_.empty()) {
+    Task* task = shared_tasks_.front();
+    shared_tasks_.pop_front();
+    return task;
+  }
+  return Steal(/*thief=*/ nullptr);
+}
+
+bool WorkStealingThreadPool::HasOutstandingTasks() const {
+  if (!started_) {
+    return false;
+  }
+  if (!shared_tasks_.empty()) {
+    return true;
+  }
+  return std::any_of(worker_queues_.begin(),
+                     worker_queues_.end(),
+                     [](const std::unique_ptr<WorkerQueue>& queue) { return queue->Size() != 0u; });
+}
+
+size_t WorkStealingThreadPool::GetTaskCount(Thread* self) {
+  MutexLock mu(self, task_queue_lock_);
+  size_t count = shared_tasks_.size();
+  for (const std::unique_ptr<WorkerQueue>& queue : worker_queues_) {
+    count += queue->Size();
+  }
+  return count;
+}
+
+void WorkStealingThreadPool::RemoveAllTasks(Thread* self) {
+  // The WorkStealingThreadPool is responsible for calling Finalize (which usually delete
+  // the task memory) on all the tasks.
+  Task* task = nullptr;
+  do {
+    {
+      MutexLock mu(self, task_queue_lock_);
+      if (!shared_tasks_.empty()) {
+        task = shared_tasks_.front();
+        shared_tasks_.pop_front();
+      } else {
+        task = Steal(/*thief=*/ nullptr);
+      }
+    }
+    if (task == nullptr) {
+      return;
+    }
+    task->Finalize();
+  } while (true);
+}
+
 void AbstractThreadPool::SetPthreadPriority(int priority) {
   for (ThreadPoolWorker* worker : threads_) {
     worker->SetPthreadPriority(priority);
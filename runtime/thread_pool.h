@@ -17,8 +17,10 @@
 #ifndef ART_RUNTIME_THREAD_POOL_H_
 #define ART_RUNTIME_THREAD_POOL_H_
 
+#include <atomic>
 #include <deque>
 #include <functional>
+#include <memory>
 #include <vector>
 
 #include "barrier.h"
@@ -119,10 +121,10 @@ class AbstractThreadPool {
   EXPORT const std::vector<ThreadPoolWorker*>& GetWorkers();
 
   // Broadcast to the workers and tell them to empty out the work queue.
-  EXPORT void StartWorkers(Thread* self) REQUIRES(!task_queue_lock_);
+  EXPORT virtual void StartWorkers(Thread* self) REQUIRES(!task_queue_lock_);
 
   // Do not allow workers to grab any new tasks.
-  EXPORT void StopWorkers(Thread* self) REQUIRES(!task_queue_lock_);
+  EXPORT virtual void StopWorkers(Thread* self) REQUIRES(!task_queue_lock_);
 
   // Returns if the thread pool has started.
   bool HasStarted(Thread* self) REQUIRES(!task_queue_lock_);
@@ -154,7 +156,7 @@ class AbstractThreadPool {
 
   // Provides a way to bound the maximum number of worker threads, threads must be less the the
   // thread count of the thread pool.
-  void SetMaxActiveWorkers(size_t threads) REQUIRES(!task_queue_lock_);
+  virtual void SetMaxActiveWorkers(size_t threads) REQUIRES(!task_queue_lock_);
 
   // Set the "nice" priority for threads in the pool.
   void SetPthreadPriority(int priority);
@@ -170,7 +172,7 @@ class AbstractThreadPool {
 
  protected:
   // get a task to run, blocks if there are no tasks left
-  Task* GetTask(Thread* self) REQUIRES(!task_queue_lock_);
+  virtual Task* GetTask(Thread* self) REQUIRES(!task_queue_lock_);
 
   // Try to get a task, returning null if there is none available.
   Task* TryGetTask(Thread* self) REQUIRES(!task_queue_lock_);
@@ -232,6 +234,12 @@ class EXPORT ThreadPool : public AbstractThreadPool {
   void RemoveAllTasks(Thread* self) REQUIRES(!task_queue_lock_) override;
   ~ThreadPool() override;
 
+  // Calls `fn(i)` for each `i` in [0, n) on the workers and on the calling thread, and returns
+  // when all calls are done. Starts the workers. The pool must not be running other tasks and
+  // the calling thread must not be one of its workers.
+  void ForAll(Thread* self, size_t n, const std::function<void(size_t)>& fn)
+      REQUIRES(!task_queue_lock_);
+
  protected:
   Task* TryGetTaskLocked() REQUIRES(task_queue_lock_) override;
 
@@ -251,6 +259,72 @@ class EXPORT ThreadPool : public AbstractThreadPool {
   DISALLOW_COPY_AND_ASSIGN(ThreadPool);
 };
 
+// A thread pool with a task deque per worker, for fine-grained tasks and tasks adding more
+// tasks. A worker adds tasks to the bottom of its own deque and takes them from there, LIFO,
+// without locking. A worker whose deque is empty steals the oldest task of another worker,
+// starting with a random one. Tasks added by other threads go to a shared queue, from which
+// an idle worker takes a share of the tasks at once. Workers that find no task park on the
+// task queue condition like ThreadPool workers do and are unparked when a task is added.
+//
+// Tasks are not run in the order they were added, even with a single worker.
+class EXPORT WorkStealingThreadPool : public AbstractThreadPool {
+ public:
+  static WorkStealingThreadPool* Create(
+      const char* name,
+      size_t num_threads,
+      bool create_peers = false,
+      size_t worker_stack_size = ThreadPoolWorker::kDefaultStackSize) {
+    WorkStealingThreadPool* pool =
+        new WorkStealingThreadPool(name, num_threads, create_peers, worker_stack_size);
+    pool->CreateThreads();
+    return pool;
+  }
+
+  void StartWorkers(Thread* self) REQUIRES(!task_queue_lock_) override;
+  void StopWorkers(Thread* self) REQUIRES(!task_queue_lock_) override;
+  void SetMaxActiveWorkers(size_t threads) REQUIRES(!task_queue_lock_) override;
+  void AddTask(Thread* self, Task* task) REQUIRES(!task_queue_lock_) override;
+  size_t GetTaskCount(Thread* self) REQUIRES(!task_queue_lock_) override;
+  void RemoveAllTasks(Thread* self) REQUIRES(!task_queue_lock_) override;
+  ~WorkStealingThreadPool() override;
+
+ protected:
+  Task* GetTask(Thread* self) REQUIRES(!task_queue_lock_) override;
+  Task* TryGetTaskLocked() REQUIRES(task_queue_lock_) override;
+  bool HasOutstandingTasks() const REQUIRES(task_queue_lock_) override;
+
+  WorkStealingThreadPool(const char* name,
+                         size_t num_threads,
+                         bool create_peers,
+                         size_t worker_stack_size);
+
+ private:
+  class WorkerQueue;
+
+  // Returns the queue of the current thread, or null if it is not a worker of this pool.
+  WorkerQueue* FindWorkerQueue() const;
+  WorkerQueue* RegisterWorker(Thread* self) REQUIRES(task_queue_lock_);
+  Task* Steal(WorkerQueue* thief);
+  // Takes a share of the shared queue, moving the tasks after the first one to the deque of
+  // `queue`, and returns the first one.
+  Task* TakeSharedTasksLocked(WorkerQueue* queue) REQUIRES(task_queue_lock_);
+  void WakeParkedWorker(Thread* self) REQUIRES(!task_queue_lock_);
+
+  // The queue of the current thread if it is a worker of a work-stealing pool, so that
+  // FindWorkerQueue() does not need to scan `worker_queues_`.
+  static thread_local WorkerQueue* current_worker_queue_;
+
+  std::vector<std::unique_ptr<WorkerQueue>> worker_queues_;
+  std::deque<Task*> shared_tasks_ GUARDED_BY(task_queue_lock_);
+  // Copies of `started_` and `max_active_workers_` read by the workers without locking.
+  std::atomic<bool> running_;
+  std::atomic<size_t> num_running_workers_;
+  // Mirrors `waiting_count_`, so that adding a task to a deque only locks if a worker is parked.
+  std::atomic<size_t> num_parked_workers_;
+
+  DISALLOW_COPY_AND_ASSIGN(WorkStealingThreadPool);
+};
+
 }  // namespace art
 
 #endif  // ART_RUNTIME_THREAD_POOL_H_
@@ -19,6 +19,7 @@
 #include <string>
 
 #include "base/atomic.h"
+#include "base/time_utils.h"
 #include "common_runtime_test.h"
 #include "scoped_thread_state_change-inl.h"
 #include "thread-inl.h"
@@ -127,7 +128,7 @@ TEST_F(ThreadPoolTest, StopWait) {
 
 class TreeTask : public Task {
  public:
-  TreeTask(ThreadPool* const thread_pool, AtomicInteger* count, int depth)
+  TreeTask(AbstractThreadPool* const thread_pool, AtomicInteger* count, int depth)
       : thread_pool_(thread_pool),
         count_(count),
         depth_(depth) {}
@@ -146,7 +147,7 @@ class TreeTask : public Task {
   }
 
  private:
-  ThreadPool* const thread_pool_;
+  AbstractThreadPool* const thread_pool_;
   AtomicInteger* const count_;
   const int depth_;
 };
@@ -164,6 +165,90 @@ TEST_F(ThreadPoolTest, RecursiveTest) {
   EXPECT_EQ((1 << depth) - 1, count.load(std::memory_order_seq_cst));
 }
 
+TEST_F(ThreadPoolTest, WorkStealingCheckRun) {
+  Thread* self = Thread::Current();
+  std::unique_ptr<WorkStealingThreadPool> thread_pool(
+      WorkStealingThreadPool::Create("Work stealing thread pool test thread pool", num_threads));
+  AtomicInteger count(0);
+  static const int32_t num_tasks = num_threads * 4;
+  for (int32_t i = 0; i < num_tasks; ++i) {
+    thread_pool->AddTask(self, new CountTask(&count));
+  }
+  EXPECT_EQ(static_cast<size_t>(num_tasks), thread_pool->GetTaskCount(self));
+  thread_pool->StartWorkers(self);
+  thread_pool->Wait(self, true, false);
+  EXPECT_EQ(num_tasks, count.load(std::memory_order_seq_cst));
+  EXPECT_EQ(0u, thread_pool->GetTaskCount(self));
+}
+
+TEST_F(ThreadPoolTest, WorkStealingStopStart) {
+  Thread* self = Thread::Current();
+  std::unique_ptr<WorkStealingThreadPool> thread_pool(
+      WorkStealingThreadPool::Create("Work stealing thread pool test thread pool", num_threads));
+  AtomicInteger count(0);
+  static const int32_t num_tasks = num_threads * 4;
+  for (int32_t i = 0; i < num_tasks; ++i) {
+    thread_pool->AddTask(self, new CountTask(&count));
+  }
+  usleep(200);
+  // Check that no threads started prematurely.
+  EXPECT_EQ(0, count.load(std::memory_order_seq_cst));
+  thread_pool->StartWorkers(self);
+  thread_pool->Wait(self, false, false);
+  thread_pool->StopWorkers(self);
+  AtomicInteger bad_count(0);
+  thread_pool->AddTask(self, new CountTask(&bad_count));
+  usleep(200);
+  // Ensure that the task added after the workers were stopped doesn't get run.
+  EXPECT_EQ(0, bad_count.load(std::memory_order_seq_cst));
+  EXPECT_EQ(num_tasks, count.load(std::memory_order_seq_cst));
+  thread_pool->StartWorkers(self);
+  thread_pool->Wait(self, false, false);
+  EXPECT_EQ(1, bad_count.load(std::memory_order_seq_cst));
+}
+
+// Tasks added by the workers go to their own deques and are stolen by the other workers.
+TEST_F(ThreadPoolTest, WorkStealingRecursiveTest) {
+  Thread* self = Thread::Current();
+  std::unique_ptr<WorkStealingThreadPool> thread_pool(
+      WorkStealingThreadPool::Create("Work stealing thread pool test thread pool", num_threads));
+  AtomicInteger count(0);
+  static const int depth = 12;
+  thread_pool->AddTask(self, new TreeTask(thread_pool.get(), &count, depth));
+  thread_pool->StartWorkers(self);
+  thread_pool->Wait(self, false, false);
+  EXPECT_EQ((1 << depth) - 1, count.load(std::memory_order_seq_cst));
+}
+
+// Compares the time to run many small tasks with both thread pools, for 1 to 64 workers. The
+// shared task queue of ThreadPool becomes the bottleneck as the number of workers grows.
+TEST_F(ThreadPoolTest, WorkStealingBenchmark) {
+  Thread* self = Thread::Current();
+  static const int depth = 14;
+  auto run = [self](AbstractThreadPool* thread_pool) {
+    AtomicInteger count(0);
+    uint64_t start = NanoTime();
+    thread_pool->AddTask(self, new TreeTask(thread_pool, &count, depth));
+    thread_pool->StartWorkers(self);
+    thread_pool->Wait(self, false, false);
+    uint64_t time = NanoTime() - start;
+    thread_pool->StopWorkers(self);
+    EXPECT_EQ((1 << depth) - 1, count.load(std::memory_order_seq_cst));
+    return time;
+  };
+  for (size_t threads = 1; threads <= 64u; threads *= 2u) {
+    std::unique_ptr<ThreadPool> thread_pool(
+        ThreadPool::Create("Thread pool test thread pool", threads));
+    uint64_t shared_queue_time = run(thread_pool.get());
+    thread_pool.reset();
+    std::unique_ptr<WorkStealingThreadPool> work_stealing_thread_pool(
+        WorkStealingThreadPool::Create("Work stealing thread pool test thread pool", threads));
+    uint64_t work_stealing_time = run(work_stealing_thread_pool.get());
+    LOG(INFO) << threads << " threads: ThreadPool " << PrettyDuration(shared_queue_time)
+              << ", WorkStealingThreadPool " << PrettyDuration(work_stealing_time);
+  }
+}
+
 class PeerTask : public Task {
  public:
   PeerTask() {}
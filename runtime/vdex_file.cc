@@ -205,20 +205,7 @@ std::unique_ptr<VdexFile> VdexFile::OpenFromDm(const std::string& filename,
 }
 
 bool VdexFile::IsValid() const {
-  if (mmap_.Size() < sizeof(VdexFileHeader) || !GetVdexFileHeader().IsValid()) {
-    return false;
-  }
-
-  // Invalidate vdex files that contain dex files in the no longer supported
-  // compact dex format. Revert this whenever the vdex version is bumped.
-  size_t i = 0;
-  for (const uint8_t* dex_file_start = GetNextDexFileData(nullptr, i); dex_file_start != nullptr;
-       dex_file_start = GetNextDexFileData(dex_file_start, ++i)) {
-    if (!DexFileLoader::IsMagicValid(dex_file_start)) {
-      return false;
-    }
-  }
-  return true;
+  return mmap_.Size() >= sizeof(VdexFileHeader) && GetVdexFileHeader().IsValid();
 }
 
 const uint8_t* VdexFile::GetNextDexFileData(const uint8_t* cursor, uint32_t dex_file_index) const {
@@ -503,20 +490,14 @@ ClassStatus VdexFile::ComputeClassStatus(Thread* self, Handle<mirror::Class> cls
 
   // Fetch type checks offsets.
   uint32_t class_def_offset = dex_file_class_defs[class_def_index];
-  if (class_def_offset == verifier::VerifierDeps::kNotVerifiedMarker) {
+  if ((class_def_offset & verifier::VerifierDeps::kNotVerifiedBit) != 0u) {
     // Return a status that needs re-verification.
     return ClassStatus::kResolved;
   }
-  // End offset for this class's type checks. We know there is one and the loop
-  // will terminate.
-  uint32_t end_offset = verifier::VerifierDeps::kNotVerifiedMarker;
-  for (uint32_t i = class_def_index + 1; i < dex_file.NumClassDefs() + 1; ++i) {
-    end_offset = dex_file_class_defs[i];
-    if (end_offset != verifier::VerifierDeps::kNotVerifiedMarker) {
-      break;
-    }
-  }
-  DCHECK_NE(end_offset, verifier::VerifierDeps::kNotVerifiedMarker);
+  // End offset for this class's type checks, the offset entry of the next class
+  // or the end of the type checks for the last class.
+  uint32_t end_offset =
+      dex_file_class_defs[class_def_index + 1u] & ~verifier::VerifierDeps::kNotVerifiedBit;
 
   uint32_t number_of_extra_strings = 0;
   // Offset where extra strings are stored.
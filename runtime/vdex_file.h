@@ -68,8 +68,8 @@ class VerifierDeps;
 //      uint32[D]                  DexFileDeps offsets for each dex file
 //      DexFileDeps[D][]           verification dependencies
 //        4-byte alignment
-//        uint32[class_def_size]     TypeAssignability offsets (kNotVerifiedMarker for a class
-//                                        that isn't verified)
+//        uint32[class_def_size]     TypeAssignability offsets (with kNotVerifiedBit set for a
+//                                        class that isn't verified)
 //        uint32                     Offset of end of AssignabilityType sets
 //        uint8[]                    AssignabilityType sets
 //        4-byte alignment
@@ -124,9 +124,8 @@ class VdexFile {
     static constexpr uint8_t kVdexMagic[] = { 'v', 'd', 'e', 'x' };
 
     // The format version of the verifier deps header and the verifier deps.
-    // TODO: Revert the dex header checks in VdexFile::IsValid when this is bumped.
-    // Last update: Introduce vdex sections.
-    static constexpr uint8_t kVdexVersion[] = { '0', '2', '7', '\0' };
+    // Last update: Keep offsets of classes that are not verified.
+    static constexpr uint8_t kVdexVersion[] = { '0', '2', '8', '\0' };
 
     uint8_t magic_[4];
     uint8_t vdex_version_[4];
@@ -1606,6 +1606,18 @@ bool MethodVerifier<kVerifierDebug>::Verify() {
           }
         }
       }
+      if ((native_access_flags & kAccReferenceFreeNative) != 0) {
+        if ((native_access_flags & kAccFastNative) == 0) {
+          Fail(VERIFY_ERROR_BAD_CLASS_HARD) << "reference-free native methods must be fast native";
+          return false;
+        }
+        const char* shorty = dex_file_->GetMethodShorty(dex_method_idx_);
+        if (Primitive::GetType(shorty[0]) == Primitive::kPrimNot) {
+          Fail(VERIFY_ERROR_BAD_CLASS_HARD) <<
+              "reference-free native methods must not have a reference return type";
+          return false;
+        }
+      }
     }
 
     // This should have been rejected by the dex file verifier. Only do in debug build.
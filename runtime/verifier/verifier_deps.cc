@@ -413,6 +413,7 @@ static void EncodeSetVector(std::vector<uint8_t>* out,
   out->resize(out->size() + (vector.size() + 1) * sizeof(uint32_t));
   uint32_t class_def_index = 0;
   for (const std::set<T>& set : vector) {
+    DCHECK_EQ(out->size() & VerifierDeps::kNotVerifiedBit, 0u);
     if (verified_classes[class_def_index]) {
       // Store the offset of the set for this class.
       SetUint32InUint8Array(out, offsets_index, class_def_index, out->size());
@@ -420,10 +421,12 @@ static void EncodeSetVector(std::vector<uint8_t>* out,
         EncodeTuple(out, entry);
       }
     } else {
-      SetUint32InUint8Array(out, offsets_index, class_def_index, VerifierDeps::kNotVerifiedMarker);
+      SetUint32InUint8Array(
+          out, offsets_index, class_def_index, VerifierDeps::kNotVerifiedBit | out->size());
     }
     class_def_index++;
   }
+  DCHECK_EQ(out->size() & VerifierDeps::kNotVerifiedBit, 0u);
   SetUint32InUint8Array(out, offsets_index, class_def_index, out->size());
 }
 
@@ -435,39 +438,40 @@ static bool DecodeSetVector(const uint8_t** cursor,
                             std::vector<bool>* verified_classes,
                             size_t num_class_defs) {
   const uint32_t* offsets = reinterpret_cast<const uint32_t*>(*cursor);
-  uint32_t next_valid_offset_index = 1;
   // Put the cursor after the offsets of each class, +1 for the offset of the
   // end of the assignable types data.
   *cursor += (num_class_defs + 1) * sizeof(uint32_t);
+  if (UNLIKELY(*cursor > end)) {
+    return false;
+  }
   for (uint32_t i = 0; i < num_class_defs; ++i) {
     uint32_t offset = offsets[i];
-    if (offset == VerifierDeps::kNotVerifiedMarker) {
+    if ((offset & VerifierDeps::kNotVerifiedBit) != 0u) {
       (*verified_classes)[i] = false;
       continue;
     }
     (*verified_classes)[i] = true;
+    if (!kFillSet) {
+      continue;
+    }
     *cursor = start + offset;
-    // Fetch the assignability checks.
+    // Fetch the assignability checks. The next entry in the `offsets` array tells us
+    // where to stop, the last one points to the end of the assignability types data.
     std::set<T>& set = (*vector)[i];
-    // Find the offset of the next entry. This will tell us where to stop when
-    // reading the checks. Note that the last entry in the `offsets` array points
-    // to the end of the assignability types data, so the loop will terminate correctly.
-    while (next_valid_offset_index <= i ||
-           offsets[next_valid_offset_index] == VerifierDeps::kNotVerifiedMarker) {
-      next_valid_offset_index++;
-    }
-    const uint8_t* set_end = start + offsets[next_valid_offset_index];
+    const uint8_t* set_end = start + (offsets[i + 1] & ~VerifierDeps::kNotVerifiedBit);
     // Decode each check.
     while (*cursor < set_end) {
       T tuple;
       if (UNLIKELY(!DecodeTuple(cursor, end, &tuple))) {
         return false;
       }
-      if (kFillSet) {
-        set.emplace(tuple);
-      }
+      set.emplace(tuple);
     }
   }
+  if (UNLIKELY(offsets[num_class_defs] > static_cast<size_t>(end - start))) {
+    return false;
+  }
+  *cursor = start + offsets[num_class_defs];
   // Align the cursor to start decoding the strings.
   *cursor = AlignUp(*cursor, sizeof(uint32_t));
   return true;
@@ -584,6 +588,50 @@ bool VerifierDeps::ParseStoredData(const std::vector<const DexFile*>& dex_files,
   return true;
 }
 
+bool VerifierDeps::ImportClasses(
+    const std::vector<const DexFile*>& old_dex_files,
+    ArrayRef<const uint8_t> old_data,
+    const std::vector<std::pair<ClassReference, ClassReference>>& classes) {
+  DCHECK_EQ(GetMainVerifierDeps(this), this);
+  VerifierDeps old_deps(old_dex_files, /*output_only=*/ false);
+  if (!old_deps.ParseStoredData(old_dex_files, old_data)) {
+    return false;
+  }
+  for (const auto& [old_ref, new_ref] : classes) {
+    const DexFileDeps* old_file_deps = old_deps.GetDexFileDeps(*old_ref.dex_file);
+    DexFileDeps* new_file_deps = GetDexFileDeps(*new_ref.dex_file);
+    DCHECK(old_file_deps != nullptr);
+    DCHECK(new_file_deps != nullptr);
+    if (!old_file_deps->verified_classes_[old_ref.ClassDefIdx()]) {
+      continue;
+    }
+    // String ids are local to a dex file, go through the strings to translate them.
+    std::set<TypeAssignability>& assignables =
+        new_file_deps->assignable_types_[new_ref.ClassDefIdx()];
+    for (const TypeAssignability& entry : old_file_deps->assignable_types_[old_ref.ClassDefIdx()]) {
+      std::string destination =
+          old_deps.GetStringFromIndex(*old_ref.dex_file, entry.GetDestination());
+      std::string source = old_deps.GetStringFromIndex(*old_ref.dex_file, entry.GetSource());
+      assignables.emplace(GetIdFromString(*new_ref.dex_file, destination),
+                          GetIdFromString(*new_ref.dex_file, source));
+    }
+    new_file_deps->verified_classes_[new_ref.ClassDefIdx()] = true;
+  }
+  return true;
+}
+
+void VerifierDeps::ClearUnverifiedClasses(const std::vector<const DexFile*>& dex_files) {
+  for (const DexFile* dex_file : dex_files) {
+    DexFileDeps* deps = GetDexFileDeps(*dex_file);
+    DCHECK(deps != nullptr);
+    for (size_t i = 0, size = deps->verified_classes_.size(); i != size; ++i) {
+      if (!deps->verified_classes_[i]) {
+        deps->assignable_types_[i].clear();
+      }
+    }
+  }
+}
+
 bool VerifierDeps::ParseVerifiedClasses(
     const std::vector<const DexFile*>& dex_files,
     ArrayRef<const uint8_t> data,
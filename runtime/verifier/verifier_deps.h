@@ -19,11 +19,13 @@
 
 #include <map>
 #include <set>
+#include <utility>
 #include <vector>
 
 #include "base/array_ref.h"
 #include "base/locks.h"
 #include "base/macros.h"
+#include "dex/class_reference.h"
 #include "dex/dex_file_structs.h"
 #include "dex/dex_file_types.h"
 #include "handle.h"
@@ -65,13 +67,30 @@ class VerifierDeps {
                                bool output_only = true);
 
   // Marker to know whether a class is verified. A non-verified class will have
-  // this marker as its offset entry in the encoded data.
-  static uint32_t constexpr kNotVerifiedMarker = std::numeric_limits<uint32_t>::max();
+  // this bit set in its offset entry in the encoded data. The rest of the entry
+  // is still the offset of the next class's data, so that the offset entries are
+  // monotonic and the data of any class can be found without a search.
+  static uint32_t constexpr kNotVerifiedBit = 1u << 31;
 
   // Fill dependencies from stored data. Returns true on success, false on failure.
   EXPORT bool ParseStoredData(const std::vector<const DexFile*>& dex_files,
                               ArrayRef<const uint8_t> data);
 
+  // Import the dependencies that a previous build recorded in `old_data` for `old_dex_files`.
+  // Each entry of `classes` pairs a class def of `old_dex_files` with a class def of this
+  // `VerifierDeps` whose verification is known to be equivalent. Only classes that were
+  // verified in the previous build are imported. Must be called on the main `VerifierDeps`.
+  // Returns false if `old_data` cannot be parsed.
+  EXPORT bool ImportClasses(const std::vector<const DexFile*>& old_dex_files,
+                            ArrayRef<const uint8_t> old_data,
+                            const std::vector<std::pair<ClassReference, ClassReference>>& classes)
+      REQUIRES(!Locks::verifier_deps_lock_);
+
+  // Drop the dependencies of the classes of `dex_files` that are not verified, e.g. imported
+  // classes whose dependencies did not hold, so that they do not get mixed with the ones the
+  // verifier records when verifying them again.
+  EXPORT void ClearUnverifiedClasses(const std::vector<const DexFile*>& dex_files);
+
   // Merge `other` into this `VerifierDeps`'. `other` and `this` must be for the
   // same set of dex files.
   EXPORT void MergeWith(std::unique_ptr<VerifierDeps> other,
@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+public class Main {
+    static int sA;
+    static int sB;
+
+    public static void main(String[] args) {
+        for (boolean flag : new boolean[] {false, true}) {
+            sA = 0;
+            sB = 0;
+            $noinline$unswitchingSimple(5, flag);
+            assertEquals(flag ? 4 : 0, sA);
+            assertEquals(flag ? 0 : 4, sB);
+
+            sA = 0;
+            sB = 0;
+            $noinline$unswitchingBudget(5, flag);
+            assertEquals(flag ? 4 : 0, sA);
+            assertEquals(flag ? 0 : 4, sB);
+        }
+    }
+
+    /// CHECK-START: void Main.$noinline$unswitchingSimple(int, boolean) loop_optimization (before)
+    /// CHECK-DAG: <<Flag:z\d+>> ParameterValue               loop:none
+    /// CHECK-DAG:               If [<<Flag>>]                loop:<<Loop:B\d+>> outer_loop:none
+
+    // The loop is duplicated behind a guard on the invariant condition.
+    /// CHECK-START: void Main.$noinline$unswitchingSimple(int, boolean) loop_optimization (after)
+    /// CHECK-DAG: <<Flag:z\d+>> ParameterValue               loop:none
+    /// CHECK-DAG:               If [<<Flag>>]                loop:none
+    /// CHECK-DAG:               Phi                          loop:<<Loop1:B\d+>> outer_loop:none
+    /// CHECK-DAG:               Phi                          loop:<<Loop2:B\d+>> outer_loop:none
+    /// CHECK-EVAL: "<<Loop1>>" != "<<Loop2>>"
+
+    /// CHECK-START: void Main.$noinline$unswitchingSimple(int, boolean) loop_optimization (after)
+    /// CHECK:       <<Flag:z\d+>> ParameterValue
+    /// CHECK-NOT:                 If [<<Flag>>]              loop:{{B\d+}}
+
+    // Each version of the loop only stores to one of the fields.
+    /// CHECK-START: void Main.$noinline$unswitchingSimple(int, boolean) dead_code_elimination$before_codegen (after)
+    /// CHECK-DAG: StaticFieldSet field_name:Main.sA          loop:<<Loop1:B\d+>> outer_loop:none
+    /// CHECK-DAG: StaticFieldSet field_name:Main.sB          loop:<<Loop2:B\d+>> outer_loop:none
+    /// CHECK-EVAL: "<<Loop1>>" != "<<Loop2>>"
+    private static void $noinline$unswitchingSimple(int n, boolean flag) {
+        for (int i = 0; i < n; i++) {
+            if (flag) {
+                sA = i;
+            } else {
+                sB = i;
+            }
+        }
+    }
+
+    // Eight loops together exceed the unswitching budget of the method, so at least one of them
+    // keeps its invariant branch.
+    /// CHECK-START: void Main.$noinline$unswitchingBudget(int, boolean) loop_optimization (after)
+    /// CHECK-DAG: <<Flag:z\d+>> ParameterValue               loop:none
+    /// CHECK-DAG:               If [<<Flag>>]                loop:none
+    /// CHECK-DAG:               If [<<Flag>>]                loop:{{B\d+}} outer_loop:none
+    private static void $noinline$unswitchingBudget(int n, boolean flag) {
+        for (int i = 0; i < n; i++) {
+            if (flag) { sA = i; } else { sB = i; }
+        }
+        for (int i = 0; i < n; i++) {
+            if (flag) { sA = i; } else { sB = i; }
+        }
+        for (int i = 0; i < n; i++) {
+            if (flag) { sA = i; } else { sB = i; }
+        }
+        for (int i = 0; i < n; i++) {
+            if (flag) { sA = i; } else { sB = i; }
+        }
+        for (int i = 0; i < n; i++) {
+            if (flag) { sA = i; } else { sB = i; }
+        }
+        for (int i = 0; i < n; i++) {
+            if (flag) { sA = i; } else { sB = i; }
+        }
+        for (int i = 0; i < n; i++) {
+            if (flag) { sA = i; } else { sB = i; }
+        }
+        for (int i = 0; i < n; i++) {
+            if (flag) { sA = i; } else { sB = i; }
+        }
+    }
+
+    private static void assertEquals(int expected, int result) {
+        if (expected != result) {
+            throw new Error("Expected: " + expected + ", found: " + result);
+        }
+    }
+}
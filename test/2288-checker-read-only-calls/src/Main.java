@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// The callees below are too big to be inlined but small enough to be scanned for heap writes.
+public class Main {
+    static int sField;
+    static int sOther;
+
+    public static void main(String[] args) {
+        int[] a = new int[] {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+
+        sField = 100;
+        assertEquals(100 + 45 + 100, $noinline$gvnAcrossReadOnlyCall(a));
+        assertEquals(3 * (100 + 45), $noinline$licmAcrossReadOnlyCall(a, 3));
+
+        sField = 100;
+        assertEquals(100 + 45 + 45, $noinline$noGvnAcrossWritingCall(a));
+        sField = 100;
+        assertEquals(100 + 45 + 45, $noinline$noGvnAcrossCallingCall(a));
+        sField = 100;
+        assertEquals((100 + 45) + (45 + 45), $noinline$noLicmAcrossWritingCall(a, 2));
+    }
+
+    /// CHECK-START: int Main.$noinline$gvnAcrossReadOnlyCall(int[]) GVN (before)
+    /// CHECK:     StaticFieldGet field_name:Main.sField
+    /// CHECK:     InvokeStaticOrDirect method_name:Main.readOnlySum
+    /// CHECK:     StaticFieldGet field_name:Main.sField
+
+    /// CHECK-START: int Main.$noinline$gvnAcrossReadOnlyCall(int[]) GVN (after)
+    /// CHECK:     StaticFieldGet field_name:Main.sField
+    /// CHECK-NOT: StaticFieldGet field_name:Main.sField
+    private static int $noinline$gvnAcrossReadOnlyCall(int[] a) {
+        int x = sField;
+        int y = readOnlySum(a);
+        return x + y + sField;
+    }
+
+    /// CHECK-START: int Main.$noinline$licmAcrossReadOnlyCall(int[], int) licm (before)
+    /// CHECK-DAG: StaticFieldGet field_name:Main.sField                   loop:{{B\d+}}
+    /// CHECK-DAG: InvokeStaticOrDirect method_name:Main.readOnlySum      loop:{{B\d+}}
+
+    /// CHECK-START: int Main.$noinline$licmAcrossReadOnlyCall(int[], int) licm (after)
+    /// CHECK-DAG: StaticFieldGet field_name:Main.sField                   loop:none
+    /// CHECK-DAG: InvokeStaticOrDirect method_name:Main.readOnlySum      loop:{{B\d+}}
+    private static int $noinline$licmAcrossReadOnlyCall(int[] a, int n) {
+        int sum = 0;
+        for (int i = 0; i < n; i++) {
+            sum += sField + readOnlySum(a);
+        }
+        return sum;
+    }
+
+    // The callee writes the field, the second load must stay.
+    /// CHECK-START: int Main.$noinline$noGvnAcrossWritingCall(int[]) GVN (after)
+    /// CHECK:     StaticFieldGet field_name:Main.sField
+    /// CHECK:     InvokeStaticOrDirect method_name:Main.writingSum
+    /// CHECK:     StaticFieldGet field_name:Main.sField
+    private static int $noinline$noGvnAcrossWritingCall(int[] a) {
+        int x = sField;
+        int y = writingSum(a);
+        return x + y + sField;
+    }
+
+    // The callee only writes through another call, the second load must stay.
+    /// CHECK-START: int Main.$noinline$noGvnAcrossCallingCall(int[]) GVN (after)
+    /// CHECK:     StaticFieldGet field_name:Main.sField
+    /// CHECK:     InvokeStaticOrDirect method_name:Main.callingSum
+    /// CHECK:     StaticFieldGet field_name:Main.sField
+    private static int $noinline$noGvnAcrossCallingCall(int[] a) {
+        int x = sField;
+        int y = callingSum(a);
+        return x + y + sField;
+    }
+
+    /// CHECK-START: int Main.$noinline$noLicmAcrossWritingCall(int[], int) licm (after)
+    /// CHECK-DAG: StaticFieldGet field_name:Main.sField                   loop:{{B\d+}}
+    /// CHECK-DAG: InvokeStaticOrDirect method_name:Main.writingSum       loop:{{B\d+}}
+    private static int $noinline$noLicmAcrossWritingCall(int[] a, int n) {
+        int sum = 0;
+        for (int i = 0; i < n; i++) {
+            sum += sField + writingSum(a);
+        }
+        return sum;
+    }
+
+    private static int readOnlySum(int[] a) {
+        return a[0] + a[1] + a[2] + a[3] + a[4] + a[5] + a[6] + a[7] + a[8] + a[9];
+    }
+
+    private static int writingSum(int[] a) {
+        int sum = a[0] + a[1] + a[2] + a[3] + a[4] + a[5] + a[6] + a[7] + a[8] + a[9];
+        sField = sum;
+        return sum;
+    }
+
+    private static int callingSum(int[] a) {
+        int sum = a[0] + a[1] + a[2] + a[3] + a[4] + a[5] + a[6] + a[7] + a[8] + a[9];
+        setField(sum);
+        return sum;
+    }
+
+    private static void setField(int value) {
+        sField = value;
+    }
+
+    private static void assertEquals(int expected, int result) {
+        if (expected != result) {
+            throw new Error("Expected: " + expected + ", found: " + result);
+        }
+    }
+}
@@ -46,6 +46,7 @@ public class Main implements Itf {
     ensureJitBaselineCompiled(Main.class, "$noinline$testInvokeInterface");
     ensureJitBaselineCompiled(Main.class, "$noinline$testInvokeInterface2");
     ensureJitBaselineCompiled(Main.class, "$noinline$testInlineToSameTarget");
+    ensureJitBaselineCompiled(Main.class, "$noinline$testMegamorphicSameTarget");
 
     // Make $noinline$testInvokeVirtual and $noinline$testInvokeInterface hot to get them jitted.
     // We pass Main and Subclass to get polymorphic inlining based on calling
@@ -66,6 +67,29 @@ public class Main implements Itf {
     ensureJittedAndPolymorphicInline("$noinline$testInvokeInterface2");
     ensureJittedAndPolymorphicInline("$noinline$testInlineToSameTarget");
 
+    // More receiver types than an inline cache holds, all sharing the same target. The target
+    // is still inlined, behind a guard that falls back to the virtual call.
+    Main[] megamorphic = new Main[] {
+        new Main(),
+        new Subclass(),
+        new MegamorphicSubclass1(),
+        new MegamorphicSubclass2(),
+        new MegamorphicSubclass3(),
+        new MegamorphicSubclass4(),
+    };
+    for (int i = 0; i < 0x10000; ++i) {
+      for (Main m : megamorphic) {
+        $noinline$testMegamorphicSameTarget(m);
+      }
+    }
+    ensureJittedAndPolymorphicInline("$noinline$testMegamorphicSameTarget");
+    for (Main m : megamorphic) {
+      assertEquals(Main.class, $noinline$testMegamorphicSameTarget(m));
+    }
+    // A receiver type with a different target takes the fallback call.
+    assertEquals(OtherSubclass.class, $noinline$testMegamorphicSameTarget(mains[2]));
+    assertEquals(Main.class, $noinline$testMegamorphicSameTarget(mains[0]));
+
     // At this point, the JIT should have compiled both methods, and inline
     // sameInvokeVirtual and sameInvokeInterface.
     assertEquals(Main.class, $noinline$testInvokeVirtual(mains[0]));
@@ -123,6 +147,15 @@ public class Main implements Itf {
     return m.sameInvokeVirtual();
   }
 
+  public Class<?> megamorphicTarget() {
+    field.getClass(); // null check to ensure we get an inlined frame in the CodeInfo.
+    return Main.class;
+  }
+
+  public static Class<?> $noinline$testMegamorphicSameTarget(Main m) {
+    return m.megamorphicTarget();
+  }
+
   public static void $noinline$testInlineToSameTarget(Main m) {
     m.increment();
   }
@@ -148,7 +181,23 @@ public class Main implements Itf {
 class Subclass extends Main {
 }
 
+class MegamorphicSubclass1 extends Main {
+}
+
+class MegamorphicSubclass2 extends Main {
+}
+
+class MegamorphicSubclass3 extends Main {
+}
+
+class MegamorphicSubclass4 extends Main {
+}
+
 class OtherSubclass extends Main {
+  public Class<?> megamorphicTarget() {
+    return OtherSubclass.class;
+  }
+
   public Class<?> sameInvokeVirtual() {
     return OtherSubclass.class;
   }
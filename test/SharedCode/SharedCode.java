@@ -0,0 +1,31 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// The methods below compile to the same code but with linker patches for different strings,
+// so their code is deduplicated while the methods are written to the oat file separately.
+class SharedCode {
+    static String first() {
+        return "SharedCode first string";
+    }
+
+    static String second() {
+        return "SharedCode second string";
+    }
+
+    static String third() {
+        return "SharedCode third string";
+    }
+}
@@ -56,6 +56,7 @@ class DexAnalyze {
         << "    -analyze-strings (Analyze string data)\n"
         << "    -analyze-debug-info (Analyze debug info)\n"
         << "    -new-bytecode (Bytecode optimizations)\n"
+        << "    -opcode-pairs (Count adjacent opcode pairs, candidates for fused handlers)\n"
         << "    -i (Ignore Dex checksum and verification failures)\n"
         << "    -a (Run all experiments)\n"
         << "    -n <int> (run experiment with 1 .. n as argument)\n"
@@ -101,6 +102,8 @@ class DexAnalyze {
           exp_debug_info_ = true;
         } else if (arg == "-new-bytecode") {
           exp_bytecode_ = true;
+        } else if (arg == "-opcode-pairs") {
+          exp_opcode_pairs_ = true;
         } else if (arg == "-d") {
           dump_per_input_dex_ = true;
         } else if (!arg.empty() && arg[0] == '-') {
@@ -125,6 +128,7 @@ class DexAnalyze {
     bool exp_analyze_strings_ = false;
     bool exp_debug_info_ = false;
     bool exp_bytecode_ = false;
+    bool exp_opcode_pairs_ = false;
     bool run_all_experiments_ = false;
     uint64_t experiment_max_ = 1u;
     std::vector<std::string> filenames_;
@@ -145,6 +149,9 @@ class DexAnalyze {
       if (options->run_all_experiments_ || options->exp_debug_info_) {
         experiments_.emplace_back(new AnalyzeDebugInfo);
       }
+      if (options->run_all_experiments_ || options->exp_opcode_pairs_) {
+        experiments_.emplace_back(new OpcodePairs);
+      }
       if (options->run_all_experiments_ || options->exp_bytecode_) {
         for (size_t i = 0; i < options->experiment_max_; ++i) {
           uint64_t exp_value = 0u;
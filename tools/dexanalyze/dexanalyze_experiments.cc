@@ -618,5 +618,46 @@ void CodeMetrics::Dump(std::ostream& os, uint64_t total_size) const {
   os << "Low arg savings: " << Percent(low_arg_total * 2, total_size) << "\n";
 }
 
+void OpcodePairs::ProcessDexFile(const DexFile& dex_file) {
+  for (ClassAccessor accessor : dex_file.GetClasses()) {
+    for (const ClassAccessor::Method& method : accessor.GetMethods()) {
+      const Instruction* prev = nullptr;
+      for (const DexInstructionPcPair& inst : method.GetInstructions()) {
+        // Payloads are NOPs, they are never executed.
+        if (inst->Opcode() == Instruction::NOP) {
+          prev = nullptr;
+          continue;
+        }
+        if (prev != nullptr && prev->CanFlowThrough()) {
+          ++pair_counts_[prev->Opcode()][inst->Opcode()];
+          ++total_pairs_;
+        }
+        prev = &inst.Inst();
+      }
+    }
+  }
+}
+
+void OpcodePairs::Dump(std::ostream& os, [[maybe_unused]] uint64_t total_size) const {
+  std::vector<std::pair<uint64_t, std::pair<size_t, size_t>>> pairs;
+  for (size_t first = 0; first < kNumOpcodes; ++first) {
+    for (size_t second = 0; second < kNumOpcodes; ++second) {
+      if (pair_counts_[first][second] != 0u) {
+        pairs.emplace_back(pair_counts_[first][second], std::make_pair(first, second));
+      }
+    }
+  }
+  std::sort(pairs.rbegin(), pairs.rend());
+  if (verbose_level_ < VerboseLevel::kEverything && pairs.size() > kNumTopPairs) {
+    pairs.resize(kNumTopPairs);
+  }
+  os << "Total opcode pairs: " << total_pairs_ << "\n";
+  for (const auto& [count, opcodes] : pairs) {
+    os << Instruction::Name(static_cast<Instruction::Code>(opcodes.first)) << " + "
+       << Instruction::Name(static_cast<Instruction::Code>(opcodes.second)) << ": "
+       << Percent(count, total_pairs_) << "\n";
+  }
+}
+
 }  // namespace dexanalyze
 }  // namespace art
@@ -172,6 +172,22 @@ class CodeMetrics : public Experiment {
   uint64_t move_result_savings_ = 0u;
 };
 
+// Count statically adjacent opcode pairs where the first instruction can fall through to the
+// second. The most frequent pairs are the candidates for fused interpreter handlers.
+class OpcodePairs : public Experiment {
+ public:
+  void ProcessDexFile(const DexFile& dex_file) override;
+
+  void Dump(std::ostream& os, uint64_t total_size) const override;
+
+ private:
+  static constexpr size_t kNumOpcodes = 256;
+  // Number of pairs to dump unless dumping everything.
+  static constexpr size_t kNumTopPairs = 32;
+  uint64_t pair_counts_[kNumOpcodes][kNumOpcodes] = {};
+  uint64_t total_pairs_ = 0u;
+};
+
 }  // namespace dexanalyze
 }  // namespace art
 